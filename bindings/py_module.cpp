@@ -1,4 +1,5 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
 #include "core/Engine.hpp"
 
@@ -8,10 +9,104 @@ PYBIND11_MODULE(trafficflowviz, m)
 {
     m.doc() = "TrafficFlowViz Python bindings";
 
+    py::enum_<tfv::FrameMode>(m, "FrameMode")
+        .value("VSYNC", tfv::FrameMode::VSYNC)
+        .value("FIXED_FPS", tfv::FrameMode::FIXED_FPS)
+        .value("UNCAPPED", tfv::FrameMode::UNCAPPED)
+        .value("ON_DEMAND", tfv::FrameMode::ON_DEMAND);
+
+    py::enum_<tfv::FeedType>(m, "FeedType")
+        .value("DUMMY", tfv::FeedType::DUMMY)
+        .value("WEBSOCKET", tfv::FeedType::WEBSOCKET)
+        .value("BINARY", tfv::FeedType::BINARY);
+
+    py::enum_<tfv::UpdateKind>(m, "UpdateKind")
+        .value("UPSERT", tfv::UpdateKind::UPSERT)
+        .value("REMOVE", tfv::UpdateKind::REMOVE);
+
+    py::class_<tfv::VehicleUpdate>(m, "VehicleUpdate")
+        .def(py::init<>())
+        .def(py::init(
+                 [](uint64_t id, uint32_t segmentId, float position, float speed)
+                 {
+                     tfv::VehicleUpdate update;
+                     update.id = id;
+                     update.segmentId = segmentId;
+                     update.position = position;
+                     update.speed = speed;
+                     return update;
+                 }),
+             py::arg("id"), py::arg("segment_id"), py::arg("position") = 0.0f,
+             py::arg("speed") = 0.0f)
+        .def_readwrite("id", &tfv::VehicleUpdate::id)
+        .def_readwrite("timestamp", &tfv::VehicleUpdate::timestamp)
+        .def_readwrite("lat", &tfv::VehicleUpdate::lat)
+        .def_readwrite("lon", &tfv::VehicleUpdate::lon)
+        .def_readwrite("segment_id", &tfv::VehicleUpdate::segmentId)
+        .def_readwrite("position", &tfv::VehicleUpdate::position)
+        .def_readwrite("speed", &tfv::VehicleUpdate::speed)
+        .def_readwrite("confidence", &tfv::VehicleUpdate::confidence)
+        .def_readwrite("sequence", &tfv::VehicleUpdate::sequence)
+        .def_readwrite("source", &tfv::VehicleUpdate::source)
+        .def_readwrite("kind", &tfv::VehicleUpdate::kind);
+
+    py::class_<tfv::FeedSourceStatus>(m, "FeedSourceStatus")
+        .def_readonly("source", &tfv::FeedSourceStatus::source)
+        .def_readonly("url", &tfv::FeedSourceStatus::url)
+        .def_readonly("type", &tfv::FeedSourceStatus::type)
+        .def_readonly("connected", &tfv::FeedSourceStatus::connected)
+        .def_readonly("messages_per_second", &tfv::FeedSourceStatus::messagesPerSecond)
+        .def_readonly("updates_per_second", &tfv::FeedSourceStatus::updatesPerSecond)
+        .def_readonly("bytes_per_second", &tfv::FeedSourceStatus::bytesPerSecond)
+        .def_readonly("lag", &tfv::FeedSourceStatus::lag)
+        .def_readonly("clock_offset", &tfv::FeedSourceStatus::clockOffset)
+        .def_readonly("decode_errors", &tfv::FeedSourceStatus::decodeErrors);
+
+    py::class_<tfv::FrameStats>(m, "FrameStats")
+        .def_readonly("p50", &tfv::FrameStats::p50)
+        .def_readonly("p95", &tfv::FrameStats::p95)
+        .def_readonly("p99", &tfv::FrameStats::p99)
+        .def_readonly("mean", &tfv::FrameStats::mean)
+        .def_readonly("samples", &tfv::FrameStats::samples);
+
     py::class_<tfv::Engine>(m, "Engine")
-        .def(py::init<const std::string&, int, int>())
+        .def(py::init<const std::string&, int, int, const std::string&>(), py::arg("title"),
+             py::arg("width"), py::arg("height"), py::arg("renderer") = "SDL")
         .def("init", &tfv::Engine::init)
         .def("run", &tfv::Engine::run)
         .def("set_csv", &tfv::Engine::setCityInfo)
-        .def("set_road_csv", &tfv::Engine::setVehicleInfo);
+        .def("set_road_csv", &tfv::Engine::setVehicleInfo)
+        .def("set_simulation_rate", &tfv::Engine::setSimulationRate)
+        .def("set_max_frames", &tfv::Engine::setMaxFrames)
+        .def("set_frame_time", &tfv::Engine::setFrameTime)
+        .def("set_threaded_rendering", &tfv::Engine::setThreadedRendering)
+        .def("set_frame_mode", &tfv::Engine::setFrameMode)
+        .def("set_target_fps", &tfv::Engine::setTargetFps)
+        .def("set_paused", &tfv::Engine::setPaused)
+        .def("frame_stats", &tfv::Engine::frameStats)
+        .def("export_image", &tfv::Engine::exportImage)
+        .def("start_video_recording", &tfv::Engine::startVideoRecording, py::arg("path"),
+             py::arg("fps") = 30)
+        .def("stop_video_recording", &tfv::Engine::stopVideoRecording)
+        .def("start_state_recording", &tfv::Engine::startStateRecording, py::arg("path"))
+        .def("stop_state_recording", &tfv::Engine::stopStateRecording)
+        .def("open_replay", &tfv::Engine::openReplay, py::arg("path"))
+        .def("close_replay", &tfv::Engine::closeReplay)
+        .def("is_replaying", &tfv::Engine::isReplaying)
+        .def("seek_replay", &tfv::Engine::seekReplay, py::arg("time"))
+        .def("set_replay_speed", &tfv::Engine::setReplaySpeed, py::arg("speed"))
+        .def("replay_time", &tfv::Engine::replayTime)
+        .def("save_checkpoint", &tfv::Engine::saveCheckpoint, py::arg("path"))
+        .def("load_checkpoint", &tfv::Engine::loadCheckpoint, py::arg("path"))
+        .def("connect_to_feed", &tfv::Engine::connectToFeed, py::arg("url"),
+             py::arg("type") = tfv::FeedType::WEBSOCKET)
+        .def("disconnect_from_feed", &tfv::Engine::disconnectFromFeed)
+        .def("add_feed_source", &tfv::Engine::addFeedSource, py::arg("url"),
+             py::arg("type") = tfv::FeedType::WEBSOCKET)
+        .def("remove_feed_source", &tfv::Engine::removeFeedSource, py::arg("source"))
+        .def("feed_sources", &tfv::Engine::feedSources)
+        .def("set_feed_geo_reference", &tfv::Engine::setFeedGeoReference, py::arg("lat"),
+             py::arg("lon"), py::arg("x"), py::arg("y"), py::arg("units_per_metre") = 1.0)
+        .def("apply_updates", &tfv::Engine::applyVehicleUpdates, py::arg("updates"))
+        .def("remove_vehicles", &tfv::Engine::removeVehicles, py::arg("ids"));
 }
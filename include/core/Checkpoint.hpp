@@ -0,0 +1,99 @@
+#ifndef TFV_CHECKPOINT_HPP
+#define TFV_CHECKPOINT_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/Simulation.hpp"
+#include "core/SimulationState.hpp"
+#include "core/TrafficEntity.hpp"
+
+namespace tfv
+{
+    /** Mutable per-segment fields of the road network (the geometry is not saved) */
+    struct SegmentCheckpoint
+    {
+        uint32_t id;
+        int vehicleCount;
+        float congestionLevel;
+        float currentSpeed;
+    };
+
+    /**
+     * Everything needed to resume a Simulation exactly where it was. The vehicles, tick and
+     * clock are those of a published state, shared rather than copied, so taking a
+     * checkpoint only copies the (small) per-segment data.
+     */
+    struct SimulationCheckpoint
+    {
+        SimulationStatePtr state;
+        uint64_t seed{0};
+        double statUpdateInterval{1.0};
+        double timeSinceStatUpdate{0.0};
+        std::vector<SegmentCheckpoint> segments;
+        SegmentStatsMap segmentStats;
+        std::unordered_map<uint32_t, float> speedLimits;
+        std::unordered_map<AlertType, float> alertThresholds;
+    };
+
+    namespace checkpoint
+    {
+        inline constexpr char kMagic[8] = {'T', 'F', 'V', 'C', 'K', 'P', 'T', '\0'};
+        inline constexpr uint32_t kVersion = 1;
+        inline constexpr std::size_t kHeaderSize = 24; // Magic, version, reserved, body size
+        inline constexpr std::size_t kVehicleRecordSize = 44;
+    } // namespace checkpoint
+
+    /**
+     * Serialize a checkpoint to a compact little-endian file. The file is written next to
+     * `path` and renamed over it, so a crash mid-write never destroys the previous one.
+     */
+    bool writeCheckpoint(const SimulationCheckpoint& checkpoint, const std::string& path);
+
+    /** Map and parse a checkpoint file; false (and `checkpoint` untouched) if it is invalid */
+    bool readCheckpoint(const std::string& path, SimulationCheckpoint& checkpoint);
+
+    /**
+     * Writes checkpoints on a background thread so the simulation never waits for the disk.
+     * Saves are written in the order they were queued.
+     */
+    class CheckpointWriter
+    {
+      public:
+        CheckpointWriter() = default;
+        ~CheckpointWriter(); // Finishes queued saves
+
+        CheckpointWriter(const CheckpointWriter&) = delete;
+        CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+        /** Queue a checkpoint to be written to `path`; returns immediately */
+        void save(SimulationCheckpoint checkpoint, std::string path);
+
+        /** Block until every queued checkpoint has been written */
+        void wait();
+
+        uint64_t written() const;
+        uint64_t failed() const;
+
+      private:
+        void run();
+
+        std::thread m_thread;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<std::pair<SimulationCheckpoint, std::string>> m_queue;
+        bool m_busy{false};
+        bool m_closing{false};
+        uint64_t m_written{0};
+        uint64_t m_failed{0};
+    };
+
+} // namespace tfv
+#endif // TFV_CHECKPOINT_HPP
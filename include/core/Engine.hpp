@@ -5,14 +5,19 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "Config.hpp"
 #include "alerts/AlertManager.hpp"
+#include "core/Checkpoint.hpp"
+#include "core/FrameScheduler.hpp"
 #include "core/LayerStack.hpp"
 #include "core/RoadNetwork.hpp"
 #include "core/Simulation.hpp"
 #include "network/LiveFeed.hpp"
 #include "recording/RecordingManager.hpp"
+#include "recording/ReplayEngine.hpp"
+#include "recording/StateRecorder.hpp"
 #include "rendering/Renderer.hpp"
 #include "rendering/layers/HeatmapLayer.hpp"
 #include "rendering/layers/ImGuiLayer.hpp"
@@ -27,6 +32,10 @@ namespace tfv
     class Engine
     {
       public:
+        /**
+         * @param rendererType "SDL", "Metal", or "Software" (windowless CPU rasteriser for
+         *                     headless servers; w x h is the framebuffer size)
+         */
         Engine(const std::string& title, int w, int h, const std::string& rendererType = "SDL");
         ~Engine();
 
@@ -37,8 +46,47 @@ namespace tfv
         void setVehicleInfo(std::string p) { m_vehicleInfoPath = std::move(p); }
 
         bool init();
+
+        /** Run the main loop (calls init() first if it has not been called). */
         void run();
 
+        /** Stop run() after this many frames (0 = run until quit). */
+        void setMaxFrames(uint64_t frames) { m_maxFrames = frames; }
+
+        /**
+         * Advance a fixed time per frame instead of wall-clock time (0 = wall clock).
+         * Useful for headless batch runs, so output does not depend on rendering speed.
+         */
+        void setFrameTime(double seconds) { m_frameTime = seconds; }
+
+        /**
+         * Replay draw commands on a dedicated render thread, so building the next frame
+         * overlaps with submitting and presenting the current one. Set before init().
+         * Ignored on macOS, where the window's renderer must stay on the main thread.
+         */
+        void setThreadedRendering(bool enable) { m_threadedRendering = enable; }
+
+        /**
+         * Step the simulation at a fixed rate (Hz) independent of the frame rate.
+         * Vehicles are interpolated between ticks when rendering. 0 steps once per frame.
+         */
+        void setSimulationRate(double hz) { m_simStep = hz > 0.0 ? 1.0 / hz : 0.0; }
+
+        /**
+         * Frame pacing: VSYNC (default), FIXED_FPS, UNCAPPED, or ON_DEMAND, which also stops
+         * drawing while paused until input arrives.
+         */
+        void setFrameMode(FrameMode mode);
+        FrameMode getFrameMode() const { return m_scheduler.mode(); }
+        void setTargetFps(double fps) { m_scheduler.setTargetFps(fps); }
+
+        /** Frame-time percentiles over the recent window */
+        FrameStats frameStats() const { return m_scheduler.stats(); }
+
+        // Pause/resume the simulation (rendering continues unless ON_DEMAND)
+        void setPaused(bool paused);
+        bool isPaused() const { return m_paused; }
+
         // Feature toggles
         void toggleHeatmap(bool enable);
         void toggleRecording(bool enable);
@@ -53,21 +101,53 @@ namespace tfv
         bool startVideoRecording(const std::string& path, int fps = 30);
         bool stopVideoRecording();
 
+        // Simulation-state log: every published state, re-renderable later at any resolution
+        bool startStateRecording(const std::string& path);
+        bool stopStateRecording();
+
+        // Replay of a state log in place of the simulation: seekable, any speed, reversible
+        bool openReplay(const std::string& path);
+        void closeReplay();
+        bool isReplaying() const { return m_replay.isOpen(); }
+        bool seekReplay(double time);
+        void setReplaySpeed(double speed) { m_replay.setSpeed(speed); }
+        double replayTime() const { return m_replay.time(); }
+
+        // Checkpoints of the full simulation state: saved in the background, restored at once
+        bool saveCheckpoint(const std::string& path);
+        bool loadCheckpoint(const std::string& path);
+
         // Live feed control
         bool connectToFeed(const std::string& url, FeedType type = FeedType::WEBSOCKET);
         bool disconnectFromFeed();
+        // Further feeds consumed alongside the current ones; the id tags their updates
+        // (LiveFeed::kNoSource once ids have run out)
+        uint16_t addFeedSource(const std::string& url, FeedType type = FeedType::WEBSOCKET);
+        bool removeFeedSource(uint16_t source);
+        std::vector<FeedSourceStatus> feedSources() const;
+        // Place GPS fixes from the feed: world (x, y) of (lat, lon), world units per metre
+        void setFeedGeoReference(double lat, double lon, double x, double y,
+                                 double unitsPerMetre = 1.0);
+
+        // Batched vehicle mutations (one simulation lock per call); see Simulation
+        std::size_t applyVehicleUpdates(const std::vector<VehicleUpdate>& updates);
+        std::size_t removeVehicles(const std::vector<uint64_t>& ids);
 
         // UI callback for alerts
         void setAlertCallback(AlertUICallback cb);
 
       private:
         void handleEvents();
+        void processEvent(void* event);
+        bool isIdle() const;
+        void waitForEvents();
         void update(double dt);
         void render();
         void processAlert(AlertType type, uint32_t segmentId, const std::string& message);
 
         // Helper methods
         bool updateFPSCounter(double dt);
+        LiveFeed& liveFeed(); // Created on first use
 
         // window / renderer
         std::string m_title;
@@ -75,20 +155,36 @@ namespace tfv
         void* m_window{nullptr};
         std::string m_rendererType;
         Renderer* m_renderer{nullptr};
+        bool m_threadedRendering{false};
 
         // timing
+        bool m_initialized{false};
         bool m_running{false};
+        uint64_t m_maxFrames{0};
+        double m_frameTime{0.0};
         double m_t{0.0};
+        FrameScheduler m_scheduler;
+        bool m_paused{false};
+        bool m_dirty{true}; // Something changed since the last present
+        static constexpr int kIdleWaitMs = 250;
         double m_fpsTimer{0.0};
         int m_frameCount{0};
         int m_fps{0};
 
+        // fixed-step simulation (0 = one variable step per frame)
+        double m_simStep{0.0};
+        double m_simAccumulator{0.0};
+        static constexpr int kMaxSimStepsPerFrame = 8;
+
         // core subsystems
         Simulation m_sim;
         RoadNetwork m_roads;
         std::unique_ptr<LiveFeed> m_liveFeed;
         std::unique_ptr<AlertManager> m_alertManager;
         std::unique_ptr<RecordingManager> m_recordingManager;
+        StateRecorder m_stateRecorder;
+        ReplayEngine m_replay;
+        CheckpointWriter m_checkpointWriter;
 
         // Layers
         LayerStack m_layerStack;
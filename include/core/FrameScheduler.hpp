@@ -0,0 +1,84 @@
+#ifndef TFV_FRAME_SCHEDULER_HPP
+#define TFV_FRAME_SCHEDULER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace tfv
+{
+    /** How the main loop paces frames */
+    enum class FrameMode
+    {
+        VSYNC,     // Present blocks on the display refresh
+        FIXED_FPS, // Sleep/spin to a target frame rate, vsync off
+        UNCAPPED,  // As fast as possible (benchmarks)
+        ON_DEMAND  // Like FIXED_FPS, but idle (block on input) while nothing changes
+    };
+
+    /** Frame-time summary over the recent window, in milliseconds */
+    struct FrameStats
+    {
+        double p50{0.0};
+        double p95{0.0};
+        double p99{0.0};
+        double mean{0.0};
+        std::size_t samples{0};
+    };
+
+    /**
+     * Paces the main loop and records frame times.
+     *
+     * Call beginFrame() at the top of every frame; it returns the time since the previous
+     * frame. Call endFrame() after presenting; in FIXED_FPS / ON_DEMAND mode it sleeps until
+     * shortly before the next deadline and spins the rest, which is precise without burning a
+     * core.
+     */
+    class FrameScheduler
+    {
+      public:
+        using Clock = std::chrono::steady_clock;
+
+        FrameScheduler();
+
+        void setMode(FrameMode mode) { m_mode = mode; }
+        FrameMode mode() const { return m_mode; }
+
+        /** Target rate for FIXED_FPS and ON_DEMAND (Hz) */
+        void setTargetFps(double fps);
+        double targetFps() const { return m_targetFps; }
+
+        /** Start a frame; returns seconds since the previous beginFrame() */
+        double beginFrame();
+
+        /** Finish a frame and wait for the next deadline if the mode paces frames */
+        void endFrame();
+
+        /**
+         * Forget the time spent outside the loop (e.g. blocked while idle) so it is not
+         * counted as a frame or passed on as a huge time step.
+         */
+        void resetClock();
+
+        /** Percentiles over the last kWindow frames */
+        FrameStats stats() const;
+
+      private:
+        static constexpr std::size_t kWindow = 512;
+        // Wake this long before the deadline and spin the remainder (covers timer slack)
+        static constexpr std::chrono::microseconds kSpinMargin{1500};
+
+        FrameMode m_mode{FrameMode::VSYNC};
+        double m_targetFps{60.0};
+        Clock::duration m_period;
+        Clock::time_point m_frameStart;
+        Clock::time_point m_deadline;
+        bool m_started{false};
+
+        // Ring buffer of frame times (ms)
+        std::vector<double> m_samples;
+        std::size_t m_next{0};
+    };
+
+} // namespace tfv
+#endif // TFV_FRAME_SCHEDULER_HPP
@@ -1,21 +1,26 @@
 #ifndef TFV_ROAD_NETWORK_HPP
 #define TFV_ROAD_NETWORK_HPP
 
+#include "core/SegmentGeometry.hpp"
+#include "core/SpatialGrid.hpp"
 #include "core/TrafficEntity.hpp"
 #include <filesystem>
 #include <queue>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
 namespace tfv
 {
-    /** One poly‑line road segment in screen space (SDL coordinates). */
+    /** One poly‑line road segment in world coordinates (any projected unit, e.g. metres). */
     struct RoadVisual
     {
         uint32_t id; // added id as the first member
-        int x1, y1;
-        int x2, y2;
-        float length; // pre‑computed pixel length
+        double x1, y1;
+        double x2, y2;
+        float length;      // pre‑computed length in world units
+        uint32_t fromNode; // End point nodes, for routing
+        uint32_t toNode;
     };
 
     /**
@@ -23,6 +28,11 @@ namespace tfv
      *
      * Expected CSV header (ignored) followed by:
      * id,x1,y1,x2,y2
+     *
+     * Build the network (loadCSV(), or addNode() then addSegments()) before the simulation,
+     * renderers and feeds start. They read it from several threads without locking and
+     * cache data derived from it (e.g. MapMatcher's successor lists), so it must not change
+     * while they run.
      */
     class RoadNetwork
     {
@@ -34,6 +44,16 @@ namespace tfv
 
         const std::vector<RoadVisual>& segments() const { return m_seg; }
 
+        /** Precomputed geometry, indexed like segments(). */
+        const SegmentGeometry& geometry() const { return m_geometry; }
+
+        /** Grid over segment bounds; items are geometry() indices. */
+        const SpatialGrid& segmentIndex() const { return m_segmentIndex; }
+
+        /** Dense index of the segment closest to a point in the geometry's local frame,
+         * within maxDistance, or SegmentGeometry::kInvalidIndex. */
+        uint32_t nearestSegment(float x, float y, float maxDistance) const;
+
         /** Retrieve pixel length for a segment id (returns 0 if out of range). */
         float segmentLength(std::size_t idx) const
         {
@@ -59,22 +79,34 @@ namespace tfv
         /** Get all segment IDs in the network */
         std::vector<uint32_t> getSegmentIds() const;
 
-        /** Add a new segment to the network */
-        void addSegment(const RoadSegment& segment);
+        /**
+         * Add segments between existing nodes, rebuilding geometry() and segmentIndex() once
+         * for the batch. Only while nothing else uses the network (see above).
+         */
+        void addSegments(std::span<const RoadSegment> segments);
 
-        /** Add a new node to the network */
+        /** Add a new node to the network; add it before the segments that end at it */
         void addNode(const Node& node);
 
         inline void clear()
         {
             m_seg.clear();
+            m_geometry.clear();
+            m_segmentIndex.clear();
             m_segments.clear();
             m_nodes.clear();
             m_adj.clear();
         }
 
       private:
+        /** Rebuild the derived geometry and segment index after m_seg changes */
+        void rebuildGeometry();
+        /** One segment of addSegments(), without the rebuild; true if a visual one was added */
+        bool insertSegment(const RoadSegment& segment);
+
         std::vector<RoadVisual> m_seg;
+        SegmentGeometry m_geometry;
+        SpatialGrid m_segmentIndex;
         std::unordered_map<uint32_t, std::vector<uint32_t>> m_adj; // adjacency list
 
         // Entities in the network
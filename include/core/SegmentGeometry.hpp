@@ -0,0 +1,78 @@
+#ifndef TFV_SEGMENT_GEOMETRY_HPP
+#define TFV_SEGMENT_GEOMETRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tfv
+{
+    struct RoadVisual;
+
+    /**
+     * Precomputed per-segment geometry in structure-of-arrays layout.
+     *
+     * Entries are indexed densely in RoadNetwork::segments() order; use indexOf() to map a
+     * segment id to its index. Rebuilt whenever the network changes, read by every renderer.
+     *
+     * Positions are float offsets from (originX, originY), the centre of the network bounds,
+     * so large world coordinates (projected metres) keep sub-millimetre precision over a
+     * metro-sized extent. Everything derived from this geometry (vehicle positions, spatial
+     * indices, picking) works in the same local frame; add the origin to get world units.
+     */
+    struct SegmentGeometry
+    {
+        static constexpr uint32_t kInvalidIndex = ~0u;
+
+        double originX{0.0}, originY{0.0}; // World position of the local frame
+        double minX{0.0}, minY{0.0};       // World bounds of all end points
+        double maxX{0.0}, maxY{0.0};
+
+        std::vector<uint32_t> ids;      // Segment id per index
+        std::vector<float> x1, y1;      // Start point
+        std::vector<float> x2, y2;      // End point
+        std::vector<float> dirX, dirY;  // Unit direction (zero for degenerate segments)
+        std::vector<float> normX, normY; // Left-hand unit normal
+        std::vector<float> length;      // Segment length
+        std::vector<float> offset;      // Cumulative length before each segment (size() + 1)
+
+        /** Rebuild from render-ready segments. */
+        void build(const std::vector<RoadVisual>& segments);
+
+        void clear();
+
+        std::size_t size() const { return ids.size(); }
+
+        /** Dense index of a segment id, or kInvalidIndex. */
+        uint32_t indexOf(uint32_t segmentId) const
+        {
+            if(!m_denseIds.empty())
+                return segmentId < m_denseIds.size() ? m_denseIds[segmentId] : kInvalidIndex;
+            auto it = m_sparseIds.find(segmentId);
+            return it != m_sparseIds.end() ? it->second : kInvalidIndex;
+        }
+
+        /** Point at normalized offset t (0-1) along segment `idx`. */
+        void pointAt(uint32_t idx, float t, float& x, float& y) const
+        {
+            float d = t * length[idx];
+            x = x1[idx] + d * dirX[idx];
+            y = y1[idx] + d * dirY[idx];
+        }
+
+        /**
+         * Batched pointAt(): one multiply-add per coordinate, branch-free over `count`
+         * entries so the compiler can vectorise the loop (gathers on AVX2 / SVE).
+         */
+        void positions(const uint32_t* idx, const float* t, std::size_t count, float* outX,
+                       float* outY) const;
+
+      private:
+        // id -> index lookup: flat table when ids are reasonably dense, hash map otherwise
+        std::vector<uint32_t> m_denseIds;
+        std::unordered_map<uint32_t, uint32_t> m_sparseIds;
+    };
+
+} // namespace tfv
+#endif // TFV_SEGMENT_GEOMETRY_HPP
@@ -2,10 +2,15 @@
 #define TFV_SIMULATION_HPP
 
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <span>
+#include <vector>
 
 #include "core/RoadNetwork.hpp"
+#include "core/SimulationState.hpp"
 #include "core/TrafficEntity.hpp"
+#include "core/VehicleUpdate.hpp"
 
 namespace tfv
 {
@@ -22,6 +27,12 @@ namespace tfv
     using AlertCallback =
         std::function<void(AlertType type, uint32_t segmentId, const std::string& message)>;
 
+    struct SimulationCheckpoint;
+    class SimulationForks;
+
+    // Called with every published state, on the simulation thread while it holds its lock
+    using StateListener = std::function<void(const SimulationStatePtr& state)>;
+
     class Simulation
     {
       public:
@@ -36,9 +47,22 @@ namespace tfv
         /** Thread‑safe copy for rendering. */
         VehicleMap snapshot() const;
 
+        /** Latest published state (never null after construction). */
+        SimulationStatePtr currentState() const;
+
+        /** Previous and current published states, read atomically as a pair. */
+        PublishedStates publishedStates() const;
+
+        /** Simulation clock in seconds. */
+        double time() const;
+
         /** Get segment statistics for visualization */
         SegmentStatsMap getSegmentStats() const;
 
+        /** Copy one segment and its statistics (for inspection); false if the id is unknown */
+        bool inspectSegment(uint32_t segmentId, RoadSegment& segment,
+                            SegmentStatistics& stats) const;
+
         /** Get current congestion levels */
         std::unordered_map<uint32_t, float> getCongestionLevels() const;
 
@@ -46,6 +70,17 @@ namespace tfv
         void addVehicle(const Vehicle& v);
         void removeVehicle(uint64_t id);
 
+        /**
+         * Apply a batch of feed updates under one lock: UPSERT adds the vehicle or moves it
+         * to the reported segment/position/speed (keeping its size and type), REMOVE drops
+         * it, and updates not yet matched to a segment are skipped. Congestion is recomputed
+         * once per segment whose occupancy changed. Returns the updates applied.
+         */
+        std::size_t applyUpdates(std::span<const VehicleUpdate> updates);
+
+        /** Remove a batch of vehicles under one lock; returns how many existed */
+        std::size_t removeVehicles(std::span<const uint64_t> ids);
+
         // Traffic rule parameters
         void setSpeedLimit(uint32_t segmentId, float limit);
         float getSpeedLimit(uint32_t segmentId) const;
@@ -56,6 +91,42 @@ namespace tfv
         void setAlertThreshold(AlertType type, float threshold);
         void setEnabled(bool enable) { m_alertsEnabled = enable; }
 
+        /**
+         * Publish externally produced states (e.g. from a ReplayEngine) in place of stepping:
+         * positions and the picking grid are filled in here, on the caller's thread, the first
+         * time a state is published, and the clock follows `current`. Call instead of
+         * update(); the listener is not notified.
+         */
+        void publishStates(const std::shared_ptr<SimulationState>& previous,
+                           const std::shared_ptr<SimulationState>& current);
+
+        /**
+         * Capture everything needed to resume this run. Vehicles are shared with the current
+         * published state and only the per-segment data is copied, so this is cheap enough to
+         * call between steps; write the result off-thread with a CheckpointWriter.
+         */
+        SimulationCheckpoint checkpoint();
+
+        /** Replace the running state with a checkpoint's (taken on the same road network) */
+        void restore(const SimulationCheckpoint& checkpoint);
+
+        /**
+         * Fork the current state into `variants` what-if copies that step in parallel and
+         * share the road network and this state copy-on-write (see SimulationForks). This
+         * simulation is unaffected and may keep running; null without a road network.
+         */
+        std::unique_ptr<SimulationForks> fork(std::size_t variants, std::size_t threads = 0);
+
+        /**
+         * Seed for routing decisions. They are a pure function of the seed, tick and vehicle,
+         * so a run restored from a checkpoint continues exactly as the original would have.
+         */
+        void setSeed(uint64_t seed);
+        uint64_t seed() const;
+
+        /** Observe every published state (e.g. to record it); keep the callback cheap */
+        void setStateListener(StateListener listener);
+
         // Get road network
         const RoadNetwork* getRoadNetwork() const { return m_roadNetwork; }
 
@@ -65,13 +136,29 @@ namespace tfv
 
         // Update congestion level for a segment
         void updateCongestion(uint32_t segmentId);
+        // Set a segment's congestion level and its entry in m_congestion
+        void setCongestion(RoadSegment& segment, float level);
+
+        // Batch helpers (caller holds m_mtx): change a segment's vehicle count and remember
+        // it, then recompute congestion once for every segment remembered
+        void adjustOccupancy(uint32_t segmentId, int delta);
+        bool eraseVehicle(uint64_t id);
+        void updateTouchedCongestion();
 
         // Check for alert conditions
         void checkAlerts();
 
+        // Publish an immutable copy of the vehicles (caller holds m_mtx)
+        void publishState();
+
+        // Fill a state's positions, picking grid and maxStep from the segment geometry;
+        // `previous` is the state published before it, if any
+        void indexState(SimulationState& state, const SimulationState* previous) const;
+
         VehicleMap m_vehicles;
         RoadNetwork* m_roadNetwork{nullptr};
         SegmentStatsMap m_segmentStats;
+        std::vector<float> m_congestion; // By geometry index, as published
         std::unordered_map<uint32_t, float> m_speedLimits;
         mutable std::mutex m_mtx;
 
@@ -83,6 +170,28 @@ namespace tfv
         // Update frequency (don't update every frame)
         double m_statUpdateInterval{1.0}; // seconds
         double m_timeSinceLastUpdate{0.0};
+
+        // Simulation clock
+        double m_time{0.0};
+        uint64_t m_tick{0};
+        uint64_t m_seed{0x7466765f73656564}; // "tfv_seed"
+
+        // Vehicles were added or removed since the last publishState()
+        bool m_unpublished{false};
+
+        // Ids added since the last publishState(), so it can merge them into the previous
+        // state's id order instead of sorting every vehicle; m_reorder when that order is
+        // not the vehicles' (reset, restore, replay)
+        std::vector<uint64_t> m_added;
+        bool m_reorder{true};
+
+        // Segments whose occupancy a batch changed (guarded by m_mtx, reused)
+        std::vector<uint32_t> m_touchedSegments;
+
+        // Published states (guarded by m_publishMtx, never by m_mtx)
+        mutable std::mutex m_publishMtx;
+        PublishedStates m_published;
+        StateListener m_stateListener; // Guarded by m_mtx
     };
 
 } // namespace tfv
@@ -0,0 +1,127 @@
+#ifndef TFV_SIMULATION_FORKS_HPP
+#define TFV_SIMULATION_FORKS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/Checkpoint.hpp"
+#include "core/RoadNetwork.hpp"
+#include "core/SimulationState.hpp"
+#include "core/TrafficEntity.hpp"
+#include "utils/TaskPool.hpp"
+
+namespace tfv
+{
+    /** How a variant's statistics for one segment differ from the baseline's */
+    struct SegmentStatsDelta
+    {
+        uint32_t segmentId;
+        float avgSpeed;   // Variant minus baseline
+        float avgDensity; // Variant minus baseline
+    };
+
+    /**
+     * What-if variants of a running simulation, stepped side by side.
+     *
+     * The fork starts from a checkpoint and runs it on as an unmodified baseline. Each
+     * variant stores only where it differs from that baseline: its edits (closed segments,
+     * added or removed vehicles), the vehicles whose state has diverged and the statistics of
+     * the segments they touched. Everything else is read from the baseline, and the road
+     * network is shared read-only, so a variant costs memory in proportion to its divergence.
+     * Vehicle dynamics are deterministic (see dynamics::advance), which is what lets a
+     * vehicle whose inputs match the baseline's be skipped: it provably moves the same way.
+     *
+     * Edits and queries must not overlap step(), which advances the baseline and then every
+     * variant in parallel on a TaskPool.
+     */
+    class SimulationForks
+    {
+      public:
+        /**
+         * Fork `checkpoint` (see Simulation::checkpoint) into `variants` copies on `network`,
+         * which must outlive this object; `threads` as for TaskPool
+         */
+        SimulationForks(const SimulationCheckpoint& checkpoint, const RoadNetwork& network,
+                        std::size_t variants, std::size_t threads = 0);
+
+        std::size_t variantCount() const { return m_variants.size(); }
+
+        // — Variant edits —
+        /** Stop vehicles from entering a segment; those already on it drive on */
+        void closeSegment(std::size_t variant, uint32_t segmentId);
+        void reopenSegment(std::size_t variant, uint32_t segmentId);
+        void addVehicle(std::size_t variant, const Vehicle& vehicle);
+        void removeVehicle(std::size_t variant, uint64_t id);
+
+        /** Advance the baseline and every variant by `dt` seconds */
+        void step(double dt);
+
+        /** Simulation clock shared by all variants */
+        double time() const { return m_base->time; }
+
+        /** Baseline vehicles (no position or picking index) */
+        SimulationStatePtr baseline() const { return m_base; }
+
+        /** Materialize a variant: the baseline with the variant's differences applied */
+        SimulationStatePtr state(std::size_t variant) const;
+
+        /** Segments whose statistics differ from the baseline's, by segment id */
+        std::vector<SegmentStatsDelta> statsDeltas(std::size_t variant) const;
+
+        /** Vehicles a variant stores itself (diverged, added or removed) */
+        std::size_t divergedVehicles(std::size_t variant) const;
+
+      private:
+        // Per-segment vehicle count and speed sum over one statistics sample
+        struct Sample
+        {
+            int count{0};
+            float speedSum{0.0f};
+        };
+
+        struct Variant
+        {
+            // Vehicles that differ from the baseline; nullopt marks one removed here
+            std::unordered_map<uint64_t, std::optional<Vehicle>> vehicles;
+            std::unordered_map<uint32_t, int> vehicleCounts; // Where they differ
+            std::unordered_set<uint32_t> closed;
+            SegmentStatsMap stats; // Segments ever touched by a diverged vehicle
+
+            // Segments whose vehicles see different inputs than in the baseline: different
+            // congestion, or a closed segment among the routes at their end
+            std::unordered_set<uint32_t> affected;
+        };
+
+        float baseCongestion(uint32_t segmentId) const;
+        float congestion(const Variant& variant, uint32_t segmentId) const;
+        int baseVehicleCount(uint32_t segmentId) const;
+        void adjustVehicleCount(Variant& variant, uint32_t segmentId, int delta);
+        void updateAffected(Variant& variant) const;
+        void advance(const Variant& variant, Vehicle& v, double dt) const;
+        void stepVariant(Variant& variant, const SimulationState& previous, double dt,
+                         bool statsTick);
+        void sampleVariant(Variant& variant) const;
+
+        const RoadNetwork& m_network;
+        SimulationStatePtr m_base; // Sorted by id, never changes size
+        std::unordered_map<uint32_t, SegmentCheckpoint> m_segments;
+        SegmentStatsMap m_stats;
+        uint64_t m_seed;
+        double m_statUpdateInterval;
+        double m_timeSinceStatUpdate;
+
+        // Filled by step() for the variants to read
+        std::unordered_map<uint32_t, std::vector<uint32_t>> m_bySegment; // Previous indices
+        std::unordered_map<uint32_t, Sample> m_samples; // Baseline sample on a statistics tick
+
+        std::vector<Variant> m_variants;
+        TaskPool m_pool;
+    };
+
+} // namespace tfv
+#endif // TFV_SIMULATION_FORKS_HPP
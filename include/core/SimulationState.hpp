@@ -0,0 +1,54 @@
+#ifndef TFV_SIMULATION_STATE_HPP
+#define TFV_SIMULATION_STATE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/SpatialGrid.hpp"
+#include "core/TrafficEntity.hpp"
+
+namespace tfv
+{
+    /**
+     * Immutable view of the simulation published after every step.
+     * Renderers read it without taking the simulation lock.
+     */
+    struct SimulationState
+    {
+        uint64_t tick{0};              // Number of steps taken so far
+        double time{0.0};              // Simulation clock (seconds)
+        std::vector<Vehicle> vehicles; // Sorted by vehicle id
+        std::vector<float> congestion; // Per segment (0-1), in RoadNetwork::segments() order
+
+        // Position per vehicle at this tick, in the segment geometry's local frame (NaN if its
+        // segment is unknown), and a grid over those points for picking; both indexed like
+        // `vehicles` and filled in before the state is published
+        std::vector<float> x, y;
+        SpatialGrid vehicleIndex;
+        // Longest path any vehicle took since the previous state: a vehicle drawn between the
+        // two ticks is at most this far from its position here
+        float maxStep{0.0f};
+
+        /** Binary search for a vehicle by id (null if not present). */
+        const Vehicle* findVehicle(uint64_t id) const
+        {
+            auto it = std::lower_bound(vehicles.begin(), vehicles.end(), id,
+                                       [](const Vehicle& v, uint64_t key) { return v.id < key; });
+            return (it != vehicles.end() && it->id == id) ? &*it : nullptr;
+        }
+    };
+
+    using SimulationStatePtr = std::shared_ptr<const SimulationState>;
+
+    /** The two most recent published states, used for inter-tick interpolation. */
+    struct PublishedStates
+    {
+        SimulationStatePtr previous;
+        SimulationStatePtr current;
+    };
+
+} // namespace tfv
+#endif // TFV_SIMULATION_STATE_HPP
@@ -0,0 +1,168 @@
+#ifndef TFV_SPATIAL_GRID_HPP
+#define TFV_SPATIAL_GRID_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace tfv
+{
+    /**
+     * Uniform grid over 2D items in compressed (CSR) form: one offset per cell into a single
+     * array of item indices. Built with two counting passes and no per-cell allocation, so it
+     * is cheap to rebuild whenever the items move.
+     *
+     * Queries return candidates from the overlapped cells; callers do the exact test.
+     * query() on a box grid reuses internal scratch state and must not be called concurrently;
+     * nearest() and point-grid queries only read.
+     */
+    class SpatialGrid
+    {
+      public:
+        static constexpr uint32_t kNone = ~0u;
+
+        /**
+         * Index boxes given by two opposite corners (e.g. segment end points); a box is
+         * listed in every cell it overlaps.
+         * @param cellSize Cell edge in world units (<= 0 picks one from the item density)
+         */
+        void buildBoxes(const float* ax, const float* ay, const float* bx, const float* by,
+                        std::size_t count, float cellSize = 0.f);
+
+        /** Index points; each lands in exactly one cell. Non-finite points are skipped. */
+        void buildPoints(const float* x, const float* y, std::size_t count, float cellSize = 0.f);
+
+        void clear();
+        bool empty() const { return m_items.empty(); }
+        float cellSize() const { return m_cellSize; }
+
+        /** Append the index of every item in a cell overlapping the rect to `out`, once each. */
+        void query(float minX, float minY, float maxX, float maxY,
+                   std::vector<uint32_t>& out) const;
+
+        /**
+         * Item closest to (x, y) within maxDistance, or kNone. `distance(i)` must return the
+         * exact distance from (x, y) to item i. Cells are searched in rings outward from the
+         * query point, stopping once no unvisited cell can hold anything closer, so the cost
+         * depends on local density rather than on the item count.
+         */
+        template <typename Distance>
+        uint32_t nearest(float x, float y, float maxDistance, Distance&& distance) const;
+
+        /**
+         * Call visit(item) for every item in a cell overlapping the rect. Unlike query() it
+         * keeps no scratch state, so it is safe from several threads at once; a box spanning
+         * several of those cells is visited once per cell.
+         */
+        template <typename Visit>
+        void visit(float minX, float minY, float maxX, float maxY, Visit&& visit) const;
+
+      private:
+        template <typename CellRange>
+        void build(std::size_t count, float minX, float minY, float maxX, float maxY,
+                   float cellSize, CellRange&& cellRange);
+
+        int cellX(float x) const;
+        int cellY(float y) const;
+
+        float m_cellSize{1.f};
+        float m_originX{0.f}, m_originY{0.f};
+        int m_cols{0}, m_rows{0};
+        bool m_boxes{false};
+
+        std::vector<uint32_t> m_cellStart; // Cell c: m_items[m_cellStart[c] .. m_cellStart[c + 1])
+        std::vector<uint32_t> m_items;     // Item indices, grouped by cell
+
+        // Query de-duplication for boxes spanning several cells
+        mutable std::vector<uint32_t> m_seen;
+        mutable uint32_t m_stamp{0};
+    };
+
+    template <typename Distance>
+    uint32_t SpatialGrid::nearest(float x, float y, float maxDistance, Distance&& distance) const
+    {
+        if(m_items.empty())
+            return kNone;
+
+        // Nothing in range if the query point is too far outside the grid
+        const float gridX1 = m_originX + m_cols * m_cellSize;
+        const float gridY1 = m_originY + m_rows * m_cellSize;
+        const float outX = std::max({m_originX - x, x - gridX1, 0.f});
+        const float outY = std::max({m_originY - y, y - gridY1, 0.f});
+        if(outX > maxDistance || outY > maxDistance)
+            return kNone;
+
+        const int cx = cellX(x), cy = cellY(y);
+        uint32_t best = kNone;
+        float bestDistance = maxDistance;
+        auto visitCell = [&](int col, int row)
+        {
+            const std::size_t c = static_cast<std::size_t>(row) * m_cols + col;
+            for(uint32_t k = m_cellStart[c]; k < m_cellStart[c + 1]; ++k)
+            {
+                const float d = distance(m_items[k]);
+                if(d < bestDistance || (d == bestDistance && best == kNone))
+                {
+                    bestDistance = d;
+                    best = m_items[k];
+                }
+            }
+        };
+
+        const int maxRing = std::max({cx, m_cols - 1 - cx, cy, m_rows - 1 - cy});
+        for(int r = 0; r <= maxRing; ++r)
+        {
+            // Perimeter of the (2r + 1)^2 square around the query cell, clipped to the grid
+            const int c0 = cx - r, c1 = cx + r, r0 = cy - r, r1 = cy + r;
+            for(int col = std::max(c0, 0); col <= std::min(c1, m_cols - 1); ++col)
+            {
+                if(r0 >= 0)
+                    visitCell(col, r0);
+                if(r1 < m_rows && r > 0)
+                    visitCell(col, r1);
+            }
+            for(int row = std::max(r0 + 1, 0); row <= std::min(r1 - 1, m_rows - 1); ++row)
+            {
+                if(c0 >= 0)
+                    visitCell(c0, row);
+                if(c1 < m_cols && r > 0)
+                    visitCell(c1, row);
+            }
+
+            // Anything unvisited lies beyond the scanned square
+            float bound = std::numeric_limits<float>::max();
+            if(c0 > 0)
+                bound = std::min(bound, x - (m_originX + c0 * m_cellSize));
+            if(c1 < m_cols - 1)
+                bound = std::min(bound, m_originX + (c1 + 1) * m_cellSize - x);
+            if(r0 > 0)
+                bound = std::min(bound, y - (m_originY + r0 * m_cellSize));
+            if(r1 < m_rows - 1)
+                bound = std::min(bound, m_originY + (r1 + 1) * m_cellSize - y);
+            if(bound >= bestDistance)
+                break;
+        }
+        return best;
+    }
+
+    template <typename Visit>
+    void SpatialGrid::visit(float minX, float minY, float maxX, float maxY, Visit&& visit) const
+    {
+        if(m_items.empty() || maxX < m_originX || maxY < m_originY ||
+           minX > m_originX + m_cols * m_cellSize || minY > m_originY + m_rows * m_cellSize)
+            return;
+
+        const int cx0 = cellX(minX), cx1 = cellX(maxX);
+        const int cy0 = cellY(minY), cy1 = cellY(maxY);
+        for(int cy = cy0; cy <= cy1; ++cy)
+        {
+            const std::size_t row = static_cast<std::size_t>(cy) * m_cols;
+            for(uint32_t k = m_cellStart[row + cx0]; k < m_cellStart[row + cx1 + 1]; ++k)
+                visit(m_items[k]);
+        }
+    }
+
+} // namespace tfv
+#endif // TFV_SPATIAL_GRID_HPP
@@ -3,6 +3,7 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -19,6 +20,29 @@ namespace tfv
 
     // Note: Alert struct is defined in AlertManager.hpp to avoid duplication
 
+    /**
+     * Vehicle type name (car, truck, etc.), interned: each distinct name is stored once for
+     * the life of the process, so a Vehicle copies and compares its type as a pointer.
+     * Interning takes a lock; keep a VehicleType rather than re-interning the same name.
+     */
+    class VehicleType
+    {
+      public:
+        VehicleType();
+        // Implicit, so a name assigns like the std::string this replaced
+        VehicleType(std::string_view name);
+        VehicleType(const std::string& name) : VehicleType(std::string_view(name)) {}
+        VehicleType(const char* name) : VehicleType(std::string_view(name)) {}
+
+        const std::string& name() const { return *m_name; }
+        const char* c_str() const { return m_name->c_str(); }
+
+        bool operator==(const VehicleType& other) const { return m_name == other.m_name; }
+
+      private:
+        const std::string* m_name;
+    };
+
     // Vehicle representation
     struct Vehicle
     {
@@ -29,7 +53,7 @@ namespace tfv
         glm::vec2 acc;           // Acceleration vector
         float length{4.5f};      // Vehicle length in meters
         float width{1.8f};       // Vehicle width in meters
-        std::string type{"car"}; // Vehicle type (car, truck, etc.)
+        VehicleType type;        // Vehicle type ("car" by default)
     };
 
     // Road segment (edge in the road network)
@@ -51,7 +75,7 @@ namespace tfv
     struct Node
     {
         uint32_t id;                    // Unique identifier
-        glm::vec2 pos;                  // Position (x, y)
+        glm::dvec2 pos;                 // World position (x, y)
         std::vector<uint32_t> incoming; // Incoming segment IDs
         std::vector<uint32_t> outgoing; // Outgoing segment IDs
     };
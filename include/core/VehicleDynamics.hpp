@@ -0,0 +1,106 @@
+#ifndef TFV_VEHICLE_DYNAMICS_HPP
+#define TFV_VEHICLE_DYNAMICS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "core/RoadNetwork.hpp"
+#include "core/TrafficEntity.hpp"
+
+namespace tfv
+{
+    /**
+     * The per-vehicle step shared by Simulation and its forks. It is a pure function of its
+     * inputs, so two runs that feed a vehicle the same segment, congestion and seed move it
+     * identically.
+     */
+    namespace dynamics
+    {
+        // SplitMix64 finalizer: a cheap, well-distributed hash of one 64-bit word
+        inline uint64_t mix(uint64_t x)
+        {
+            x += 0x9e3779b97f4a7c15;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+            return x ^ (x >> 31);
+        }
+
+        /** Route choice hash; counter-based so it never depends on iteration order */
+        inline uint64_t routeHash(uint64_t seed, uint64_t tick, uint64_t vehicleId)
+        {
+            return mix(seed ^ mix(tick ^ mix(vehicleId)));
+        }
+
+        /**
+         * Move `v` along `segment` for `dt` seconds, slowed by `congestion`, and onto a
+         * random next segment past its end. `isOpen(segmentId)` filters the candidates; with
+         * none open the vehicle loops back onto its segment. Returns the speed it moved at.
+         */
+        template <typename IsOpen>
+        float advance(Vehicle& v, const RoadSegment& segment, float congestion,
+                      const RoadNetwork& network, uint64_t seed, uint64_t tick, double dt,
+                      IsOpen&& isOpen)
+        {
+            // Adjust speed based on congestion
+            const float speedFactor = 1.0f - congestion * 0.8f;
+
+            // Move vehicle along its segment by its velocity's magnitude
+            const float speed = glm::length(v.vel) * speedFactor;
+            const float distance = speed * static_cast<float>(dt);
+            v.position += distance / segment.length; // position is 0..1 along segment
+
+            if(v.position <= 1.f)
+                return speed;
+
+            // Carry the extra distance over onto the next segment
+            v.position -= 1.f;
+            const Node* node = network.getNode(segment.toNode);
+            if(!node || node->outgoing.empty())
+                return speed; // Dead end: loop back to the beginning
+
+            const uint64_t hash = routeHash(seed, tick, v.id);
+            std::size_t open = 0;
+            for(uint32_t next : node->outgoing)
+                open += isOpen(next) ? 1 : 0;
+            if(open == node->outgoing.size())
+            {
+                v.segmentId = node->outgoing[hash % open];
+            }
+            else if(open > 0)
+            {
+                std::size_t pick = hash % open;
+                for(uint32_t next : node->outgoing)
+                {
+                    if(isOpen(next) && pick-- == 0)
+                    {
+                        v.segmentId = next;
+                        break;
+                    }
+                }
+            }
+            return speed;
+        }
+
+        /** advance() with every segment open */
+        inline float advance(Vehicle& v, const RoadSegment& segment, float congestion,
+                             const RoadNetwork& network, uint64_t seed, uint64_t tick,
+                             double dt)
+        {
+            return advance(v, segment, congestion, network, seed, tick, dt,
+                           [](uint32_t) { return true; });
+        }
+
+        /** Congestion model: vehicle count over capacity (one vehicle per 10 m), 0-1 */
+        inline float congestion(int vehicleCount, float length)
+        {
+            const float capacity = length / 10.0f;
+            const float level = static_cast<float>(vehicleCount) / capacity;
+            return std::max(0.0f, std::min(level, 1.0f));
+        }
+    } // namespace dynamics
+
+} // namespace tfv
+#endif // TFV_VEHICLE_DYNAMICS_HPP
@@ -0,0 +1,43 @@
+#ifndef TFV_VEHICLE_UPDATE_HPP
+#define TFV_VEHICLE_UPDATE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace tfv
+{
+    enum class UpdateKind : uint8_t
+    {
+        UPSERT, // Add the vehicle or move it to the reported place
+        REMOVE  // The vehicle left the feed
+    };
+
+    /**
+     * One vehicle report from a live feed. Plain data, so feed threads can hand it to the
+     * simulation through an IngestRing without allocating. A report carries either a raw fix
+     * (lat/lon), a place on the network (segmentId/position), or both once map-matched.
+     */
+    struct VehicleUpdate
+    {
+        static constexpr uint32_t kNoSegment = std::numeric_limits<uint32_t>::max();
+
+        uint64_t id{0};
+        double timestamp{0.0}; // Source clock, seconds
+        double lat{0.0};       // Degrees
+        double lon{0.0};       // Degrees
+        uint32_t segmentId{kNoSegment};
+        float position{0.0f};   // Normalized position along the segment (0-1)
+        float speed{0.0f};      // m/s
+        float confidence{1.0f}; // Map-matching confidence (0-1); 1 when the source placed it
+        uint32_t sequence{0};   // Source's message counter; 0 when it sends none
+        uint16_t source{0};     // Feed that produced the report
+        UpdateKind kind{UpdateKind::UPSERT};
+
+        bool matched() const { return segmentId != kNoSegment; }
+    };
+
+    static_assert(std::is_trivially_copyable_v<VehicleUpdate>);
+
+} // namespace tfv
+#endif // TFV_VEHICLE_UPDATE_HPP
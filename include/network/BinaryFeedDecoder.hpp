@@ -0,0 +1,129 @@
+#ifndef TFV_BINARY_FEED_DECODER_HPP
+#define TFV_BINARY_FEED_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/VehicleUpdate.hpp"
+
+namespace tfv
+{
+    /** Protocol Buffers wire format primitives */
+    namespace protowire
+    {
+        enum WireType : uint8_t
+        {
+            VARINT = 0,
+            FIXED64 = 1,
+            LENGTH_DELIMITED = 2,
+            FIXED32 = 5
+        };
+
+        /** Read a varint at `p`; returns the byte after it, or null if truncated or overlong */
+        inline const uint8_t* readVarint(const uint8_t* p, const uint8_t* end, uint64_t& value)
+        {
+            uint64_t result = 0;
+            for(int shift = 0; shift < 64 && p < end; shift += 7)
+            {
+                const uint8_t byte = *p++;
+                result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if(!(byte & 0x80))
+                {
+                    value = result;
+                    return p;
+                }
+            }
+            return nullptr;
+        }
+
+        inline int64_t zigzag(uint64_t value)
+        {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+    } // namespace protowire
+
+    /**
+     * Decoder for the binary live feed: a byte stream of varint length-prefixed messages, the
+     * framing protobuf's writeDelimitedTo() produces, each encoding
+     *
+     *     message VehicleUpdate {
+     *       uint64 id = 1;
+     *       double ts = 2;        // Source clock, seconds
+     *       sint32 lat_e7 = 3;    // Degrees * 1e7
+     *       sint32 lon_e7 = 4;
+     *       float speed = 5;      // m/s
+     *       uint32 segment = 6;   // Present when the producer has map-matched the vehicle
+     *       float position = 7;   // 0-1 along the segment
+     *       bool removed = 8;
+     *       uint32 seq = 9;       // Per-source counter, for dropping duplicates and replays
+     *     }
+     *
+     * decode() reads straight out of the caller's receive buffer and stops at a trailing
+     * partial message, to be completed by the next read. Unknown fields are skipped, so the
+     * schema can grow; id and either lat/lon or segment are required unless removed.
+     */
+    class BinaryFeedDecoder
+    {
+      public:
+        /** Longer length prefixes are treated as a corrupt stream */
+        static constexpr std::size_t kMaxMessageSize = 4096;
+
+        explicit BinaryFeedDecoder(uint16_t source = 0) : m_source(source) {}
+
+        /**
+         * Decode every complete message in `data`, calling `onUpdate(const VehicleUpdate&)`
+         * for each. Returns the bytes consumed; on a malformed message returns what was
+         * consumed before it and failed() becomes true (the stream cannot be resynchronised).
+         */
+        template <typename OnUpdate>
+        std::size_t decode(const uint8_t* data, std::size_t size, OnUpdate&& onUpdate);
+
+        bool failed() const { return m_error != nullptr; }
+        const char* error() const { return m_error ? m_error : ""; }
+
+        /** Forget an error, for a new connection */
+        void reset() { m_error = nullptr; }
+
+      private:
+        bool parseUpdate(const uint8_t* p, const uint8_t* end, VehicleUpdate& update);
+        bool fail(const char* reason);
+
+        uint16_t m_source;
+        const char* m_error{nullptr};
+    };
+
+    template <typename OnUpdate>
+    std::size_t BinaryFeedDecoder::decode(const uint8_t* data, std::size_t size,
+                                          OnUpdate&& onUpdate)
+    {
+        const uint8_t* p = data;
+        const uint8_t* const end = data + size;
+        VehicleUpdate update;
+        while(!failed() && p < end)
+        {
+            uint64_t length = 0;
+            const uint8_t* body = protowire::readVarint(p, end, length);
+            if(!body)
+            {
+                if(end - p >= 10)
+                    fail("malformed length prefix");
+                break; // Otherwise the prefix is still arriving
+            }
+            if(length > kMaxMessageSize)
+            {
+                fail("message too large");
+                break;
+            }
+            if(static_cast<uint64_t>(end - body) < length)
+                break; // Body still arriving
+
+            if(!parseUpdate(body, body + length, update))
+                break;
+            onUpdate(static_cast<const VehicleUpdate&>(update));
+            p = body + length;
+        }
+        return static_cast<std::size_t>(p - data);
+    }
+
+} // namespace tfv
+#endif // TFV_BINARY_FEED_DECODER_HPP
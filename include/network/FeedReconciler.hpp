@@ -0,0 +1,128 @@
+#ifndef TFV_FEED_RECONCILER_HPP
+#define TFV_FEED_RECONCILER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "core/RoadNetwork.hpp"
+#include "core/VehicleUpdate.hpp"
+
+namespace tfv
+{
+    /** Counters of FeedReconciler since it was created */
+    struct ReconcilerStats
+    {
+        uint64_t accepted{0};   // Updates passed on to the simulation
+        uint64_t stale{0};      // Older than what was already applied for the vehicle
+        uint64_t duplicates{0}; // Same report as the last one applied for the vehicle
+        std::size_t tracked{0}; // Vehicles in the table, removed and idle ones included
+    };
+
+    /**
+     * The merge stage between the IngestRing and the simulation. Feeds deliver late,
+     * duplicated and clock-skewed reports; per vehicle the reconciler remembers the last
+     * report it let through (source, sequence, timestamp) and drops anything that is not
+     * newer.
+     *
+     * Within one source, sequence numbers decide when both reports carry one, else source
+     * timestamps. Across sources the timestamps are first moved onto the local clock: per
+     * source the offset (local - source) is the smallest seen over the last one to two
+     * clock windows, i.e. the delay of the fastest recent delivery, which follows drift
+     * without being thrown by queueing. The same report relayed by two sources lands on the
+     * same corrected time and counts as a duplicate. Reports older than a removal are dropped
+     * too, until the removal is forgotten kForgetRemovedAfter seconds later; a vehicle with
+     * no report for kForgetIdleAfter seconds is forgotten the same way.
+     *
+     * Vehicles live in an open-addressing table of plain records, so each report costs one
+     * probe and nothing is allocated per vehicle. At half full, and every kForgetIdleAfter
+     * seconds, the table is rebuilt without forgotten vehicles, doubling until it is at most
+     * a quarter full.
+     */
+    class FeedReconciler
+    {
+      public:
+        static constexpr double kClockWindow = 10.0;        // Seconds
+        static constexpr double kForgetRemovedAfter = 60.0; // Seconds
+        static constexpr double kForgetIdleAfter = 300.0;   // Seconds
+
+        /** Sized for `expectedVehicles` without growing */
+        explicit FeedReconciler(std::size_t expectedVehicles = 0);
+
+        /**
+         * Drop stale and duplicate updates in place, keeping the order of the rest, and
+         * learn the source clocks from them. `now` is the local clock in seconds when the
+         * batch was drained. Returns the updates kept.
+         */
+        std::size_t filter(std::vector<VehicleUpdate>& updates, double now);
+
+        /**
+         * Move each placed upsert forward along its segment of `network` by the distance its
+         * speed covers between its timestamp and `now`, so a late report lands where the
+         * vehicle is rather than where it was. Source timestamps are wall-clock seconds like
+         * `now`, so the age is their difference: the clock offset would also take out the
+         * fastest delivery delay. Projection stops at the segment's end, where the simulation
+         * carries it on, and covers at most setMaxAge() seconds (2 by default).
+         */
+        void deadReckon(std::span<VehicleUpdate> updates, double now,
+                        const RoadNetwork& network) const;
+
+        void setMaxAge(double seconds) { m_maxAge = seconds; }
+
+        /** Estimated local - source clock offset in seconds; 0 for an unseen source */
+        double clockOffset(uint16_t source) const;
+
+        const ReconcilerStats& stats() const { return m_stats; }
+
+      private:
+        enum class State : uint8_t
+        {
+            EMPTY,
+            LIVE,
+            REMOVED
+        };
+
+        struct Entry
+        {
+            uint64_t id{0};
+            double timestamp{0.0}; // Last accepted report, source clock
+            double time{0.0};      // The same on the local clock
+            uint32_t sequence{0};
+            uint16_t source{0};
+            State state{State::EMPTY};
+        };
+
+        struct SourceClock
+        {
+            double offset{0.0}; // Estimate: min(windowMin, previousMin)
+            double windowMin{0.0};
+            double previousMin{0.0};
+            double windowStart{0.0};
+            bool seen{false};
+        };
+
+        // Why an update was dropped, or ACCEPT
+        enum class Verdict
+        {
+            ACCEPT,
+            STALE,
+            DUPLICATE
+        };
+
+        Verdict judge(const Entry& entry, const VehicleUpdate& update, double time) const;
+        double toLocal(const VehicleUpdate& update, double now) const;
+        void observeClock(const VehicleUpdate& update, double now);
+        Entry& find(uint64_t id, double now); // The vehicle's entry, EMPTY if new
+        void rehash(std::size_t capacity, double now);
+
+        std::vector<Entry> m_table; // Power-of-two size
+        std::size_t m_used{0};      // Entries not EMPTY
+        std::vector<SourceClock> m_clocks;
+        double m_lastSweep{0.0}; // Local clock of the last rebuild
+        double m_maxAge{2.0};
+        ReconcilerStats m_stats;
+    };
+
+} // namespace tfv
+#endif // TFV_FEED_RECONCILER_HPP
@@ -0,0 +1,145 @@
+#ifndef TFV_INGEST_RING_HPP
+#define TFV_INGEST_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "core/VehicleUpdate.hpp"
+
+namespace tfv
+{
+    /** What a feed thread does when the ring is full */
+    enum class IngestOverflowPolicy
+    {
+        DROP_OLDEST, // Discard the oldest queued update; the freshest data always gets in
+        DROP_NEWEST, // Discard the update being pushed; queued data is kept
+        BLOCK        // Wait for the simulation to drain; nothing is lost, the feed slows down
+    };
+
+    /** Snapshot of the ring counters */
+    struct IngestRingStats
+    {
+        uint64_t pushed{0};        // Updates accepted into the ring
+        uint64_t drained{0};       // Updates handed to the simulation
+        uint64_t droppedOldest{0}; // Queued updates discarded to make room (DROP_OLDEST)
+        uint64_t droppedNewest{0}; // Pushes refused because the ring was full (DROP_NEWEST)
+        uint64_t blocked{0};       // Pushes that had to wait for room (BLOCK)
+        std::size_t queued{0};     // Updates waiting right now
+        std::size_t capacity{0};
+    };
+
+    /**
+     * Bounded lock-free queue of VehicleUpdates between feed threads (any number of
+     * producers) and the simulation thread, which drains everything queued once per tick.
+     *
+     * Each slot carries a sequence number that says whether it is free for the producer or
+     * filled for the consumer at the current lap, so producers claim slots with one
+     * compare-exchange and never take a lock. Under DROP_OLDEST a producer that finds the ring
+     * full pops the oldest update itself and retries; under BLOCK it waits on an atomic that
+     * drain() bumps, so an idle producer costs nothing.
+     */
+    class IngestRing
+    {
+      public:
+        /** `capacity` is rounded up to a power of two */
+        explicit IngestRing(std::size_t capacity = 1u << 16,
+                            IngestOverflowPolicy policy = IngestOverflowPolicy::DROP_OLDEST);
+
+        IngestRing(const IngestRing&) = delete;
+        IngestRing& operator=(const IngestRing&) = delete;
+
+        void setPolicy(IngestOverflowPolicy policy);
+        IngestOverflowPolicy policy() const;
+
+        /**
+         * Queue one update; safe from any number of threads. False if it was refused
+         * (DROP_NEWEST on a full ring) or the ring is closed.
+         */
+        bool push(const VehicleUpdate& update);
+
+        /**
+         * Move up to `max` queued updates, oldest first, to the end of `out` and return how
+         * many. Meant for one consumer; reuse `out` so steady-state draining never allocates.
+         */
+        std::size_t drain(std::vector<VehicleUpdate>& out,
+                          std::size_t max = std::numeric_limits<std::size_t>::max());
+
+        /** Refuse further pushes and release producers blocked under BLOCK */
+        void close();
+
+        /** Accept pushes again after close(); queued updates are kept */
+        void open();
+
+        bool closed() const { return m_closed.load(std::memory_order_acquire); }
+
+        IngestRingStats stats() const;
+        std::size_t capacity() const { return m_mask + 1; }
+
+      private:
+        struct Slot
+        {
+            std::atomic<std::size_t> sequence;
+            VehicleUpdate update;
+        };
+
+        bool tryPush(const VehicleUpdate& update);
+        bool tryPop(VehicleUpdate& update);
+
+        std::unique_ptr<Slot[]> m_slots;
+        std::size_t m_mask;
+        std::atomic<IngestOverflowPolicy> m_policy;
+        std::atomic<bool> m_closed{false};
+
+        // Producer and consumer positions on separate cache lines
+        alignas(64) std::atomic<std::size_t> m_enqueuePos{0};
+        alignas(64) std::atomic<std::size_t> m_dequeuePos{0};
+
+        // Bumped whenever room appears or the ring closes; BLOCK producers wait on it
+        alignas(64) std::atomic<uint32_t> m_space{0};
+        std::atomic<uint64_t> m_droppedOldest{0};
+        std::atomic<uint64_t> m_droppedNewest{0};
+        std::atomic<uint64_t> m_blocked{0};
+    };
+
+    /**
+     * IngestRings sharded by vehicle id, for several feed threads at once: producers spread
+     * over the shards instead of contending on one ring's enqueue position, and all of a
+     * vehicle's updates go through one shard, so they are drained in the order they were
+     * pushed. The ring API, applied to every shard.
+     */
+    class IngestShards
+    {
+      public:
+        /** `capacity` is split over `shards` rings (0 = one per hardware thread, up to 8) */
+        explicit IngestShards(std::size_t capacity = 1u << 16, std::size_t shards = 0,
+                              IngestOverflowPolicy policy = IngestOverflowPolicy::DROP_OLDEST);
+
+        void setPolicy(IngestOverflowPolicy policy);
+        IngestOverflowPolicy policy() const { return m_shards.front()->policy(); }
+
+        bool push(const VehicleUpdate& update)
+        {
+            return m_shards[update.id % m_shards.size()]->push(update);
+        }
+
+        /** Drain each shard in turn, at most one shard's capacity from each */
+        std::size_t drain(std::vector<VehicleUpdate>& out);
+
+        void close();
+        void open();
+
+        /** Counters summed over the shards */
+        IngestRingStats stats() const;
+        std::size_t capacity() const { return m_shards.size() * m_shards.front()->capacity(); }
+        std::size_t shards() const { return m_shards.size(); }
+
+      private:
+        std::vector<std::unique_ptr<IngestRing>> m_shards;
+    };
+
+} // namespace tfv
+#endif // TFV_INGEST_RING_HPP
@@ -0,0 +1,94 @@
+#ifndef TFV_JSON_FEED_DECODER_HPP
+#define TFV_JSON_FEED_DECODER_HPP
+
+#include <cstdint>
+#include <string_view>
+
+#include "core/VehicleUpdate.hpp"
+
+namespace tfv
+{
+    /**
+     * Decoder for live feed messages shaped like vehicles_live.json: one object
+     * {"id": 17, "ts": 1700000000.25, "lat": 52.52, "lon": 13.40, "speed": 8.5} or an array
+     * of them. It walks the text once without building a DOM: structural scans (string ends,
+     * whitespace, skipped values) run 16 bytes at a time with SSE2 where available, numbers
+     * go through std::from_chars, and each object is decoded straight into a VehicleUpdate.
+     * Nothing is allocated. Keys may come in any order; unknown keys are skipped, id, lat and
+     * lon are required and must not be null, and a null or missing ts/speed/seq stays 0.
+     */
+    class JsonFeedDecoder
+    {
+      public:
+        explicit JsonFeedDecoder(uint16_t source = 0) : m_source(source) {}
+
+        /**
+         * Decode one message, calling `onUpdate(const VehicleUpdate&)` for each object in
+         * order. False on malformed input (see error()); updates before the fault have
+         * already been delivered.
+         */
+        template <typename OnUpdate>
+        bool decode(std::string_view message, OnUpdate&& onUpdate);
+
+        /** Why the last decode() failed */
+        const char* error() const { return m_error; }
+
+      private:
+        // Each returns the position after what it consumed, or null on malformed input
+        const char* parseObject(const char* p, const char* end, VehicleUpdate& update);
+        const char* skipValue(const char* p, const char* end);
+        const char* fail(const char* reason);
+
+        uint16_t m_source;
+        const char* m_error{""};
+    };
+
+    namespace json
+    {
+        /** First non-whitespace byte in [p, end), or end */
+        const char* skipSpace(const char* p, const char* end);
+    } // namespace json
+
+    template <typename OnUpdate>
+    bool JsonFeedDecoder::decode(std::string_view message, OnUpdate&& onUpdate)
+    {
+        m_error = "";
+        const char* const end = message.data() + message.size();
+        const char* p = json::skipSpace(message.data(), end);
+        VehicleUpdate update;
+
+        if(p != end && *p == '[')
+        {
+            p = json::skipSpace(p + 1, end);
+            if(p != end && *p == ']')
+                return json::skipSpace(p + 1, end) == end || fail("trailing data");
+            for(;;)
+            {
+                p = parseObject(p, end, update);
+                if(!p)
+                    return false;
+                onUpdate(static_cast<const VehicleUpdate&>(update));
+
+                p = json::skipSpace(p, end);
+                if(p == end)
+                    return fail("unterminated array");
+                if(*p == ']')
+                    break;
+                if(*p != ',')
+                    return fail("expected ',' or ']' in array");
+                p = json::skipSpace(p + 1, end);
+            }
+            ++p;
+        }
+        else
+        {
+            p = parseObject(p, end, update);
+            if(!p)
+                return false;
+            onUpdate(static_cast<const VehicleUpdate&>(update));
+        }
+        return json::skipSpace(p, end) == end || fail("trailing data");
+    }
+
+} // namespace tfv
+#endif // TFV_JSON_FEED_DECODER_HPP
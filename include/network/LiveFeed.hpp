@@ -2,20 +2,38 @@
 #define TFV_LIVE_FEED_HPP
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
 #include "core/Simulation.hpp"
+#include "network/BinaryFeedDecoder.hpp"
+#include "network/FeedReconciler.hpp"
+#include "network/IngestRing.hpp"
+#include "network/JsonFeedDecoder.hpp"
+#include "network/MapMatcher.hpp"
+#include "network/StreamClient.hpp"
+#include "network/WebSocketClient.hpp"
 
 namespace tfv
 {
     enum class FeedType
     {
-        DUMMY,    // Dummy feed for testing
-        WEBSOCKET // WebSocket feed
+        DUMMY,     // Dummy feed for testing
+        WEBSOCKET, // WebSocket feed of JSON messages
+        BINARY     // Length-prefixed protobuf-wire messages over tcp:// or unix://
+    };
+
+    /** Running totals of a feed handler; safe to read from any thread */
+    struct FeedHandlerStats
+    {
+        uint64_t messages{0};
+        uint64_t bytes{0};
+        uint64_t decodeErrors{0};
     };
 
     class IFeedHandler
@@ -25,12 +43,16 @@ namespace tfv
         virtual void start() = 0;
         virtual void stop() = 0;
         virtual bool isRunning() const = 0;
+        /** Running and connected; a running handler may be waiting to reconnect */
+        virtual bool isConnected() const { return isRunning(); }
+        virtual FeedHandlerStats stats() const { return {}; }
     };
 
+    /** Moves a few synthetic vehicles around the road network, for testing */
     class DummyFeedHandler : public IFeedHandler
     {
       public:
-        explicit DummyFeedHandler(Simulation& sim);
+        DummyFeedHandler(IngestShards& rings, const RoadNetwork* network, uint16_t source = 0);
         ~DummyFeedHandler() override;
 
         void start() override;
@@ -38,56 +60,224 @@ namespace tfv
         bool isRunning() const override;
 
       private:
+        static constexpr int kVehicles = 32;
+        static constexpr int kIntervalMs = 200;
+
         void loop();
 
-        Simulation& m_sim;
+        IngestShards& m_rings;
+        const RoadNetwork* m_network;
+        uint16_t m_source;
         std::thread m_thr;
         std::atomic_bool m_running{false};
     };
 
+    /**
+     * Consumes a ws:// feed on its own thread. A lost connection is retried after
+     * m_reconnectInterval, doubling per failed attempt (with jitter) up to
+     * kMaxBackoffFactor times that; a connection silent for a ping interval is pinged and
+     * one silent for two is dropped and reconnected. Decoded updates go to the ingest rings,
+     * tagged with the handler's source id.
+     */
     class WebSocketFeedHandler : public IFeedHandler
     {
       public:
-        explicit WebSocketFeedHandler(Simulation& sim);
+        explicit WebSocketFeedHandler(IngestShards& rings, uint16_t source = 0);
         ~WebSocketFeedHandler() override;
 
         void setUrl(const std::string& url) { m_url = url; }
         void setReconnectInterval(int ms) { m_reconnectInterval = ms; }
+        void setPingInterval(int ms) { m_pingInterval = ms; }
 
         void start() override;
         void stop() override;
         bool isRunning() const override;
+        bool isConnected() const override { return m_connected.load(std::memory_order_relaxed); }
+        FeedHandlerStats stats() const override;
+
+        uint64_t messagesReceived() const { return m_messages.load(std::memory_order_relaxed); }
+        uint64_t bytesReceived() const { return m_bytes.load(std::memory_order_relaxed); }
+        uint64_t decodeErrors() const { return m_decodeErrors.load(std::memory_order_relaxed); }
 
       private:
+        static constexpr int kConnectTimeoutMs = 5000;
+        static constexpr int kMaxBackoffFactor = 16;
+
         void loop();
-        bool connect();
-        void processMessage(const std::string& msg);
+        bool connect(const websocket::Url& url);
+        int reconnectDelay(int failures) const;
+        void processMessage(std::string_view msg);
 
-        Simulation& m_sim;
+        IngestShards& m_rings;
         std::string m_url;
         std::thread m_thr;
         std::atomic_bool m_running{false};
+        std::atomic_bool m_connected{false};
         int m_reconnectInterval{5000}; // ms
+        int m_pingInterval{10000};     // ms
+        WebSocketClient m_client;
+        JsonFeedDecoder m_decoder;
+        std::atomic<uint64_t> m_messages{0};
+        std::atomic<uint64_t> m_bytes{0};
+        std::atomic<uint64_t> m_decodeErrors{0};
     };
 
-    /** Real-time data feed manager */
+    /**
+     * Consumes a binary feed (see BinaryFeedDecoder) from a tcp:// or unix:// stream on its
+     * own thread, decoding in place in the receive buffer. Reconnects like
+     * WebSocketFeedHandler; a corrupt stream is dropped and reconnected, since length-prefixed
+     * framing cannot be resynchronised.
+     */
+    class BinaryFeedHandler : public IFeedHandler
+    {
+      public:
+        explicit BinaryFeedHandler(IngestShards& rings, uint16_t source = 0);
+        ~BinaryFeedHandler() override;
+
+        void setUrl(const std::string& url) { m_url = url; }
+        void setReconnectInterval(int ms) { m_reconnectInterval = ms; }
+
+        void start() override;
+        void stop() override;
+        bool isRunning() const override;
+        bool isConnected() const override { return m_connected.load(std::memory_order_relaxed); }
+        FeedHandlerStats stats() const override;
+
+        uint64_t messagesReceived() const { return m_messages.load(std::memory_order_relaxed); }
+        uint64_t bytesReceived() const { return m_bytes.load(std::memory_order_relaxed); }
+        uint64_t decodeErrors() const { return m_decodeErrors.load(std::memory_order_relaxed); }
+
+      private:
+        static constexpr int kConnectTimeoutMs = 5000;
+        static constexpr int kMaxBackoffFactor = 16;
+        static constexpr int kReadTimeoutMs = 500;
+        static constexpr std::size_t kBufferSize = 256 * 1024;
+
+        void loop();
+        void receive(); // Read and decode until the connection ends or stop()
+
+        IngestShards& m_rings;
+        std::string m_url;
+        std::thread m_thr;
+        std::atomic_bool m_running{false};
+        std::atomic_bool m_connected{false};
+        int m_reconnectInterval{5000}; // ms
+        StreamClient m_client;
+        BinaryFeedDecoder m_decoder;
+        std::vector<uint8_t> m_buffer;
+        std::atomic<uint64_t> m_messages{0};
+        std::atomic<uint64_t> m_bytes{0};
+        std::atomic<uint64_t> m_decodeErrors{0};
+    };
+
+    /** One source of a LiveFeed, as of its last status report */
+    struct FeedSourceStatus
+    {
+        uint16_t source{0}; // Tags the source's updates (VehicleUpdate::source)
+        std::string url;
+        FeedType type{FeedType::DUMMY};
+        bool connected{false};
+        double messagesPerSecond{0.0};
+        double updatesPerSecond{0.0}; // Drained for the simulation
+        double bytesPerSecond{0.0};
+        double lag{0.0};         // Local clock minus the newest report's timestamp, seconds
+        double clockOffset{0.0}; // Local - source clock (see FeedReconciler); lag includes it
+        uint64_t decodeErrors{0};
+    };
+
+    /**
+     * Real-time data feed manager for any number of sources, each handler on its own thread
+     * decoding into IngestShards: updates are sharded by vehicle id over several rings, so
+     * feed threads do not contend on one. Decoding scales with the number of sources, not
+     * within one: a single source is decoded on its handler's thread, so a feed too fast for
+     * one core has to be split across several sources. The simulation thread drains every shard once per
+     * tick in update(), so the simulation lock is never taken per message. There the batch
+     * is reconciled (stale and duplicate reports dropped, late ones dead-reckoned to the
+     * present, see FeedReconciler) and raw fixes are map-matched, once a GeoReference is
+     * set.
+     *
+     * Each source's throughput and lag are reported through the status callback every
+     * status interval, and its connection changes as they are seen. Control the feed and
+     * call update() from one thread; callbacks run on it too.
+     */
     class LiveFeed
     {
       public:
-        explicit LiveFeed(Simulation& sim);
+        static constexpr uint16_t kNoSource = 0xFFFF; // addSource() when ids have run out
+
+        /** `shards` rings share `ringCapacity` (0 = one per hardware thread, up to 8) */
+        explicit LiveFeed(Simulation& sim, std::size_t ringCapacity = 1u << 16,
+                          std::size_t shards = 0);
         ~LiveFeed();
 
+        /** Drop every source and consume just `url` */
         void connect(const std::string& url, FeedType type = FeedType::WEBSOCKET);
+        /** Drop every source */
         void disconnect();
+        /** At least one source is running */
         bool isConnected() const;
 
-        // Set callback for connection status changes
+        /**
+         * Consume `url` alongside the current sources, on a thread of its own. Returns the
+         * source id its updates are tagged with; ids are not reused, so once all 65535 have
+         * been handed out no source is added and kNoSource is returned.
+         */
+        uint16_t addSource(const std::string& url, FeedType type = FeedType::WEBSOCKET);
+        bool removeSource(uint16_t source);
+        std::vector<FeedSourceStatus> sources() const;
+
+        /** Apply every update queued since the last call; call on the simulation thread */
+        std::size_t update();
+
+        /**
+         * Map-match updates that carry only a GPS fix, using `reference` to place fixes on
+         * the simulation's road network; without one such updates are skipped
+         */
+        void setGeoReference(const GeoReference& reference);
+
+        /** What the feed threads do when the simulation falls behind */
+        void setOverflowPolicy(IngestOverflowPolicy policy) { m_rings.setPolicy(policy); }
+        IngestRingStats ingestStats() const { return m_rings.stats(); }
+
+        /** Reports dropped as stale or duplicate so far; read on the simulation thread */
+        const ReconcilerStats& reconcileStats() const { return m_reconciler.stats(); }
+
+        // Set callback for connection status changes and per-source status reports
         using StatusCallback = std::function<void(bool connected, const std::string& message)>;
         void setStatusCallback(StatusCallback cb) { m_statusCallback = cb; }
+        void setStatusInterval(double seconds) { m_statusInterval = seconds; }
 
       private:
+        struct Source
+        {
+            FeedSourceStatus status;
+            std::unique_ptr<IFeedHandler> handler;
+            FeedHandlerStats reported; // Handler totals at the last report
+        };
+
+        // Drained per source id since the last report
+        struct SourceTally
+        {
+            uint64_t updates{0};
+            double newest{0.0}; // Newest source timestamp
+        };
+
+        std::unique_ptr<IFeedHandler> createHandler(const std::string& url, FeedType type,
+                                                    uint16_t source);
+        void stopSource(Source& source);
+        void checkSources(double now); // Connection changes, and reports when due
+        void report(bool connected, const std::string& message);
+
         Simulation& m_sim;
-        std::unique_ptr<IFeedHandler> m_handler;
+        IngestShards m_rings;
+        std::vector<VehicleUpdate> m_batch; // Reused by update()
+        FeedReconciler m_reconciler;
+        std::unique_ptr<MapMatcher> m_matcher;
+        std::vector<Source> m_sources;
+        std::vector<SourceTally> m_tally; // By source id
+        uint32_t m_nextSource{0}; // Wider than an id, so running out is seen
+        double m_lastReport{0.0}; // Steady clock, seconds
+        double m_statusInterval{5.0};
         StatusCallback m_statusCallback;
     };
 
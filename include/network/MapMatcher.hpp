@@ -0,0 +1,123 @@
+#ifndef TFV_MAP_MATCHER_HPP
+#define TFV_MAP_MATCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "core/RoadNetwork.hpp"
+#include "core/VehicleUpdate.hpp"
+#include "utils/TaskPool.hpp"
+
+namespace tfv
+{
+    /**
+     * Ties geographic fixes to the network's world coordinates: the point (refLat, refLon)
+     * sits at world (refX, refY), x grows east and y north, `unitsPerMetre` world units to
+     * the metre. The projection is equirectangular about the reference point, accurate to
+     * well under a metre across a city.
+     */
+    struct GeoReference
+    {
+        double refLat{0.0};
+        double refLon{0.0};
+        double refX{0.0};
+        double refY{0.0};
+        double unitsPerMetre{1.0};
+    };
+
+    /** Tuning for MapMatcher; distances in metres */
+    struct MapMatchParams
+    {
+        float searchRadius{50.0f}; // Segments farther from a fix are not candidates
+        float gpsSigma{8.0f};      // Standard deviation of GPS error
+        float beta{10.0f};         // Scale of |route distance - straight distance| penalty
+        double maxGap{30.0};       // Seconds without a fix after which a track restarts
+    };
+
+    /**
+     * Online HMM map-matcher (Newson & Krumm). Each fix is projected onto the candidate
+     * segments the spatial index finds within the search radius; a candidate's emission
+     * score falls with its distance from the fix, and a transition's with how far the route
+     * distance between consecutive candidates differs from the straight-line distance
+     * between the fixes (found by a short bounded search along outgoing segments). Per
+     * vehicle only the previous step's candidates and Viterbi scores are kept, so each fix
+     * extends the best paths by one step in O(candidates^2); an impossible transition or a
+     * long gap restarts the track.
+     *
+     * match() partitions a batch by vehicle across a TaskPool, so every track is touched by
+     * one thread and in report order. Tracks are not thread-safe otherwise: call match() from
+     * one thread at a time. A track with no fix for maxGap seconds of local time would
+     * restart anyway and is dropped; its storage goes to the next new vehicle.
+     */
+    class MapMatcher
+    {
+      public:
+        static constexpr int kMaxCandidates = 8;
+
+        /** `network` must outlive the matcher and not change while it is used */
+        MapMatcher(const RoadNetwork& network, const GeoReference& reference,
+                   std::size_t threads = 0);
+        ~MapMatcher();
+
+        void setParams(const MapMatchParams& params) { m_params = params; }
+        const MapMatchParams& params() const { return m_params; }
+
+        /**
+         * Match every upsert that has no segment yet, in place: segmentId, position and
+         * confidence are filled in, or left unmatched when no segment is in range. Removals
+         * drop their track. `now` is the local clock in seconds, which ages out idle tracks.
+         * Returns the updates matched.
+         */
+        std::size_t match(std::span<VehicleUpdate> updates, double now);
+
+        /** World position of a fix */
+        void project(double lat, double lon, double& x, double& y) const;
+
+        std::size_t trackedVehicles() const;
+
+      private:
+        struct Track
+        {
+            double time{0.0};       // Last fix, source clock
+            double seen{0.0};       // The same on the local clock, for eviction
+            float x{0.0f}, y{0.0f}; // Last fix, local frame
+            int count{0};           // Candidates below; 0 restarts the track
+            uint32_t segment[kMaxCandidates];
+            float offset[kMaxCandidates]; // Along the segment, world units
+            float score[kMaxCandidates];  // Viterbi log-probability, best = 0
+        };
+
+        struct Candidate
+        {
+            uint32_t segment; // Dense geometry index
+            float offset;     // Along the segment, world units
+            float distance;   // From the fix, world units
+        };
+
+        struct Shard; // Tracks and scratch of the vehicles with id % shards == k
+
+        bool matchOne(Shard& shard, VehicleUpdate& update, double now);
+        void findCandidates(float x, float y, std::vector<Candidate>& out) const;
+        // Route distance from (from, fromOffset) to each candidate, in world units
+        void routeDistances(uint32_t from, float fromOffset, const Candidate* to, int count,
+                            float bound, float* out, Shard& shard) const;
+
+        const RoadNetwork& m_network;
+        GeoReference m_reference;
+        MapMatchParams m_params;
+        double m_metresPerDegreeLon;
+
+        // Successors of each segment (those leaving its end node), CSR by dense index
+        std::vector<uint32_t> m_nextStart;
+        std::vector<uint32_t> m_next;
+
+        std::vector<std::unique_ptr<Shard>> m_shards;
+        TaskPool m_pool;
+    };
+
+} // namespace tfv
+#endif // TFV_MAP_MATCHER_HPP
@@ -0,0 +1,66 @@
+#ifndef TFV_STREAM_CLIENT_HPP
+#define TFV_STREAM_CLIENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace tfv
+{
+    /** Where a raw byte-stream feed lives: tcp://host:port or unix:///path/to/socket */
+    struct StreamEndpoint
+    {
+        bool local{false}; // Unix domain socket at `path`
+        std::string host;
+        uint16_t port{0};
+        std::string path;
+    };
+
+    bool parseStreamUrl(std::string_view url, StreamEndpoint& out);
+
+    /**
+     * Plain connected stream socket (TCP or Unix domain) read with poll(2) from a single
+     * thread. Unlike WebSocketClient there is no framing: read() fills the caller's buffer
+     * so a decoder can parse in place. Only wake() may be called from another thread.
+     */
+    class StreamClient
+    {
+      public:
+        StreamClient();
+        ~StreamClient();
+
+        StreamClient(const StreamClient&) = delete;
+        StreamClient& operator=(const StreamClient&) = delete;
+
+        bool connect(const StreamEndpoint& endpoint, int timeoutMs);
+
+        /**
+         * Wait up to `timeoutMs` and read what is available into `buffer`: the bytes read,
+         * 0 on timeout or wake(), -1 once the connection is gone (see error()).
+         */
+        long read(uint8_t* buffer, std::size_t capacity, int timeoutMs);
+
+        void close();
+        bool isOpen() const { return m_fd >= 0; }
+
+        /** Interrupt a blocked read() or sleep(); safe from any thread */
+        void wake();
+
+        /** Sleep up to `ms`; true if woken early */
+        bool sleep(int ms);
+
+        const std::string& error() const { return m_error; }
+
+      private:
+        bool fail(const std::string& reason);
+        void drainWake();
+
+        int m_fd{-1};
+        int m_wakeRead{-1};
+        int m_wakeWrite{-1};
+        std::string m_error;
+    };
+
+} // namespace tfv
+#endif // TFV_STREAM_CLIENT_HPP
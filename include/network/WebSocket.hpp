@@ -0,0 +1,192 @@
+#ifndef TFV_WEB_SOCKET_HPP
+#define TFV_WEB_SOCKET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tfv
+{
+    /** Transport-independent pieces of the WebSocket protocol (RFC 6455) */
+    namespace websocket
+    {
+        enum class Opcode : uint8_t
+        {
+            CONTINUATION = 0x0,
+            TEXT = 0x1,
+            BINARY = 0x2,
+            CLOSE = 0x8,
+            PING = 0x9,
+            PONG = 0xA
+        };
+
+        // Close status codes used by the client
+        inline constexpr uint16_t kCloseNormal = 1000;
+        inline constexpr uint16_t kCloseProtocolError = 1002;
+        inline constexpr uint16_t kCloseTooBig = 1009;
+
+        struct Url
+        {
+            std::string host;
+            uint16_t port{80};
+            std::string path{"/"}; // Path plus query
+        };
+
+        /** Parse a ws:// URL; wss:// is rejected (no TLS support) */
+        bool parseUrl(std::string_view url, Url& out);
+
+        /** Random Sec-WebSocket-Key for a handshake */
+        std::string makeKey();
+
+        /** Sec-WebSocket-Accept a server must answer `key` with */
+        std::string acceptFor(std::string_view key);
+
+        /** The client's opening handshake request */
+        std::string handshakeRequest(const Url& url, std::string_view key);
+
+        /**
+         * Check a server's handshake response (everything up to and including the blank
+         * line) against the key sent; `error` says why it was rejected
+         */
+        bool checkHandshakeResponse(std::string_view response, std::string_view key,
+                                    std::string& error);
+
+        /**
+         * Append one frame to `out`. Clients must mask every frame they send (pass a random
+         * `maskKey`); servers must not (pass `masked = false`).
+         */
+        void encodeFrame(Opcode opcode, const uint8_t* payload, std::size_t size, bool masked,
+                         uint32_t maskKey, std::vector<uint8_t>& out, bool fin = true);
+
+        /** XOR `size` bytes with the 4-byte mask, starting `offset` bytes into the payload */
+        void applyMask(uint8_t* data, std::size_t size, uint32_t maskKey, std::size_t offset = 0);
+
+        /**
+         * Incremental parser for frames a server sends to this client. parse() consumes every
+         * complete frame in a buffer and leaves a trailing partial frame for the next call,
+         * once more bytes have arrived behind it. Servers must not mask frames (RFC 6455
+         * section 5.1), so a masked frame fails with kCloseProtocolError. Unfragmented
+         * messages are delivered as views into the caller's buffer, so the common case copies
+         * nothing; only fragmented messages are reassembled into an internal buffer. Control
+         * frames may arrive between fragments, as the RFC allows.
+         */
+        class FrameParser
+        {
+          public:
+            struct Message
+            {
+                Opcode opcode;
+                const uint8_t* data;
+                std::size_t size;
+
+                std::string_view text() const
+                {
+                    return {reinterpret_cast<const char*>(data), size};
+                }
+            };
+
+            /** Largest message accepted, fragmented or not */
+            void setMaxMessageSize(std::size_t bytes) { m_maxMessageSize = bytes; }
+
+            /**
+             * Parse complete frames from `data`, calling `onMessage(const Message&)` for each
+             * whole message (data or control). Returns the bytes consumed; on a protocol
+             * violation returns what was consumed so far and failed() becomes true. Views
+             * are valid until the caller reuses the buffer or calls parse() again.
+             */
+            template <typename OnMessage>
+            std::size_t parse(uint8_t* data, std::size_t size, OnMessage&& onMessage);
+
+            bool failed() const { return m_closeCode != 0; }
+            /** Close code to report for a failure (kCloseProtocolError or kCloseTooBig) */
+            uint16_t closeCode() const { return m_closeCode; }
+            const std::string& error() const { return m_error; }
+
+            /** Forget any partial message and error, for a new connection */
+            void reset();
+
+          private:
+            struct Header
+            {
+                bool fin;
+                Opcode opcode;
+                std::size_t headerSize;
+                uint64_t payloadSize;
+            };
+
+            // Decode a frame header; false if more bytes are needed (or on error)
+            bool readHeader(const uint8_t* data, std::size_t size, Header& header);
+            bool fail(uint16_t code, const char* reason);
+
+            std::vector<uint8_t> m_fragments;
+            Opcode m_fragmentOpcode{Opcode::CONTINUATION}; // CONTINUATION: none in progress
+            std::size_t m_maxMessageSize{16u << 20};
+            uint16_t m_closeCode{0};
+            std::string m_error;
+        };
+
+        template <typename OnMessage>
+        std::size_t FrameParser::parse(uint8_t* data, std::size_t size, OnMessage&& onMessage)
+        {
+            std::size_t pos = 0;
+            Header header;
+            while(!failed() && readHeader(data + pos, size - pos, header))
+            {
+                if(size - pos - header.headerSize < header.payloadSize)
+                    break; // Payload still arriving
+
+                uint8_t* payload = data + pos + header.headerSize;
+                const std::size_t length = static_cast<std::size_t>(header.payloadSize);
+                pos += header.headerSize + length;
+
+                if(header.opcode >= Opcode::CLOSE)
+                {
+                    onMessage(Message{header.opcode, payload, length});
+                }
+                else if(header.opcode != Opcode::CONTINUATION)
+                {
+                    if(m_fragmentOpcode != Opcode::CONTINUATION)
+                    {
+                        fail(kCloseProtocolError, "new message inside a fragmented one");
+                        break;
+                    }
+                    if(header.fin)
+                    {
+                        onMessage(Message{header.opcode, payload, length});
+                    }
+                    else
+                    {
+                        m_fragmentOpcode = header.opcode;
+                        m_fragments.assign(payload, payload + length);
+                    }
+                }
+                else
+                {
+                    if(m_fragmentOpcode == Opcode::CONTINUATION)
+                    {
+                        fail(kCloseProtocolError, "continuation without a message");
+                        break;
+                    }
+                    if(m_fragments.size() + length > m_maxMessageSize)
+                    {
+                        fail(kCloseTooBig, "fragmented message too large");
+                        break;
+                    }
+                    m_fragments.insert(m_fragments.end(), payload, payload + length);
+                    if(header.fin)
+                    {
+                        const Opcode opcode = m_fragmentOpcode;
+                        m_fragmentOpcode = Opcode::CONTINUATION;
+                        onMessage(Message{opcode, m_fragments.data(), m_fragments.size()});
+                        m_fragments.clear();
+                    }
+                }
+            }
+            return pos;
+        }
+    } // namespace websocket
+
+} // namespace tfv
+#endif // TFV_WEB_SOCKET_HPP
@@ -0,0 +1,105 @@
+#ifndef TFV_WEB_SOCKET_CLIENT_HPP
+#define TFV_WEB_SOCKET_CLIENT_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "network/WebSocket.hpp"
+
+namespace tfv
+{
+    /**
+     * One WebSocket connection over a non-blocking TCP socket, driven by poll() from a single
+     * thread: epoll on Linux, poll(2) on other POSIX systems. Pings are answered and close
+     * frames echoed internally; data messages are handed to the caller as views into the
+     * receive buffer. Only wake() may be called from another thread.
+     */
+    class WebSocketClient
+    {
+      public:
+        using Message = websocket::FrameParser::Message;
+        using MessageHandler = std::function<void(const Message& message)>;
+
+        WebSocketClient();
+        ~WebSocketClient();
+
+        WebSocketClient(const WebSocketClient&) = delete;
+        WebSocketClient& operator=(const WebSocketClient&) = delete;
+
+        /** Connect and complete the opening handshake within `timeoutMs` */
+        bool connect(const websocket::Url& url, int timeoutMs);
+
+        /**
+         * Wait up to `timeoutMs` for traffic and process all of it, calling `onMessage` for
+         * each text or binary message. False once the connection is gone (see error());
+         * returns early, still true, when woken.
+         */
+        bool poll(int timeoutMs, const MessageHandler& onMessage);
+
+        void sendPing();
+
+        /** Send a close frame (best effort) and drop the connection */
+        void close(uint16_t code = websocket::kCloseNormal);
+
+        bool isOpen() const { return m_fd >= 0; }
+
+        /** Interrupt a blocked poll() or sleep(); safe from any thread */
+        void wake();
+
+        /** Sleep up to `ms`; true if woken early */
+        bool sleep(int ms);
+
+        /** When anything was last received on this connection */
+        std::chrono::steady_clock::time_point lastReceive() const { return m_lastReceive; }
+
+        /** Why connect() failed or the connection ended */
+        const std::string& error() const { return m_error; }
+
+      private:
+        enum Event
+        {
+            READABLE = 1,
+            WRITABLE = 2,
+            WOKEN = 4,
+            FAILED = 8
+        };
+
+        int wait(bool wantWrite, int timeoutMs);
+        bool connectSocket(const websocket::Url& url,
+                           std::chrono::steady_clock::time_point deadline);
+        bool handshake(const websocket::Url& url, std::chrono::steady_clock::time_point deadline);
+        int readInput(); // One recv() into m_in: bytes read, 0 if none waiting, -1 if gone
+        bool processInput(const MessageHandler* onMessage);
+        bool flush();
+        void queueFrame(websocket::Opcode opcode, const uint8_t* payload, std::size_t size);
+        bool fail(const std::string& reason);
+        void closeSocket();
+
+        int m_fd{-1};
+        int m_poller{-1}; // epoll instance (Linux only)
+        int m_wakeRead{-1};
+        int m_wakeWrite{-1};
+        bool m_pollingWrite{false};
+
+        // Received bytes not yet parsed are [m_begin, m_end)
+        std::vector<uint8_t> m_in;
+        std::size_t m_begin{0};
+        std::size_t m_end{0};
+        std::vector<uint8_t> m_out;
+        std::size_t m_outPos{0};
+
+        websocket::FrameParser m_parser;
+        std::mt19937 m_maskRng{std::random_device{}()};
+        bool m_closeSent{false};
+        bool m_closeReceived{false};
+        std::chrono::steady_clock::time_point m_lastReceive{};
+        std::string m_error;
+    };
+
+} // namespace tfv
+#endif // TFV_WEB_SOCKET_CLIENT_HPP
@@ -0,0 +1,69 @@
+#ifndef TFV_ENCODER_POOL_HPP
+#define TFV_ENCODER_POOL_HPP
+
+#include "recording/FramePool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace tfv
+{
+    /**
+     * Worker threads that drain a FramePool, encode frames in parallel and emit the results in
+     * capture order.
+     *
+     * Each worker pops the next frame, encodes it into its own scratch buffer and returns the
+     * frame to the pool straight away, so capture buffers are never held for the slow part of
+     * the write. Output then waits for its turn: `write` is called once per frame, strictly by
+     * increasing Frame::index and never concurrently, so it can append to a single stream.
+     */
+    class EncoderPool
+    {
+      public:
+        /** Encode a frame into `out`; false skips the frame's output */
+        using EncodeFn = std::function<bool(const Frame& frame, std::vector<uint8_t>& out)>;
+        /** Consume one encoded frame, in order; false counts as a write failure */
+        using WriteFn = std::function<bool(uint64_t index, std::span<const uint8_t> bytes)>;
+
+        /**
+         * Start the workers; they run until the frame pool is closed and drained
+         * @param threads Worker count (0: hardware threads minus one for the render loop)
+         */
+        EncoderPool(FramePool& frames, unsigned threads, EncodeFn encode, WriteFn write);
+        ~EncoderPool();
+
+        EncoderPool(const EncoderPool&) = delete;
+        EncoderPool& operator=(const EncoderPool&) = delete;
+
+        /** Wait for the workers to finish (call after FramePool::close()) */
+        void join();
+
+        unsigned threadCount() const { return static_cast<unsigned>(m_threads.size()); }
+        uint64_t written() const { return m_written; }
+        uint64_t failed() const { return m_failed; }
+
+      private:
+        void run();
+
+        FramePool& m_frames;
+        EncodeFn m_encode;
+        WriteFn m_write;
+        std::vector<std::thread> m_threads;
+
+        // Output turn: the index of the next frame allowed to write
+        std::mutex m_turnMutex;
+        std::condition_variable m_turnCv;
+        uint64_t m_nextWrite{0};
+
+        std::atomic<uint64_t> m_written{0};
+        std::atomic<uint64_t> m_failed{0};
+    };
+
+} // namespace tfv
+#endif // TFV_ENCODER_POOL_HPP
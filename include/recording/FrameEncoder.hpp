@@ -0,0 +1,40 @@
+#ifndef TFV_FRAME_ENCODER_HPP
+#define TFV_FRAME_ENCODER_HPP
+
+#include "recording/FramePool.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace tfv
+{
+    /** Image format for recorded frames */
+    enum class FrameFormat
+    {
+        PNG, // Deflate-compressed; smallest files, slowest to encode
+        QOI, // "Quite OK Image": lossless, 20-50x faster than PNG at similar size on UI content
+        BMP, // Uncompressed 32-bit; a header plus one copy of the pixels
+        PPM  // Uncompressed binary RGB (P6)
+    };
+
+    /** How recorded frames are encoded */
+    struct EncoderOptions
+    {
+        FrameFormat format{FrameFormat::PNG};
+        int compressionLevel{6}; // PNG deflate level, 0 (store) to 9 (smallest)
+        unsigned threads{0};     // Encoder threads; 0 picks one from the core count
+    };
+
+    /** File extension for a format, without the dot */
+    const char* frameExtension(FrameFormat format);
+
+    /**
+     * Encode one frame into `out` (cleared first; capacity is kept for the next frame).
+     * @param compressionLevel Deflate level for PNG, ignored by the other formats
+     * @return false if the frame could not be encoded
+     */
+    bool encodeFrame(const Frame& frame, FrameFormat format, int compressionLevel,
+                     std::vector<uint8_t>& out);
+
+} // namespace tfv
+#endif // TFV_FRAME_ENCODER_HPP
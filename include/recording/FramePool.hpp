@@ -0,0 +1,101 @@
+#ifndef TFV_FRAME_POOL_HPP
+#define TFV_FRAME_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tfv
+{
+    /** What the capture side does when every buffer is still queued for encoding */
+    enum class OverflowPolicy
+    {
+        DROP, // Skip the frame and count it; capture never stalls the render loop
+        BLOCK // Wait for the writer; no frame is lost, the render loop slows down instead
+    };
+
+    /** One captured frame: ARGB8888 pixels, tightly packed */
+    struct Frame
+    {
+        std::vector<uint32_t> pixels;
+        int width{0};
+        int height{0};
+        uint64_t index{0}; // Sequence number among accepted frames
+
+        int pitch() const { return width * static_cast<int>(sizeof(uint32_t)); }
+    };
+
+    /** Snapshot of the pool counters */
+    struct FramePoolStats
+    {
+        uint64_t captured{0};  // Frames submitted to the queue
+        uint64_t dropped{0};   // Frames skipped because no buffer was free (DROP)
+        uint64_t blocked{0};   // Captures that had to wait for a buffer (BLOCK)
+        std::size_t queued{0}; // Frames waiting for the writer right now
+        std::size_t capacity{0};
+    };
+
+    /**
+     * Fixed set of frame buffers shared by one producer (capture) and one consumer (writer).
+     *
+     * All buffers are allocated up front; afterwards frames only move between a free list and
+     * a FIFO ring of filled frames, so memory stays flat however long a recording runs. Both
+     * sides wait on condition variables instead of polling.
+     */
+    class FramePool
+    {
+      public:
+        FramePool(std::size_t capacity, int width, int height);
+
+        FramePool(const FramePool&) = delete;
+        FramePool& operator=(const FramePool&) = delete;
+
+        /**
+         * Free buffer to fill, or null when none is available under DROP (counted as dropped)
+         * or after close().
+         */
+        Frame* acquire(OverflowPolicy policy);
+
+        /** Queue a filled buffer for the writer */
+        void submit(Frame* frame);
+
+        /** Return a buffer taken by acquire() without submitting it */
+        void cancel(Frame* frame);
+
+        /** Oldest filled frame; waits for one. Null once closed and drained. */
+        Frame* pop();
+
+        /** Hand a frame returned by pop() back to the free list */
+        void release(Frame* frame);
+
+        /** Stop accepting frames and wake every waiter; queued frames can still be popped */
+        void close();
+
+        FramePoolStats stats() const;
+        int width() const { return m_width; }
+        int height() const { return m_height; }
+
+      private:
+        const int m_width;
+        const int m_height;
+        std::vector<std::unique_ptr<Frame>> m_storage;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_freeCv;  // Producer: a buffer was released
+        std::condition_variable m_readyCv; // Consumer: a frame was submitted
+        std::vector<Frame*> m_free;        // Stack, capacity reserved up front
+        std::vector<Frame*> m_ready;       // Ring of filled frames
+        std::size_t m_head{0};
+        std::size_t m_count{0};
+        bool m_closed{false};
+
+        uint64_t m_nextIndex{0};
+        uint64_t m_dropped{0};
+        uint64_t m_blocked{0};
+    };
+
+} // namespace tfv
+#endif // TFV_FRAME_POOL_HPP
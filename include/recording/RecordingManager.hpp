@@ -1,6 +1,7 @@
 #ifndef TFV_RECORDING_MANAGER_HPP
 #define TFV_RECORDING_MANAGER_HPP
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <memory>
@@ -9,15 +10,29 @@
 #include <thread>
 #include <vector>
 
+#include "recording/EncoderPool.hpp"
+#include "recording/FrameEncoder.hpp"
+#include "recording/FramePool.hpp"
+#include "recording/VideoWriter.hpp"
 #include "rendering/Renderer.hpp"
 
 namespace tfv
 {
-    // Forward declarations
-    struct Surface;
+    /** Where a recording is written */
+    enum class RecordingOutput
+    {
+        VIDEO, // One video file: encoded by ffmpeg when it is on the PATH, else a .y4m stream
+        Y4M,   // One uncompressed YUV4MPEG2 stream, written as frames arrive
+        FRAMES // One image per frame in <path>_frames, in the EncoderOptions format
+    };
 
     /**
-     * Manages the recording and export of video/images from the traffic visualization
+     * Manages the recording and export of video/images from the traffic visualization.
+     *
+     * Captured frames go through a FramePool: a fixed number of buffers allocated when
+     * recording starts, so memory use is bounded by the queue capacity rather than by how far
+     * the writer falls behind. A pool of encoder threads drains it and writes frames in
+     * capture order, either into a single video stream or as numbered images.
      */
     class RecordingManager
     {
@@ -34,7 +49,8 @@ namespace tfv
 
         /**
          * Start recording frames to create a video
-         * @param path Output file path for the video
+         * @param path Output file path for the video (VIDEO without ffmpeg writes the same
+         * path with a .y4m extension)
          * @param fps Frames per second to record
          * @return true if recording started successfully
          */
@@ -56,6 +72,41 @@ namespace tfv
          */
         void captureFrame();
 
+        /**
+         * Number of frame buffers allocated per recording (default 8); applies from the next
+         * startRecording(). Bounds memory at capacity * width * height * 4 bytes.
+         */
+        void setQueueCapacity(std::size_t frames)
+        {
+            m_queueCapacity = std::max<std::size_t>(1, frames);
+        }
+        std::size_t getQueueCapacity() const { return m_queueCapacity; }
+
+        /**
+         * What captureFrame() does when the writer is behind (default DROP)
+         */
+        void setOverflowPolicy(OverflowPolicy policy) { m_policy = policy; }
+        OverflowPolicy getOverflowPolicy() const { return m_policy; }
+
+        /**
+         * Video stream or image directory (default VIDEO); applies from the next
+         * startRecording()
+         */
+        void setOutput(RecordingOutput output) { m_output = output; }
+        RecordingOutput getOutput() const { return m_output; }
+
+        /**
+         * Frame format (FRAMES output only), PNG compression level and encoder thread count;
+         * applies from the next startRecording()
+         */
+        void setEncoderOptions(const EncoderOptions& options) { m_encoderOptions = options; }
+        const EncoderOptions& getEncoderOptions() const { return m_encoderOptions; }
+
+        /**
+         * Counters for the current (or last) recording
+         */
+        FramePoolStats getStats() const;
+
         /**
          * Set a callback for recording status updates
          */
@@ -63,11 +114,8 @@ namespace tfv
         void setStatusCallback(StatusCallback callback) { m_statusCallback = callback; }
 
       private:
-        // Save a surface to a PNG file
-        bool saveSurface(Surface* surface, const std::string& path);
-
-        // Process thread that saves frames to disk
-        void processFrames();
+        // Write encoded bytes to a file
+        static bool writeFile(const std::string& path, std::span<const uint8_t> bytes);
 
         Renderer* m_renderer;
         int m_width;
@@ -75,14 +123,21 @@ namespace tfv
 
         // Video recording state
         std::atomic<bool> m_recording{false};
-        std::atomic<bool> m_threadRunning{false};
         std::string m_outputPath;
         int m_fps{30};
-
-        // Frame queue for video recording
-        std::vector<Surface*> m_frameQueue;
-        std::mutex m_queueMutex;
-        std::thread m_processThread;
+        bool m_sizeWarned{false};
+
+        // Pooled frame buffers and the encoders draining them
+        std::unique_ptr<FramePool> m_pool;
+        std::unique_ptr<EncoderPool> m_encoders;
+        std::size_t m_queueCapacity{8};
+        OverflowPolicy m_policy{OverflowPolicy::DROP};
+        EncoderOptions m_encoderOptions;
+        RecordingOutput m_output{RecordingOutput::VIDEO};
+
+        // Single-file output for VIDEO and Y4M; outlives the encoders that write to it
+        std::unique_ptr<VideoWriter> m_video;
+        std::string m_videoPath;
 
         // Status updates
         StatusCallback m_statusCallback;
@@ -0,0 +1,156 @@
+#ifndef TFV_REPLAY_ENGINE_HPP
+#define TFV_REPLAY_ENGINE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/SimulationState.hpp"
+#include "recording/StateCodec.hpp"
+#include "recording/StateRecorder.hpp"
+#include "utils/MappedFile.hpp"
+
+namespace tfv
+{
+    /**
+     * Plays back a state log written by StateRecorder, with random access by time.
+     *
+     * The log is memory-mapped and its block headers form the keyframe index, so seeking is
+     * a binary search over blocks plus decoding the states of one block up to the target.
+     * While a block is decoded, the decoder is checkpointed every few states; stepping
+     * backwards restores the nearest checkpoint instead of starting over from the keyframe,
+     * which keeps reverse playback smooth. A background thread unpacks (and, for zstd
+     * blocks, decompresses) the next block in the playback direction ahead of use; a block
+     * is unpacked by one thread at a time, and one that asks for it meanwhile waits for that
+     * result.
+     *
+     * The output is the pair of decoded states bracketing the playback clock, ready for
+     * Simulation::publishStates() so every layer renders (and interpolates) a replay
+     * exactly like a live run. States are shared and never modified after they are returned.
+     */
+    class ReplayEngine
+    {
+      public:
+        ReplayEngine() = default;
+        ~ReplayEngine();
+
+        ReplayEngine(const ReplayEngine&) = delete;
+        ReplayEngine& operator=(const ReplayEngine&) = delete;
+
+        /** Map a state log, index its blocks and position playback at its start */
+        bool open(const std::string& path);
+        void close();
+        bool isOpen() const { return !m_blocks.empty(); }
+
+        /** Time range covered by the log (simulation seconds) */
+        double startTime() const;
+        double endTime() const;
+        std::size_t blockCount() const { return m_blocks.size(); }
+
+        /** Move the playback clock to `time` (clamped to the log) and decode around it */
+        bool seek(double time);
+
+        /**
+         * Advance the playback clock by `dt` wall seconds times the speed; stops at either
+         * end of the log
+         */
+        void advance(double dt);
+
+        /** Playback rate: 1 is real time, 0 holds still, negative values play backwards */
+        void setSpeed(double speed) { m_speed = speed; }
+        double speed() const { return m_speed; }
+
+        /** Current playback clock */
+        double time() const { return m_time; }
+
+        /**
+         * Decoded states around the clock: before()->time <= time() <= after()->time (they
+         * are the same state at the ends of the log); null until a log is open
+         */
+        const std::shared_ptr<SimulationState>& before() const { return m_before; }
+        const std::shared_ptr<SimulationState>& after() const { return m_after; }
+
+      private:
+        struct Block
+        {
+            std::size_t offset; // Payload offset in the mapping
+            statelog::BlockHeader header;
+        };
+
+        // A block's decoded payload: into the mapping for raw blocks, owned otherwise
+        struct Payload
+        {
+            std::shared_ptr<const std::vector<uint8_t>> storage;
+            const uint8_t* data{nullptr};
+            std::size_t size{0};
+        };
+
+        // Decoder state from which state `index` is the next one to decode
+        struct Checkpoint
+        {
+            StateDecoder decoder;
+            std::size_t offset;
+        };
+
+        // The next block's keyframe, decoded early as m_after; playback carries on from here
+        // when it enters that block instead of decoding the keyframe again
+        struct Ahead
+        {
+            std::size_t block{SIZE_MAX};
+            std::shared_ptr<SimulationState> state;
+            Payload payload;
+            StateDecoder decoder;
+            std::size_t offset{0};
+        };
+
+        static constexpr uint32_t kCheckpointStride = 16;
+        static constexpr std::size_t kCacheBlocks = 3;
+
+        std::size_t blockFor(double time) const;
+        bool loadBlock(std::size_t block);
+        Payload payload(std::size_t block);
+        std::shared_ptr<SimulationState> decodeNext();
+        std::shared_ptr<SimulationState> rewindTo(uint32_t index);
+        std::shared_ptr<SimulationState> firstStateOf(std::size_t block);
+        bool enterAhead(); // Make m_ahead's block current, with m_after as its first state
+        bool fillAfter();
+        void requestPrefetch();
+        void prefetchLoop();
+
+        MappedFile m_file;
+        std::vector<Block> m_blocks;
+
+        // Playback
+        double m_time{0.0};
+        double m_speed{1.0};
+        std::shared_ptr<SimulationState> m_before, m_after;
+        uint32_t m_beforeIndex{0}; // Index of m_before within the current block
+
+        // Current block; the decoder has consumed states [0, m_next)
+        std::size_t m_block{SIZE_MAX};
+        Payload m_payload;
+        StateDecoder m_decoder;
+        std::size_t m_offset{0};
+        uint32_t m_next{0};
+        std::vector<double> m_times; // Time of each decoded state in the block
+        std::vector<Checkpoint> m_checkpoints;
+        Ahead m_ahead;
+
+        // Background unpacking of the next block in the playback direction
+        std::thread m_prefetchThread;
+        std::mutex m_cacheMutex;
+        std::condition_variable m_prefetchCv;
+        std::condition_variable m_unpackedCv;
+        std::vector<std::pair<std::size_t, Payload>> m_cache; // Most recent last
+        std::vector<std::size_t> m_unpacking;                 // Blocks being unpacked now
+        std::size_t m_prefetchBlock{SIZE_MAX};
+        std::size_t m_requested{SIZE_MAX}; // Last block asked for (playback thread only)
+        bool m_stopPrefetch{false};
+    };
+
+} // namespace tfv
+#endif // TFV_REPLAY_ENGINE_HPP
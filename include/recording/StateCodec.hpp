@@ -0,0 +1,98 @@
+#ifndef TFV_STATE_CODEC_HPP
+#define TFV_STATE_CODEC_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/SimulationState.hpp"
+
+namespace tfv
+{
+    /**
+     * Compact binary encoding of consecutive SimulationStates.
+     *
+     * The first state after reset() is a keyframe holding every vehicle; the rest are deltas
+     * against the previously encoded state, merge-joined by vehicle id:
+     *
+     * - removed and added vehicles (type, length and width are only stored on arrival)
+     * - segment changes, only for vehicles that moved onto another segment
+     * - one position residual per vehicle: the quantised position minus a constant-speed
+     *   prediction from the last two ticks, usually 0 or +-1 and therefore one byte
+     * - velocity deltas in cm/s and changed congestion entries
+     *
+     * Integers are LEB128 varints (signed ones zigzag-encoded), written column by column so
+     * that a general-purpose compressor sees long runs of similar bytes. Positions are kept
+     * to 1/65536 of a segment and velocities to 1 cm/s; accelerations and the derived
+     * x/y/vehicleIndex fields are not stored.
+     */
+    class StateEncoder
+    {
+      public:
+        /** Start over: the next state is written as a keyframe */
+        void reset();
+
+        /** Append one state (vehicles sorted by id, as published) to `out` */
+        void encode(const SimulationState& state, std::vector<uint8_t>& out);
+
+      private:
+        struct Track
+        {
+            uint64_t id;
+            uint32_t segment;
+            int32_t position; // Quantised
+            int32_t step;     // Last position change on the same segment
+            int32_t vx, vy;   // cm/s
+        };
+
+        void writeVehicle(const Vehicle& v, const Track& t, std::vector<uint8_t>& out);
+
+        bool m_key{true};
+        uint64_t m_tick{0};
+        std::vector<Track> m_tracks, m_next;
+        std::vector<uint8_t> m_congestion;
+        std::vector<VehicleType> m_types;
+
+        // Column scratch, kept between calls
+        std::vector<uint8_t> m_removed, m_added, m_segments, m_positions, m_velocities, m_changes;
+    };
+
+    /**
+     * Reads what StateEncoder wrote, one state per call. Vehicles come back sorted by id with
+     * vel and position restored to the recorded precision; x, y and vehicleIndex are left
+     * empty for Simulation::publishStates() to rebuild against its geometry.
+     */
+    class StateDecoder
+    {
+      public:
+        /** Start over: the next record must be a keyframe */
+        void reset();
+
+        /**
+         * Decode the record at `data` into `state`, advancing `data`
+         * @return false on malformed input or a delta without a preceding keyframe; call
+         * reset() before decoding from another position
+         */
+        bool decode(const uint8_t*& data, const uint8_t* end, SimulationState& state);
+
+      private:
+        struct Track
+        {
+            uint32_t segment;
+            int32_t position;
+            int32_t step;
+            int32_t vx, vy;
+            uint32_t type;
+            float length, width;
+        };
+
+        bool m_valid{false};
+        uint64_t m_tick{0};
+        std::vector<uint64_t> m_ids, m_nextIds;
+        std::vector<Track> m_tracks, m_next;
+        std::vector<uint8_t> m_congestion;
+        std::vector<VehicleType> m_types;
+    };
+
+} // namespace tfv
+#endif // TFV_STATE_CODEC_HPP
@@ -0,0 +1,142 @@
+#ifndef TFV_STATE_RECORDER_HPP
+#define TFV_STATE_RECORDER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/SimulationState.hpp"
+#include "recording/StateCodec.hpp"
+
+namespace tfv
+{
+    /**
+     * On-disk layout of a state log (all integers little-endian):
+     *
+     *   file   := "TFVSTATE" u32 version u32 reserved block*
+     *   block  := BlockHeader payload[storedSize]
+     *
+     * Every block starts with a keyframe, so it decodes on its own; the header carries the
+     * tick and time range so a reader can seek without touching the payload.
+     */
+    namespace statelog
+    {
+        inline constexpr char kMagic[8] = {'T', 'F', 'V', 'S', 'T', 'A', 'T', 'E'};
+        inline constexpr uint32_t kVersion = 1;
+        inline constexpr std::size_t kFileHeaderSize = 16;
+        inline constexpr std::size_t kBlockHeaderSize = 48;
+
+        enum class Codec : uint8_t
+        {
+            RAW = 0,
+            ZSTD = 1
+        };
+
+        struct BlockHeader
+        {
+            uint64_t firstTick{0};
+            uint64_t lastTick{0};
+            double firstTime{0.0};
+            double lastTime{0.0};
+            uint32_t stateCount{0};
+            uint32_t rawSize{0};    // Decoded payload size
+            uint32_t storedSize{0}; // Bytes following the header
+            Codec codec{Codec::RAW};
+        };
+
+        /** Serialise a header into kBlockHeaderSize bytes */
+        void writeBlockHeader(const BlockHeader& header, uint8_t* out);
+
+        /** Parse kBlockHeaderSize bytes; false if the fields are inconsistent */
+        bool readBlockHeader(const uint8_t* in, BlockHeader& header);
+
+        /** Whether payloads can be zstd-compressed (written) or decompressed (read) here */
+        bool zstdAvailable();
+
+        /** Decode a block payload into `raw` (rawSize bytes); false on corrupt data */
+        bool unpackBlock(const BlockHeader& header, const uint8_t* payload,
+                         std::vector<uint8_t>& raw);
+    } // namespace statelog
+
+    /** How a state log is written */
+    struct StateRecorderOptions
+    {
+        uint32_t keyframeInterval{256};   // States per block (each block opens with a keyframe)
+        std::size_t blockBytes{32 << 20}; // Also close a block once its raw payload is this big
+        int compressionLevel{3};          // zstd level; 0 stores blocks uncompressed
+        std::size_t queueCapacity{64};    // States waiting for the writer before drops
+    };
+
+    /** Counters for the current (or last) state log */
+    struct StateRecorderStats
+    {
+        uint64_t recorded{0}; // States encoded
+        uint64_t dropped{0};  // States skipped because the queue was full
+        uint64_t blocks{0};
+        uint64_t rawBytes{0};    // Encoded size before compression
+        uint64_t storedBytes{0}; // Bytes written to disk, headers included
+    };
+
+    /**
+     * Records published simulation states to a compact binary log instead of pixels, so any
+     * time range can be re-rendered later at any resolution.
+     *
+     * record() only queues the shared state pointer (states are immutable once published),
+     * so the simulation thread pays a lock and a push per tick. A writer thread delta-encodes
+     * each state against the previous one with StateEncoder, groups them into blocks and
+     * compresses full blocks with zstd when available (TFV_HAS_ZSTD).
+     */
+    class StateRecorder
+    {
+      public:
+        StateRecorder() = default;
+        ~StateRecorder();
+
+        StateRecorder(const StateRecorder&) = delete;
+        StateRecorder& operator=(const StateRecorder&) = delete;
+
+        /** Create `path` and start the writer; false if already recording or on I/O error */
+        bool start(const std::string& path, const StateRecorderOptions& options = {});
+
+        /** Queue a published state; dropped and counted if the writer is too far behind */
+        void record(SimulationStatePtr state);
+
+        /** Drain the queue, write the last block and close the file */
+        bool stop();
+
+        bool isRecording() const { return m_recording; }
+        StateRecorderStats stats() const;
+
+      private:
+        void run();
+        bool flushBlock();
+
+        StateRecorderOptions m_options;
+        std::FILE* m_file{nullptr};
+        std::thread m_thread;
+        std::atomic<bool> m_recording{false};
+
+        // Hand-off from the simulation thread
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<SimulationStatePtr> m_queue;
+        bool m_closing{false};
+
+        // Writer thread only
+        StateEncoder m_encoder;
+        std::vector<uint8_t> m_block, m_packed;
+        statelog::BlockHeader m_header;
+        bool m_failed{false};
+
+        // Written by the writer, read by stats() (guarded by m_mutex)
+        StateRecorderStats m_stats;
+    };
+
+} // namespace tfv
+#endif // TFV_STATE_RECORDER_HPP
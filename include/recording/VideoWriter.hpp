@@ -0,0 +1,75 @@
+#ifndef TFV_VIDEO_WRITER_HPP
+#define TFV_VIDEO_WRITER_HPP
+
+#include "recording/FramePool.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tfv
+{
+    /**
+     * Convert an ARGB8888 frame to planar YUV 4:2:0 (BT.601, limited range).
+     *
+     * Chroma is the average of each 2x2 block (centre-sited, edges replicated for odd sizes).
+     * Uses SSE2 for 8-pixel spans when the target has it; the scalar path gives identical
+     * results. Plane sizes: width*height for `y`, ((width+1)/2)*((height+1)/2) for `u`, `v`.
+     */
+    void rgbToYuv420(const Frame& frame, uint8_t* y, uint8_t* u, uint8_t* v);
+
+    /**
+     * Encode one frame as a YUV4MPEG2 frame record ("FRAME\n" plus the three planes) into
+     * `out` (cleared first; capacity is kept for the next frame)
+     */
+    bool encodeY4mFrame(const Frame& frame, std::vector<uint8_t>& out);
+
+    /**
+     * A single YUV4MPEG2 stream written incrementally: to a .y4m file, or into the stdin of a
+     * local ffmpeg process that encodes it straight to the final video.
+     *
+     * Frame records come from encodeY4mFrame(); write() must be called in frame order and
+     * from one thread at a time (EncoderPool guarantees both).
+     */
+    class VideoWriter
+    {
+      public:
+        VideoWriter() = default;
+        ~VideoWriter();
+
+        VideoWriter(const VideoWriter&) = delete;
+        VideoWriter& operator=(const VideoWriter&) = delete;
+
+        /** Whether an executable ffmpeg is on the PATH */
+        static bool encoderAvailable();
+
+        /** Create `path` and write the stream header */
+        bool openFile(const std::string& path, int width, int height, int fps);
+
+        /** Start ffmpeg encoding to `path` (container from its extension) and feed it */
+        bool openPipe(const std::string& path, int width, int height, int fps);
+
+        /** Append one frame record */
+        bool write(std::span<const uint8_t> bytes);
+
+        /**
+         * Flush and close; for a pipe this waits for the encoder to finish the file
+         * @return false if a write failed or the encoder exited with an error
+         */
+        bool close();
+
+        bool isOpen() const { return m_file != nullptr; }
+        bool isPipe() const { return m_pipe; }
+
+      private:
+        bool writeHeader(int width, int height, int fps);
+
+        std::FILE* m_file{nullptr};
+        bool m_pipe{false};
+        bool m_failed{false};
+    };
+
+} // namespace tfv
+#endif // TFV_VIDEO_WRITER_HPP
@@ -0,0 +1,112 @@
+#ifndef TFV_CAMERA_HPP
+#define TFV_CAMERA_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+namespace tfv
+{
+    /**
+     * Precomputed 2D affine map from a float coordinate frame to screen pixels:
+     *   screen = M * (p - pivot) + t
+     *
+     * The pivot is the camera centre expressed in the source frame, so the subtraction
+     * happens on nearby floats and stays exact; the large world offset never reaches float.
+     */
+    struct ViewTransform
+    {
+        float pivotX{0.f}, pivotY{0.f}; // Camera centre in the source frame
+        float a{1.f}, b{0.f};           // Linear part, row 0
+        float c{0.f}, d{1.f};           // Linear part, row 1
+        float tx{0.f}, ty{0.f};         // Screen position of the pivot
+
+        /** Pixels per source unit (uniform part of the linear map) */
+        float scale() const { return std::sqrt(std::abs(a * d - b * c)); }
+
+        void apply(float x, float y, float& sx, float& sy) const
+        {
+            const float dx = x - pivotX, dy = y - pivotY;
+            sx = a * dx + b * dy + tx;
+            sy = c * dx + d * dy + ty;
+        }
+
+        /** Linear part only, for directions and offsets */
+        void applyVector(float x, float y, float& sx, float& sy) const
+        {
+            sx = a * x + b * y;
+            sy = c * x + d * y;
+        }
+
+        /**
+         * Batched apply() over structure-of-arrays input. Branch-free with no aliasing, so
+         * the loop vectorises (4-8 points per instruction).
+         */
+        void apply(const float* x, const float* y, std::size_t count, float* outX,
+                   float* outY) const;
+    };
+
+    /** Round a screen coordinate to the nearest pixel */
+    inline int toPixel(float v)
+    {
+        return static_cast<int>(std::floor(v + 0.5f));
+    }
+
+    /**
+     * Clip a screen-space segment to [-margin, width + margin] x [-margin, height + margin]
+     * (Liang-Barsky). Keeps far-off end points at deep zoom out of integer pixel range.
+     * @return false if the segment lies entirely outside
+     */
+    bool clipToViewport(float& x1, float& y1, float& x2, float& y2, int width, int height,
+                        float margin);
+
+    /**
+     * 2D view onto double-precision world coordinates (metres, projected map units, ...).
+     *
+     * The camera stores its centre in world units and a zoom in pixels per world unit; pan
+     * and zoom never round. Geometry is stored in float relative to a local origin, and
+     * transform() hands renderers a camera-relative float matrix for that origin.
+     */
+    class Camera
+    {
+      public:
+        static constexpr double kMinZoom = 1e-6;
+        static constexpr double kMaxZoom = 1e6;
+
+        /** Viewport size in pixels; the camera centre stays at the viewport centre */
+        void setViewport(int width, int height);
+        int viewportWidth() const { return m_width; }
+        int viewportHeight() const { return m_height; }
+
+        void setCenter(double x, double y) { m_center = {x, y}; }
+        glm::dvec2 center() const { return m_center; }
+
+        void setZoom(double zoom);
+        double zoom() const { return m_zoom; }
+
+        /** Move the view so the scene shifts by (dx, dy) pixels on screen */
+        void pan(double dx, double dy);
+
+        /** Scale the zoom by `factor`, keeping the world point under a screen point fixed */
+        void zoomAt(double factor, double screenX, double screenY);
+
+        /** Centre on a world rect and zoom so it fills the viewport, less a margin in pixels */
+        void fit(double minX, double minY, double maxX, double maxY, double margin = 20.0);
+
+        glm::dvec2 worldToScreen(glm::dvec2 world) const;
+        glm::dvec2 screenToWorld(glm::dvec2 screen) const;
+
+        /** World rect covered by the viewport */
+        void visibleBounds(double& minX, double& minY, double& maxX, double& maxY) const;
+
+        /** Transform for float coordinates stored relative to (originX, originY) */
+        ViewTransform transform(double originX, double originY) const;
+
+      private:
+        glm::dvec2 m_center{0.0, 0.0};
+        double m_zoom{1.0};
+        int m_width{0}, m_height{0};
+    };
+
+} // namespace tfv
+#endif // TFV_CAMERA_HPP
@@ -0,0 +1,105 @@
+#ifndef TFV_COMMAND_BUFFER_HPP
+#define TFV_COMMAND_BUFFER_HPP
+
+#include "rendering/Renderer.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tfv
+{
+    // Work run on the render thread against the real backend (e.g. submitting ImGui draw data)
+    using RenderCallback = void (*)(void* user, Renderer* backend);
+
+    enum class CommandType : uint8_t
+    {
+        CLEAR,
+        LINES,      // Batch of line segments sharing colour and width
+        POINTS,     // Batch of points
+        FILL_RECTS, // Batch of filled quads
+        DRAW_RECTS, // Batch of rect outlines
+        TEXT,       // Text run
+        CREATE_TEXTURE,
+        UPDATE_TEXTURE,
+        DRAW_TEXTURE,  // Texture blit
+        TEXTURE_QUADS, // Batch of tinted texture regions (glyph runs)
+        DESTROY_TEXTURE,
+        SET_ANTI_ALIASING,
+        CALLBACK
+    };
+
+    /**
+     * One recorded draw command. Plain data: variable-sized payloads (coordinates, text,
+     * pixels) live in the owning buffer's arenas and are referenced by offset/count.
+     */
+    struct Command
+    {
+        CommandType type;
+        uint8_t r, g, b, a;     // Draw colour
+        int32_t x, y, w, h;     // Position/size; w is the line width for LINES
+        TextureHandle texture;  // Recorder-side texture handle
+        uint32_t offset, count; // Payload range
+    };
+
+    /**
+     * Compact list of draw commands for one frame.
+     *
+     * Consecutive lines, points and rects with the same state are merged into one batch
+     * command. Storage is reused between frames, so recording does not allocate once the
+     * buffers have grown to their working size.
+     */
+    class CommandBuffer
+    {
+      public:
+        // Maps recorder-side texture handles to backend handles during replay
+        using TextureMap = std::unordered_map<TextureHandle, TextureHandle>;
+
+        void clear();
+        bool empty() const { return m_commands.empty(); }
+
+        // Recording
+        void setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+        void clearTarget(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+        void line(int x1, int y1, int x2, int y2, int width);
+        void point(int x, int y);
+        void rect(int x, int y, int w, int h, bool filled);
+        void text(std::string_view text, int x, int y);
+        void createTexture(TextureHandle texture, int width, int height);
+        void updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch, int width,
+                           int height);
+        void drawTexture(TextureHandle texture, int x, int y, int w, int h);
+        void textureQuads(TextureHandle texture, std::span<const TexturedQuad> quads);
+        void destroyTexture(TextureHandle texture);
+        void setAntiAliasing(bool enable);
+        void callback(RenderCallback fn, void* user);
+
+        /** Execute every command against a backend renderer, in recording order. */
+        void replay(Renderer& target, TextureMap& textures) const;
+
+        std::size_t commandCount() const { return m_commands.size(); }
+
+      private:
+        struct Callback
+        {
+            RenderCallback fn;
+            void* user;
+        };
+
+        Command& push(CommandType type);
+        // Extend the last command if it is a batch of the same kind and state
+        Command& batch(CommandType type, int width);
+
+        std::vector<Command> m_commands;
+        std::vector<int32_t> m_coords;     // LINES/POINTS/RECTS payloads
+        std::vector<char> m_text;          // TEXT payloads
+        std::vector<uint32_t> m_pixels;    // UPDATE_TEXTURE payloads (tightly packed rows)
+        std::vector<TexturedQuad> m_quads; // TEXTURE_QUADS payloads
+        std::vector<Callback> m_callbacks;
+        uint8_t m_r{255}, m_g{255}, m_b{255}, m_a{255};
+    };
+
+} // namespace tfv
+#endif // TFV_COMMAND_BUFFER_HPP
@@ -0,0 +1,107 @@
+#ifndef TFV_DENSITY_HEATMAP_RENDERER_HPP
+#define TFV_DENSITY_HEATMAP_RENDERER_HPP
+
+#include "core/RoadNetwork.hpp"
+#include "core/SimulationState.hpp"
+#include "rendering/Camera.hpp"
+#include "rendering/Renderer.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace tfv
+{
+    /**
+     * Area-level vehicle density heatmap (kernel density estimate).
+     *
+     * Vehicles are binned into a coarse grid over the network bounds; the grid is kept up to
+     * date incrementally (only vehicles that changed cell touch it), smoothed with a separable
+     * Gaussian and colour-mapped into a streaming texture drawn over the map.
+     */
+    class DensityHeatmapRenderer
+    {
+      public:
+        explicit DensityHeatmapRenderer(Renderer* renderer);
+        ~DensityHeatmapRenderer();
+
+        /**
+         * Bring the density grid up to date with a published state
+         * @param roadNetwork Network the vehicles move on
+         * @param state Latest published state
+         * @param scale Zoom scale; grid resolution follows it
+         */
+        void update(const RoadNetwork* roadNetwork, const SimulationState& state, float scale);
+
+        /**
+         * Draw the density texture
+         * @param view Camera transform for the network's local frame
+         */
+        void draw(const ViewTransform& view);
+
+        /**
+         * Colour ramp, packed 0xAARRGGBB (see HeatmapRenderer::lut())
+         */
+        void setLut(const std::vector<uint32_t>& lut);
+
+        /**
+         * Set heatmap opacity (0.0-1.0)
+         */
+        void setOpacity(float opacity);
+
+        /**
+         * Set kernel standard deviation in grid cells
+         */
+        void setKernelSigma(float cells);
+
+        /**
+         * Set target cell size on screen in pixels (grid resolution follows zoom)
+         */
+        void setCellSize(float pixels);
+
+      private:
+        // Recreate the grid for new bounds/resolution; returns true if it changed
+        bool configureGrid(const RoadNetwork* roadNetwork, float scale);
+        void rebuildKernel();
+        void blur();
+        void colorize();
+
+        Renderer* m_renderer;
+        TextureHandle m_texture{0};
+        int m_textureW{0}, m_textureH{0};
+
+        // Grid placement in the network's local frame
+        const RoadNetwork* m_network{nullptr};
+        std::size_t m_networkSegments{0};
+        float m_minX{0.f}, m_minY{0.f}, m_maxX{0.f}, m_maxY{0.f}; // Network bounds
+        float m_originX{0.f}, m_originY{0.f};
+        float m_cellSize{0.f}; // World units per cell (power of two)
+        int m_gridW{0}, m_gridH{0};
+
+        // Vehicle counts per cell and the cell each vehicle was counted in (sorted by id)
+        std::vector<float> m_counts;
+        std::vector<uint64_t> m_ids;
+        std::vector<int32_t> m_cells;
+        uint64_t m_lastTick{~0ull};
+        bool m_dirty{false};
+
+        // Smoothing and output buffers
+        std::vector<float> m_kernel;
+        std::vector<float> m_tmp;
+        std::vector<float> m_density;
+        std::vector<uint32_t> m_pixels;
+        std::vector<uint32_t> m_lut;
+
+        // Scratch for batched position lookup
+        std::vector<uint32_t> m_segIdx;
+        std::vector<float> m_t, m_x, m_y;
+        std::vector<uint64_t> m_newIds;
+        std::vector<int32_t> m_newCells;
+
+        float m_opacity{0.7f};
+        float m_sigma{1.5f};
+        float m_cellPixels{8.f};
+        static constexpr int kMaxGridDim = 512;
+    };
+} // namespace tfv
+
+#endif // TFV_DENSITY_HEATMAP_RENDERER_HPP
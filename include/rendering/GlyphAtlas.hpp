@@ -0,0 +1,141 @@
+#ifndef TFV_GLYPH_ATLAS_HPP
+#define TFV_GLYPH_ATLAS_HPP
+
+#include "rendering/Renderer.hpp"
+#include <SDL2/SDL_ttf.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tfv
+{
+    /**
+     * Keeps SDL_ttf initialised while it lives. Every user of SDL_ttf holds one, so
+     * TTF_Init() runs for the first holder and TTF_Quit() after the last, from any thread.
+     */
+    class TtfLibrary
+    {
+      public:
+        TtfLibrary();
+        ~TtfLibrary();
+
+        TtfLibrary(const TtfLibrary&) = delete;
+        TtfLibrary& operator=(const TtfLibrary&) = delete;
+
+        /** Whether SDL_ttf is usable */
+        bool ready() const { return m_ready; }
+
+      private:
+        bool m_ready{false};
+    };
+
+    /** Placement of one cached glyph */
+    struct Glyph
+    {
+        int16_t x, y, w, h;       // Region in the atlas texture (empty for blank glyphs)
+        int16_t offsetX, offsetY; // Region origin relative to the pen at the line top
+        int16_t advance;          // Pen advance in pixels
+    };
+
+    /**
+     * Texture cache of rasterised glyphs, keyed by font, size and codepoint.
+     *
+     * Glyphs are rendered once with SDL_ttf (white, coverage in alpha), trimmed and packed
+     * into shelves of a single texture, so any amount of text can be drawn as tinted quads
+     * from one texture. Newly rasterised glyphs are uploaded by upload(). When the texture
+     * is full, the cache is emptied at the start of the next frame and refilled on demand.
+     */
+    class GlyphAtlas
+    {
+      public:
+        static constexpr int kInvalidFont = -1;
+
+        /**
+         * @param renderer Renderer that owns the atlas texture
+         * @param size Width and height of the atlas texture in pixels
+         */
+        explicit GlyphAtlas(Renderer* renderer, int size = 1024);
+        ~GlyphAtlas();
+
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        /** Open a font at a pixel size (reused if already open); kInvalidFont on failure */
+        int loadFont(const std::string& path, int pointSize);
+
+        /** First available font from the platform search list */
+        int loadDefaultFont(int pointSize);
+
+        /** Cached glyph, rasterised on first use; null while the atlas is full */
+        const Glyph* glyph(int font, char32_t codepoint);
+
+        /** Distance between baselines of consecutive lines */
+        int lineHeight(int font) const;
+
+        /** Call once per frame before laying out text; empties the cache if it overflowed */
+        void beginFrame();
+
+        /** Push glyphs rasterised since the last upload to the texture */
+        void upload();
+
+        TextureHandle texture() const { return m_texture; }
+        std::size_t glyphCount() const { return m_glyphs.size(); }
+
+      private:
+        struct Font
+        {
+            std::string path;
+            int pointSize;
+            TTF_Font* handle;
+        };
+
+        bool rasterize(const Font& font, char32_t codepoint, Glyph& out);
+        void reset();
+
+        Renderer* m_renderer;
+        int m_size;
+        TextureHandle m_texture{0};
+        std::vector<uint32_t> m_pixels; // CPU copy of the texture (0xAARRGGBB)
+        bool m_dirty{false};
+        bool m_overflow{false};
+        TtfLibrary m_ttf;
+
+        std::vector<Font> m_fonts;
+        std::unordered_map<uint64_t, Glyph> m_glyphs; // (font << 32 | codepoint) -> glyph
+
+        // Shelf packer: glyphs fill rows left to right, a new row starts below the tallest
+        int m_shelfX{0}, m_shelfY{0}, m_shelfHeight{0};
+    };
+
+    /**
+     * Text runs laid out into tinted quads sharing one atlas texture, so a frame's worth of
+     * labels is drawn with a single Renderer::drawTextureQuads() call.
+     */
+    class TextBatch
+    {
+      public:
+        explicit TextBatch(GlyphAtlas& atlas) : m_atlas(atlas) {}
+
+        void clear() { m_quads.clear(); }
+        bool empty() const { return m_quads.empty(); }
+        std::size_t quadCount() const { return m_quads.size(); }
+
+        /** Width of a UTF-8 run in pixels (rasterises missing glyphs) */
+        int measure(int font, std::string_view text);
+
+        /** Lay out a UTF-8 run with its top-left corner at (x, y); returns its width */
+        int add(int font, std::string_view text, int x, int y, uint32_t color);
+
+        /** Upload new glyphs and draw every queued quad */
+        void draw(Renderer& renderer);
+
+      private:
+        GlyphAtlas& m_atlas;
+        std::vector<TexturedQuad> m_quads;
+    };
+
+} // namespace tfv
+#endif // TFV_GLYPH_ATLAS_HPP
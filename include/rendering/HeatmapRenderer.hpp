@@ -3,8 +3,12 @@
 
 #include "core/RoadNetwork.hpp"
 #include "core/Simulation.hpp"
+#include "rendering/Camera.hpp"
 #include "rendering/Renderer.hpp"
 
+#include <span>
+#include <vector>
+
 namespace tfv
 {
     // Renderer-agnostic color structure
@@ -27,16 +31,15 @@ namespace tfv
         explicit HeatmapRenderer(Renderer* renderer);
 
         /**
-         * Draw heatmap overlay on the road network
+         * Draw heatmap overlay on the road network. Every segment with an entry in
+         * `congestion` is drawn, one with no traffic in the low colour; segments past its end
+         * (a state from a smaller network) are not drawn.
          * @param roadNetwork The road network to visualize
-         * @param congestionLevels Map of segment IDs to congestion levels (0.0-1.0)
-         * @param panX X pan offset
-         * @param panY Y pan offset
-         * @param scale Zoom scale
+         * @param congestion Congestion levels (0.0-1.0) in RoadNetwork::segments() order
+         * @param view Camera transform for the network's local frame
          */
-        void draw(const RoadNetwork* roadNetwork,
-                  const std::unordered_map<uint32_t, float>& congestionLevels, int panX, int panY,
-                  float scale);
+        void draw(const RoadNetwork* roadNetwork, std::span<const float> congestion,
+                  const ViewTransform& view);
 
         /**
          * Set the color scheme for the heatmap
@@ -47,6 +50,21 @@ namespace tfv
         void setColorScheme(const Color& lowColor, const Color& mediumColor,
                             const Color& highColor);
 
+        /**
+         * Set the number of entries in the colour lookup table (default 256)
+         */
+        void setLutSize(std::size_t entries);
+
+        /**
+         * Map congestion levels to packed 0xAARRGGBB colours through the lookup table
+         * @param levels Congestion levels (clamped to 0.0-1.0)
+         * @param out Destination, at least levels.size() entries
+         */
+        void mapColors(std::span<const float> levels, uint32_t* out) const;
+
+        /** Colour lookup table, packed 0xAARRGGBB (alpha 255) */
+        const std::vector<uint32_t>& lut() const { return m_lut; }
+
         /**
          * Set heatmap opacity (0.0-1.0)
          */
@@ -65,10 +83,23 @@ namespace tfv
         float m_opacity{0.7f};
         float m_lineWidthFactor{0.8f};
 
+        // Precomputed colour ramp, rebuilt when the scheme or size changes
+        std::vector<uint32_t> m_lut;
+        std::size_t m_lutSize{256};
+
+        // Per-frame colour and screen position buffers, kept to reuse their capacity
+        std::vector<uint32_t> m_colors;
+        std::vector<float> m_x1, m_y1, m_x2, m_y2;
+
         /**
          * Interpolate between colors based on congestion level
          */
         Color getColorForCongestion(float level) const;
+
+        /**
+         * Rebuild the lookup table from the current colour scheme
+         */
+        void rebuildLut();
     };
 } // namespace tfv
 
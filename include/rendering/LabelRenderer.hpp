@@ -0,0 +1,68 @@
+#ifndef TFV_LABEL_RENDERER_HPP
+#define TFV_LABEL_RENDERER_HPP
+
+#include "core/RoadNetwork.hpp"
+#include "core/SimulationState.hpp"
+#include "rendering/GlyphAtlas.hpp"
+#include "rendering/SceneRenderer.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace tfv
+{
+    /**
+     * Segment and vehicle text labels.
+     *
+     * Segments are culled to the viewport through the network's spatial index; labels that
+     * would overlap one already placed are dropped using a coarse screen-space occupancy grid.
+     * Every accepted label goes into one TextBatch, so the whole set costs a single
+     * drawTextureQuads() call (plus an atlas upload when new glyphs appear).
+     */
+    class LabelRenderer
+    {
+      public:
+        explicit LabelRenderer(Renderer* renderer);
+
+        /**
+         * Lay out and draw labels for the current view.
+         * @param state Latest published state (null: segment ids only)
+         * @param vehicles Screen positions from this frame's vehicle pass
+         * @param camera View the scene was drawn with
+         */
+        void draw(const RoadNetwork* net, const SimulationState* state,
+                  const VehicleBatch& vehicles, const Camera& camera);
+
+        void setSegmentLabels(bool enable) { m_segmentLabels = enable; }
+        void setVehicleLabels(bool enable) { m_vehicleLabels = enable; }
+
+      private:
+        /** Claim the occupancy cells under a screen rect; false if any is taken */
+        bool reserve(int x, int y, int w, int h);
+
+        void drawSegmentLabels(const RoadNetwork& net, const SimulationState* state,
+                               const Camera& camera);
+        void drawVehicleLabels(const SimulationState& state, const VehicleBatch& vehicles);
+
+        static constexpr int kCellSize = 8;             // Occupancy grid cell (pixels)
+        static constexpr std::size_t kMaxLabels = 4096; // Per frame, after culling
+        static constexpr float kMinVehicleScale = 2.f;  // Vehicle labels only once arrows show
+
+        Renderer* m_r;
+        GlyphAtlas m_atlas;
+        TextBatch m_text;
+        int m_font{GlyphAtlas::kInvalidFont};
+        bool m_segmentLabels{true};
+        bool m_vehicleLabels{true};
+
+        // Per-frame scratch, kept to reuse capacity
+        int m_viewW{0}, m_viewH{0};
+        ViewTransform m_view;
+        int m_cols{0}, m_rows{0};
+        std::vector<uint8_t> m_occupied;
+        std::vector<uint32_t> m_visible;
+        std::size_t m_labelCount{0};
+    };
+
+} // namespace tfv
+#endif // TFV_LABEL_RENDERER_HPP
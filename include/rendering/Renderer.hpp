@@ -3,16 +3,31 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 
 namespace tfv
 {
+    // Opaque handle to a renderer-owned texture (0 = invalid)
+    using TextureHandle = uint32_t;
+
+    // One textured quad: destination rect in pixels, source rect in texels, and a tint
+    // (0xAARRGGBB) that the texels are multiplied by
+    struct TexturedQuad
+    {
+        int x, y, w, h;
+        int srcX, srcY, srcW, srcH;
+        uint32_t color;
+    };
+
     // Abstract rendering interface, templated on the backend type and window type
     class Renderer
     {
       public:
-        // Factory method to create a renderer instance with a specific type
-        static std::unique_ptr<Renderer> create(const std::string& type, void* window);
+        // Factory method to create a renderer instance with a specific type.
+        // Windowless backends ("Software") take their framebuffer size from width/height.
+        static std::unique_ptr<Renderer> create(const std::string& type, void* window,
+                                                int width = 0, int height = 0);
 
         // Constructor and destructor
         Renderer() = default;                          // Default constructor
@@ -38,6 +53,22 @@ namespace tfv
         virtual void fillRect(int x, int y, int w, int h) = 0;
         virtual void drawText(const std::string& text, int x, int y) = 0;
 
+        // Streaming textures; pixels are packed 0xAARRGGBB, blended when drawn
+        virtual TextureHandle createTexture(int width, int height) = 0;
+        virtual void updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch) = 0;
+        virtual void drawTexture(TextureHandle texture, int x, int y, int w, int h) = 0;
+        virtual void destroyTexture(TextureHandle texture) = 0;
+
+        // Draw many tinted regions of one texture in a single call (glyph runs, sprites)
+        virtual void drawTextureQuads(TextureHandle texture,
+                                      std::span<const TexturedQuad> quads) = 0;
+
+        // Copy the last presented frame as packed 0xAARRGGBB rows (getWindowSize() pixels)
+        virtual bool readPixels(uint32_t* pixels, int pitch) = 0;
+
+        // Sync presents to the display refresh (ignored by backends without a display)
+        virtual void setVSync(bool enable) = 0;
+
         // Control anti-aliasing for renderers that support it
         virtual void setAntiAliasing(bool enable) = 0;
 
@@ -5,16 +5,27 @@
 
 #include "core/RoadNetwork.hpp"
 #include "core/Simulation.hpp"
+#include "rendering/Camera.hpp"
 #include "rendering/Renderer.hpp"
 
+#include <memory>
+
 namespace tfv
 {
+    class LabelRenderer;
+
+    /** Screen-space segment end points, reused across frames by RoadRenderer. */
+    struct RoadBatch
+    {
+        std::vector<float> x1, y1;
+        std::vector<float> x2, y2;
+    };
 
     class RoadRenderer
     {
       public:
-        RoadRenderer(Renderer* renderer, int panX, int panY, float scale, bool antiAliasing = false)
-            : m_r(renderer), m_panX(panX), m_panY(panY), m_scale(scale), roadWidth{10.f},
+        RoadRenderer(Renderer* renderer, const ViewTransform& view, bool antiAliasing = false)
+            : m_r(renderer), m_view(view), m_scale(view.scale()), roadWidth{10.f},
               dashed{false}, m_antiAliasing{antiAliasing}
         {
             // Apply anti-aliasing setting to the renderer
@@ -23,12 +34,12 @@ namespace tfv
                 m_r->setAntiAliasing(antiAliasing);
             }
         }
-        void draw(const RoadNetwork* net);
+        void draw(const RoadNetwork* net, RoadBatch& batch);
         void setAntiAliasing(bool enable) { m_antiAliasing = enable; }
 
       private:
         Renderer* m_r;
-        int m_panX, m_panY;
+        ViewTransform m_view;
         float m_scale;
         float roadWidth{10.f};
         bool dashed{false};
@@ -36,17 +47,54 @@ namespace tfv
         void drawDashedLine(int x1, int y1, int x2, int y2);
     };
 
+    /** Objects under a screen point: nearest vehicle and/or nearest segment */
+    struct PickResult
+    {
+        bool hasVehicle{false};
+        uint64_t vehicleId{0};
+        uint32_t segment{SegmentGeometry::kInvalidIndex}; // Dense segment index
+
+        bool hasSegment() const { return segment != SegmentGeometry::kInvalidIndex; }
+        bool empty() const { return !hasVehicle && !hasSegment(); }
+    };
+
+    /** Scratch buffers reused across frames by VehicleRenderer (avoids per-frame allocation). */
+    struct VehicleBatch
+    {
+        std::vector<uint32_t> vehicle; // Index into SimulationState::vehicles
+        std::vector<uint32_t> segment; // Dense segment index per vehicle
+        std::vector<float> t;          // Normalized offset along that segment
+        std::vector<float> x, y;       // Position in the geometry's local frame
+        std::vector<float> sx, sy;     // Screen position
+
+        void clear()
+        {
+            vehicle.clear();
+            segment.clear();
+            t.clear();
+        }
+    };
+
     class VehicleRenderer
     {
       public:
-        VehicleRenderer(Renderer* renderer, int panX, int panY, float scale,
-                        bool antiAliasing = false);
-        void draw(const VehicleMap& vehicles, const RoadNetwork* net);
+        VehicleRenderer(Renderer* renderer, const ViewTransform& view, bool antiAliasing = false);
+
+        /**
+         * Draw vehicles interpolated between two published states.
+         * @param renderTime Simulation time to display; clamped to [previous.time, current.time]
+         */
+        void draw(const SimulationState& previous, const SimulationState& current,
+                  double renderTime, const RoadNetwork* net, VehicleBatch& batch);
         void setAntiAliasing(bool enable) { m_antiAliasing = enable; }
 
       private:
+        /** Segment index and offset of a vehicle blended between two ticks. */
+        static bool interpolate(const Vehicle* prev, const Vehicle& cur, float alpha,
+                                const SegmentGeometry& geom, uint32_t& segment, float& t);
+
         Renderer* m_r;
-        int m_panX, m_panY;
+        ViewTransform m_view;
         float m_scale;
         bool m_antiAliasing{false};
     };
@@ -55,22 +103,23 @@ namespace tfv
     class SceneRenderer
     {
       public:
-        explicit SceneRenderer(Renderer* r) : m_r(r) {}
-
-        /** Supply road network (can be nullptr). */
-        void setNetwork(const RoadNetwork* net) { m_net = net; }
+        explicit SceneRenderer(Renderer* r);
+        ~SceneRenderer();
 
-        /** Set zoom scale (1.0 = 100%). */
-        void setZoom(float scale) { m_scale = scale; }
-        /** Set pan offset in pixels. */
-        void setPan(int dx, int dy)
+        /** Supply road network (can be nullptr); the camera frames it on the next draw. */
+        void setNetwork(const RoadNetwork* net)
         {
-            m_panX = dx;
-            m_panY = dy;
+            m_net = net;
+            m_cameraFitted = false;
         }
 
-        /** Draw roads first, then vehicles. */
-        void draw(const VehicleMap& vehicles);
+        /** View onto the world; pan and zoom go through here. */
+        Camera& camera() { return m_camera; }
+        const Camera& camera() const { return m_camera; }
+
+        /** Draw roads first, then vehicles blended between two published states, then labels. */
+        void draw(const SimulationStatePtr& previous, const SimulationStatePtr& current,
+                  double renderTime);
 
         /** Update method for animations */
         void update(double dt);
@@ -88,22 +137,52 @@ namespace tfv
             }
         }
 
-        float getZoom() const { return m_scale; }
-        int getPanX() const { return m_panX; }
-        int getPanY() const { return m_panY; }
+        /**
+         * Vehicle closest to a point in the geometry's local frame, within maxDistance, as it
+         * was drawn by the last draw() (interpolated between ticks); the segment it was drawn
+         * on comes with it. Empty if none.
+         */
+        PickResult pickVehicle(float x, float y, float maxDistance) const;
+
+        /** Outline the selected and hovered objects on top of the scene */
+        void setSelection(const PickResult& selection) { m_selection = selection; }
+        void setHover(const PickResult& hover) { m_hover = hover; }
+
+        /** Segment and vehicle text labels (glyph atlas is created on first use) */
+        void setLabelsEnabled(bool enable) { m_labelsEnabled = enable; }
+        bool getLabelsEnabled() const { return m_labelsEnabled; }
+
         bool getAntiAliasing() const { return m_antiAliasing; }
         const RoadNetwork* getNetwork() const { return m_net; }
 
       private:
+        void drawHighlight(const PickResult& pick, const SimulationState* current, uint8_t r,
+                           uint8_t g, uint8_t b, uint8_t a);
+
+        /** Match the camera to the window and frame a newly set network */
+        void updateCamera();
+
         Renderer* m_r;
         const RoadNetwork* m_net{nullptr};
-        float m_scale{1.0f};
-        int m_panX{0};
-        int m_panY{0};
+        Camera m_camera;
+        ViewTransform m_view; // Camera transform for the network's local frame, this frame
+        bool m_cameraFitted{false};
         bool m_antiAliasing{true};
 
-        // Store the last simulation snapshot
-        VehicleMap m_lastSnapshot;
+        // Per-frame road and vehicle buffers, kept to reuse their capacity
+        RoadBatch m_roadBatch;
+        VehicleBatch m_vehicleBatch;
+
+        PickResult m_selection;
+        PickResult m_hover;
+
+        bool m_labelsEnabled{false};
+        std::unique_ptr<LabelRenderer> m_labels;
+
+        // Last published states and render timestamp
+        SimulationStatePtr m_previous;
+        SimulationStatePtr m_current;
+        double m_renderTime{0.0};
     };
 
 } // namespace tfv
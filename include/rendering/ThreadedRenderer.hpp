@@ -0,0 +1,117 @@
+#ifndef TFV_THREADED_RENDERER_HPP
+#define TFV_THREADED_RENDERER_HPP
+
+#include "rendering/CommandBuffer.hpp"
+#include "rendering/Renderer.hpp"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace tfv
+{
+    /**
+     * Renderer that records draw calls into a CommandBuffer and replays them on a dedicated
+     * render thread against a backend renderer.
+     *
+     * Two buffers are used: while the render thread replays and presents frame N, layers record
+     * frame N+1 on the main thread. present() hands the recorded buffer over, waiting only if
+     * the previous frame is still being replayed. The backend is initialised, used and shut
+     * down entirely on the render thread, which SDL allows on Linux and Windows but not on
+     * macOS (Cocoa requires the main thread); Engine never creates one there.
+     */
+    class ThreadedRenderer : public Renderer
+    {
+      public:
+        explicit ThreadedRenderer(std::unique_ptr<Renderer> backend);
+        ~ThreadedRenderer();
+
+        // Initialization methods (start/stop the render thread)
+        bool initialize() override;
+        void shutdown() override;
+
+        // Rendering methods (recorded)
+        void clear(uint8_t r, uint8_t g, uint8_t b, uint8_t a) override;
+        void present() override;
+        void setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) override;
+        void drawLine(int x1, int y1, int x2, int y2) override;
+        void drawLine(int x1, int y1, int x2, int y2, int width) override;
+        void drawPoint(int x, int y) override;
+        void drawRect(int x, int y, int w, int h) override;
+        void fillRect(int x, int y, int w, int h) override;
+        void drawText(const std::string& text, int x, int y) override;
+
+        // Streaming textures (handles are ours; mapped to backend handles on replay)
+        TextureHandle createTexture(int width, int height) override;
+        void updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch) override;
+        void drawTexture(TextureHandle texture, int x, int y, int w, int h) override;
+        void destroyTexture(TextureHandle texture) override;
+        void drawTextureQuads(TextureHandle texture, std::span<const TexturedQuad> quads) override;
+
+        // Reads back the last presented frame (blocks until the render thread has drawn it)
+        bool readPixels(uint32_t* pixels, int pitch) override;
+
+        void setAntiAliasing(bool enable) override;
+        void setVSync(bool enable) override;
+
+        // Forwarded to the backend
+        void* getNativeRenderer() const override;
+        void getWindowSize(int& width, int& height) const override;
+
+        /**
+         * Run `fn` on the render thread at this point in the frame, with the backend renderer.
+         * Anything `user` points to must stay valid until the frame has been presented.
+         */
+        void recordCallback(RenderCallback fn, void* user);
+
+        /**
+         * Run `fn` on the render thread now, after any queued frame, and wait for it.
+         * For backend work that cannot wait for the next frame (readback, UI backend setup).
+         */
+        void invoke(RenderCallback fn, void* user);
+
+        /** Block until every submitted frame has been replayed and presented. */
+        void waitIdle();
+
+        Renderer* backend() const { return m_backend.get(); }
+
+      private:
+        void threadMain();
+
+        std::unique_ptr<Renderer> m_backend;
+        std::thread m_thread;
+
+        // m_recording is only touched by the main thread, m_submitted by the render thread
+        // while m_frameQueued is set
+        CommandBuffer m_buffers[2];
+        CommandBuffer* m_recording{&m_buffers[0]};
+        CommandBuffer* m_submitted{&m_buffers[1]};
+        uint8_t m_r{255}, m_g{255}, m_b{255}, m_a{255}; // Carried across buffer swaps
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake; // Render thread: new frame, task or stop
+        std::condition_variable m_done; // Main thread: frame finished or task run
+        bool m_frameQueued{false};
+        bool m_stopping{false};
+        bool m_started{false};
+
+        // Pending invoke() request
+        RenderCallback m_task{nullptr};
+        void* m_taskUser{nullptr};
+
+        // Main-thread texture bookkeeping (sizes are needed to copy updates)
+        struct TextureSize
+        {
+            int width, height;
+        };
+        std::unordered_map<TextureHandle, TextureSize> m_textureSizes;
+        TextureHandle m_nextTexture{1};
+
+        // Render-thread mapping from our handles to the backend's
+        CommandBuffer::TextureMap m_backendTextures;
+    };
+
+} // namespace tfv
+#endif // TFV_THREADED_RENDERER_HPP
@@ -4,6 +4,7 @@
 #include "core/Layer.hpp"
 #include "core/RoadNetwork.hpp"
 #include "core/Simulation.hpp"
+#include "rendering/DensityHeatmapRenderer.hpp"
 #include "rendering/HeatmapRenderer.hpp"
 #include "rendering/Renderer.hpp"
 #include "rendering/layers/SimulationLayer.hpp"
@@ -12,6 +13,13 @@
 namespace tfv
 {
 
+    /** What the heatmap shows */
+    enum class HeatmapMode
+    {
+        SEGMENTS, // Recolour road segments by congestion
+        DENSITY   // Area-level vehicle density (kernel density estimate)
+    };
+
     /**
      * Layer for rendering the traffic heatmap visualization
      */
@@ -29,11 +37,17 @@ namespace tfv
         virtual void onRender() override;
         virtual void onImGuiRender() override;
 
+        // Heatmap mode
+        void setMode(HeatmapMode mode) { m_mode = mode; }
+        HeatmapMode getMode() const { return m_mode; }
+
       private:
         Renderer* m_renderer;
         Simulation* m_simulation;
         SimulationLayer* m_simulationLayer;
         std::unique_ptr<HeatmapRenderer> m_heatmapRenderer;
+        std::unique_ptr<DensityHeatmapRenderer> m_densityRenderer;
+        HeatmapMode m_mode{HeatmapMode::SEGMENTS};
     };
 
 } // namespace tfv
@@ -2,9 +2,11 @@
 #define TFV_IMGUI_LAYER_HPP
 
 #include "alerts/AlertManager.hpp"
+#include "core/FrameScheduler.hpp"
 #include "core/Layer.hpp"
 #include "core/Simulation.hpp"
 #include "recording/RecordingManager.hpp"
+#include "rendering/ThreadedRenderer.hpp"
 #include "rendering/layers/SimulationLayer.hpp"
 #include <SDL2/SDL.h>
 #include <functional>
@@ -38,6 +40,9 @@ namespace tfv
         void setAlertManager(AlertManager* manager) { m_alertManager = manager; }
         void setRecordingManager(RecordingManager* manager) { m_recordingManager = manager; }
 
+        // With threaded rendering, ImGui draw data is submitted on the render thread
+        void setThreadedRenderer(ThreadedRenderer* renderer) { m_threadedRenderer = renderer; }
+
         // Feature toggles for UI elements
         void showKeybindingsWindow(bool show) { m_showKeybindings = show; }
         bool isKeybindingsWindowVisible() const { return m_showKeybindings; }
@@ -45,6 +50,7 @@ namespace tfv
         // FPS setting
         void setFPS(int fps) { m_fps = fps; }
         int getFPS() const { return m_fps; }
+        void setFrameStats(const FrameStats& stats) { m_frameStats = stats; }
 
         // Alert callback
         using AlertUICallback = std::function<void(const std::string& message, uint32_t segmentId)>;
@@ -57,12 +63,14 @@ namespace tfv
         SimulationLayer* m_simulationLayer{nullptr};
         AlertManager* m_alertManager{nullptr};
         RecordingManager* m_recordingManager{nullptr};
+        ThreadedRenderer* m_threadedRenderer{nullptr};
 
         bool m_initialized{false};
         bool m_showKeybindings{false};
 
         // FPS tracking
         int m_fps{0};
+        FrameStats m_frameStats;
 
         // Alert callback
         AlertUICallback m_alertUICallback;
@@ -71,9 +79,16 @@ namespace tfv
         void renderMainMenuBar();
         void renderStatusBar();
         void renderKeybindingsWindow();
+        void renderInspectorWindow();
         void renderDockspace();
 
         static void HelpMarker(const char* desc);
+
+        // Render-thread callbacks (threaded rendering only)
+        static void backendInit(void* user, Renderer* backend);
+        static void backendNewFrame(void* user, Renderer* backend);
+        static void submitDrawData(void* user, Renderer* backend);
+        static void backendShutdown(void* user, Renderer* backend);
     };
 
 } // namespace tfv
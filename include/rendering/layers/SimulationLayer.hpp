@@ -30,12 +30,31 @@ namespace tfv
         virtual void onRender() override;
         virtual void onImGuiRender() override;
 
-        // Scene control
-        void setPan(float x, float y);
-        void setZoom(float zoom);
-        float getPanX() const;
-        float getPanY() const;
-        float getZoom() const;
+        // Scene control: pan and zoom go through the scene camera
+        Camera& getCamera();
+        const Camera& getCamera() const;
+        double getZoom() const { return getCamera().zoom(); }
+
+        /**
+         * Nearest vehicle and segment within a few pixels of a screen point, via the
+         * spatial indices of the current state and the network.
+         */
+        PickResult pick(int screenX, int screenY) const;
+
+        /** Clicked objects (shown in the inspector) and those under the cursor */
+        const PickResult& getSelection() const { return m_selection; }
+        const PickResult& getHover() const { return m_hover; }
+        void clearSelection();
+
+        /** Wall time of the most recent pick, in milliseconds */
+        double getLastPickMs() const { return m_lastPickMs; }
+
+        /** Segment and vehicle text labels */
+        void setLabelsEnabled(bool enable);
+        bool getLabelsEnabled() const;
+
+        /** Simulation time to display; vehicles are interpolated between published ticks. */
+        void setRenderTime(double t) { m_renderTime = t; }
 
         // Get road network for use by other layers
         const RoadNetwork* getRoadNetwork() const { return m_simulation->getRoadNetwork(); }
@@ -43,6 +62,17 @@ namespace tfv
       private:
         Renderer* m_renderer;
         Simulation* m_simulation;
+        double m_renderTime{0.0};
+
+        // Pick radius around the cursor, in screen pixels
+        static constexpr float kPickRadius = 10.f;
+
+        // Pan step for the arrow keys (pixels) and zoom factor per key press or wheel notch
+        static constexpr double kPanStep = 20.0;
+        static constexpr double kZoomStep = 1.1;
+        PickResult m_selection;
+        PickResult m_hover;
+        mutable double m_lastPickMs{0.0};
 
         // Scene renderer for visualization
         std::unique_ptr<SceneRenderer> m_sceneRenderer;
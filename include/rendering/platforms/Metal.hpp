@@ -22,7 +22,14 @@ namespace tfv
         void drawRect(int x, int y, int w, int h) override;
         void fillRect(int x, int y, int w, int h) override;
         void drawText(const std::string& text, int x, int y) override;
+        TextureHandle createTexture(int width, int height) override;
+        void updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch) override;
+        void drawTexture(TextureHandle texture, int x, int y, int w, int h) override;
+        void destroyTexture(TextureHandle texture) override;
+        void drawTextureQuads(TextureHandle texture, std::span<const TexturedQuad> quads) override;
+        bool readPixels(uint32_t* pixels, int pitch) override;
         void setAntiAliasing(bool enable) override;
+        void setVSync(bool enable) override;
         void* getNativeRenderer() const override;
         void getWindowSize(int& width, int& height) const override;
 
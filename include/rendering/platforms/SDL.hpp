@@ -1,7 +1,11 @@
 #pragma once
+#include "rendering/GlyphAtlas.hpp"
 #include "rendering/Renderer.hpp"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 namespace tfv
 {
     class SDLRenderer : public Renderer
@@ -25,8 +29,19 @@ namespace tfv
         void fillRect(int x, int y, int w, int h) override;
         void drawText(const std::string& text, int x, int y) override;
 
+        // Streaming textures
+        TextureHandle createTexture(int width, int height) override;
+        void updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch) override;
+        void drawTexture(TextureHandle texture, int x, int y, int w, int h) override;
+        void destroyTexture(TextureHandle texture) override;
+        void drawTextureQuads(TextureHandle texture, std::span<const TexturedQuad> quads) override;
+
+        // Frame readback
+        bool readPixels(uint32_t* pixels, int pitch) override;
+
         // Control anti-aliasing for renderers that support it
         void setAntiAliasing(bool enable) override;
+        void setVSync(bool enable) override;
 
         // Access to underlying renderer for backend-specific operations
         void* getNativeRenderer() const override;
@@ -34,12 +49,24 @@ namespace tfv
         // Get window size
         void getWindowSize(int& width, int& height) const override;
 
-      private:
-        SDL_Texture* createTextTexture(const std::string& text);
-
       private:
         SDL_Renderer* m_renderer;
         SDL_Window* m_window;
         bool m_antiAliasingEnabled;
+        bool m_vsync{true};
+
+        // Textures handed out through the Renderer interface
+        std::unordered_map<TextureHandle, SDL_Texture*> m_textures;
+        TextureHandle m_nextTexture{1};
+
+        // Cached glyphs for drawText()
+        std::unique_ptr<TtfLibrary> m_ttf;
+        std::unique_ptr<GlyphAtlas> m_glyphs;
+        std::unique_ptr<TextBatch> m_text;
+        int m_font{GlyphAtlas::kInvalidFont};
+
+        // Scratch geometry for drawTextureQuads()
+        std::vector<SDL_Vertex> m_quadVertices;
+        std::vector<int> m_quadIndices;
     };
 } // namespace tfv
\ No newline at end of file
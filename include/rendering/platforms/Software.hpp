@@ -0,0 +1,137 @@
+#pragma once
+#include "rendering/GlyphAtlas.hpp"
+#include "rendering/Renderer.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace tfv
+{
+    /**
+     * Windowless renderer that rasterises into a CPU framebuffer.
+     *
+     * Draw calls are recorded and binned into screen tiles; present() (or readPixels())
+     * rasterises the tiles in parallel on a small worker pool. Needs no GPU or display, so
+     * it runs on headless servers and CI.
+     */
+    class SoftwareRenderer : public Renderer
+    {
+      public:
+        /**
+         * @param width Framebuffer width in pixels
+         * @param height Framebuffer height in pixels
+         * @param threads Rasteriser threads (0 = hardware concurrency)
+         */
+        SoftwareRenderer(int width, int height, unsigned threads = 0);
+        ~SoftwareRenderer();
+
+        // Initialization methods
+        bool initialize() override;
+        void shutdown() override;
+
+        // Rendering methods
+        void clear(uint8_t r, uint8_t g, uint8_t b, uint8_t a) override;
+        void present() override;
+        void setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) override;
+        void drawLine(int x1, int y1, int x2, int y2) override;
+        void drawLine(int x1, int y1, int x2, int y2, int width) override;
+        void drawPoint(int x, int y) override;
+        void drawRect(int x, int y, int w, int h) override;
+        void fillRect(int x, int y, int w, int h) override;
+        void drawText(const std::string& text, int x, int y) override;
+
+        // Streaming textures
+        TextureHandle createTexture(int width, int height) override;
+        void updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch) override;
+        void drawTexture(TextureHandle texture, int x, int y, int w, int h) override;
+        void destroyTexture(TextureHandle texture) override;
+        void drawTextureQuads(TextureHandle texture, std::span<const TexturedQuad> quads) override;
+
+        // Frame readback
+        bool readPixels(uint32_t* pixels, int pitch) override;
+
+        // Control anti-aliasing (coverage-based edges on lines)
+        void setAntiAliasing(bool enable) override;
+        void setVSync(bool enable) override;
+
+        // Returns the framebuffer (width * height packed 0xAARRGGBB pixels)
+        void* getNativeRenderer() const override;
+
+        // Framebuffer size
+        void getWindowSize(int& width, int& height) const override;
+
+      private:
+        struct Image
+        {
+            int width{0}, height{0};
+            std::vector<uint32_t> pixels;
+        };
+
+        enum class PrimType : uint8_t
+        {
+            LINE,
+            RECT,
+            IMAGE
+        };
+
+        // One recorded draw call; coordinates in pixels
+        struct Primitive
+        {
+            PrimType type;
+            uint32_t color;             // 0xAARRGGBB; tint for images
+            float x1, y1, x2, y2;       // Line end points, or image corners
+            float halfWidth;            // Lines only
+            const Image* image;         // Images only
+            int srcX, srcY, srcW, srcH; // Images only: source rect in texels
+            int minX, minY, maxX, maxY; // Inclusive pixel bounds, clipped to the framebuffer
+        };
+
+        static constexpr int kTileSize = 64;
+
+        void record(const Primitive& prim);
+        void recordImage(const Image& image, int x, int y, int w, int h, int srcX, int srcY,
+                         int srcW, int srcH, uint32_t tint);
+        void flush();
+        void rasterTile(int tile);
+        void rasterLine(const Primitive& p, int x0, int y0, int x1, int y1);
+        void rasterRect(const Primitive& p, int x0, int y0, int x1, int y1);
+        void rasterImage(const Primitive& p, int x0, int y0, int x1, int y1);
+        void workerLoop();
+
+        int m_width, m_height;
+        int m_tilesX{0}, m_tilesY{0};
+        std::vector<uint32_t> m_framebuffer;
+
+        // Current frame
+        uint32_t m_color{0xFFFFFFFF};
+        bool m_antiAliasingEnabled{false};
+        bool m_clearPending{false};
+        uint32_t m_clearColor{0xFF000000};
+        std::vector<Primitive> m_prims;
+        std::vector<std::vector<uint32_t>> m_tileBins; // Primitive indices per tile, in order
+
+        // Textures; text is drawn from a glyph atlas that lives among them
+        std::unordered_map<TextureHandle, Image> m_textures;
+        TextureHandle m_nextTexture{1};
+        std::unique_ptr<GlyphAtlas> m_glyphs;
+        std::unique_ptr<TextBatch> m_text;
+        int m_font{GlyphAtlas::kInvalidFont};
+
+        // Worker pool: each flush hands out tiles through m_nextTile
+        unsigned m_threadCount;
+        std::vector<std::thread> m_workers;
+        std::mutex m_poolMutex;
+        std::condition_variable m_poolCv;
+        std::condition_variable m_doneCv;
+        uint64_t m_job{0};
+        int m_busyWorkers{0};
+        bool m_stopping{false};
+        std::atomic<int> m_nextTile{0};
+    };
+} // namespace tfv
@@ -0,0 +1,46 @@
+#ifndef TFV_MAPPED_FILE_HPP
+#define TFV_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tfv
+{
+    /**
+     * Read-only memory map of a whole file. Pages are loaded by the OS on first touch, so
+     * opening a multi-gigabyte log costs nothing until its blocks are read.
+     */
+    class MappedFile
+    {
+      public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /** Map `path`; false if it cannot be opened or is empty */
+        bool open(const std::string& path);
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; }
+        const uint8_t* data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+
+        /** Ask the OS to start reading a range in ahead of use (a hint; never blocks) */
+        void prefetch(std::size_t offset, std::size_t length) const;
+
+      private:
+        const uint8_t* m_data{nullptr};
+        std::size_t m_size{0};
+#ifdef _WIN32
+        void* m_file{nullptr};
+        void* m_mapping{nullptr};
+#endif
+    };
+
+} // namespace tfv
+#endif // TFV_MAPPED_FILE_HPP
@@ -0,0 +1,52 @@
+#ifndef TFV_TASK_POOL_HPP
+#define TFV_TASK_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tfv
+{
+    /**
+     * Fork-join pool of persistent worker threads. run() hands out task indices from a shared
+     * counter, so uneven tasks balance themselves, and the calling thread works too.
+     */
+    class TaskPool
+    {
+      public:
+        /** `threads` workers besides the caller; 0 uses one per hardware thread, minus one */
+        explicit TaskPool(std::size_t threads = 0);
+        ~TaskPool();
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        /** Threads that run tasks, including the caller */
+        std::size_t concurrency() const { return m_threads.size() + 1; }
+
+        /** Call task(i) for every i in [0, count) and return once all have finished */
+        void run(std::size_t count, const std::function<void(std::size_t)>& task);
+
+      private:
+        void workerLoop();
+        void drain();
+
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_wakeCv;
+        std::condition_variable m_doneCv;
+        const std::function<void(std::size_t)>* m_task{nullptr}; // Null between runs
+        std::size_t m_count{0};
+        std::atomic<std::size_t> m_next{0};
+        std::size_t m_active{0}; // Workers inside the current run
+        uint64_t m_generation{0};
+        bool m_stop{false};
+    };
+
+} // namespace tfv
+#endif // TFV_TASK_POOL_HPP
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+TrafficFlowViz - binary feed stand-in
+
+Streams varint length-prefixed VehicleUpdate messages (protobuf wire format, see
+include/network/BinaryFeedDecoder.hpp) to every client of a TCP or Unix socket, for
+exercising BinaryFeedHandler locally:
+
+    ./scripts/feeds/binary_feed_server.py --tcp 127.0.0.1:9002 --rate 100000
+    engine.connect_to_feed("tcp://127.0.0.1:9002", trafficflowviz.FeedType.BINARY)
+
+    ./scripts/feeds/binary_feed_server.py --unix /tmp/tfv-feed.sock
+    engine.connect_to_feed("unix:///tmp/tfv-feed.sock", trafficflowviz.FeedType.BINARY)
+"""
+
+import argparse
+import os
+import random
+import socket
+import struct
+import threading
+import time
+
+# Field numbers and wire types of the VehicleUpdate schema
+ID, TS, LAT_E7, LON_E7, SPEED, SEGMENT, POSITION, REMOVED, SEQ = range(1, 10)
+VARINT, FIXED64, FIXED32 = 0, 1, 5
+PASS_MESSAGES = 10000  # Messages rendered at a time
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) ^ (value >> 63)
+
+
+def key(field, wire_type):
+    return varint((field << 3) | wire_type)
+
+
+def encode_update(vehicle_id, seq, ts, lat, lon, speed, segment=None, position=None,
+                  removed=False):
+    """One length-prefixed VehicleUpdate message."""
+    body = key(ID, VARINT) + varint(vehicle_id)
+    body += key(SEQ, VARINT) + varint(seq)
+    body += key(TS, FIXED64) + struct.pack("<d", ts)
+    if removed:
+        body += key(REMOVED, VARINT) + varint(1)
+    else:
+        body += key(LAT_E7, VARINT) + varint(zigzag(round(lat * 1e7)))
+        body += key(LON_E7, VARINT) + varint(zigzag(round(lon * 1e7)))
+        body += key(SPEED, FIXED32) + struct.pack("<f", speed)
+        if segment is not None:
+            body += key(SEGMENT, VARINT) + varint(segment)
+            body += key(POSITION, FIXED32) + struct.pack("<f", position or 0.0)
+    return varint(len(body)) + body
+
+
+def make_messages(count, vehicles, segments, remove_every, first=0, start_ts=1_700_000_000.0,
+                  spacing=0.001):
+    """Pre-rendered messages; with `segments` the producer claims to have map-matched.
+
+    Message i of the stream gets seq = i + 1 and a timestamp `spacing` seconds after the one
+    before, from `start_ts`, so a pass starting at message `first` continues the previous
+    one rather than replaying it (which the client would drop as stale)."""
+    rng = random.Random(42)
+    messages = []
+    for i in range(first, first + count):
+        vehicle_id = rng.randrange(1, vehicles + 1)
+        ts = start_ts + (i - first) * spacing
+        if remove_every and i % remove_every == remove_every - 1:
+            messages.append(encode_update(vehicle_id, i + 1, ts, 0, 0, 0, removed=True))
+            continue
+        segment = rng.randrange(1, segments + 1) if segments else None
+        messages.append(encode_update(vehicle_id, i + 1, ts,
+                                      52.52 + rng.uniform(-0.05, 0.05),
+                                      13.40 + rng.uniform(-0.05, 0.05),
+                                      rng.uniform(0, 20), segment, rng.random()))
+    return messages
+
+
+def serve(conn, name, args):
+    # Send in chunks of `per_chunk` messages; the rate is enforced per chunk
+    per_chunk = max(1, min(1000, args.rate // 100 if args.rate else 1000))
+    per_pass = (PASS_MESSAGES // per_chunk) * per_chunk
+
+    def render(first):
+        # Stamped with the wall-clock time each message is due to go out
+        messages = make_messages(per_pass, args.vehicles, args.segments, args.remove_every,
+                                 first, time.time(), 1.0 / args.rate if args.rate else 0.0)
+        return [b"".join(messages[i:i + per_chunk]) for i in range(0, per_pass, per_chunk)]
+
+    chunks = render(0)
+    print(f"client {name} connected")
+
+    sent, start = 0, time.monotonic()
+    try:
+        while not args.count or sent < args.count:
+            if sent and sent % per_pass == 0:
+                chunks = render(sent)
+            conn.sendall(chunks[(sent % per_pass) // per_chunk])
+            sent += per_chunk
+            if args.rate:
+                ahead = sent / args.rate - (time.monotonic() - start)
+                if ahead > 0:
+                    time.sleep(ahead)
+    except OSError as error:
+        print(f"client {name} gone: {error}")
+    elapsed = time.monotonic() - start
+    print(f"client {name}: {sent} messages in {elapsed:.2f}s "
+          f"({sent / max(elapsed, 1e-9):,.0f}/s)")
+    conn.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1])
+    where = parser.add_mutually_exclusive_group()
+    where.add_argument("--tcp", default="127.0.0.1:9002", help="host:port to listen on")
+    where.add_argument("--unix", help="Unix socket path to listen on")
+    parser.add_argument("--rate", type=int, default=10000, help="messages/s (0 = unlimited)")
+    parser.add_argument("--count", type=int, default=0, help="close after N messages")
+    parser.add_argument("--vehicles", type=int, default=50000)
+    parser.add_argument("--segments", type=int, default=0,
+                        help="also send segment/position for ids 1..N (pre-matched)")
+    parser.add_argument("--remove-every", type=int, default=0,
+                        help="make every Nth message a removal")
+    args = parser.parse_args()
+
+    if args.unix:
+        if os.path.exists(args.unix):
+            os.unlink(args.unix)
+        server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        server.bind(args.unix)
+        server.listen()
+        where = f"unix://{args.unix}"
+    else:
+        host, _, port = args.tcp.rpartition(":")
+        server = socket.create_server((host.strip("[]"), int(port)))
+        where = f"tcp://{args.tcp}"
+    sample = make_messages(1000, args.vehicles, args.segments, args.remove_every)
+    average = sum(map(len, sample)) / len(sample)
+    print(f"serving {where} ({args.rate or 'unlimited'} msgs/s, {average:.1f} bytes/msg)")
+
+    try:
+        while True:
+            conn, addr = server.accept()
+            name = f"{addr[0]}:{addr[1]}" if addr else "local"
+            threading.Thread(target=serve, args=(conn, name, args), daemon=True).start()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if args.unix:
+            os.unlink(args.unix)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""
+TrafficFlowViz - WebSocket feed stand-in
+
+A minimal RFC 6455 server (standard library only) that streams vehicles_live.json-shaped
+messages to every client, for exercising WebSocketFeedHandler locally:
+
+    ./scripts/feeds/ws_feed_server.py --port 9001 --rate 100000
+    engine.connect_to_feed("ws://127.0.0.1:9001/live")
+
+It can fragment messages, interleave pings and drop connections to test reconnects.
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import random
+import socket
+import struct
+import threading
+import time
+
+GUID = b"258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+TEXT, CONTINUATION, CLOSE, PING, PONG = 0x1, 0x0, 0x8, 0x9, 0xA
+PASS_MESSAGES = 10000  # Messages rendered at a time
+
+
+def frame(opcode, payload, fin=True):
+    """Encode one unmasked (server-to-client) frame."""
+    head = bytes([(0x80 if fin else 0) | opcode])
+    n = len(payload)
+    if n < 126:
+        head += bytes([n])
+    elif n <= 0xFFFF:
+        head += bytes([126]) + struct.pack(">H", n)
+    else:
+        head += bytes([127]) + struct.pack(">Q", n)
+    return head + payload
+
+
+def message_frames(payload, fragments):
+    """One message as `fragments` frames (1 = unfragmented)."""
+    if fragments <= 1 or len(payload) < fragments:
+        return frame(TEXT, payload)
+    step = len(payload) // fragments
+    parts = [payload[i * step:(i + 1) * step] for i in range(fragments - 1)]
+    parts.append(payload[(fragments - 1) * step:])
+    out = frame(TEXT, parts[0], fin=False)
+    for i, part in enumerate(parts[1:], 1):
+        out += frame(CONTINUATION, part, fin=(i == len(parts) - 1))
+    return out
+
+
+def make_messages(count, vehicles, batch, first=0, start_ts=1_700_000_000.0, spacing=0.001):
+    """Pre-render messages: one update object, or an array of `batch` of them.
+
+    Updates are numbered from 1 in `seq` and message i is stamped `spacing` seconds after the
+    one before, from `start_ts`, so a pass starting at message `first` continues the
+    previous one rather than replaying it (which the client would drop as stale)."""
+    rng = random.Random(42)
+    messages = []
+    for i in range(first, first + count):
+        updates = []
+        for k in range(batch):
+            updates.append({
+                "id": rng.randrange(1, vehicles + 1),
+                "seq": i * batch + k + 1,
+                "ts": start_ts + (i - first) * spacing,
+                "lat": round(52.52 + rng.uniform(-0.05, 0.05), 6),
+                "lon": round(13.40 + rng.uniform(-0.05, 0.05), 6),
+                "speed": round(rng.uniform(0, 20), 2),
+            })
+        body = updates[0] if batch == 1 else updates
+        messages.append(json.dumps(body, separators=(",", ":")).encode())
+    return messages
+
+
+def handshake(conn):
+    request = b""
+    while b"\r\n\r\n" not in request:
+        chunk = conn.recv(4096)
+        if not chunk:
+            return False
+        request += chunk
+    key = None
+    for line in request.split(b"\r\n")[1:]:
+        name, _, value = line.partition(b":")
+        if name.strip().lower() == b"sec-websocket-key":
+            key = value.strip()
+    if key is None:
+        conn.sendall(b"HTTP/1.1 400 Bad Request\r\n\r\n")
+        return False
+    accept = base64.b64encode(hashlib.sha1(key + GUID).digest())
+    conn.sendall(b"HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                 b"Connection: Upgrade\r\nSec-WebSocket-Accept: " + accept + b"\r\n\r\n")
+    return True
+
+
+def read_client(conn, stats, closed):
+    """Consume the client's (masked) frames: count pongs, notice close."""
+    buf = b""
+    try:
+        while not closed.is_set():
+            chunk = conn.recv(65536)
+            if not chunk:
+                break
+            buf += chunk
+            while len(buf) >= 2:
+                opcode, n, pos = buf[0] & 0x0F, buf[1] & 0x7F, 2
+                if n == 126:
+                    if len(buf) < 4:
+                        break
+                    n, pos = struct.unpack(">H", buf[2:4])[0], 4
+                elif n == 127:
+                    if len(buf) < 10:
+                        break
+                    n, pos = struct.unpack(">Q", buf[2:10])[0], 10
+                if buf[1] & 0x80:
+                    pos += 4
+                if len(buf) < pos + n:
+                    break
+                buf = buf[pos + n:]
+                if opcode == PONG:
+                    stats["pongs"] += 1
+                elif opcode == CLOSE:
+                    stats["closes"] += 1
+                    closed.set()
+    except OSError:
+        pass
+    closed.set()
+
+
+def serve(conn, addr, args):
+    conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    if not handshake(conn):
+        conn.close()
+        return
+    print(f"client {addr[0]}:{addr[1]} connected")
+
+    stats = {"pongs": 0, "closes": 0}
+    closed = threading.Event()
+    threading.Thread(target=read_client, args=(conn, stats, closed), daemon=True).start()
+
+    # Frames are sent in chunks of `per_chunk` messages to keep Python's overhead out of
+    # the way; the rate is enforced per chunk
+    per_chunk = max(1, min(1000, args.rate // 100 if args.rate else 1000))
+    per_pass = (PASS_MESSAGES // per_chunk) * per_chunk
+
+    def render(first):
+        # Stamped with the wall-clock time each message is due to go out
+        messages = make_messages(per_pass, args.vehicles, args.batch, first, time.time(),
+                                 1.0 / args.rate if args.rate else 0.0)
+        return [b"".join(message_frames(m, args.fragments) for m in messages[i:i + per_chunk])
+                for i in range(0, len(messages), per_chunk)]
+
+    chunks = render(0)
+
+    sent, start, next_ping = 0, time.monotonic(), time.monotonic() + args.ping_every
+    try:
+        while not closed.is_set():
+            if args.count and sent >= args.count:
+                break
+            if args.drop_after and sent >= args.drop_after:
+                print(f"dropping {addr[0]}:{addr[1]} after {sent} messages")
+                conn.shutdown(socket.SHUT_RDWR)
+                break
+            if sent and sent % per_pass == 0:
+                chunks = render(sent)
+            data = chunks[(sent % per_pass) // per_chunk]
+            if args.ping_every and time.monotonic() >= next_ping:
+                data = frame(PING, b"tfv") + data
+                next_ping += args.ping_every
+            conn.sendall(data)
+            sent += per_chunk
+            if args.rate:
+                ahead = sent / args.rate - (time.monotonic() - start)
+                if ahead > 0:
+                    time.sleep(ahead)
+        if not closed.is_set() and args.count:
+            conn.sendall(frame(CLOSE, struct.pack(">H", 1000)))
+            closed.wait(2.0)
+    except OSError as error:
+        print(f"client {addr[0]}:{addr[1]} gone: {error}")
+    elapsed = time.monotonic() - start
+    print(f"client {addr[0]}:{addr[1]}: {sent} messages in {elapsed:.2f}s "
+          f"({sent / max(elapsed, 1e-9):,.0f}/s), {stats['pongs']} pongs")
+    conn.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=9001)
+    parser.add_argument("--rate", type=int, default=10000, help="messages/s (0 = unlimited)")
+    parser.add_argument("--count", type=int, default=0, help="close after N messages")
+    parser.add_argument("--vehicles", type=int, default=50000)
+    parser.add_argument("--batch", type=int, default=1, help="updates per message")
+    parser.add_argument("--fragments", type=int, default=1, help="frames per message")
+    parser.add_argument("--ping-every", type=float, default=0.0, help="seconds between pings")
+    parser.add_argument("--drop-after", type=int, default=0,
+                        help="drop the connection after N messages")
+    args = parser.parse_args()
+
+    server = socket.create_server((args.host, args.port), reuse_port=False)
+    print(f"serving ws://{args.host}:{args.port}/ ({args.rate or 'unlimited'} msgs/s)")
+    try:
+        while True:
+            conn, addr = server.accept()
+            threading.Thread(target=serve, args=(conn, addr, args), daemon=True).start()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
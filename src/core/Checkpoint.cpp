@@ -0,0 +1,425 @@
+#include "core/Checkpoint.hpp"
+#include "utils/LoggingManager.hpp"
+#include "utils/MappedFile.hpp"
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+namespace tfv
+{
+    namespace
+    {
+        class Writer
+        {
+          public:
+            explicit Writer(std::vector<uint8_t>& out) : m_out(out) {}
+
+            void put(uint64_t v, int bytes)
+            {
+                for(int i = 0; i < bytes; ++i)
+                    m_out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+            }
+            void u32(uint32_t v) { put(v, 4); }
+            void u64(uint64_t v) { put(v, 8); }
+            void f32(float v) { put(std::bit_cast<uint32_t>(v), 4); }
+            void f64(double v) { put(std::bit_cast<uint64_t>(v), 8); }
+
+          private:
+            std::vector<uint8_t>& m_out;
+        };
+
+        // Bounds-checked reader over the mapping; once a read runs past the end every
+        // further read returns zero and ok() stays false
+        class Reader
+        {
+          public:
+            Reader(const uint8_t* data, std::size_t size) : m_p(data), m_end(data + size) {}
+
+            uint64_t get(int bytes)
+            {
+                if(static_cast<std::size_t>(m_end - m_p) < static_cast<std::size_t>(bytes))
+                {
+                    m_ok = false;
+                    m_p = m_end;
+                    return 0;
+                }
+                uint64_t v = 0;
+                for(int i = 0; i < bytes; ++i)
+                    v |= static_cast<uint64_t>(m_p[i]) << (8 * i);
+                m_p += bytes;
+                return v;
+            }
+            uint32_t u32() { return static_cast<uint32_t>(get(4)); }
+            uint64_t u64() { return get(8); }
+            float f32() { return std::bit_cast<float>(u32()); }
+            double f64() { return std::bit_cast<double>(u64()); }
+
+            /** True if `count` items of `size` bytes remain (guards reserve() on bad counts) */
+            bool has(uint64_t count, std::size_t size)
+            {
+                if(count > static_cast<std::size_t>(m_end - m_p) / size)
+                    m_ok = false;
+                return m_ok;
+            }
+
+            const uint8_t* take(std::size_t bytes)
+            {
+                if(!has(bytes, 1))
+                    return nullptr;
+                const uint8_t* p = m_p;
+                m_p += bytes;
+                return p;
+            }
+
+            bool ok() const { return m_ok; }
+            bool atEnd() const { return m_p == m_end; }
+
+          private:
+            const uint8_t* m_p;
+            const uint8_t* m_end;
+            bool m_ok{true};
+        };
+
+        void encode(const SimulationCheckpoint& c, std::vector<uint8_t>& out)
+        {
+            Writer w(out);
+            const SimulationState& state = *c.state;
+            w.u64(state.tick);
+            w.f64(state.time);
+            w.u64(c.seed);
+            w.f64(c.statUpdateInterval);
+            w.f64(c.timeSinceStatUpdate);
+
+            w.u32(static_cast<uint32_t>(c.alertThresholds.size()));
+            for(const auto& [type, threshold] : c.alertThresholds)
+            {
+                w.u32(static_cast<uint32_t>(type));
+                w.f32(threshold);
+            }
+
+            // Vehicle types are interned so the vehicle records stay fixed-size
+            std::vector<const std::string*> types;
+            std::unordered_map<const std::string*, uint32_t> typeIndex; // Names are interned
+            std::vector<uint32_t> vehicleTypes(state.vehicles.size());
+            for(std::size_t i = 0; i < state.vehicles.size(); ++i)
+            {
+                auto [it, added] = typeIndex.try_emplace(&state.vehicles[i].type.name(),
+                                                         static_cast<uint32_t>(types.size()));
+                if(added)
+                    types.push_back(it->first);
+                vehicleTypes[i] = it->second;
+            }
+            w.u32(static_cast<uint32_t>(types.size()));
+            for(const std::string* type : types)
+            {
+                w.u32(static_cast<uint32_t>(type->size()));
+                out.insert(out.end(), type->begin(), type->end());
+            }
+
+            w.u64(state.vehicles.size());
+            out.reserve(out.size() + state.vehicles.size() * checkpoint::kVehicleRecordSize);
+            for(std::size_t i = 0; i < state.vehicles.size(); ++i)
+            {
+                const Vehicle& v = state.vehicles[i];
+                w.u64(v.id);
+                w.u32(v.segmentId);
+                w.f32(v.position);
+                w.f32(v.vel.x);
+                w.f32(v.vel.y);
+                w.f32(v.acc.x);
+                w.f32(v.acc.y);
+                w.f32(v.length);
+                w.f32(v.width);
+                w.u32(vehicleTypes[i]);
+            }
+
+            w.u32(static_cast<uint32_t>(c.segments.size()));
+            for(const SegmentCheckpoint& s : c.segments)
+            {
+                w.u32(s.id);
+                w.u32(static_cast<uint32_t>(s.vehicleCount));
+                w.f32(s.congestionLevel);
+                w.f32(s.currentSpeed);
+            }
+
+            w.u32(static_cast<uint32_t>(c.segmentStats.size()));
+            for(const auto& [id, stats] : c.segmentStats)
+            {
+                w.u32(id);
+                w.f32(stats.avgSpeed);
+                w.f32(stats.avgDensity);
+                w.u32(static_cast<uint32_t>(stats.speedHistory.size()));
+                for(float s : stats.speedHistory)
+                    w.f32(s);
+                w.u32(static_cast<uint32_t>(stats.densityHistory.size()));
+                for(int d : stats.densityHistory)
+                    w.u32(static_cast<uint32_t>(d));
+            }
+
+            w.u32(static_cast<uint32_t>(c.speedLimits.size()));
+            for(const auto& [id, limit] : c.speedLimits)
+            {
+                w.u32(id);
+                w.f32(limit);
+            }
+        }
+
+        bool decode(Reader& r, SimulationCheckpoint& c)
+        {
+            auto state = std::make_shared<SimulationState>();
+            state->tick = r.u64();
+            state->time = r.f64();
+            c.seed = r.u64();
+            c.statUpdateInterval = r.f64();
+            c.timeSinceStatUpdate = r.f64();
+
+            const uint32_t thresholds = r.u32();
+            if(!r.has(thresholds, 8))
+                return false;
+            for(uint32_t i = 0; i < thresholds; ++i)
+            {
+                const uint32_t type = r.u32();
+                const float threshold = r.f32();
+                if(type > static_cast<uint32_t>(AlertType::INCIDENT))
+                    return false;
+                c.alertThresholds[static_cast<AlertType>(type)] = threshold;
+            }
+
+            const uint32_t typeCount = r.u32();
+            if(!r.has(typeCount, 4))
+                return false;
+            std::vector<VehicleType> types;
+            types.reserve(typeCount);
+            for(uint32_t k = 0; k < typeCount; ++k)
+            {
+                const uint32_t length = r.u32();
+                const uint8_t* chars = r.take(length);
+                if(!chars)
+                    return false;
+                types.emplace_back(std::string_view(reinterpret_cast<const char*>(chars), length));
+            }
+
+            const uint64_t vehicleCount = r.u64();
+            if(!r.has(vehicleCount, checkpoint::kVehicleRecordSize))
+                return false;
+            state->vehicles.resize(static_cast<std::size_t>(vehicleCount));
+            for(Vehicle& v : state->vehicles)
+            {
+                v.id = r.u64();
+                v.segmentId = r.u32();
+                v.position = r.f32();
+                v.vel.x = r.f32();
+                v.vel.y = r.f32();
+                v.acc.x = r.f32();
+                v.acc.y = r.f32();
+                v.length = r.f32();
+                v.width = r.f32();
+                const uint32_t type = r.u32();
+                if(type >= types.size())
+                    return false;
+                v.type = types[type];
+            }
+
+            const uint32_t segmentCount = r.u32();
+            if(!r.has(segmentCount, 16))
+                return false;
+            c.segments.resize(segmentCount);
+            for(SegmentCheckpoint& s : c.segments)
+            {
+                s.id = r.u32();
+                s.vehicleCount = static_cast<int>(r.u32());
+                s.congestionLevel = r.f32();
+                s.currentSpeed = r.f32();
+            }
+
+            const uint32_t statsCount = r.u32();
+            if(!r.has(statsCount, 20))
+                return false;
+            c.segmentStats.reserve(statsCount);
+            for(uint32_t i = 0; i < statsCount; ++i)
+            {
+                SegmentStatistics& stats = c.segmentStats[r.u32()];
+                stats.avgSpeed = r.f32();
+                stats.avgDensity = r.f32();
+                const uint32_t speeds = r.u32();
+                if(!r.has(speeds, 4))
+                    return false;
+                stats.speedHistory.resize(speeds);
+                for(float& s : stats.speedHistory)
+                    s = r.f32();
+                const uint32_t densities = r.u32();
+                if(!r.has(densities, 4))
+                    return false;
+                stats.densityHistory.resize(densities);
+                for(int& d : stats.densityHistory)
+                    d = static_cast<int>(r.u32());
+            }
+
+            const uint32_t limitCount = r.u32();
+            if(!r.has(limitCount, 8))
+                return false;
+            c.speedLimits.reserve(limitCount);
+            for(uint32_t i = 0; i < limitCount; ++i)
+            {
+                const uint32_t id = r.u32();
+                c.speedLimits[id] = r.f32();
+            }
+
+            c.state = std::move(state);
+            return r.ok() && r.atEnd();
+        }
+    } // namespace
+
+    bool writeCheckpoint(const SimulationCheckpoint& checkpoint, const std::string& path)
+    {
+        if(!checkpoint.state)
+            return false;
+
+        std::vector<uint8_t> bytes(checkpoint::kHeaderSize);
+        encode(checkpoint, bytes);
+
+        std::memcpy(bytes.data(), checkpoint::kMagic, sizeof(checkpoint::kMagic));
+        const uint64_t bodySize = bytes.size() - checkpoint::kHeaderSize;
+        for(int i = 0; i < 4; ++i)
+            bytes[8 + i] = static_cast<uint8_t>(checkpoint::kVersion >> (8 * i));
+        for(int i = 0; i < 8; ++i)
+            bytes[16 + i] = static_cast<uint8_t>(bodySize >> (8 * i));
+
+        const std::string temp = path + ".tmp";
+        std::FILE* file = std::fopen(temp.c_str(), "wb");
+        if(!file)
+        {
+            LOG_ERROR("Failed to create checkpoint {file}", PARAM(file, temp));
+            return false;
+        }
+        const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        if(std::fclose(file) != 0 || !written)
+        {
+            LOG_ERROR("Failed to write checkpoint {file}", PARAM(file, temp));
+            std::remove(temp.c_str());
+            return false;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temp, path, error);
+        if(error)
+        {
+            LOG_ERROR("Failed to move checkpoint into place at {file}: {error}",
+                      PARAM(file, path), PARAM(error, error.message()));
+            std::remove(temp.c_str());
+            return false;
+        }
+
+        LOG_INFO("Checkpoint of tick {tick} written to {file} ({bytes} bytes)",
+                 PARAM(tick, checkpoint.state->tick), PARAM(file, path),
+                 PARAM(bytes, bytes.size()));
+        return true;
+    }
+
+    bool readCheckpoint(const std::string& path, SimulationCheckpoint& checkpoint)
+    {
+        MappedFile file;
+        if(!file.open(path))
+        {
+            LOG_ERROR("Failed to map checkpoint {file}", PARAM(file, path));
+            return false;
+        }
+        // The whole file is read front to back right away
+        file.prefetch(0, file.size());
+
+        Reader header(file.data(), file.size());
+        const uint8_t* magic = header.take(sizeof(checkpoint::kMagic));
+        const uint32_t version = header.u32();
+        header.u32(); // Reserved
+        const uint64_t bodySize = header.u64();
+        if(!header.ok() || std::memcmp(magic, checkpoint::kMagic, sizeof(checkpoint::kMagic)) ||
+           version != checkpoint::kVersion ||
+           bodySize != file.size() - checkpoint::kHeaderSize)
+        {
+            LOG_ERROR("{file} is not a complete checkpoint", PARAM(file, path));
+            return false;
+        }
+
+        Reader body(file.data() + checkpoint::kHeaderSize, file.size() - checkpoint::kHeaderSize);
+        SimulationCheckpoint result;
+        if(!decode(body, result))
+        {
+            LOG_ERROR("Checkpoint {file} is corrupt", PARAM(file, path));
+            return false;
+        }
+
+        checkpoint = std::move(result);
+        return true;
+    }
+
+    CheckpointWriter::~CheckpointWriter()
+    {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_closing = true;
+        }
+        m_cv.notify_all();
+        if(m_thread.joinable())
+            m_thread.join();
+    }
+
+    void CheckpointWriter::save(SimulationCheckpoint checkpoint, std::string path)
+    {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_queue.emplace_back(std::move(checkpoint), std::move(path));
+            if(!m_thread.joinable())
+                m_thread = std::thread(&CheckpointWriter::run, this);
+        }
+        m_cv.notify_all();
+    }
+
+    void CheckpointWriter::wait()
+    {
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_queue.empty() && !m_busy; });
+    }
+
+    uint64_t CheckpointWriter::written() const
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_written;
+    }
+
+    uint64_t CheckpointWriter::failed() const
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_failed;
+    }
+
+    void CheckpointWriter::run()
+    {
+        std::unique_lock lock(m_mutex);
+        while(true)
+        {
+            m_cv.wait(lock, [&] { return !m_queue.empty() || m_closing; });
+            if(m_queue.empty())
+                return; // Closing and drained
+
+            auto job = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            lock.unlock();
+
+            const bool ok = writeCheckpoint(job.first, job.second);
+            job = {}; // Release the shared state before reporting completion
+
+            lock.lock();
+            m_busy = false;
+            if(ok)
+                ++m_written;
+            else
+                ++m_failed;
+            m_cv.notify_all();
+        }
+    }
+
+} // namespace tfv
@@ -9,6 +9,7 @@
 #include "recording/RecordingManager.hpp"
 #include "rendering/layers/HeatmapLayer.hpp"
 #include "rendering/layers/ImGuiLayer.hpp"
+#include "rendering/ThreadedRenderer.hpp"
 #include "rendering/layers/SimulationLayer.hpp"
 #include "utils/LoggingManager.hpp"
 #include <imgui.h>
@@ -26,6 +27,9 @@ namespace tfv
 
     Engine::~Engine()
     {
+        // Detach the state log before the simulation goes away
+        stopStateRecording();
+
         // Clean up in reverse order of creation
         m_layerStack.clear();
         m_simulationLayer.reset();
@@ -50,51 +54,73 @@ namespace tfv
 
     bool Engine::init()
     {
-        // Initialize SDL for the SDL renderer
-        if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0)
+        if(m_initialized)
+            return true;
+
+        // The software renderer draws offscreen: no display, window or GPU needed
+        if(m_rendererType != "Software")
         {
-            LOG_ERROR("SDL init failed: {error}", PARAM(error, SDL_GetError()));
-            return false;
-        }
+            // Initialize SDL for the SDL renderer
+            if(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0)
+            {
+                LOG_ERROR("SDL init failed: {error}", PARAM(error, SDL_GetError()));
+                return false;
+            }
 
-        // Create window with no border, resizable, and with a specific size also without top client
-        // area to make it look like a native window
-        m_window = SDL_CreateWindow(m_title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                    m_w, m_h, SDL_WINDOW_BORDERLESS | SDL_WINDOW_RESIZABLE);
+            // Create window with no border, resizable, and with a specific size also without top
+            // client area to make it look like a native window
+            m_window =
+                SDL_CreateWindow(m_title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                 m_w, m_h, SDL_WINDOW_BORDERLESS | SDL_WINDOW_RESIZABLE);
 
-        if(!m_window)
-        {
-            LOG_ERROR("Window creation failed: {error}", PARAM(error, SDL_GetError()));
-            return false;
-        }
-        LOG_INFO("Window created successfully");
-        // Set window icon
-        SDL_Surface* icon = SDL_LoadBMP("assets/icon.bmp");
+            if(!m_window)
+            {
+                LOG_ERROR("Window creation failed: {error}", PARAM(error, SDL_GetError()));
+                return false;
+            }
+            LOG_INFO("Window created successfully");
+            // Set window icon
+            SDL_Surface* icon = SDL_LoadBMP("assets/icon.bmp");
 
-        if(icon)
-        {
-            SDL_SetWindowIcon(static_cast<SDL_Window*>(m_window), icon);
-            SDL_FreeSurface(icon);
-        }
-        else
-        {
-            LOG_ERROR("Failed to load window icon: {error}", PARAM(error, SDL_GetError()));
+            if(icon)
+            {
+                SDL_SetWindowIcon(static_cast<SDL_Window*>(m_window), icon);
+                SDL_FreeSurface(icon);
+            }
+            else
+            {
+                LOG_ERROR("Failed to load window icon: {error}", PARAM(error, SDL_GetError()));
+            }
         }
 
         // Create the renderer using factory method
-        m_renderer = Renderer::create(m_rendererType, m_window).release();
+        m_renderer = Renderer::create(m_rendererType, m_window, m_w, m_h).release();
         if(!m_renderer)
         {
             LOG_ERROR("Renderer creation failed");
             return false;
         }
         LOG_INFO("Renderer created successfully");
+
+        // Layers record into command buffers; the backend runs on its own thread. macOS only
+        // allows window and renderer work on the main thread, so it always renders directly.
+#ifdef __APPLE__
+        if(m_threadedRendering)
+        {
+            LOG_WARN("Threaded rendering is not supported on macOS; rendering on the main thread");
+            m_threadedRendering = false;
+        }
+#endif
+        if(m_threadedRendering)
+            m_renderer = new ThreadedRenderer(std::unique_ptr<Renderer>(m_renderer));
+
         if(!m_renderer->initialize())
         {
             LOG_ERROR("Renderer initialization failed");
             return false;
         }
         LOG_INFO("Renderer initialized successfully");
+        m_renderer->setVSync(m_scheduler.mode() == FrameMode::VSYNC);
 
         if(!m_sim.initialize(m_cityInfoPath, m_vehicleInfoPath))
         {
@@ -143,12 +169,15 @@ namespace tfv
             m_imguiLayer->setSimulationLayer(m_simulationLayer.get());
             m_imguiLayer->setAlertManager(m_alertManager.get());
             m_imguiLayer->setRecordingManager(m_recordingManager.get());
+            if(m_threadedRendering)
+                m_imguiLayer->setThreadedRenderer(static_cast<ThreadedRenderer*>(m_renderer));
             m_imguiLayer->showKeybindingsWindow(m_showKeybindings);
 
             m_layerStack.pushLayer(m_imguiLayer);
             m_imguiLayer->setEnabled(m_imguiEnabled);
         }
 
+        m_initialized = true;
         return true;
     }
 
@@ -157,15 +186,22 @@ namespace tfv
         if(!init())
             return;
 
-        using clk = std::chrono::high_resolution_clock;
-        auto last = clk::now();
+        uint64_t frames = 0;
         m_running = true;
 
         while(m_running)
         {
-            auto now = clk::now();
-            double dt = std::chrono::duration<double>(now - last).count();
-            last = now;
+            // Nothing changes until input arrives: block instead of drawing identical frames
+            if(isIdle())
+            {
+                waitForEvents();
+                m_scheduler.resetClock();
+                continue;
+            }
+
+            double dt = m_scheduler.beginFrame();
+            if(m_frameTime > 0.0)
+                dt = m_frameTime;
 
             handleEvents();
             update(dt);
@@ -179,90 +215,172 @@ namespace tfv
 
             // Update FPS counter
             updateFPSCounter(dt);
+
+            if(m_maxFrames && ++frames >= m_maxFrames)
+                m_running = false;
+
+            // Pace to the target rate (no-op for VSYNC and UNCAPPED)
+            m_scheduler.endFrame();
         }
+
+        FrameStats stats = m_scheduler.stats();
+        LOG_INFO("Frame time p50 {p50} ms, p95 {p95} ms, p99 {p99} ms", PARAM(p50, stats.p50),
+                 PARAM(p95, stats.p95), PARAM(p99, stats.p99));
+    }
+
+    bool Engine::isIdle() const
+    {
+        if(m_scheduler.mode() != FrameMode::ON_DEMAND || !m_paused || m_dirty || !m_window)
+            return false;
+        // A recording needs a steady stream of frames
+        return !(m_recordingManager && m_recordingManager->isRecording());
+    }
+
+    void Engine::waitForEvents()
+    {
+        // Time out now and then so state changed from other threads is picked up
+        SDL_Event e;
+        if(SDL_WaitEventTimeout(&e, kIdleWaitMs))
+            processEvent(&e);
     }
 
     void Engine::handleEvents()
     {
+        // Headless: no window, so no input
+        if(!m_window)
+            return;
+
         // For now, keep SDL event handling since we're focusing on rendering API abstraction
         SDL_Event e;
         while(SDL_PollEvent(&e))
+            processEvent(&e);
+    }
+
+    void Engine::processEvent(void* event)
+    {
+        SDL_Event& e = *static_cast<SDL_Event*>(event);
+
+        // Any input may change what is on screen
+        m_dirty = true;
+
+        // Process events through the layer stack first
+        if(m_layerStack.onEvent(&e))
         {
-            // Process events through the layer stack first
-            if(m_layerStack.onEvent(&e))
-            {
-                // Event was handled by a layer
-                continue;
-            }
+            // Event was handled by a layer
+            return;
+        }
 
-            // Handle application-level events
-            if(e.type == SDL_QUIT)
-                m_running = false;
+        // Handle application-level events
+        if(e.type == SDL_QUIT)
+            m_running = false;
 
-            if(e.type == SDL_KEYDOWN)
+        if(e.type == SDL_KEYDOWN)
+        {
+            switch(e.key.keysym.sym)
             {
-                switch(e.key.keysym.sym)
+            case SDLK_ESCAPE:
+                m_running = false;
+                break;
+
+            // Feature toggles
+            case SDLK_h: // Toggle heatmap
+                toggleHeatmap(!m_showHeatmap);
+                break;
+            case SDLK_d: // Switch heatmap between segment and density modes
+                if(m_heatmapLayer)
                 {
-                case SDLK_ESCAPE:
-                    m_running = false;
-                    break;
-
-                // Feature toggles
-                case SDLK_h: // Toggle heatmap
-                    toggleHeatmap(!m_showHeatmap);
-                    break;
-                case SDLK_l: // Toggle live feed
-                    toggleLiveFeed(!m_liveFeedEnabled);
-                    break;
-                case SDLK_a: // Toggle alerts
-                    toggleAlerts(!m_alertsEnabled);
-                    break;
-                case SDLK_r: // Toggle recording
-                    toggleRecording(!m_recordingEnabled);
-                    break;
-                case SDLK_i: // Toggle ImGui
-                    toggleImGui(!m_imguiEnabled);
-                    break;
-                case SDLK_g: // Toggle anti-aliasing
-                    toggleAntiAliasing(!m_antiAliasingEnabled);
-                    break;
-                case SDLK_k: // Toggle keybindings window
-                    toggleKeybindingsWindow(!m_showKeybindings);
-                    break;
-
-                // Export functions
-                case SDLK_s: // Save screenshot
-                    if(m_recordingManager)
-                    {
-                        m_recordingManager->captureScreenshot(
-                            "trafficviz_" + std::to_string(static_cast<long>(time(nullptr))) +
-                            ".png");
-                    }
-                    break;
-
-                default:
-                    break;
+                    m_heatmapLayer->setMode(m_heatmapLayer->getMode() == HeatmapMode::SEGMENTS
+                                                ? HeatmapMode::DENSITY
+                                                : HeatmapMode::SEGMENTS);
                 }
+                break;
+            case SDLK_t: // Toggle segment/vehicle labels
+                if(m_simulationLayer)
+                    m_simulationLayer->setLabelsEnabled(!m_simulationLayer->getLabelsEnabled());
+                break;
+            case SDLK_l: // Toggle live feed
+                toggleLiveFeed(!m_liveFeedEnabled);
+                break;
+            case SDLK_a: // Toggle alerts
+                toggleAlerts(!m_alertsEnabled);
+                break;
+            case SDLK_r: // Toggle recording
+                toggleRecording(!m_recordingEnabled);
+                break;
+            case SDLK_i: // Toggle ImGui
+                toggleImGui(!m_imguiEnabled);
+                break;
+            case SDLK_g: // Toggle anti-aliasing
+                toggleAntiAliasing(!m_antiAliasingEnabled);
+                break;
+            case SDLK_k: // Toggle keybindings window
+                toggleKeybindingsWindow(!m_showKeybindings);
+                break;
+            case SDLK_p: // Pause/resume the simulation
+                setPaused(!m_paused);
+                break;
+
+            // Export functions
+            case SDLK_s: // Save screenshot
+                if(m_recordingManager)
+                {
+                    m_recordingManager->captureScreenshot(
+                        "trafficviz_" + std::to_string(static_cast<long>(time(nullptr))) + ".png");
+                }
+                break;
+
+            default:
+                break;
             }
         }
     }
 
     void Engine::update(double dt)
     {
-        // Update simulation
-        m_sim.update(dt);
-
-        // Process live data if enabled
-        if(m_liveFeedEnabled && m_liveFeed)
+        // Update simulation, either once per frame or in fixed steps. While paused the
+        // simulation and the interpolation clock hold still.
+        if(!m_paused && m_replay.isOpen())
+        {
+            // Replaying: the log drives the published states and the clock
+            m_replay.advance(dt);
+            m_sim.publishStates(m_replay.before(), m_replay.after());
+            if(m_simulationLayer)
+                m_simulationLayer->setRenderTime(m_replay.time());
+            m_dirty = true;
+        }
+        else if(!m_paused)
         {
-            // Note: These should be implemented in LiveFeed class if needed
-            // For now, removed these calls since they don't exist
-            // m_liveFeed->update();
-            // const auto& updates = m_liveFeed->getVehicleUpdates();
-            // for(const auto& update : updates)
-            // {
-            //     m_sim.updateVehicle(update);
-            // }
+            // Live data queued since the last frame goes in as one batch before stepping
+            if(m_liveFeedEnabled && m_liveFeed)
+                m_liveFeed->update();
+
+            if(m_simStep > 0.0)
+            {
+                m_simAccumulator += dt;
+                int steps = 0;
+                while(m_simAccumulator >= m_simStep && steps < kMaxSimStepsPerFrame)
+                {
+                    m_sim.update(m_simStep);
+                    m_simAccumulator -= m_simStep;
+                    ++steps;
+                }
+
+                // Too far behind: drop the backlog rather than spiral
+                if(steps == kMaxSimStepsPerFrame)
+                    m_simAccumulator = std::fmod(m_simAccumulator, m_simStep);
+            }
+            else
+            {
+                m_sim.update(dt);
+            }
+            m_dirty = true;
+
+            // Render one tick behind so there is always a state on each side to blend between
+            if(m_simulationLayer)
+            {
+                double lag = m_simStep > 0.0 ? m_simStep - m_simAccumulator : 0.0;
+                m_simulationLayer->setRenderTime(m_sim.time() - lag);
+            }
         }
 
         // Process alerts if enabled
@@ -293,6 +411,7 @@ namespace tfv
 
         // Present the renderer
         m_renderer->present();
+        m_dirty = false;
     }
 
     bool Engine::updateFPSCounter(double dt)
@@ -312,6 +431,7 @@ namespace tfv
                 // Set fps directly on layer or provide a setter method
                 // in the ImGuiLayer class instead of directly accessing private member
                 m_imguiLayer->setFPS(m_fps);
+                m_imguiLayer->setFrameStats(m_scheduler.stats());
             }
 
             return true;
@@ -402,16 +522,138 @@ namespace tfv
         return false;
     }
 
+    bool Engine::startStateRecording(const std::string& path)
+    {
+        if(!m_stateRecorder.start(path))
+            return false;
+        m_sim.setStateListener([this](const SimulationStatePtr& state)
+                               { m_stateRecorder.record(state); });
+        return true;
+    }
+
+    bool Engine::stopStateRecording()
+    {
+        if(!m_stateRecorder.isRecording())
+            return false;
+        m_sim.setStateListener(nullptr);
+        return m_stateRecorder.stop();
+    }
+
+    bool Engine::openReplay(const std::string& path)
+    {
+        if(!m_replay.open(path))
+            return false;
+        m_sim.publishStates(m_replay.before(), m_replay.after());
+        m_dirty = true;
+        return true;
+    }
+
+    void Engine::closeReplay()
+    {
+        m_replay.close();
+    }
+
+    bool Engine::seekReplay(double time)
+    {
+        if(!m_replay.seek(time))
+            return false;
+        m_sim.publishStates(m_replay.before(), m_replay.after());
+        if(m_simulationLayer)
+            m_simulationLayer->setRenderTime(m_replay.time());
+        m_dirty = true;
+        return true;
+    }
+
+    bool Engine::saveCheckpoint(const std::string& path)
+    {
+        if(m_replay.isOpen())
+        {
+            LOG_ERROR("Cannot checkpoint while replaying a state log");
+            return false;
+        }
+        m_checkpointWriter.save(m_sim.checkpoint(), path);
+        return true;
+    }
+
+    bool Engine::loadCheckpoint(const std::string& path)
+    {
+        SimulationCheckpoint checkpoint;
+        if(!readCheckpoint(path, checkpoint))
+            return false;
+        closeReplay();
+        m_sim.restore(checkpoint);
+        if(m_simulationLayer)
+            m_simulationLayer->setRenderTime(checkpoint.state->time);
+        m_simAccumulator = 0.0;
+        m_dirty = true;
+        return true;
+    }
+
+    LiveFeed& Engine::liveFeed()
+    {
+        if(!m_liveFeed)
+        {
+            m_liveFeed = std::make_unique<LiveFeed>(m_sim);
+            m_liveFeed->setStatusCallback([](bool, const std::string& msg)
+                                          { LOG_INFO("[Feed] {msg}", PARAM(msg, msg)); });
+        }
+        return *m_liveFeed;
+    }
+
     bool Engine::connectToFeed(const std::string& url, FeedType type)
     {
-        // Implementation of live feed connection
-        return false;
+        // The handler connects (and reconnects) on its own thread
+        liveFeed().connect(url, type);
+        m_liveFeedEnabled = true;
+        return m_liveFeed->isConnected();
+    }
+
+    uint16_t Engine::addFeedSource(const std::string& url, FeedType type)
+    {
+        const uint16_t source = liveFeed().addSource(url, type);
+        if(source != LiveFeed::kNoSource)
+            m_liveFeedEnabled = true;
+        return source;
+    }
+
+    bool Engine::removeFeedSource(uint16_t source)
+    {
+        return m_liveFeed && m_liveFeed->removeSource(source);
+    }
+
+    std::vector<FeedSourceStatus> Engine::feedSources() const
+    {
+        return m_liveFeed ? m_liveFeed->sources() : std::vector<FeedSourceStatus>{};
+    }
+
+    void Engine::setFeedGeoReference(double lat, double lon, double x, double y,
+                                     double unitsPerMetre)
+    {
+        liveFeed().setGeoReference(GeoReference{lat, lon, x, y, unitsPerMetre});
     }
 
     bool Engine::disconnectFromFeed()
     {
-        // Implementation of live feed disconnection
-        return false;
+        if(!m_liveFeed || !m_liveFeed->isConnected())
+            return false;
+
+        m_liveFeed->disconnect();
+        m_liveFeedEnabled = false;
+        return true;
+    }
+
+    std::size_t Engine::applyVehicleUpdates(const std::vector<VehicleUpdate>& updates)
+    {
+        const std::size_t applied = m_sim.applyUpdates(updates);
+        m_dirty = true;
+        return applied;
+    }
+
+    std::size_t Engine::removeVehicles(const std::vector<uint64_t>& ids)
+    {
+        const std::size_t removed = m_sim.removeVehicles(ids);
+        m_dirty = true;
+        return removed;
     }
 
     void Engine::setAlertCallback(AlertUICallback cb)
@@ -442,6 +684,21 @@ namespace tfv
         }
     }
 
+    void Engine::setFrameMode(FrameMode mode)
+    {
+        m_scheduler.setMode(mode);
+        if(m_renderer)
+            m_renderer->setVSync(mode == FrameMode::VSYNC);
+        m_dirty = true;
+    }
+
+    void Engine::setPaused(bool paused)
+    {
+        m_paused = paused;
+        m_dirty = true;
+        LOG_INFO("Simulation {state}", PARAM(state, paused ? "paused" : "resumed"));
+    }
+
     void Engine::toggleAntiAliasing(bool enable)
     {
         m_antiAliasingEnabled = enable;
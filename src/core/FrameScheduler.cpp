@@ -0,0 +1,91 @@
+#include "core/FrameScheduler.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+namespace tfv
+{
+    FrameScheduler::FrameScheduler()
+    {
+        m_samples.reserve(kWindow);
+        setTargetFps(m_targetFps);
+    }
+
+    void FrameScheduler::setTargetFps(double fps)
+    {
+        m_targetFps = fps > 0.0 ? fps : 60.0;
+        m_period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / m_targetFps));
+    }
+
+    double FrameScheduler::beginFrame()
+    {
+        const auto now = Clock::now();
+        if(!m_started)
+        {
+            m_started = true;
+            m_frameStart = now;
+            m_deadline = now + m_period;
+            return 0.0;
+        }
+
+        double dt = std::chrono::duration<double>(now - m_frameStart).count();
+        m_frameStart = now;
+
+        double ms = dt * 1000.0;
+        if(m_samples.size() < kWindow)
+            m_samples.push_back(ms);
+        else
+            m_samples[m_next] = ms;
+        m_next = (m_next + 1) % kWindow;
+        return dt;
+    }
+
+    void FrameScheduler::endFrame()
+    {
+        if(m_mode != FrameMode::FIXED_FPS && m_mode != FrameMode::ON_DEMAND)
+            return;
+
+        // More than a frame late: start a new schedule instead of rushing to catch up
+        auto now = Clock::now();
+        if(now > m_deadline + m_period)
+            m_deadline = now;
+
+        // Coarse sleep, then spin the last stretch for precision
+        if(m_deadline - now > kSpinMargin)
+            std::this_thread::sleep_until(m_deadline - kSpinMargin);
+        while(Clock::now() < m_deadline)
+            std::this_thread::yield();
+
+        m_deadline += m_period;
+    }
+
+    void FrameScheduler::resetClock()
+    {
+        m_frameStart = Clock::now();
+        m_deadline = m_frameStart + m_period;
+    }
+
+    FrameStats FrameScheduler::stats() const
+    {
+        FrameStats s;
+        s.samples = m_samples.size();
+        if(m_samples.empty())
+            return s;
+
+        std::vector<double> sorted(m_samples);
+        std::sort(sorted.begin(), sorted.end());
+        auto at = [&](double q)
+        {
+            auto i = static_cast<std::size_t>(q * sorted.size());
+            return sorted[std::min(sorted.size() - 1, i)];
+        };
+        s.p50 = at(0.50);
+        s.p95 = at(0.95);
+        s.p99 = at(0.99);
+        s.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+        return s;
+    }
+
+} // namespace tfv
@@ -1,6 +1,7 @@
 #include "core/RoadNetwork.hpp"
 #include "utils/LoggingManager.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <glm/glm.hpp>
@@ -15,20 +16,39 @@ namespace tfv
     // Hash function for pairs - define this before it's used
     struct pair_hash
     {
-        size_t operator()(const std::pair<int, int>& p) const
+        size_t operator()(const std::pair<double, double>& p) const
         {
-            return std::hash<int>()(p.first) ^ std::hash<int>()(p.second);
+            return std::hash<double>()(p.first) ^ (std::hash<double>()(p.second) * 31);
         }
     };
 
     RoadNetwork::RoadNetwork() = default;
 
+    void RoadNetwork::rebuildGeometry()
+    {
+        m_geometry.build(m_seg);
+        const SegmentGeometry& g = m_geometry;
+        m_segmentIndex.buildBoxes(g.x1.data(), g.y1.data(), g.x2.data(), g.y2.data(), g.size());
+    }
+
+    uint32_t RoadNetwork::nearestSegment(float x, float y, float maxDistance) const
+    {
+        const SegmentGeometry& g = m_geometry;
+        uint32_t idx = m_segmentIndex.nearest(
+            x, y, maxDistance,
+            [&](uint32_t i)
+            {
+                // Distance to the closest point on the segment
+                float px = x - g.x1[i], py = y - g.y1[i];
+                float along = std::clamp(px * g.dirX[i] + py * g.dirY[i], 0.f, g.length[i]);
+                return std::hypot(px - along * g.dirX[i], py - along * g.dirY[i]);
+            });
+        return idx != SpatialGrid::kNone ? idx : SegmentGeometry::kInvalidIndex;
+    }
+
     bool RoadNetwork::loadCSV(const std::filesystem::path& path)
     {
-        m_seg.clear();
-        m_adj.clear(); // Initialize adjacency list
-        m_segments.clear();
-        m_nodes.clear();
+        clear();
 
         std::ifstream file(path);
         if(!file.is_open())
@@ -41,77 +61,55 @@ namespace tfv
         std::getline(file, line); // skip header
 
         uint32_t nextNodeId = 1; // Start node IDs at 1
-        std::unordered_map<std::pair<int, int>, uint32_t, pair_hash>
-            nodeMap; // Map positions to node IDs
+        std::unordered_map<std::pair<double, double>, uint32_t, pair_hash>
+            nodeMap; // Map positions to node IDs (end points shared exactly in the file)
 
         // Helper to create a hash for a pair
-        auto makeCoordPair = [](int x, int y) -> std::pair<int, int> { return {x, y}; };
+        auto makeCoordPair = [](double x, double y) -> std::pair<double, double>
+        { return {x, y}; };
 
+        // Nodes go in as they are met; segments are added as one batch at the end, so the
+        // geometry and segment index are built once
+        std::vector<RoadSegment> segments;
         while(std::getline(file, line))
         {
             std::stringstream ss(line);
-            RoadVisual r{};
-            char comma;
-
             uint32_t segId;
-            ss >> segId >> comma >> r.x1 >> comma >> r.y1 >> comma >> r.x2 >> comma >> r.y2;
-            r.id = segId;
-
-            if(ss)
+            double x1, y1, x2, y2;
+            char comma;
+            ss >> segId >> comma >> x1 >> comma >> y1 >> comma >> x2 >> comma >> y2;
+            if(!ss)
+                continue;
+
+            // Create nodes if they don't exist yet
+            uint32_t ends[2];
+            const std::pair<double, double> positions[2] = {makeCoordPair(x1, y1),
+                                                            makeCoordPair(x2, y2)};
+            for(int k = 0; k < 2; ++k)
             {
-                // compute pixel length once
-                float dx = static_cast<float>(r.x2 - r.x1);
-                float dy = static_cast<float>(r.y2 - r.y1);
-                r.length = std::sqrtf(dx * dx + dy * dy);
-                m_seg.emplace_back(r);
-
-                // Create nodes if they don't exist yet
-                auto fromPos = makeCoordPair(r.x1, r.y1);
-                auto toPos = makeCoordPair(r.x2, r.y2);
-
-                if(nodeMap.find(fromPos) == nodeMap.end())
+                auto [it, added] = nodeMap.try_emplace(positions[k], nextNodeId);
+                if(added)
                 {
-                    nodeMap[fromPos] = nextNodeId++;
-
-                    // Create the node entity
                     Node node;
-                    node.id = nodeMap[fromPos];
-                    node.pos = {static_cast<float>(r.x1), static_cast<float>(r.y1)};
-                    m_nodes[node.id] = node;
+                    node.id = nextNodeId++;
+                    node.pos = {positions[k].first, positions[k].second};
+                    addNode(node);
                 }
-
-                if(nodeMap.find(toPos) == nodeMap.end())
-                {
-                    nodeMap[toPos] = nextNodeId++;
-
-                    // Create the node entity
-                    Node node;
-                    node.id = nodeMap[toPos];
-                    node.pos = {static_cast<float>(r.x2), static_cast<float>(r.y2)};
-                    m_nodes[node.id] = node;
-                }
-
-                // Create the road segment entity
-                RoadSegment segment;
-                segment.id = segId;
-                segment.fromNode = nodeMap[fromPos];
-                segment.toNode = nodeMap[toPos];
-                segment.length = r.length;
-
-                // Calculate direction vector
-                segment.dir = glm::normalize(glm::vec2(r.x2 - r.x1, r.y2 - r.y1));
-
-                // Add to segment map
-                m_segments[segId] = segment;
-
-                // Update node's outgoing segments
-                m_nodes[segment.fromNode].outgoing.push_back(segId);
-
-                // Update adjacency list for routing
-                m_adj[r.x1].push_back(r.id);
-                m_adj[r.x2].push_back(r.id);
+                ends[k] = it->second;
             }
+
+            // Create the road segment entity; length in double so far-from-origin
+            // coordinates stay exact
+            RoadSegment segment;
+            segment.id = segId;
+            segment.fromNode = ends[0];
+            segment.toNode = ends[1];
+            segment.length = static_cast<float>(std::hypot(x2 - x1, y2 - y1));
+            segment.dir = glm::vec2(glm::normalize(glm::dvec2(x2 - x1, y2 - y1)));
+            segments.push_back(segment);
         }
+        addSegments(segments);
+
         LOG_INFO("loaded {count} segments from {file}", PARAM(count, m_seg.size()),
                  PARAM(file, path.string()));
         LOG_INFO("created {count} nodes", PARAM(count, m_nodes.size()));
@@ -130,10 +128,16 @@ namespace tfv
         {
             uint32_t n = q.front();
             q.pop();
-            for(uint32_t segId : m_adj.at(n))
+            auto adj = m_adj.find(n);
+            if(adj == m_adj.end())
+                continue;
+            for(uint32_t segId : adj->second)
             {
-                const auto& seg = m_seg[segId];
-                uint32_t nextNode = (seg.x1 == n) ? seg.x2 : seg.x1;
+                const uint32_t idx = m_geometry.indexOf(segId);
+                if(idx == SegmentGeometry::kInvalidIndex)
+                    continue;
+                const auto& seg = m_seg[idx];
+                uint32_t nextNode = (seg.fromNode == n) ? seg.toNode : seg.fromNode;
                 if(!visited.insert(nextNode).second)
                     continue;
                 prevSeg[nextNode] = segId;
@@ -145,8 +149,8 @@ namespace tfv
                     {
                         uint32_t id = prevSeg[cur];
                         route.push_back(id);
-                        const auto& s = m_seg[id];
-                        cur = (s.x1 == cur) ? s.x2 : s.x1;
+                        const auto& s = m_seg[m_geometry.indexOf(id)];
+                        cur = (s.fromNode == cur) ? s.toNode : s.fromNode;
                     }
                     std::reverse(route.begin(), route.end());
                     return route;
@@ -208,16 +212,30 @@ namespace tfv
         return ids;
     }
 
-    void RoadNetwork::addSegment(const RoadSegment& segment)
+    void RoadNetwork::addSegments(std::span<const RoadSegment> segments)
+    {
+        bool added = false;
+        for(const auto& segment : segments)
+            added |= insertSegment(segment);
+        if(added)
+            rebuildGeometry();
+    }
+
+    bool RoadNetwork::insertSegment(const RoadSegment& segment)
     {
         m_segments[segment.id] = segment;
 
-        // Update the node's outgoing list
+        // Update the end nodes' segment lists
         auto* fromNode = getNode(segment.fromNode);
         if(fromNode)
         {
             fromNode->outgoing.push_back(segment.id);
         }
+        auto* toNode = getNode(segment.toNode);
+        if(toNode)
+        {
+            toNode->incoming.push_back(segment.id);
+        }
 
         // Create visual segment
         RoadVisual vis;
@@ -227,20 +245,23 @@ namespace tfv
         const auto* fromNodeConst = getNode(segment.fromNode);
         const auto* toNodeConst = getNode(segment.toNode);
 
-        if(fromNodeConst && toNodeConst)
-        {
-            vis.x1 = static_cast<int>(fromNodeConst->pos.x);
-            vis.y1 = static_cast<int>(fromNodeConst->pos.y);
-            vis.x2 = static_cast<int>(toNodeConst->pos.x);
-            vis.y2 = static_cast<int>(toNodeConst->pos.y);
-            vis.length = segment.length;
+        if(!fromNodeConst || !toNodeConst)
+            return false;
 
-            m_seg.push_back(vis);
+        vis.x1 = fromNodeConst->pos.x;
+        vis.y1 = fromNodeConst->pos.y;
+        vis.x2 = toNodeConst->pos.x;
+        vis.y2 = toNodeConst->pos.y;
+        vis.length = segment.length;
+        vis.fromNode = segment.fromNode;
+        vis.toNode = segment.toNode;
 
-            // Update adjacency list for routing
-            m_adj[vis.x1].push_back(vis.id);
-            m_adj[vis.x2].push_back(vis.id);
-        }
+        m_seg.push_back(vis);
+
+        // Update adjacency list for routing
+        m_adj[vis.fromNode].push_back(vis.id);
+        m_adj[vis.toNode].push_back(vis.id);
+        return true;
     }
 
     void RoadNetwork::addNode(const Node& node)
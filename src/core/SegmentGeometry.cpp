@@ -0,0 +1,108 @@
+#include "core/SegmentGeometry.hpp"
+#include "core/RoadNetwork.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace tfv
+{
+    void SegmentGeometry::build(const std::vector<RoadVisual>& segments)
+    {
+        clear();
+        const std::size_t n = segments.size();
+        for(auto* v : {&x1, &y1, &x2, &y2, &dirX, &dirY, &normX, &normY, &length})
+            v->resize(n);
+        ids.resize(n);
+        offset.resize(n + 1);
+
+        // Local origin at the centre of the bounds
+        if(n > 0)
+        {
+            std::tie(minX, maxX) = std::minmax({segments[0].x1, segments[0].x2});
+            std::tie(minY, maxY) = std::minmax({segments[0].y1, segments[0].y2});
+            for(const auto& s : segments)
+            {
+                minX = std::min({minX, s.x1, s.x2});
+                maxX = std::max({maxX, s.x1, s.x2});
+                minY = std::min({minY, s.y1, s.y2});
+                maxY = std::max({maxY, s.y1, s.y2});
+            }
+            originX = (minX + maxX) * 0.5;
+            originY = (minY + maxY) * 0.5;
+        }
+
+        uint32_t maxId = 0;
+        float cumulative = 0.f;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            const auto& s = segments[i];
+            ids[i] = s.id;
+            maxId = std::max(maxId, s.id);
+
+            x1[i] = static_cast<float>(s.x1 - originX);
+            y1[i] = static_cast<float>(s.y1 - originY);
+            x2[i] = static_cast<float>(s.x2 - originX);
+            y2[i] = static_cast<float>(s.y2 - originY);
+
+            // Direction and length from the double end points, before any rounding
+            const double dx = s.x2 - s.x1, dy = s.y2 - s.y1;
+            const double len = std::sqrt(dx * dx + dy * dy);
+            const double inv = len > 0.0 ? 1.0 / len : 0.0;
+            dirX[i] = static_cast<float>(dx * inv);
+            dirY[i] = static_cast<float>(dy * inv);
+            normX[i] = -dirY[i];
+            normY[i] = dirX[i];
+            length[i] = static_cast<float>(len);
+
+            offset[i] = cumulative;
+            cumulative += length[i];
+        }
+        offset[n] = cumulative;
+
+        // Flat id table unless ids are very sparse
+        if(n > 0 && maxId < 4 * n + 1024)
+        {
+            m_denseIds.assign(static_cast<std::size_t>(maxId) + 1, kInvalidIndex);
+            for(std::size_t i = 0; i < n; ++i)
+                m_denseIds[ids[i]] = static_cast<uint32_t>(i);
+        }
+        else
+        {
+            m_sparseIds.reserve(n);
+            for(std::size_t i = 0; i < n; ++i)
+                m_sparseIds[ids[i]] = static_cast<uint32_t>(i);
+        }
+    }
+
+    void SegmentGeometry::clear()
+    {
+        for(auto* v : {&x1, &y1, &x2, &y2, &dirX, &dirY, &normX, &normY, &length, &offset})
+            v->clear();
+        ids.clear();
+        originX = originY = 0.0;
+        minX = minY = maxX = maxY = 0.0;
+        m_denseIds.clear();
+        m_sparseIds.clear();
+    }
+
+    void SegmentGeometry::positions(const uint32_t* __restrict idx, const float* __restrict t,
+                                    std::size_t count, float* __restrict outX,
+                                    float* __restrict outY) const
+    {
+        const float* __restrict px = x1.data();
+        const float* __restrict py = y1.data();
+        const float* __restrict ux = dirX.data();
+        const float* __restrict uy = dirY.data();
+        const float* __restrict len = length.data();
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const uint32_t s = idx[i];
+            const float d = t[i] * len[s];
+            outX[i] = px[s] + d * ux[s];
+            outY[i] = py[s] + d * uy[s];
+        }
+    }
+
+} // namespace tfv
@@ -1,9 +1,13 @@
 #include "core/Simulation.hpp"
+#include "core/Checkpoint.hpp"
+#include "core/SimulationForks.hpp"
+#include "core/VehicleDynamics.hpp"
 #include "utils/LoggingManager.hpp"
 #include <algorithm>
 #include <data/CSVLoader.hpp>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <limits>
 #include <unordered_set>
 
 namespace tfv
@@ -15,6 +19,10 @@ namespace tfv
         m_alertThresholds[AlertType::SPEED_VIOLATION] = 1.5f;  // 50% over limit
         m_alertThresholds[AlertType::UNUSUAL_SLOWDOWN] = 0.5f; // 50% below average
         m_alertThresholds[AlertType::INCIDENT] = 0.8f;         // 80% drop in speed
+
+        // Start with an empty state so readers never see null
+        auto empty = std::make_shared<const SimulationState>();
+        m_published = {empty, empty};
     }
 
     bool Simulation::initialize(const std::filesystem::path& cityInformationPath,
@@ -23,9 +31,12 @@ namespace tfv
         std::scoped_lock lock(m_mtx);
         // Clear previous data
         m_vehicles.clear();
+        m_reorder = true;
         m_segmentStats.clear();
         m_speedLimits.clear();
         m_timeSinceLastUpdate = 0.0;
+        m_time = 0.0;
+        m_tick = 0;
 
         // Load road network
         if(!m_roadNetwork)
@@ -68,6 +79,10 @@ namespace tfv
 
         LOG_INFO("Initialized {count} vehicles in the simulation.", PARAM(count, vehicles.size()));
 
+        // Publish twice so previous and current both hold the initial state
+        publishState();
+        publishState();
+
         return true;
     }
 
@@ -77,6 +92,8 @@ namespace tfv
 
         // Update time since last statistics update
         m_timeSinceLastUpdate += dt;
+        m_time += dt;
+        ++m_tick;
 
         // Update vehicle positions
         for(auto& [id, v] : m_vehicles)
@@ -89,44 +106,9 @@ namespace tfv
             if(!segment)
                 continue;
 
-            // Adjust speed based on congestion
-            float speedFactor = 1.0f - segment->congestionLevel * 0.8f;
-
-            // Move vehicle along its segment by its velocity's magnitude
-            float speed = glm::length(v.vel) * speedFactor;
-            float distance = speed * static_cast<float>(dt);
-            float prevPosition = v.position;
-            v.position += distance / segment->length; // position is 0..1 along segment
-
-            // If vehicle passes end of segment, move to next segment
-            if(v.position > 1.f)
-            {
-                if(m_roadNetwork)
-                {
-                    // Get the next segment from the road network
-                    const auto* fromNode = m_roadNetwork->getNode(segment->toNode);
-                    if(fromNode && !fromNode->outgoing.empty())
-                    {
-                        // Choose a random outgoing segment
-                        size_t nextIdx = rand() % fromNode->outgoing.size();
-                        uint32_t nextSegmentId = fromNode->outgoing[nextIdx];
-
-                        // Update the vehicle's segment and reset position
-                        v.segmentId = nextSegmentId;
-                        v.position = v.position - 1.f; // Carry over extra distance
-                    }
-                    else
-                    {
-                        // No outgoing segments, loop back to beginning
-                        v.position -= 1.f;
-                    }
-                }
-                else
-                {
-                    // No road network, simple loop for demo
-                    v.position -= 1.f;
-                }
-            }
+            // Move along the segment (and onto the next one past its end)
+            float speed = dynamics::advance(v, *segment, segment->congestionLevel,
+                                            *m_roadNetwork, m_seed, m_tick, dt);
 
             // Record current speed for segment statistics
             segment->currentSpeed = speed;
@@ -173,6 +155,8 @@ namespace tfv
 
             m_timeSinceLastUpdate = 0.0;
         }
+
+        publishState();
     }
 
     VehicleMap Simulation::snapshot() const
@@ -181,12 +165,290 @@ namespace tfv
         return m_vehicles; // copy
     }
 
+    SimulationStatePtr Simulation::currentState() const
+    {
+        std::scoped_lock lock(m_publishMtx);
+        return m_published.current;
+    }
+
+    PublishedStates Simulation::publishedStates() const
+    {
+        std::scoped_lock lock(m_publishMtx);
+        return m_published;
+    }
+
+    double Simulation::time() const
+    {
+        std::scoped_lock lock(m_mtx);
+        return m_time;
+    }
+
+    void Simulation::publishState()
+    {
+        auto state = std::make_shared<SimulationState>();
+        state->tick = m_tick;
+        state->time = m_time;
+        state->vehicles.reserve(m_vehicles.size());
+
+        // Sorted by id so consumers can merge-join consecutive states. The previous state is
+        // sorted already: keep its order, skipping vehicles that left and merging in the few
+        // that arrived, and sort everything only when there is no usable order
+        const SimulationStatePtr previous = currentState();
+        if(!m_reorder)
+        {
+            std::sort(m_added.begin(), m_added.end());
+            m_added.erase(std::unique(m_added.begin(), m_added.end()), m_added.end());
+            const auto push = [&](uint64_t id)
+            {
+                auto it = m_vehicles.find(id);
+                if(it != m_vehicles.end())
+                    state->vehicles.push_back(it->second);
+            };
+            auto added = m_added.cbegin();
+            for(const Vehicle& old : previous->vehicles)
+            {
+                while(added != m_added.cend() && *added < old.id)
+                    push(*added++);
+                if(added != m_added.cend() && *added == old.id)
+                    ++added; // Removed and added again: already listed
+                push(old.id);
+            }
+            while(added != m_added.cend())
+                push(*added++);
+        }
+        if(m_reorder || state->vehicles.size() != m_vehicles.size())
+        {
+            state->vehicles.clear();
+            for(const auto& [id, v] : m_vehicles)
+                state->vehicles.push_back(v);
+            std::sort(state->vehicles.begin(), state->vehicles.end(),
+                      [](const Vehicle& a, const Vehicle& b) { return a.id < b.id; });
+        }
+        m_added.clear();
+        m_reorder = false;
+
+        // Congestion as a dense array aligned with the segment geometry, kept that way by
+        // setCongestion()
+        if(m_roadNetwork)
+        {
+            m_congestion.resize(m_roadNetwork->geometry().size(), 0.0f);
+            state->congestion = m_congestion;
+        }
+        indexState(*state, previous.get());
+        m_unpublished = false;
+
+        if(m_stateListener)
+            m_stateListener(state);
+
+        std::scoped_lock lock(m_publishMtx);
+        m_published.previous = std::move(m_published.current);
+        m_published.current = std::move(state);
+    }
+
+    void Simulation::indexState(SimulationState& state, const SimulationState* previous) const
+    {
+        if(!m_roadNetwork)
+            return;
+
+        // Tick positions plus a point grid, built before publishing so a pick on the render
+        // thread only searches
+        const SegmentGeometry& geom = m_roadNetwork->geometry();
+        const std::size_t count = state.vehicles.size();
+        state.x.resize(count);
+        state.y.resize(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const Vehicle& v = state.vehicles[i];
+            const uint32_t idx = geom.indexOf(v.segmentId);
+            if(idx == SegmentGeometry::kInvalidIndex)
+            {
+                state.x[i] = state.y[i] = std::numeric_limits<float>::quiet_NaN();
+                continue;
+            }
+            geom.pointAt(idx, std::clamp(v.position, 0.f, 1.f), state.x[i], state.y[i]);
+        }
+        state.vehicleIndex.buildPoints(state.x.data(), state.y.data(), count);
+
+        // Path length since the previous tick, measured as the renderer interpolates it
+        state.maxStep = 0.0f;
+        if(!previous)
+            return;
+        auto prevIt = previous->vehicles.begin();
+        const auto prevEnd = previous->vehicles.end();
+        for(const Vehicle& v : state.vehicles)
+        {
+            while(prevIt != prevEnd && prevIt->id < v.id)
+                ++prevIt;
+            if(prevIt == prevEnd || prevIt->id != v.id)
+                continue;
+            const uint32_t idx = geom.indexOf(v.segmentId);
+            if(idx == SegmentGeometry::kInvalidIndex)
+                continue;
+            float step;
+            if(prevIt->segmentId == v.segmentId && v.position >= prevIt->position)
+            {
+                step = (v.position - prevIt->position) * geom.length[idx];
+            }
+            else
+            {
+                const uint32_t prevIdx = geom.indexOf(prevIt->segmentId);
+                const float prevLen =
+                    prevIdx != SegmentGeometry::kInvalidIndex ? geom.length[prevIdx] : 0.f;
+                step = (1.f - std::min(prevIt->position, 1.f)) * prevLen +
+                       v.position * geom.length[idx];
+            }
+            state.maxStep = std::max(state.maxStep, step);
+        }
+    }
+
+    void Simulation::publishStates(const std::shared_ptr<SimulationState>& previous,
+                                   const std::shared_ptr<SimulationState>& current)
+    {
+        if(!previous || !current)
+            return;
+
+        // A replayed state is indexed once, the first time it is published
+        if(previous->x.size() != previous->vehicles.size())
+            indexState(*previous, nullptr);
+        if(current->x.size() != current->vehicles.size())
+            indexState(*current, previous.get());
+
+        {
+            std::scoped_lock lock(m_mtx);
+            m_time = current->time;
+            m_tick = current->tick;
+            m_reorder = true; // The published order is the replay's now
+        }
+        std::scoped_lock lock(m_publishMtx);
+        m_published = {previous, current};
+    }
+
+    SimulationCheckpoint Simulation::checkpoint()
+    {
+        std::scoped_lock lock(m_mtx);
+
+        // The published state must hold exactly the current vehicles
+        if(m_unpublished)
+            publishState();
+
+        SimulationCheckpoint c;
+        c.state = currentState();
+        c.seed = m_seed;
+        c.statUpdateInterval = m_statUpdateInterval;
+        c.timeSinceStatUpdate = m_timeSinceLastUpdate;
+        c.segmentStats = m_segmentStats;
+        c.speedLimits = m_speedLimits;
+        c.alertThresholds = m_alertThresholds;
+        if(m_roadNetwork)
+        {
+            const auto ids = m_roadNetwork->getSegmentIds();
+            c.segments.reserve(ids.size());
+            for(uint32_t id : ids)
+            {
+                const RoadSegment* segment = m_roadNetwork->getSegment(id);
+                c.segments.push_back({id, segment->vehicleCount, segment->congestionLevel,
+                                      segment->currentSpeed});
+            }
+        }
+        return c;
+    }
+
+    void Simulation::restore(const SimulationCheckpoint& checkpoint)
+    {
+        if(!checkpoint.state)
+            return;
+
+        std::scoped_lock lock(m_mtx);
+        m_vehicles.clear();
+        m_reorder = true;
+        m_vehicles.reserve(checkpoint.state->vehicles.size());
+        for(const Vehicle& v : checkpoint.state->vehicles)
+            m_vehicles.emplace(v.id, v);
+
+        m_seed = checkpoint.seed;
+        m_statUpdateInterval = checkpoint.statUpdateInterval;
+        m_timeSinceLastUpdate = checkpoint.timeSinceStatUpdate;
+        m_segmentStats = checkpoint.segmentStats;
+        m_speedLimits = checkpoint.speedLimits;
+        m_alertThresholds = checkpoint.alertThresholds;
+        m_time = checkpoint.state->time;
+        m_tick = checkpoint.state->tick;
+
+        if(m_roadNetwork)
+        {
+            std::size_t unknown = 0;
+            for(const SegmentCheckpoint& s : checkpoint.segments)
+            {
+                RoadSegment* segment = m_roadNetwork->getSegment(s.id);
+                if(!segment)
+                {
+                    ++unknown;
+                    continue;
+                }
+                segment->vehicleCount = s.vehicleCount;
+                setCongestion(*segment, s.congestionLevel);
+                segment->currentSpeed = s.currentSpeed;
+            }
+            if(unknown > 0)
+                LOG_ERROR("Checkpoint names {count} segments missing from the road network",
+                          PARAM(count, unknown));
+        }
+
+        LOG_INFO("Restored {count} vehicles at tick {tick}", PARAM(count, m_vehicles.size()),
+                 PARAM(tick, m_tick));
+
+        // Publish twice so previous and current both hold the restored state
+        publishState();
+        publishState();
+    }
+
+    std::unique_ptr<SimulationForks> Simulation::fork(std::size_t variants, std::size_t threads)
+    {
+        if(!m_roadNetwork)
+            return nullptr;
+        return std::make_unique<SimulationForks>(checkpoint(), *m_roadNetwork, variants,
+                                                 threads);
+    }
+
+    void Simulation::setSeed(uint64_t seed)
+    {
+        std::scoped_lock lock(m_mtx);
+        m_seed = seed;
+    }
+
+    uint64_t Simulation::seed() const
+    {
+        std::scoped_lock lock(m_mtx);
+        return m_seed;
+    }
+
+    void Simulation::setStateListener(StateListener listener)
+    {
+        std::scoped_lock lock(m_mtx);
+        m_stateListener = std::move(listener);
+    }
+
     SegmentStatsMap Simulation::getSegmentStats() const
     {
         std::scoped_lock lock(m_mtx);
         return m_segmentStats; // copy
     }
 
+    bool Simulation::inspectSegment(uint32_t segmentId, RoadSegment& segment,
+                                    SegmentStatistics& stats) const
+    {
+        std::scoped_lock lock(m_mtx);
+        if(!m_roadNetwork)
+            return false;
+        const RoadSegment* live = m_roadNetwork->getSegment(segmentId);
+        if(!live)
+            return false;
+        segment = *live;
+        auto it = m_segmentStats.find(segmentId);
+        stats = it != m_segmentStats.end() ? it->second : SegmentStatistics{};
+        return true;
+    }
+
     std::unordered_map<uint32_t, float> Simulation::getCongestionLevels() const
     {
         std::scoped_lock lock(m_mtx);
@@ -212,6 +474,8 @@ namespace tfv
         std::scoped_lock lock(m_mtx);
         LOG_DEBUG("Adding vehicle {id}", PARAM(id, v.id));
         m_vehicles[v.id] = v;
+        m_added.push_back(v.id);
+        m_unpublished = true;
 
         // Update congestion for the segment
         if(m_roadNetwork)
@@ -244,6 +508,99 @@ namespace tfv
         }
 
         m_vehicles.erase(id);
+        m_unpublished = true;
+    }
+
+    std::size_t Simulation::applyUpdates(std::span<const VehicleUpdate> updates)
+    {
+        std::scoped_lock lock(m_mtx);
+        LOG_DEBUG("Applying {count} vehicle updates", PARAM(count, updates.size()));
+
+        std::size_t applied = 0;
+        for(const auto& update : updates)
+        {
+            if(update.kind == UpdateKind::REMOVE)
+            {
+                applied += eraseVehicle(update.id) ? 1 : 0;
+                continue;
+            }
+            if(!update.matched())
+                continue;
+
+            auto [it, inserted] = m_vehicles.try_emplace(update.id);
+            Vehicle& vehicle = it->second;
+            if(inserted)
+            {
+                m_added.push_back(update.id);
+                vehicle.id = update.id;
+                vehicle.acc = glm::vec2(0.0f, 0.0f);
+                adjustOccupancy(update.segmentId, +1);
+            }
+            else if(vehicle.segmentId != update.segmentId)
+            {
+                adjustOccupancy(vehicle.segmentId, -1);
+                adjustOccupancy(update.segmentId, +1);
+            }
+
+            vehicle.segmentId = update.segmentId;
+            vehicle.position = update.position;
+            const RoadSegment* segment =
+                m_roadNetwork ? m_roadNetwork->getSegment(update.segmentId) : nullptr;
+            vehicle.vel = segment ? segment->dir * update.speed : glm::vec2(update.speed, 0.0f);
+            ++applied;
+        }
+
+        updateTouchedCongestion();
+        if(applied > 0)
+            m_unpublished = true;
+        return applied;
+    }
+
+    std::size_t Simulation::removeVehicles(std::span<const uint64_t> ids)
+    {
+        std::scoped_lock lock(m_mtx);
+        LOG_DEBUG("Removing {count} vehicles", PARAM(count, ids.size()));
+
+        std::size_t removed = 0;
+        for(uint64_t id : ids)
+            removed += eraseVehicle(id) ? 1 : 0;
+
+        updateTouchedCongestion();
+        if(removed > 0)
+            m_unpublished = true;
+        return removed;
+    }
+
+    void Simulation::adjustOccupancy(uint32_t segmentId, int delta)
+    {
+        RoadSegment* segment = m_roadNetwork ? m_roadNetwork->getSegment(segmentId) : nullptr;
+        if(!segment)
+            return;
+        if(delta < 0 && segment->vehicleCount == 0)
+            return;
+
+        segment->vehicleCount += delta;
+        m_touchedSegments.push_back(segmentId);
+    }
+
+    bool Simulation::eraseVehicle(uint64_t id)
+    {
+        auto it = m_vehicles.find(id);
+        if(it == m_vehicles.end())
+            return false;
+
+        adjustOccupancy(it->second.segmentId, -1);
+        m_vehicles.erase(it);
+        return true;
+    }
+
+    void Simulation::updateTouchedCongestion()
+    {
+        std::sort(m_touchedSegments.begin(), m_touchedSegments.end());
+        const auto last = std::unique(m_touchedSegments.begin(), m_touchedSegments.end());
+        for(auto it = m_touchedSegments.begin(); it != last; ++it)
+            updateCongestion(*it);
+        m_touchedSegments.clear();
     }
 
     void Simulation::setSpeedLimit(uint32_t segmentId, float limit)
@@ -282,14 +639,19 @@ namespace tfv
             return;
 
         // Simple congestion model: vehicle count / segment length
-        float capacity = segment->length / 10.0f; // 1 vehicle per 10 meters at max capacity
-        float congestionLevel = static_cast<float>(segment->vehicleCount) / capacity;
-
-        // Clamp to 0-1 range
-        congestionLevel = std::max(0.0f, std::min(congestionLevel, 1.0f));
+        setCongestion(*segment, dynamics::congestion(segment->vehicleCount, segment->length));
+    }
 
-        // Update segment congestion level
-        segment->congestionLevel = congestionLevel;
+    void Simulation::setCongestion(RoadSegment& segment, float level)
+    {
+        segment.congestionLevel = level;
+        const SegmentGeometry& geom = m_roadNetwork->geometry();
+        const uint32_t idx = geom.indexOf(segment.id);
+        if(idx == SegmentGeometry::kInvalidIndex)
+            return;
+        if(m_congestion.size() != geom.size())
+            m_congestion.resize(geom.size(), 0.0f);
+        m_congestion[idx] = level;
     }
 
     void Simulation::checkAlerts()
@@ -0,0 +1,410 @@
+#include "core/SimulationForks.hpp"
+#include "core/VehicleDynamics.hpp"
+#include "utils/LoggingManager.hpp"
+
+#include <algorithm>
+
+namespace tfv
+{
+    namespace
+    {
+        // Baseline vehicles are moved in chunks of this many across the pool
+        constexpr std::size_t kStepChunk = 4096;
+
+        bool sameVehicle(const Vehicle& a, const Vehicle& b)
+        {
+            return a.segmentId == b.segmentId && a.position == b.position && a.vel == b.vel &&
+                   a.acc == b.acc && a.length == b.length && a.width == b.width &&
+                   a.type == b.type;
+        }
+    } // namespace
+
+    SimulationForks::SimulationForks(const SimulationCheckpoint& checkpoint,
+                                     const RoadNetwork& network, std::size_t variants,
+                                     std::size_t threads)
+        : m_network(network), m_base(checkpoint.state), m_stats(checkpoint.segmentStats),
+          m_seed(checkpoint.seed), m_statUpdateInterval(checkpoint.statUpdateInterval),
+          m_timeSinceStatUpdate(checkpoint.timeSinceStatUpdate), m_variants(variants),
+          m_pool(threads)
+    {
+        if(!m_base)
+            m_base = std::make_shared<const SimulationState>();
+        m_segments.reserve(checkpoint.segments.size());
+        for(const SegmentCheckpoint& segment : checkpoint.segments)
+            m_segments.emplace(segment.id, segment);
+
+        LOG_INFO("Forked {variants} variants of {count} vehicles at tick {tick}",
+                 PARAM(variants, variants), PARAM(count, m_base->vehicles.size()),
+                 PARAM(tick, m_base->tick));
+    }
+
+    float SimulationForks::baseCongestion(uint32_t segmentId) const
+    {
+        auto it = m_segments.find(segmentId);
+        return it != m_segments.end() ? it->second.congestionLevel : 0.0f;
+    }
+
+    int SimulationForks::baseVehicleCount(uint32_t segmentId) const
+    {
+        auto it = m_segments.find(segmentId);
+        return it != m_segments.end() ? it->second.vehicleCount : 0;
+    }
+
+    float SimulationForks::congestion(const Variant& variant, uint32_t segmentId) const
+    {
+        auto it = variant.vehicleCounts.find(segmentId);
+        if(it == variant.vehicleCounts.end())
+            return baseCongestion(segmentId);
+        const RoadSegment* segment = m_network.getSegment(segmentId);
+        return segment ? dynamics::congestion(it->second, segment->length) : 0.0f;
+    }
+
+    void SimulationForks::adjustVehicleCount(Variant& variant, uint32_t segmentId, int delta)
+    {
+        if(!m_network.getSegment(segmentId))
+            return;
+
+        // Same bookkeeping as Simulation::addVehicle/removeVehicle
+        auto it = variant.vehicleCounts.find(segmentId);
+        int count = it != variant.vehicleCounts.end() ? it->second : baseVehicleCount(segmentId);
+        if(delta < 0 && count == 0)
+            return;
+        count += delta;
+
+        if(count == baseVehicleCount(segmentId))
+            variant.vehicleCounts.erase(segmentId);
+        else
+            variant.vehicleCounts[segmentId] = count;
+        updateAffected(variant);
+    }
+
+    void SimulationForks::updateAffected(Variant& variant) const
+    {
+        variant.affected.clear();
+        for(const auto& [segmentId, count] : variant.vehicleCounts)
+        {
+            if(congestion(variant, segmentId) != baseCongestion(segmentId))
+                variant.affected.insert(segmentId);
+        }
+
+        // A closure changes the choices of every vehicle arriving at its start node
+        for(uint32_t segmentId : variant.closed)
+        {
+            const RoadSegment* segment = m_network.getSegment(segmentId);
+            const Node* node = segment ? m_network.getNode(segment->fromNode) : nullptr;
+            if(node)
+                variant.affected.insert(node->incoming.begin(), node->incoming.end());
+        }
+    }
+
+    void SimulationForks::closeSegment(std::size_t variant, uint32_t segmentId)
+    {
+        if(variant >= m_variants.size())
+            return;
+        m_variants[variant].closed.insert(segmentId);
+        updateAffected(m_variants[variant]);
+    }
+
+    void SimulationForks::reopenSegment(std::size_t variant, uint32_t segmentId)
+    {
+        if(variant >= m_variants.size())
+            return;
+        m_variants[variant].closed.erase(segmentId);
+        updateAffected(m_variants[variant]);
+    }
+
+    void SimulationForks::addVehicle(std::size_t variant, const Vehicle& vehicle)
+    {
+        if(variant >= m_variants.size())
+            return;
+        Variant& v = m_variants[variant];
+        v.vehicles[vehicle.id] = vehicle;
+        adjustVehicleCount(v, vehicle.segmentId, 1);
+    }
+
+    void SimulationForks::removeVehicle(std::size_t variant, uint64_t id)
+    {
+        if(variant >= m_variants.size())
+            return;
+        Variant& v = m_variants[variant];
+
+        const Vehicle* base = m_base->findVehicle(id);
+        auto it = v.vehicles.find(id);
+        const Vehicle* current = it == v.vehicles.end() ? base
+                                 : it->second        ? &*it->second
+                                                     : nullptr;
+        if(!current)
+            return;
+
+        const uint32_t segmentId = current->segmentId;
+        if(base)
+            v.vehicles[id] = std::nullopt;
+        else
+            v.vehicles.erase(it);
+        adjustVehicleCount(v, segmentId, -1);
+    }
+
+    void SimulationForks::advance(const Variant& variant, Vehicle& v, double dt) const
+    {
+        const RoadSegment* segment = m_network.getSegment(v.segmentId);
+        if(!segment)
+            return;
+        dynamics::advance(v, *segment, congestion(variant, v.segmentId), m_network, m_seed,
+                          m_base->tick, dt,
+                          [&](uint32_t next) { return !variant.closed.contains(next); });
+    }
+
+    void SimulationForks::step(double dt)
+    {
+        const SimulationStatePtr previous = m_base;
+
+        // The baseline: every vehicle moves, so it is the one full copy per step
+        auto next = std::make_shared<SimulationState>();
+        next->tick = previous->tick + 1;
+        next->time = previous->time + dt;
+        next->vehicles = previous->vehicles;
+        const std::size_t chunks = (next->vehicles.size() + kStepChunk - 1) / kStepChunk;
+        m_pool.run(chunks,
+                   [&](std::size_t chunk)
+                   {
+                       const std::size_t end =
+                           std::min(next->vehicles.size(), (chunk + 1) * kStepChunk);
+                       for(std::size_t i = chunk * kStepChunk; i < end; ++i)
+                       {
+                           Vehicle& v = next->vehicles[i];
+                           const RoadSegment* segment = m_network.getSegment(v.segmentId);
+                           if(segment)
+                               dynamics::advance(v, *segment, baseCongestion(v.segmentId),
+                                                 m_network, m_seed, next->tick, dt);
+                       }
+                   });
+        m_base = next;
+
+        m_timeSinceStatUpdate += dt;
+        const bool statsTick = m_timeSinceStatUpdate >= m_statUpdateInterval;
+        m_samples.clear();
+        if(statsTick)
+        {
+            for(const Vehicle& v : next->vehicles)
+            {
+                Sample& sample = m_samples[v.segmentId];
+                ++sample.count;
+                sample.speedSum += glm::length(v.vel);
+            }
+        }
+
+        // Index the previous baseline only on the segments some variant has to re-simulate
+        std::unordered_set<uint32_t> affected;
+        for(const Variant& variant : m_variants)
+            affected.insert(variant.affected.begin(), variant.affected.end());
+        m_bySegment.clear();
+        if(!affected.empty())
+        {
+            for(std::size_t i = 0; i < previous->vehicles.size(); ++i)
+            {
+                const uint32_t segmentId = previous->vehicles[i].segmentId;
+                if(affected.contains(segmentId))
+                    m_bySegment[segmentId].push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        m_pool.run(m_variants.size(), [&](std::size_t k)
+                   { stepVariant(m_variants[k], *previous, dt, statsTick); });
+
+        if(!statsTick)
+            return;
+
+        // Same order as Simulation::update: congestion first, then the new sample
+        bool congestionChanged = false;
+        for(const auto& [segmentId, sample] : m_samples)
+        {
+            auto segment = m_segments.find(segmentId);
+            const RoadSegment* geometry = m_network.getSegment(segmentId);
+            if(segment != m_segments.end() && geometry)
+            {
+                const float level =
+                    dynamics::congestion(segment->second.vehicleCount, geometry->length);
+                congestionChanged |= level != segment->second.congestionLevel;
+                segment->second.congestionLevel = level;
+            }
+            m_stats[segmentId].addSample(sample.speedSum / sample.count, sample.count);
+        }
+        if(congestionChanged)
+        {
+            for(Variant& variant : m_variants)
+                updateAffected(variant);
+        }
+        m_timeSinceStatUpdate = 0.0;
+    }
+
+    void SimulationForks::stepVariant(Variant& variant, const SimulationState& previous,
+                                      double dt, bool statsTick)
+    {
+        const SimulationState& next = *m_base;
+        std::unordered_map<uint64_t, std::optional<Vehicle>> vehicles;
+        vehicles.reserve(variant.vehicles.size());
+
+        // Vehicles already diverged move under the variant's inputs; any that end up back in
+        // step with the baseline are dropped
+        for(const auto& [id, stored] : variant.vehicles)
+        {
+            if(!stored)
+            {
+                vehicles.emplace(id, std::nullopt);
+                continue;
+            }
+            Vehicle v = *stored;
+            advance(variant, v, dt);
+            const Vehicle* base = next.findVehicle(id);
+            if(!base || !sameVehicle(*base, v))
+                vehicles.emplace(id, v);
+        }
+
+        // Baseline vehicles on segments where the variant differs may diverge now
+        for(uint32_t segmentId : variant.affected)
+        {
+            auto indices = m_bySegment.find(segmentId);
+            if(indices == m_bySegment.end())
+                continue;
+            for(uint32_t i : indices->second)
+            {
+                const Vehicle& base = previous.vehicles[i];
+                if(variant.vehicles.contains(base.id))
+                    continue;
+                Vehicle v = base;
+                advance(variant, v, dt);
+                if(!sameVehicle(next.vehicles[i], v))
+                    vehicles.emplace(base.id, v);
+            }
+        }
+        variant.vehicles = std::move(vehicles);
+
+        if(statsTick)
+            sampleVariant(variant);
+    }
+
+    void SimulationForks::sampleVariant(Variant& variant) const
+    {
+        // How the variant's sample differs from the baseline's, per segment; in double so
+        // contributions that cancel out cancel exactly
+        struct Adjustment
+        {
+            int count{0};
+            double speedSum{0.0};
+        };
+        std::unordered_map<uint32_t, Adjustment> adjust;
+        for(const auto& [id, v] : variant.vehicles)
+        {
+            if(const Vehicle* base = m_base->findVehicle(id))
+            {
+                Adjustment& a = adjust[base->segmentId];
+                --a.count;
+                a.speedSum -= glm::length(base->vel);
+            }
+            if(v)
+            {
+                Adjustment& a = adjust[v->segmentId];
+                ++a.count;
+                a.speedSum += glm::length(v->vel);
+            }
+        }
+
+        // A segment's history is copied from the baseline the first time it is touched
+        for(const auto& [segmentId, a] : adjust)
+        {
+            if(!variant.stats.contains(segmentId))
+            {
+                auto base = m_stats.find(segmentId);
+                variant.stats.emplace(segmentId, base != m_stats.end() ? base->second
+                                                                       : SegmentStatistics{});
+            }
+        }
+
+        for(auto& [segmentId, stats] : variant.stats)
+        {
+            auto base = m_samples.find(segmentId);
+            const Sample sample = base != m_samples.end() ? base->second : Sample{};
+            auto a = adjust.find(segmentId);
+            if(a == adjust.end() || (a->second.count == 0 && a->second.speedSum == 0.0))
+            {
+                if(sample.count > 0)
+                    stats.addSample(sample.speedSum / sample.count, sample.count);
+                continue;
+            }
+
+            const int count = sample.count + a->second.count;
+            if(count > 0)
+                stats.addSample(static_cast<float>((sample.speedSum + a->second.speedSum) /
+                                                   count),
+                                count);
+        }
+    }
+
+    SimulationStatePtr SimulationForks::state(std::size_t variant) const
+    {
+        if(variant >= m_variants.size())
+            return nullptr;
+        const Variant& v = m_variants[variant];
+
+        auto state = std::make_shared<SimulationState>();
+        state->tick = m_base->tick;
+        state->time = m_base->time;
+        state->vehicles.reserve(m_base->vehicles.size());
+        for(const Vehicle& base : m_base->vehicles)
+        {
+            auto it = v.vehicles.find(base.id);
+            if(it == v.vehicles.end())
+                state->vehicles.push_back(base);
+            else if(it->second)
+                state->vehicles.push_back(*it->second);
+        }
+
+        // Vehicles only this variant has
+        bool added = false;
+        for(const auto& [id, vehicle] : v.vehicles)
+        {
+            if(vehicle && !m_base->findVehicle(id))
+            {
+                state->vehicles.push_back(*vehicle);
+                added = true;
+            }
+        }
+        if(added)
+            std::sort(state->vehicles.begin(), state->vehicles.end(),
+                      [](const Vehicle& a, const Vehicle& b) { return a.id < b.id; });
+
+        const auto& ids = m_network.geometry().ids;
+        state->congestion.resize(ids.size());
+        for(std::size_t i = 0; i < ids.size(); ++i)
+            state->congestion[i] = congestion(v, ids[i]);
+        return state;
+    }
+
+    std::vector<SegmentStatsDelta> SimulationForks::statsDeltas(std::size_t variant) const
+    {
+        std::vector<SegmentStatsDelta> deltas;
+        if(variant >= m_variants.size())
+            return deltas;
+
+        const SegmentStatistics empty;
+        for(const auto& [segmentId, stats] : m_variants[variant].stats)
+        {
+            auto it = m_stats.find(segmentId);
+            const SegmentStatistics& base = it != m_stats.end() ? it->second : empty;
+            const float speed = stats.avgSpeed - base.avgSpeed;
+            const float density = stats.avgDensity - base.avgDensity;
+            if(speed != 0.0f || density != 0.0f)
+                deltas.push_back({segmentId, speed, density});
+        }
+        std::sort(deltas.begin(), deltas.end(),
+                  [](const SegmentStatsDelta& a, const SegmentStatsDelta& b)
+                  { return a.segmentId < b.segmentId; });
+        return deltas;
+    }
+
+    std::size_t SimulationForks::divergedVehicles(std::size_t variant) const
+    {
+        return variant < m_variants.size() ? m_variants[variant].vehicles.size() : 0;
+    }
+
+} // namespace tfv
@@ -0,0 +1,192 @@
+#include "core/SpatialGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace tfv
+{
+    namespace
+    {
+        // Upper bound on cells, so sparse outliers cannot blow up the offset table
+        constexpr std::size_t kMaxCells = 1u << 20;
+    } // namespace
+
+    void SpatialGrid::clear()
+    {
+        m_cols = m_rows = 0;
+        m_cellStart.clear();
+        m_items.clear();
+        m_seen.clear();
+    }
+
+    int SpatialGrid::cellX(float x) const
+    {
+        return std::clamp(static_cast<int>(std::floor((x - m_originX) / m_cellSize)), 0,
+                          m_cols - 1);
+    }
+
+    int SpatialGrid::cellY(float y) const
+    {
+        return std::clamp(static_cast<int>(std::floor((y - m_originY) / m_cellSize)), 0,
+                          m_rows - 1);
+    }
+
+    template <typename CellRange>
+    void SpatialGrid::build(std::size_t count, float minX, float minY, float maxX, float maxY,
+                            float cellSize, CellRange&& cellRange)
+    {
+        clear();
+        if(count == 0)
+            return;
+
+        // Default: about one item per cell
+        const float width = std::max(maxX - minX, 1.f);
+        const float height = std::max(maxY - minY, 1.f);
+        if(cellSize <= 0.f)
+            cellSize = std::sqrt(width * height / static_cast<float>(count));
+        cellSize = std::max(cellSize, std::sqrt(width * height / static_cast<float>(kMaxCells)));
+        cellSize = std::max(cellSize, 1e-3f);
+
+        m_cellSize = cellSize;
+        m_originX = minX;
+        m_originY = minY;
+        m_cols = static_cast<int>(width / cellSize) + 1;
+        m_rows = static_cast<int>(height / cellSize) + 1;
+        const std::size_t cells = static_cast<std::size_t>(m_cols) * m_rows;
+
+        // Pass 1: count items per cell (shifted by one so the prefix sum yields start offsets)
+        m_cellStart.assign(cells + 1, 0);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            int cx0, cy0, cx1, cy1;
+            cellRange(i, cx0, cy0, cx1, cy1);
+            for(int cy = cy0; cy <= cy1; ++cy)
+                for(int cx = cx0; cx <= cx1; ++cx)
+                    ++m_cellStart[static_cast<std::size_t>(cy) * m_cols + cx + 1];
+        }
+        for(std::size_t c = 0; c < cells; ++c)
+            m_cellStart[c + 1] += m_cellStart[c];
+
+        // Pass 2: scatter item indices; m_seen doubles as the per-cell write cursor
+        m_items.resize(m_cellStart[cells]);
+        m_seen.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            int cx0, cy0, cx1, cy1;
+            cellRange(i, cx0, cy0, cx1, cy1);
+            for(int cy = cy0; cy <= cy1; ++cy)
+                for(int cx = cx0; cx <= cx1; ++cx)
+                    m_items[m_seen[static_cast<std::size_t>(cy) * m_cols + cx]++] =
+                        static_cast<uint32_t>(i);
+        }
+
+        m_seen.assign(count, 0);
+        m_stamp = 0;
+    }
+
+    void SpatialGrid::buildBoxes(const float* ax, const float* ay, const float* bx,
+                                 const float* by, std::size_t count, float cellSize)
+    {
+        float minX = 0.f, minY = 0.f, maxX = 0.f, maxY = 0.f;
+        if(count > 0)
+        {
+            minX = std::min(*std::min_element(ax, ax + count), *std::min_element(bx, bx + count));
+            minY = std::min(*std::min_element(ay, ay + count), *std::min_element(by, by + count));
+            maxX = std::max(*std::max_element(ax, ax + count), *std::max_element(bx, bx + count));
+            maxY = std::max(*std::max_element(ay, ay + count), *std::max_element(by, by + count));
+        }
+
+        // Density estimate from the average box size rather than the item count: long
+        // boxes would otherwise be listed in many small cells
+        if(cellSize <= 0.f && count > 0)
+        {
+            double extent = 0.0;
+            for(std::size_t i = 0; i < count; ++i)
+                extent += std::max(std::abs(bx[i] - ax[i]), std::abs(by[i] - ay[i]));
+            const float area = std::max(maxX - minX, 1.f) * std::max(maxY - minY, 1.f);
+            cellSize = std::max(static_cast<float>(extent / count),
+                                std::sqrt(area / static_cast<float>(count)));
+        }
+
+        m_boxes = true;
+        build(count, minX, minY, maxX, maxY, cellSize,
+              [&](std::size_t i, int& cx0, int& cy0, int& cx1, int& cy1)
+              {
+                  cx0 = cellX(std::min(ax[i], bx[i]));
+                  cx1 = cellX(std::max(ax[i], bx[i]));
+                  cy0 = cellY(std::min(ay[i], by[i]));
+                  cy1 = cellY(std::max(ay[i], by[i]));
+              });
+    }
+
+    void SpatialGrid::buildPoints(const float* x, const float* y, std::size_t count,
+                                  float cellSize)
+    {
+        // Non-finite points (items without a position) are left out
+        float minX = std::numeric_limits<float>::max(), minY = minX;
+        float maxX = std::numeric_limits<float>::lowest(), maxY = maxX;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            if(!std::isfinite(x[i]) || !std::isfinite(y[i]))
+                continue;
+            minX = std::min(minX, x[i]);
+            maxX = std::max(maxX, x[i]);
+            minY = std::min(minY, y[i]);
+            maxY = std::max(maxY, y[i]);
+        }
+        if(minX > maxX)
+        {
+            clear();
+            return;
+        }
+
+        m_boxes = false;
+        build(count, minX, minY, maxX, maxY, cellSize,
+              [&](std::size_t i, int& cx0, int& cy0, int& cx1, int& cy1)
+              {
+                  if(!std::isfinite(x[i]) || !std::isfinite(y[i]))
+                  {
+                      cx0 = cy0 = 0;
+                      cx1 = cy1 = -1; // Empty range
+                      return;
+                  }
+                  cx0 = cx1 = cellX(x[i]);
+                  cy0 = cy1 = cellY(y[i]);
+              });
+    }
+
+    void SpatialGrid::query(float minX, float minY, float maxX, float maxY,
+                            std::vector<uint32_t>& out) const
+    {
+        if(m_items.empty() || maxX < m_originX || maxY < m_originY ||
+           minX > m_originX + m_cols * m_cellSize || minY > m_originY + m_rows * m_cellSize)
+            return;
+
+        // New stamp per query; wrap-around clears the marks once every 2^32 queries
+        if(m_boxes && ++m_stamp == 0)
+        {
+            std::fill(m_seen.begin(), m_seen.end(), 0u);
+            m_stamp = 1;
+        }
+
+        const int cx0 = cellX(minX), cx1 = cellX(maxX);
+        const int cy0 = cellY(minY), cy1 = cellY(maxY);
+        for(int cy = cy0; cy <= cy1; ++cy)
+        {
+            const std::size_t row = static_cast<std::size_t>(cy) * m_cols;
+            for(uint32_t k = m_cellStart[row + cx0]; k < m_cellStart[row + cx1 + 1]; ++k)
+            {
+                const uint32_t item = m_items[k];
+                if(m_boxes)
+                {
+                    if(m_seen[item] == m_stamp)
+                        continue;
+                    m_seen[item] = m_stamp;
+                }
+                out.push_back(item);
+            }
+        }
+    }
+
+} // namespace tfv
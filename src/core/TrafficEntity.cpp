@@ -0,0 +1,27 @@
+#include "core/TrafficEntity.hpp"
+
+#include <mutex>
+#include <unordered_set>
+
+namespace tfv
+{
+    namespace
+    {
+        // Set nodes never move, so the names can be handed out by address
+        const std::string* intern(std::string_view name)
+        {
+            static std::mutex mtx;
+            static std::unordered_set<std::string> names;
+            std::scoped_lock lock(mtx);
+            return &*names.emplace(name).first;
+        }
+    } // namespace
+
+    VehicleType::VehicleType()
+    {
+        static const std::string* const car = intern("car");
+        m_name = car;
+    }
+
+    VehicleType::VehicleType(std::string_view name) : m_name(intern(name)) {}
+} // namespace tfv
@@ -1,10 +1,42 @@
 #include "core/Engine.hpp"
+#include <cstdlib>
 #include <iostream>
+#include <string>
 
 int main(int argc, char* argv[])
 {
-    // Create the engine with default SDL renderer
-    tfv::Engine engine("Traffic Flow Visualization", 1280, 720, "SDL");
+    // --headless renders offscreen with the software renderer (no display or GPU needed)
+    std::string rendererType = "SDL";
+    uint64_t maxFrames = 0;
+    bool threaded = false;
+    tfv::FrameMode frameMode = tfv::FrameMode::VSYNC;
+    double targetFps = 60.0;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--headless")
+            rendererType = "Software";
+        else if(arg == "--threaded")
+            threaded = true;
+        else if(arg == "--frames" && i + 1 < argc)
+            maxFrames = std::strtoull(argv[++i], nullptr, 10);
+        else if(arg == "--fps" && i + 1 < argc)
+        {
+            frameMode = tfv::FrameMode::FIXED_FPS;
+            targetFps = std::strtod(argv[++i], nullptr);
+        }
+        else if(arg == "--uncapped")
+            frameMode = tfv::FrameMode::UNCAPPED;
+        else if(arg == "--on-demand")
+            frameMode = tfv::FrameMode::ON_DEMAND;
+    }
+
+    // Create the engine with the selected renderer
+    tfv::Engine engine("Traffic Flow Visualization", 1280, 720, rendererType);
+    engine.setMaxFrames(maxFrames);
+    engine.setThreadedRendering(threaded);
+    engine.setFrameMode(frameMode);
+    engine.setTargetFps(targetFps);
 
     // Initialize the engine and run the simulation
     engine.run();
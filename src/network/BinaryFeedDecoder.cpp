@@ -0,0 +1,159 @@
+#include "network/BinaryFeedDecoder.hpp"
+
+#include <bit>
+
+namespace tfv
+{
+    namespace
+    {
+        enum Field : uint32_t
+        {
+            ID = 1,
+            TIMESTAMP = 2,
+            LAT_E7 = 3,
+            LON_E7 = 4,
+            SPEED = 5,
+            SEGMENT = 6,
+            POSITION = 7,
+            REMOVED = 8,
+            SEQUENCE = 9
+        };
+
+        constexpr unsigned kHaveId = 1;
+        constexpr unsigned kHaveLat = 2;
+        constexpr unsigned kHaveLon = 4;
+        constexpr unsigned kHaveSegment = 8;
+
+        constexpr double kDegreesPerE7 = 1e-7;
+
+        // Little-endian fixed-width field
+        inline uint64_t readFixed(const uint8_t* p, int bytes)
+        {
+            uint64_t value = 0;
+            for(int i = 0; i < bytes; ++i)
+                value |= static_cast<uint64_t>(p[i]) << (8 * i);
+            return value;
+        }
+    } // namespace
+
+    bool BinaryFeedDecoder::fail(const char* reason)
+    {
+        m_error = reason;
+        return false;
+    }
+
+    bool BinaryFeedDecoder::parseUpdate(const uint8_t* p, const uint8_t* end,
+                                        VehicleUpdate& update)
+    {
+        update = VehicleUpdate{};
+        update.source = m_source;
+        unsigned seen = 0;
+
+        while(p < end)
+        {
+            uint64_t key = 0;
+            p = protowire::readVarint(p, end, key);
+            if(!p)
+                return fail("truncated field key");
+            const auto field = static_cast<uint32_t>(key >> 3);
+            const auto wireType = static_cast<uint8_t>(key & 7);
+
+            // Read the value by wire type first; known fields then take what they expect
+            uint64_t value = 0;
+            switch(wireType)
+            {
+            case protowire::VARINT:
+                p = protowire::readVarint(p, end, value);
+                if(!p)
+                    return fail("truncated varint");
+                break;
+            case protowire::FIXED64:
+                if(end - p < 8)
+                    return fail("truncated fixed64");
+                value = readFixed(p, 8);
+                p += 8;
+                break;
+            case protowire::FIXED32:
+                if(end - p < 4)
+                    return fail("truncated fixed32");
+                value = readFixed(p, 4);
+                p += 4;
+                break;
+            case protowire::LENGTH_DELIMITED:
+                p = protowire::readVarint(p, end, value);
+                if(!p || static_cast<uint64_t>(end - p) < value)
+                    return fail("truncated length-delimited field");
+                p += value; // No known field is length-delimited
+                continue;
+            default:
+                return fail("unsupported wire type");
+            }
+
+            const auto expect = [&](protowire::WireType type)
+            { return wireType == type || fail("wrong wire type for a known field"); };
+
+            switch(field)
+            {
+            case ID:
+                if(!expect(protowire::VARINT))
+                    return false;
+                update.id = value;
+                seen |= kHaveId;
+                break;
+            case TIMESTAMP:
+                if(!expect(protowire::FIXED64))
+                    return false;
+                update.timestamp = std::bit_cast<double>(value);
+                break;
+            case LAT_E7:
+                if(!expect(protowire::VARINT))
+                    return false;
+                update.lat = static_cast<double>(protowire::zigzag(value)) * kDegreesPerE7;
+                seen |= kHaveLat;
+                break;
+            case LON_E7:
+                if(!expect(protowire::VARINT))
+                    return false;
+                update.lon = static_cast<double>(protowire::zigzag(value)) * kDegreesPerE7;
+                seen |= kHaveLon;
+                break;
+            case SPEED:
+                if(!expect(protowire::FIXED32))
+                    return false;
+                update.speed = std::bit_cast<float>(static_cast<uint32_t>(value));
+                break;
+            case SEGMENT:
+                if(!expect(protowire::VARINT))
+                    return false;
+                update.segmentId = static_cast<uint32_t>(value);
+                seen |= kHaveSegment;
+                break;
+            case POSITION:
+                if(!expect(protowire::FIXED32))
+                    return false;
+                update.position = std::bit_cast<float>(static_cast<uint32_t>(value));
+                break;
+            case REMOVED:
+                if(!expect(protowire::VARINT))
+                    return false;
+                update.kind = value ? UpdateKind::REMOVE : UpdateKind::UPSERT;
+                break;
+            case SEQUENCE:
+                if(!expect(protowire::VARINT))
+                    return false;
+                update.sequence = static_cast<uint32_t>(value);
+                break;
+            default:
+                break; // Unknown field: already skipped
+            }
+        }
+
+        if(!(seen & kHaveId))
+            return fail("missing id");
+        const bool located = (seen & (kHaveLat | kHaveLon)) == (kHaveLat | kHaveLon) ||
+                             (seen & kHaveSegment);
+        if(update.kind == UpdateKind::UPSERT && !located)
+            return fail("missing lat/lon or segment");
+        return true;
+    }
+} // namespace tfv
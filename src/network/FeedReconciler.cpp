@@ -0,0 +1,194 @@
+#include "network/FeedReconciler.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include "core/VehicleDynamics.hpp"
+
+namespace tfv
+{
+    namespace
+    {
+        constexpr std::size_t kMinCapacity = 1024;
+    } // namespace
+
+    FeedReconciler::FeedReconciler(std::size_t expectedVehicles)
+        : m_table(std::max(kMinCapacity, std::bit_ceil(expectedVehicles * 4)))
+    {
+    }
+
+    std::size_t FeedReconciler::filter(std::vector<VehicleUpdate>& updates, double now)
+    {
+        // Idle vehicles are only forgotten by a rebuild; a quiet table still gets one now
+        // and then
+        if(now - m_lastSweep >= kForgetIdleAfter)
+            rehash(m_table.size(), now);
+
+        std::size_t kept = 0;
+        for(const auto& update : updates)
+        {
+            observeClock(update, now);
+            const double time = toLocal(update, now);
+
+            Entry& entry = find(update.id, now);
+            const Verdict verdict = judge(entry, update, time);
+            if(verdict != Verdict::ACCEPT)
+            {
+                ++(verdict == Verdict::STALE ? m_stats.stale : m_stats.duplicates);
+                continue;
+            }
+
+            if(entry.state == State::EMPTY)
+                ++m_used;
+            entry.id = update.id;
+            entry.timestamp = update.timestamp;
+            entry.time = time;
+            entry.sequence = update.sequence;
+            entry.source = update.source;
+            entry.state = update.kind == UpdateKind::REMOVE ? State::REMOVED : State::LIVE;
+            updates[kept++] = update;
+        }
+
+        m_stats.accepted += kept;
+        m_stats.tracked = m_used;
+        updates.resize(kept);
+        return kept;
+    }
+
+    void FeedReconciler::deadReckon(std::span<VehicleUpdate> updates, double now,
+                                    const RoadNetwork& network) const
+    {
+        for(auto& update : updates)
+        {
+            if(update.kind != UpdateKind::UPSERT || !update.matched() || update.speed <= 0.0f ||
+               update.timestamp == 0.0)
+                continue;
+            const double age = std::clamp(now - update.timestamp, 0.0, m_maxAge);
+            const RoadSegment* segment = network.getSegment(update.segmentId);
+            if(!segment || segment->length <= 0.0f)
+                continue;
+            const auto distance = static_cast<float>(update.speed * age);
+            update.position = std::min(update.position + distance / segment->length, 1.0f);
+        }
+    }
+
+    double FeedReconciler::clockOffset(uint16_t source) const
+    {
+        return source < m_clocks.size() ? m_clocks[source].offset : 0.0;
+    }
+
+    FeedReconciler::Verdict FeedReconciler::judge(const Entry& entry, const VehicleUpdate& update,
+                                                  double time) const
+    {
+        if(entry.state == State::EMPTY)
+            return Verdict::ACCEPT;
+
+        if(update.source == entry.source)
+        {
+            // Sequence numbers are exact; compared modulo 2^32 so a wrapped counter still
+            // counts as newer
+            if(update.sequence != 0 && entry.sequence != 0)
+            {
+                const auto ahead = static_cast<int32_t>(update.sequence - entry.sequence);
+                return ahead > 0    ? Verdict::ACCEPT
+                       : ahead == 0 ? Verdict::DUPLICATE
+                                    : Verdict::STALE;
+            }
+            if(update.timestamp == 0.0 || entry.timestamp == 0.0)
+                return Verdict::ACCEPT; // Nothing to order by
+            return update.timestamp > entry.timestamp    ? Verdict::ACCEPT
+                   : update.timestamp == entry.timestamp ? Verdict::DUPLICATE
+                                                         : Verdict::STALE;
+        }
+
+        // Another source: only the corrected clocks are comparable. A report relayed by both
+        // sources lands on the same corrected time; one without a timestamp has only `now`.
+        if(time == entry.time && update.timestamp != 0.0)
+            return Verdict::DUPLICATE;
+        return time >= entry.time ? Verdict::ACCEPT : Verdict::STALE;
+    }
+
+    double FeedReconciler::toLocal(const VehicleUpdate& update, double now) const
+    {
+        if(update.timestamp == 0.0 || update.source >= m_clocks.size())
+            return now;
+        return update.timestamp + m_clocks[update.source].offset;
+    }
+
+    void FeedReconciler::observeClock(const VehicleUpdate& update, double now)
+    {
+        if(update.timestamp == 0.0)
+            return;
+        if(update.source >= m_clocks.size())
+            m_clocks.resize(update.source + 1u);
+
+        SourceClock& clock = m_clocks[update.source];
+        const double sample = now - update.timestamp;
+        if(!clock.seen)
+        {
+            clock = {sample, sample, sample, now, true};
+            return;
+        }
+
+        // Minimum over the current and previous window: a delivery delayed by queueing
+        // never raises the estimate, but drift is followed within two windows
+        if(now - clock.windowStart >= kClockWindow)
+        {
+            clock.previousMin = clock.windowMin;
+            clock.windowMin = sample;
+            clock.windowStart = now;
+        }
+        else
+        {
+            clock.windowMin = std::min(clock.windowMin, sample);
+        }
+        clock.offset = std::min(clock.windowMin, clock.previousMin);
+    }
+
+    FeedReconciler::Entry& FeedReconciler::find(uint64_t id, double now)
+    {
+        if((m_used + 1) * 2 > m_table.size())
+            rehash(m_table.size(), now);
+
+        // Linear probing; entries are never emptied outside rehash(), so a probe ends at
+        // the vehicle or at the first empty slot
+        const std::size_t mask = m_table.size() - 1;
+        for(std::size_t i = dynamics::mix(id) & mask;; i = (i + 1) & mask)
+        {
+            Entry& entry = m_table[i];
+            if(entry.state == State::EMPTY || entry.id == id)
+                return entry;
+        }
+    }
+
+    void FeedReconciler::rehash(std::size_t capacity, double now)
+    {
+        const auto keep = [&](const Entry& e)
+        {
+            return (e.state == State::LIVE && now - e.time < kForgetIdleAfter) ||
+                   (e.state == State::REMOVED && now - e.time < kForgetRemovedAfter);
+        };
+        m_lastSweep = now;
+
+        std::size_t survivors = 0;
+        for(const auto& entry : m_table)
+            survivors += keep(entry) ? 1 : 0;
+        while(survivors * 4 > capacity)
+            capacity *= 2;
+
+        std::vector<Entry> old(capacity);
+        old.swap(m_table);
+        m_used = survivors;
+
+        const std::size_t mask = capacity - 1;
+        for(const auto& entry : old)
+        {
+            if(!keep(entry))
+                continue;
+            std::size_t i = dynamics::mix(entry.id) & mask;
+            while(m_table[i].state != State::EMPTY)
+                i = (i + 1) & mask;
+            m_table[i] = entry;
+        }
+    }
+} // namespace tfv
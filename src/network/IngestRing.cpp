@@ -0,0 +1,224 @@
+#include "network/IngestRing.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+namespace tfv
+{
+    IngestRing::IngestRing(std::size_t capacity, IngestOverflowPolicy policy)
+        : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1), m_policy(policy)
+    {
+        m_slots = std::make_unique<Slot[]>(m_mask + 1);
+        for(std::size_t i = 0; i <= m_mask; ++i)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    void IngestRing::setPolicy(IngestOverflowPolicy policy)
+    {
+        m_policy.store(policy, std::memory_order_relaxed);
+        // A producer blocked under the old policy re-reads it
+        m_space.fetch_add(1, std::memory_order_release);
+        m_space.notify_all();
+    }
+
+    IngestOverflowPolicy IngestRing::policy() const
+    {
+        return m_policy.load(std::memory_order_relaxed);
+    }
+
+    bool IngestRing::tryPush(const VehicleUpdate& update)
+    {
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            Slot& slot = m_slots[pos & m_mask];
+            const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::ptrdiff_t>(sequence - pos);
+            if(lag == 0)
+            {
+                // Free at this lap: claim it
+                if(m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.update = update;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(lag < 0)
+            {
+                return false; // Still holds last lap's update: full
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool IngestRing::tryPop(VehicleUpdate& update)
+    {
+        // Producers pop too (DROP_OLDEST), so the consumer side also claims slots by CAS
+        std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            Slot& slot = m_slots[pos & m_mask];
+            const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+            if(lag == 0)
+            {
+                if(m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    update = slot.update;
+                    slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(lag < 0)
+            {
+                return false; // Empty
+            }
+            else
+            {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool IngestRing::push(const VehicleUpdate& update)
+    {
+        bool waited = false;
+        for(;;)
+        {
+            if(m_closed.load(std::memory_order_acquire))
+                return false;
+
+            // Read before trying, so a drain between the attempt and the wait is not missed
+            const uint32_t space = m_space.load(std::memory_order_acquire);
+            if(tryPush(update))
+                return true;
+
+            switch(m_policy.load(std::memory_order_relaxed))
+            {
+            case IngestOverflowPolicy::DROP_OLDEST:
+            {
+                VehicleUpdate discarded;
+                if(tryPop(discarded))
+                    m_droppedOldest.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            case IngestOverflowPolicy::DROP_NEWEST:
+                m_droppedNewest.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            case IngestOverflowPolicy::BLOCK:
+                if(!waited)
+                {
+                    m_blocked.fetch_add(1, std::memory_order_relaxed);
+                    waited = true;
+                }
+                m_space.wait(space, std::memory_order_acquire);
+                break;
+            }
+        }
+    }
+
+    std::size_t IngestRing::drain(std::vector<VehicleUpdate>& out, std::size_t max)
+    {
+        std::size_t count = 0;
+        VehicleUpdate update;
+        while(count < max && tryPop(update))
+        {
+            out.push_back(update);
+            ++count;
+        }
+
+        if(count > 0)
+        {
+            m_space.fetch_add(1, std::memory_order_release);
+            m_space.notify_all();
+        }
+        return count;
+    }
+
+    void IngestRing::close()
+    {
+        m_closed.store(true, std::memory_order_release);
+        m_space.fetch_add(1, std::memory_order_release);
+        m_space.notify_all();
+    }
+
+    void IngestRing::open()
+    {
+        m_closed.store(false, std::memory_order_release);
+    }
+
+    IngestRingStats IngestRing::stats() const
+    {
+        // Positions only ever grow: every claimed enqueue slot is a push, every dequeue is a
+        // drain or an overwrite, so the hot path needs no counters of its own. Overwrites are
+        // counted after their dequeue, so read that counter first to never exceed it
+        IngestRingStats stats;
+        stats.droppedOldest = m_droppedOldest.load(std::memory_order_relaxed);
+        const std::size_t dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+        const std::size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        stats.pushed = enqueued;
+        stats.drained = dequeued - stats.droppedOldest;
+        stats.droppedNewest = m_droppedNewest.load(std::memory_order_relaxed);
+        stats.blocked = m_blocked.load(std::memory_order_relaxed);
+        stats.queued = enqueued > dequeued ? enqueued - dequeued : 0;
+        stats.capacity = capacity();
+        return stats;
+    }
+
+    IngestShards::IngestShards(std::size_t capacity, std::size_t shards,
+                               IngestOverflowPolicy policy)
+    {
+        if(shards == 0)
+            shards = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 8);
+        for(std::size_t k = 0; k < shards; ++k)
+            m_shards.push_back(std::make_unique<IngestRing>(capacity / shards, policy));
+    }
+
+    void IngestShards::setPolicy(IngestOverflowPolicy policy)
+    {
+        for(auto& shard : m_shards)
+            shard->setPolicy(policy);
+    }
+
+    std::size_t IngestShards::drain(std::vector<VehicleUpdate>& out)
+    {
+        std::size_t count = 0;
+        for(auto& shard : m_shards)
+            count += shard->drain(out, shard->capacity());
+        return count;
+    }
+
+    void IngestShards::close()
+    {
+        for(auto& shard : m_shards)
+            shard->close();
+    }
+
+    void IngestShards::open()
+    {
+        for(auto& shard : m_shards)
+            shard->open();
+    }
+
+    IngestRingStats IngestShards::stats() const
+    {
+        IngestRingStats total;
+        for(const auto& shard : m_shards)
+        {
+            const IngestRingStats stats = shard->stats();
+            total.pushed += stats.pushed;
+            total.drained += stats.drained;
+            total.droppedOldest += stats.droppedOldest;
+            total.droppedNewest += stats.droppedNewest;
+            total.blocked += stats.blocked;
+            total.queued += stats.queued;
+            total.capacity += stats.capacity;
+        }
+        return total;
+    }
+} // namespace tfv
@@ -0,0 +1,285 @@
+#include "network/JsonFeedDecoder.hpp"
+
+#include <bit>
+#include <charconv>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TFV_JSON_SSE2 1
+#endif
+
+namespace tfv
+{
+    namespace
+    {
+        // Fields that must appear in every object
+        constexpr unsigned kHaveId = 1;
+        constexpr unsigned kHaveLat = 2;
+        constexpr unsigned kHaveLon = 4;
+        constexpr unsigned kRequired = kHaveId | kHaveLat | kHaveLon;
+
+        inline bool isSpace(char c)
+        {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+#ifdef TFV_JSON_SSE2
+        inline __m128i load16(const char* p)
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        }
+
+        inline int matches(__m128i chunk, char c)
+        {
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(c)));
+        }
+#endif
+
+        // First '"' or '\' in [p, end): the end of a string, or an escape inside it
+        const char* findQuoteOrEscape(const char* p, const char* end)
+        {
+#ifdef TFV_JSON_SSE2
+            for(; end - p >= 16; p += 16)
+            {
+                const __m128i chunk = load16(p);
+                const int mask = matches(chunk, '"') | matches(chunk, '\\');
+                if(mask)
+                    return p + std::countr_zero(static_cast<unsigned>(mask));
+            }
+#endif
+            while(p < end && *p != '"' && *p != '\\')
+                ++p;
+            return p;
+        }
+
+        // First '"', '{', '}', '[' or ']' in [p, end): what matters inside a skipped container
+        const char* findStructural(const char* p, const char* end)
+        {
+#ifdef TFV_JSON_SSE2
+            for(; end - p >= 16; p += 16)
+            {
+                const __m128i chunk = load16(p);
+                const int mask = matches(chunk, '"') | matches(chunk, '{') | matches(chunk, '}') |
+                                 matches(chunk, '[') | matches(chunk, ']');
+                if(mask)
+                    return p + std::countr_zero(static_cast<unsigned>(mask));
+            }
+#endif
+            while(p < end && *p != '"' && *p != '{' && *p != '}' && *p != '[' && *p != ']')
+                ++p;
+            return p;
+        }
+
+        // Past the closing quote of a string whose opening quote is at p - 1; null if unclosed
+        const char* skipString(const char* p, const char* end)
+        {
+            for(;;)
+            {
+                p = findQuoteOrEscape(p, end);
+                if(p == end)
+                    return nullptr;
+                if(*p == '"')
+                    return p + 1;
+                if(end - p < 2)
+                    return nullptr;
+                p += 2; // Escape: the next byte cannot end the string
+            }
+        }
+
+        // `null` at p: the field keeps its default
+        inline const char* skipNull(const char* p, const char* end)
+        {
+            if(end - p >= 4 && std::memcmp(p, "null", 4) == 0)
+                return p + 4;
+            return nullptr;
+        }
+
+        // A number that must be there: `null` is malformed
+        template <typename T>
+        const char* parseRequired(const char* p, const char* end, T& out)
+        {
+            auto [next, ec] = std::from_chars(p, end, out);
+            return ec == std::errc{} ? next : nullptr;
+        }
+
+        template <typename T>
+        const char* parseNumber(const char* p, const char* end, T& out)
+        {
+            if(p != end && *p == 'n')
+                return skipNull(p, end);
+            return parseRequired(p, end, out);
+        }
+    } // namespace
+
+    namespace json
+    {
+        const char* skipSpace(const char* p, const char* end)
+        {
+            // Compact feeds have no whitespace at all: test one byte before going wide
+            if(p == end || !isSpace(*p))
+                return p;
+#ifdef TFV_JSON_SSE2
+            for(; end - p >= 16; p += 16)
+            {
+                const __m128i chunk = load16(p);
+                const int space = matches(chunk, ' ') | matches(chunk, '\n') |
+                                  matches(chunk, '\r') | matches(chunk, '\t');
+                if(space != 0xFFFF)
+                    return p + std::countr_zero(static_cast<unsigned>(~space & 0xFFFF));
+            }
+#endif
+            while(p < end && isSpace(*p))
+                ++p;
+            return p;
+        }
+    } // namespace json
+
+    const char* JsonFeedDecoder::fail(const char* reason)
+    {
+        m_error = reason;
+        return nullptr;
+    }
+
+    const char* JsonFeedDecoder::parseObject(const char* p, const char* end,
+                                             VehicleUpdate& update)
+    {
+        if(p == end || *p != '{')
+            return fail("expected an object");
+
+        update = VehicleUpdate{};
+        update.source = m_source;
+        unsigned seen = 0;
+
+        p = json::skipSpace(p + 1, end);
+        if(p != end && *p == '}')
+            return fail("missing id, lat or lon");
+
+        for(;;)
+        {
+            if(p == end || *p != '"')
+                return fail("expected a key");
+
+            // Keys we know are plain ASCII; one with an escape is skipped as unknown
+            const char* key = p + 1;
+            const char* keyEnd = findQuoteOrEscape(key, end);
+            std::string_view name;
+            if(keyEnd != end && *keyEnd == '"')
+            {
+                name = std::string_view(key, static_cast<std::size_t>(keyEnd - key));
+                p = keyEnd + 1;
+            }
+            else
+            {
+                p = skipString(key, end);
+                if(!p)
+                    return fail("unterminated key");
+            }
+
+            p = json::skipSpace(p, end);
+            if(p == end || *p != ':')
+                return fail("expected ':' after a key");
+            p = json::skipSpace(p + 1, end);
+
+            if(name == "id")
+            {
+                // Accept "id": 17 and "id": "17"
+                const bool quoted = p != end && *p == '"';
+                p = parseRequired(p + (quoted ? 1 : 0), end, update.id);
+                if(p && quoted)
+                    p = p != end && *p == '"' ? p + 1 : nullptr;
+                seen |= kHaveId;
+            }
+            else if(name == "ts")
+            {
+                p = parseNumber(p, end, update.timestamp);
+            }
+            else if(name == "lat")
+            {
+                p = parseRequired(p, end, update.lat);
+                seen |= kHaveLat;
+            }
+            else if(name == "lon")
+            {
+                p = parseRequired(p, end, update.lon);
+                seen |= kHaveLon;
+            }
+            else if(name == "speed")
+            {
+                p = parseNumber(p, end, update.speed);
+            }
+            else if(name == "seq")
+            {
+                p = parseNumber(p, end, update.sequence);
+            }
+            else
+            {
+                p = skipValue(p, end);
+                if(!p)
+                    return nullptr;
+            }
+            if(!p)
+                return fail("malformed number");
+
+            p = json::skipSpace(p, end);
+            if(p == end)
+                return fail("unterminated object");
+            if(*p == '}')
+                break;
+            if(*p != ',')
+                return fail("expected ',' or '}' in object");
+            p = json::skipSpace(p + 1, end);
+        }
+
+        if((seen & kRequired) != kRequired)
+            return fail("missing id, lat or lon");
+        return p + 1;
+    }
+
+    const char* JsonFeedDecoder::skipValue(const char* p, const char* end)
+    {
+        if(p == end)
+            return fail("missing value");
+
+        if(*p == '"')
+        {
+            p = skipString(p + 1, end);
+            return p ? p : fail("unterminated string");
+        }
+
+        if(*p == '{' || *p == '[')
+        {
+            // Only nesting and strings matter until the container closes
+            int depth = 0;
+            for(;;)
+            {
+                p = findStructural(p, end);
+                if(p == end)
+                    return fail("unterminated container");
+                switch(*p)
+                {
+                case '"':
+                    p = skipString(p + 1, end);
+                    if(!p)
+                        return fail("unterminated string");
+                    continue;
+                case '{':
+                case '[':
+                    ++depth;
+                    break;
+                default:
+                    if(--depth == 0)
+                        return p + 1;
+                    break;
+                }
+                ++p;
+            }
+        }
+
+        // Number or literal: runs to the next delimiter
+        const char* start = p;
+        while(p < end && *p != ',' && *p != '}' && *p != ']' && !isSpace(*p))
+            ++p;
+        return p != start ? p : fail("missing value");
+    }
+} // namespace tfv
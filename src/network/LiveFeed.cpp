@@ -1,12 +1,41 @@
 #include "network/LiveFeed.hpp"
+#include "utils/LoggingManager.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <random>
 
 namespace tfv
 {
+    namespace
+    {
+        using SteadyClock = std::chrono::steady_clock;
+
+        template <typename Clock>
+        double secondsNow()
+        {
+            return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+        }
+
+        // Exponential backoff with +-25% jitter so many clients do not retry in lockstep
+        int backoffDelay(int intervalMs, int failures, int maxFactor)
+        {
+            thread_local std::mt19937 rng{std::random_device{}()};
+            const int factor = std::min(1 << std::min(failures - 1, 30), maxFactor);
+            const double base = static_cast<double>(intervalMs) * factor;
+            std::uniform_real_distribution<double> jitter(0.75, 1.25);
+            return static_cast<int>(base * jitter(rng));
+        }
+    } // namespace
+
     // Dummy feed handler implementation
-    DummyFeedHandler::DummyFeedHandler(Simulation& sim) : m_sim(sim) {}
+    DummyFeedHandler::DummyFeedHandler(IngestShards& rings, const RoadNetwork* network,
+                                       uint16_t source)
+        : m_rings(rings), m_network(network), m_source(source)
+    {
+    }
 
     DummyFeedHandler::~DummyFeedHandler()
     {
@@ -42,19 +71,51 @@ namespace tfv
         std::random_device rd;
         std::mt19937 gen(rd());
 
-        // Generate random vehicle updates every few seconds
+        const std::vector<uint32_t> segments =
+            m_network ? m_network->getSegmentIds() : std::vector<uint32_t>{};
+        if(segments.empty())
+            return;
+
+        // A few vehicles that drift along random segments, reported every interval
+        std::uniform_int_distribution<std::size_t> pickSegment(0, segments.size() - 1);
+        std::uniform_real_distribution<float> pickSpeed(2.0f, 15.0f);
+        std::vector<VehicleUpdate> vehicles(kVehicles);
+        for(int i = 0; i < kVehicles; ++i)
+        {
+            // Clear of CSV-loaded ids and of other dummy sources
+            vehicles[i].id = (1ull << 48) + (static_cast<uint64_t>(m_source) << 16) + i;
+            vehicles[i].source = m_source;
+            vehicles[i].segmentId = segments[pickSegment(gen)];
+            vehicles[i].speed = pickSpeed(gen);
+        }
+
         while(m_running)
         {
-            // Sleep for a bit
-            std::this_thread::sleep_for(std::chrono::seconds(2));
+            // Wall-clock seconds, like a real source's timestamps
+            const double now = secondsNow<std::chrono::system_clock>();
+            for(auto& vehicle : vehicles)
+            {
+                const auto* segment = m_network->getSegment(vehicle.segmentId);
+                const float length = segment && segment->length > 0.0f ? segment->length : 1.0f;
+                vehicle.position += vehicle.speed * kIntervalMs / 1000.0f / length;
+                if(vehicle.position >= 1.0f)
+                {
+                    vehicle.position = 0.0f;
+                    vehicle.segmentId = segments[pickSegment(gen)];
+                }
+                vehicle.timestamp = now;
+                m_rings.push(vehicle);
+            }
 
-            // In a real implementation, this would add/update vehicles
-            // But for a dummy feed, we'll do nothing
+            std::this_thread::sleep_for(std::chrono::milliseconds(kIntervalMs));
         }
     }
 
-    // WebSocket feed handler stub implementation
-    WebSocketFeedHandler::WebSocketFeedHandler(Simulation& sim) : m_sim(sim) {}
+    // WebSocket feed handler implementation
+    WebSocketFeedHandler::WebSocketFeedHandler(IngestShards& rings, uint16_t source)
+        : m_rings(rings), m_decoder(source)
+    {
+    }
 
     WebSocketFeedHandler::~WebSocketFeedHandler()
     {
@@ -76,6 +137,7 @@ namespace tfv
             return;
 
         m_running = false;
+        m_client.wake(); // Out of a blocked poll or a reconnect delay right away
         if(m_thr.joinable())
             m_thr.join();
     }
@@ -85,38 +147,240 @@ namespace tfv
         return m_running;
     }
 
+    FeedHandlerStats WebSocketFeedHandler::stats() const
+    {
+        return {messagesReceived(), bytesReceived(), decodeErrors()};
+    }
+
     void WebSocketFeedHandler::loop()
     {
+        websocket::Url url;
+        if(!websocket::parseUrl(m_url, url))
+        {
+            LOG_ERROR("Invalid WebSocket feed URL {url} (expected ws://host[:port]/path)",
+                      PARAM(url, m_url));
+            m_running = false;
+            return;
+        }
+
+        const auto onMessage = [this](const WebSocketClient::Message& message)
+        { processMessage(message.text()); };
+
+        int failures = 0;
         while(m_running)
         {
-            if(connect())
+            if(failures > 0 && m_client.sleep(reconnectDelay(failures)))
+                continue; // Woken: re-check m_running
+
+            if(!connect(url))
             {
-                // In a real implementation, this would run the WebSocket protocol
-                // For now, just sleep
-                std::this_thread::sleep_for(std::chrono::seconds(5));
+                ++failures;
+                continue;
             }
-            else
+            failures = 0;
+            m_connected = true;
+
+            bool pinged = false;
+            while(m_running && m_client.poll(m_pingInterval / 2, onMessage))
             {
-                // Sleep then retry connection
-                std::this_thread::sleep_for(std::chrono::milliseconds(m_reconnectInterval));
+                const auto idle = std::chrono::steady_clock::now() - m_client.lastReceive();
+                if(idle < std::chrono::milliseconds(m_pingInterval))
+                {
+                    pinged = false;
+                }
+                else if(idle >= std::chrono::milliseconds(2 * m_pingInterval))
+                {
+                    LOG_ERROR("WebSocket feed {url} went silent; reconnecting",
+                              PARAM(url, m_url));
+                    m_client.close(websocket::kCloseNormal);
+                    break;
+                }
+                else if(!pinged)
+                {
+                    m_client.sendPing();
+                    pinged = true;
+                }
             }
+
+            m_connected = false;
+            if(!m_running)
+                break;
+            if(!m_client.error().empty())
+                LOG_ERROR("WebSocket feed {url} disconnected: {error}", PARAM(url, m_url),
+                          PARAM(error, m_client.error()));
+            failures = 1; // Wait one interval before the first reconnect
         }
+        m_client.close(websocket::kCloseNormal);
     }
 
-    bool WebSocketFeedHandler::connect()
+    bool WebSocketFeedHandler::connect(const websocket::Url& url)
     {
-        // In a real implementation, this would establish a WebSocket connection
-        // For now, pretend it worked
+        if(!m_client.connect(url, kConnectTimeoutMs))
+        {
+            LOG_ERROR("WebSocket feed {url} unavailable: {error}", PARAM(url, m_url),
+                      PARAM(error, m_client.error()));
+            return false;
+        }
+        LOG_INFO("Connected to WebSocket feed {url}", PARAM(url, m_url));
         return true;
     }
 
-    void WebSocketFeedHandler::processMessage(const std::string& msg)
+    int WebSocketFeedHandler::reconnectDelay(int failures) const
+    {
+        return backoffDelay(m_reconnectInterval, failures, kMaxBackoffFactor);
+    }
+
+    void WebSocketFeedHandler::processMessage(std::string_view msg)
+    {
+        // A view into the client's receive buffer, valid until this returns
+        m_messages.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(msg.size(), std::memory_order_relaxed);
+
+        if(m_decoder.decode(msg, [this](const VehicleUpdate& update) { m_rings.push(update); }))
+            return;
+
+        // Log the first bad message and then every 1000th, not a flood of them
+        const uint64_t errors = m_decodeErrors.fetch_add(1, std::memory_order_relaxed);
+        if(errors % 1000 == 0)
+            LOG_ERROR("Undecodable message from {url} ({count} so far): {error}",
+                      PARAM(url, m_url), PARAM(count, errors + 1),
+                      PARAM(error, m_decoder.error()));
+    }
+
+    // Binary feed handler implementation
+    BinaryFeedHandler::BinaryFeedHandler(IngestShards& rings, uint16_t source)
+        : m_rings(rings), m_decoder(source)
     {
-        // In a real implementation, this would parse JSON and update vehicles
+    }
+
+    BinaryFeedHandler::~BinaryFeedHandler()
+    {
+        stop();
+    }
+
+    void BinaryFeedHandler::start()
+    {
+        if(m_running)
+            return;
+
+        m_running = true;
+        m_thr = std::thread(&BinaryFeedHandler::loop, this);
+    }
+
+    void BinaryFeedHandler::stop()
+    {
+        if(!m_running)
+            return;
+
+        m_running = false;
+        m_client.wake();
+        if(m_thr.joinable())
+            m_thr.join();
+    }
+
+    bool BinaryFeedHandler::isRunning() const
+    {
+        return m_running;
+    }
+
+    FeedHandlerStats BinaryFeedHandler::stats() const
+    {
+        return {messagesReceived(), bytesReceived(), decodeErrors()};
+    }
+
+    void BinaryFeedHandler::loop()
+    {
+        StreamEndpoint endpoint;
+        if(!parseStreamUrl(m_url, endpoint))
+        {
+            LOG_ERROR("Invalid binary feed URL {url} (expected tcp://host:port or unix:///path)",
+                      PARAM(url, m_url));
+            m_running = false;
+            return;
+        }
+        m_buffer.resize(kBufferSize);
+
+        int failures = 0;
+        while(m_running)
+        {
+            if(failures > 0 &&
+               m_client.sleep(backoffDelay(m_reconnectInterval, failures, kMaxBackoffFactor)))
+                continue; // Woken: re-check m_running
+
+            if(!m_client.connect(endpoint, kConnectTimeoutMs))
+            {
+                LOG_ERROR("Binary feed {url} unavailable: {error}", PARAM(url, m_url),
+                          PARAM(error, m_client.error()));
+                ++failures;
+                continue;
+            }
+            LOG_INFO("Connected to binary feed {url}", PARAM(url, m_url));
+
+            m_connected = true;
+            receive();
+            m_connected = false;
+            m_client.close();
+            if(!m_running)
+                break;
+            LOG_ERROR("Binary feed {url} disconnected: {error}", PARAM(url, m_url),
+                      PARAM(error, m_decoder.failed() ? m_decoder.error() : m_client.error()));
+            failures = 1; // Wait one interval before the first reconnect
+        }
+        m_client.close();
+    }
+
+    void BinaryFeedHandler::receive()
+    {
+        m_decoder.reset();
+        uint64_t messages = 0;
+        const auto onUpdate = [this, &messages](const VehicleUpdate& update)
+        {
+            m_rings.push(update);
+            ++messages;
+        };
+
+        // Undecoded bytes are [begin, end); a partial message waits at the tail for the rest
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        while(m_running)
+        {
+            if(begin == end)
+            {
+                begin = end = 0;
+            }
+            else if(m_buffer.size() - end < m_buffer.size() / 4)
+            {
+                std::memmove(m_buffer.data(), m_buffer.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+            }
+
+            const long n = m_client.read(m_buffer.data() + end, m_buffer.size() - end,
+                                         kReadTimeoutMs);
+            if(n < 0)
+                return;
+            if(n == 0)
+                continue;
+            end += static_cast<std::size_t>(n);
+            m_bytes.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+
+            messages = 0;
+            begin += m_decoder.decode(m_buffer.data() + begin, end - begin, onUpdate);
+            m_messages.fetch_add(messages, std::memory_order_relaxed);
+            if(m_decoder.failed())
+            {
+                m_decodeErrors.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
     }
 
     // LiveFeed implementation
-    LiveFeed::LiveFeed(Simulation& sim) : m_sim(sim) {}
+    LiveFeed::LiveFeed(Simulation& sim, std::size_t ringCapacity, std::size_t shards)
+        : m_sim(sim), m_rings(ringCapacity, shards), m_lastReport(secondsNow<SteadyClock>())
+    {
+        m_batch.reserve(m_rings.capacity());
+    }
 
     LiveFeed::~LiveFeed()
     {
@@ -125,49 +389,201 @@ namespace tfv
 
     void LiveFeed::connect(const std::string& url, FeedType type)
     {
-        // Disconnect if already connected
         disconnect();
+        addSource(url, type);
+    }
 
-        // Create handler based on feed type
+    void LiveFeed::disconnect()
+    {
+        if(m_sources.empty())
+            return;
+
+        // Release feed threads blocked on a full ring before joining them
+        m_rings.close();
+        for(auto& source : m_sources)
+            source.handler->stop();
+        m_sources.clear();
+        report(false, "Disconnected from feed");
+    }
+
+    bool LiveFeed::isConnected() const
+    {
+        return std::any_of(m_sources.begin(), m_sources.end(),
+                           [](const Source& source) { return source.handler->isRunning(); });
+    }
+
+    uint16_t LiveFeed::addSource(const std::string& url, FeedType type)
+    {
+        if(m_nextSource >= kNoSource)
+        {
+            LOG_ERROR("Feed source ids are used up; not adding {url}", PARAM(url, url));
+            return kNoSource;
+        }
+        const auto id = static_cast<uint16_t>(m_nextSource++);
+        if(m_tally.size() <= id)
+            m_tally.resize(id + 1u);
+        m_tally[id] = {};
+
+        Source source;
+        source.status.source = id;
+        source.status.url = url;
+        source.status.type = type;
+        source.handler = createHandler(url, type, id);
+
+        m_rings.open();
+        source.handler->start();
+        m_sources.push_back(std::move(source));
+        report(true, "Started feed source " + std::to_string(id) + ": " + url);
+        return id;
+    }
+
+    bool LiveFeed::removeSource(uint16_t source)
+    {
+        auto it = std::find_if(m_sources.begin(), m_sources.end(), [source](const Source& s)
+                               { return s.status.source == source; });
+        if(it == m_sources.end())
+            return false;
+
+        // Under BLOCK the handler may be waiting for room that only update() would make;
+        // closing the rings releases it, at the cost of refusing the other sources' pushes
+        // for the moment it takes to join
+        const bool block = m_rings.policy() == IngestOverflowPolicy::BLOCK;
+        if(block)
+            m_rings.close();
+        it->handler->stop();
+        if(block)
+            m_rings.open();
+
+        report(false, "Removed feed source " + std::to_string(source) + ": " + it->status.url);
+        m_sources.erase(it);
+        return true;
+    }
+
+    std::vector<FeedSourceStatus> LiveFeed::sources() const
+    {
+        std::vector<FeedSourceStatus> statuses;
+        statuses.reserve(m_sources.size());
+        for(const auto& source : m_sources)
+            statuses.push_back(source.status);
+        return statuses;
+    }
+
+    std::size_t LiveFeed::update()
+    {
+        checkSources(secondsNow<SteadyClock>());
+
+        // At most one ring's worth per shard, so a flooding feed cannot stall the tick
+        m_batch.clear();
+        const std::size_t count = m_rings.drain(m_batch);
+        if(count == 0)
+            return 0;
+
+        for(const auto& update : m_batch)
+        {
+            if(update.source >= m_tally.size())
+                continue;
+            SourceTally& tally = m_tally[update.source];
+            ++tally.updates;
+            tally.newest = std::max(tally.newest, update.timestamp);
+        }
+
+        // Source timestamps are wall-clock seconds; the reconciler learns each source's offset
+        const double now = secondsNow<std::chrono::system_clock>();
+        m_reconciler.filter(m_batch, now);
+        if(m_matcher)
+            m_matcher->match(m_batch, now);
+        if(const RoadNetwork* network = m_sim.getRoadNetwork())
+            m_reconciler.deadReckon(m_batch, now, *network);
+        m_sim.applyUpdates(m_batch);
+        return count;
+    }
+
+    std::unique_ptr<IFeedHandler> LiveFeed::createHandler(const std::string& url, FeedType type,
+                                                          uint16_t source)
+    {
         switch(type)
         {
-        case FeedType::DUMMY:
-            m_handler = std::make_unique<DummyFeedHandler>(m_sim);
-            break;
         case FeedType::WEBSOCKET:
-            auto wsHandler = std::make_unique<WebSocketFeedHandler>(m_sim);
+        {
+            auto wsHandler = std::make_unique<WebSocketFeedHandler>(m_rings, source);
             wsHandler->setUrl(url);
-            m_handler = std::move(wsHandler);
-            break;
+            return wsHandler;
         }
-
-        if(m_handler)
+        case FeedType::BINARY:
         {
-            m_handler->start();
-
-            if(m_statusCallback)
-            {
-                m_statusCallback(true, "Connected to feed");
-            }
+            auto binaryHandler = std::make_unique<BinaryFeedHandler>(m_rings, source);
+            binaryHandler->setUrl(url);
+            return binaryHandler;
         }
+        case FeedType::DUMMY:
+            break;
+        }
+        return std::make_unique<DummyFeedHandler>(m_rings, m_sim.getRoadNetwork(), source);
     }
 
-    void LiveFeed::disconnect()
+    void LiveFeed::checkSources(double now)
     {
-        if(m_handler)
+        for(auto& source : m_sources)
         {
-            m_handler->stop();
-            m_handler.reset();
+            const bool connected = source.handler->isConnected();
+            if(connected == source.status.connected)
+                continue;
+            source.status.connected = connected;
+            report(connected, "Feed source " + std::to_string(source.status.source) +
+                                  (connected ? " connected: " : " lost its connection: ") +
+                                  source.status.url);
+        }
 
-            if(m_statusCallback)
-            {
-                m_statusCallback(false, "Disconnected from feed");
-            }
+        const double elapsed = now - m_lastReport;
+        if(elapsed < m_statusInterval)
+            return;
+        m_lastReport = now;
+
+        const double wallNow = secondsNow<std::chrono::system_clock>();
+        for(auto& source : m_sources)
+        {
+            FeedSourceStatus& status = source.status;
+            SourceTally& tally = m_tally[status.source];
+            const FeedHandlerStats stats = source.handler->stats();
+
+            status.messagesPerSecond =
+                static_cast<double>(stats.messages - source.reported.messages) / elapsed;
+            status.bytesPerSecond =
+                static_cast<double>(stats.bytes - source.reported.bytes) / elapsed;
+            status.updatesPerSecond = static_cast<double>(tally.updates) / elapsed;
+            status.decodeErrors = stats.decodeErrors;
+            status.clockOffset = m_reconciler.clockOffset(status.source);
+            // Keeps growing while the source is silent
+            status.lag = tally.newest > 0.0 ? wallNow - tally.newest : 0.0;
+            source.reported = stats;
+            tally.updates = 0;
+
+            char figures[192];
+            std::snprintf(figures, sizeof(figures),
+                          "%.0f msg/s, %.0f updates/s, %.1f KB/s, lag %.2f s "
+                          "(clock offset %.2f s), %llu decode errors",
+                          status.messagesPerSecond, status.updatesPerSecond,
+                          status.bytesPerSecond / 1024.0, status.lag, status.clockOffset,
+                          static_cast<unsigned long long>(status.decodeErrors));
+            report(status.connected, "Feed source " + std::to_string(status.source) + " (" +
+                                         status.url + "): " + figures);
         }
     }
 
-    bool LiveFeed::isConnected() const
+    void LiveFeed::report(bool connected, const std::string& message)
+    {
+        if(m_statusCallback)
+            m_statusCallback(connected, message);
+    }
+
+    void LiveFeed::setGeoReference(const GeoReference& reference)
     {
-        return m_handler && m_handler->isRunning();
+        const RoadNetwork* network = m_sim.getRoadNetwork();
+        if(!network)
+        {
+            LOG_ERROR("Cannot map-match the live feed without a road network");
+            return;
+        }
+        m_matcher = std::make_unique<MapMatcher>(*network, reference);
     }
 } // namespace tfv
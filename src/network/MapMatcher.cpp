@@ -0,0 +1,307 @@
+#include "network/MapMatcher.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace tfv
+{
+    namespace
+    {
+        constexpr double kMetresPerDegree = 6378137.0 * 3.14159265358979323846 / 180.0;
+        constexpr float kInfinity = std::numeric_limits<float>::infinity();
+        constexpr int kMaxHops = 4; // Segments a route may cross between two fixes
+    } // namespace
+
+    struct MapMatcher::Shard
+    {
+        struct Step
+        {
+            uint32_t segment;
+            float distance; // Route distance to the start of `segment`
+            int hops;
+        };
+
+        using Tracks = std::unordered_map<uint64_t, Track>;
+
+        Tracks tracks;
+        std::vector<Tracks::node_type> spare; // Dropped tracks, reused before allocating
+        double lastSweep{0.0};                // Local clock
+        std::vector<Candidate> candidates;
+        std::vector<Step> stack;
+        std::size_t matched{0};
+
+        // The vehicle's track, a fresh one if it has none
+        Track& track(uint64_t id)
+        {
+            auto it = tracks.find(id);
+            if(it != tracks.end())
+                return it->second;
+            if(spare.empty())
+                return tracks[id];
+            Tracks::node_type node = std::move(spare.back());
+            spare.pop_back();
+            node.key() = id;
+            node.mapped() = Track{};
+            return tracks.insert(std::move(node)).position->second;
+        }
+
+        void drop(Tracks::iterator it) { spare.push_back(tracks.extract(it)); }
+
+        // Drop tracks idle for longer than maxGap; run at most once per maxGap, so each track
+        // is looked at a bounded number of times however often match() is called
+        void sweep(double now, double maxGap)
+        {
+            if(now - lastSweep < maxGap)
+                return;
+            lastSweep = now;
+            for(auto it = tracks.begin(); it != tracks.end();)
+            {
+                auto next = std::next(it);
+                if(now - it->second.seen > maxGap)
+                    drop(it);
+                it = next;
+            }
+        }
+    };
+
+    MapMatcher::MapMatcher(const RoadNetwork& network, const GeoReference& reference,
+                           std::size_t threads)
+        : m_network(network), m_reference(reference),
+          m_metresPerDegreeLon(kMetresPerDegree *
+                               std::cos(reference.refLat * 3.14159265358979323846 / 180.0)),
+          m_pool(threads)
+    {
+        // Segments leaving each node; a segment's successors are those leaving its end node
+        const auto& segments = network.segments();
+        std::unordered_map<uint32_t, std::vector<uint32_t>> leaving;
+        for(uint32_t i = 0; i < segments.size(); ++i)
+            leaving[segments[i].fromNode].push_back(i);
+
+        m_nextStart.reserve(segments.size() + 1);
+        m_nextStart.push_back(0);
+        for(const auto& segment : segments)
+        {
+            auto it = leaving.find(segment.toNode);
+            if(it != leaving.end())
+                m_next.insert(m_next.end(), it->second.begin(), it->second.end());
+            m_nextStart.push_back(static_cast<uint32_t>(m_next.size()));
+        }
+
+        // One shard per thread; vehicle ids spread evenly enough by modulo
+        for(std::size_t k = 0; k < m_pool.concurrency(); ++k)
+            m_shards.push_back(std::make_unique<Shard>());
+    }
+
+    MapMatcher::~MapMatcher() = default;
+
+    void MapMatcher::project(double lat, double lon, double& x, double& y) const
+    {
+        x = m_reference.refX +
+            (lon - m_reference.refLon) * m_metresPerDegreeLon * m_reference.unitsPerMetre;
+        y = m_reference.refY +
+            (lat - m_reference.refLat) * kMetresPerDegree * m_reference.unitsPerMetre;
+    }
+
+    std::size_t MapMatcher::trackedVehicles() const
+    {
+        std::size_t count = 0;
+        for(const auto& shard : m_shards)
+            count += shard->tracks.size();
+        return count;
+    }
+
+    std::size_t MapMatcher::match(std::span<VehicleUpdate> updates, double now)
+    {
+        if(m_network.geometry().size() == 0)
+            return 0;
+
+        const std::size_t shards = m_shards.size();
+        m_pool.run(shards,
+                   [&](std::size_t k)
+                   {
+                       Shard& shard = *m_shards[k];
+                       shard.matched = 0;
+                       for(auto& update : updates)
+                       {
+                           if(update.id % shards != k)
+                               continue;
+                           if(update.kind == UpdateKind::REMOVE)
+                           {
+                               auto it = shard.tracks.find(update.id);
+                               if(it != shard.tracks.end())
+                                   shard.drop(it);
+                           }
+                           else if(!update.matched() && matchOne(shard, update, now))
+                           {
+                               ++shard.matched;
+                           }
+                       }
+                       shard.sweep(now, m_params.maxGap);
+                   });
+
+        std::size_t matched = 0;
+        for(const auto& shard : m_shards)
+            matched += shard->matched;
+        return matched;
+    }
+
+    bool MapMatcher::matchOne(Shard& shard, VehicleUpdate& update, double now)
+    {
+        const SegmentGeometry& g = m_network.geometry();
+        double worldX, worldY;
+        project(update.lat, update.lon, worldX, worldY);
+        const auto x = static_cast<float>(worldX - g.originX);
+        const auto y = static_cast<float>(worldY - g.originY);
+
+        auto& candidates = shard.candidates;
+        findCandidates(x, y, candidates);
+        Track& track = shard.track(update.id);
+        track.seen = now;
+        if(candidates.empty())
+        {
+            track.count = 0; // Off the network: start afresh at the next fix
+            return false;
+        }
+
+        const auto unitsPerMetre = static_cast<float>(m_reference.unitsPerMetre);
+        const int count = static_cast<int>(candidates.size());
+        float score[kMaxCandidates];
+
+        // Viterbi step from the previous candidates, unless the track has to restart
+        bool restart = track.count == 0 || update.timestamp < track.time ||
+                       update.timestamp - track.time > m_params.maxGap;
+        if(!restart)
+        {
+            const float line = std::hypot(x - track.x, y - track.y);
+            const float bound = line + 2.0f * m_params.searchRadius * unitsPerMetre;
+            const float scale = 1.0f / (m_params.beta * unitsPerMetre);
+            std::fill(score, score + count, -kInfinity);
+
+            float route[kMaxCandidates];
+            for(int i = 0; i < track.count; ++i)
+            {
+                routeDistances(track.segment[i], track.offset[i], candidates.data(), count, bound,
+                               route, shard);
+                for(int j = 0; j < count; ++j)
+                {
+                    if(route[j] == kInfinity)
+                        continue;
+                    const float s = track.score[i] - std::fabs(route[j] - line) * scale;
+                    score[j] = std::max(score[j], s);
+                }
+            }
+            restart = std::all_of(score, score + count, [](float s) { return s == -kInfinity; });
+        }
+        if(restart)
+            std::fill(score, score + count, 0.0f);
+
+        // Emission: Gaussian in the distance from the fix
+        int best = 0;
+        for(int j = 0; j < count; ++j)
+        {
+            const float error = candidates[j].distance / (m_params.gpsSigma * unitsPerMetre);
+            score[j] -= 0.5f * error * error;
+            if(score[j] > score[best])
+                best = j;
+        }
+
+        // Keep the reachable candidates, normalised so the best scores 0; the best one's
+        // share of the total probability is the confidence
+        const float top = score[best];
+        float total = 0.0f;
+        track.count = 0;
+        for(int j = 0; j < count; ++j)
+        {
+            if(score[j] == -kInfinity)
+                continue;
+            const float normalised = score[j] - top;
+            total += std::exp(normalised);
+            track.segment[track.count] = candidates[j].segment;
+            track.offset[track.count] = candidates[j].offset;
+            track.score[track.count] = normalised;
+            ++track.count;
+        }
+        track.time = update.timestamp;
+        track.x = x;
+        track.y = y;
+
+        const Candidate& chosen = candidates[best];
+        const float length = g.length[chosen.segment];
+        update.segmentId = g.ids[chosen.segment];
+        update.position = length > 0.0f ? std::clamp(chosen.offset / length, 0.0f, 1.0f) : 0.0f;
+        update.confidence = 1.0f / total;
+        return true;
+    }
+
+    void MapMatcher::findCandidates(float x, float y, std::vector<Candidate>& out) const
+    {
+        const SegmentGeometry& g = m_network.geometry();
+        const float radius = m_params.searchRadius * static_cast<float>(m_reference.unitsPerMetre);
+        out.clear();
+        m_network.segmentIndex().visit(
+            x - radius, y - radius, x + radius, y + radius,
+            [&](uint32_t i)
+            {
+                // Closest point on the segment (as RoadNetwork::nearestSegment)
+                const float px = x - g.x1[i], py = y - g.y1[i];
+                const float along = std::clamp(px * g.dirX[i] + py * g.dirY[i], 0.f, g.length[i]);
+                const float distance = std::hypot(px - along * g.dirX[i], py - along * g.dirY[i]);
+                if(distance > radius)
+                    return;
+                // A segment spanning several cells is visited once per cell
+                for(const auto& c : out)
+                    if(c.segment == i)
+                        return;
+                out.push_back({i, along, distance});
+            });
+
+        if(out.size() > kMaxCandidates)
+        {
+            std::partial_sort(out.begin(), out.begin() + kMaxCandidates, out.end(),
+                              [](const Candidate& a, const Candidate& b)
+                              { return a.distance < b.distance; });
+            out.resize(kMaxCandidates);
+        }
+    }
+
+    void MapMatcher::routeDistances(uint32_t from, float fromOffset, const Candidate* to,
+                                    int count, float bound, float* out, Shard& shard) const
+    {
+        const SegmentGeometry& g = m_network.geometry();
+
+        // Along the same segment; a little backwards is GPS noise, not a U-turn
+        const float slack = 2.0f * m_params.gpsSigma * static_cast<float>(m_reference.unitsPerMetre);
+        for(int j = 0; j < count; ++j)
+        {
+            out[j] = kInfinity;
+            if(to[j].segment == from && to[j].offset >= fromOffset - slack)
+                out[j] = std::fabs(to[j].offset - fromOffset);
+        }
+
+        // Bounded depth-first search along outgoing segments
+        const float rest = g.length[from] - fromOffset;
+        if(rest > bound)
+            return;
+        auto& stack = shard.stack;
+        stack.clear();
+        for(uint32_t k = m_nextStart[from]; k < m_nextStart[from + 1]; ++k)
+            stack.push_back({m_next[k], rest, 1});
+
+        while(!stack.empty())
+        {
+            const auto step = stack.back();
+            stack.pop_back();
+            for(int j = 0; j < count; ++j)
+                if(to[j].segment == step.segment)
+                    out[j] = std::min(out[j], step.distance + to[j].offset);
+
+            const float next = step.distance + g.length[step.segment];
+            if(next > bound || step.hops >= kMaxHops)
+                continue;
+            for(uint32_t k = m_nextStart[step.segment]; k < m_nextStart[step.segment + 1]; ++k)
+                stack.push_back({m_next[k], next, step.hops + 1});
+        }
+    }
+} // namespace tfv
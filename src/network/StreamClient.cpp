@@ -0,0 +1,275 @@
+#include "network/StreamClient.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <thread>
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace tfv
+{
+    bool parseStreamUrl(std::string_view url, StreamEndpoint& out)
+    {
+        StreamEndpoint result;
+        if(url.starts_with("unix://"))
+        {
+            result.local = true;
+            result.path = std::string(url.substr(7));
+            if(result.path.empty())
+                return false;
+            out = std::move(result);
+            return true;
+        }
+        if(!url.starts_with("tcp://"))
+            return false;
+        url.remove_prefix(6);
+        if(!url.empty() && url.back() == '/')
+            url.remove_suffix(1);
+
+        // host:port, with IPv6 literals bracketed
+        const std::size_t colon = url.rfind(':');
+        if(colon == std::string_view::npos || colon == 0)
+            return false;
+        std::string_view host = url.substr(0, colon);
+        if(host.front() == '[' && host.back() == ']')
+            host = host.substr(1, host.size() - 2);
+        const std::string_view port = url.substr(colon + 1);
+
+        unsigned value = 0;
+        auto [end, ec] = std::from_chars(port.data(), port.data() + port.size(), value);
+        if(host.empty() || ec != std::errc() || end != port.data() + port.size() || value == 0 ||
+           value > 65535)
+            return false;
+        result.host = std::string(host);
+        result.port = static_cast<uint16_t>(value);
+        out = std::move(result);
+        return true;
+    }
+
+#ifdef _WIN32
+    // Windows has no poll-based implementation yet; connecting always fails
+    StreamClient::StreamClient() = default;
+    StreamClient::~StreamClient() = default;
+
+    bool StreamClient::connect(const StreamEndpoint&, int)
+    {
+        return fail("stream feeds are not supported on this platform");
+    }
+    long StreamClient::read(uint8_t*, std::size_t, int) { return -1; }
+    void StreamClient::close() {}
+    void StreamClient::wake() {}
+    bool StreamClient::sleep(int ms)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return false;
+    }
+    bool StreamClient::fail(const std::string& reason)
+    {
+        m_error = reason;
+        return false;
+    }
+    void StreamClient::drainWake() {}
+#else
+    namespace
+    {
+        void setNonBlocking(int fd)
+        {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+
+        // Finish a non-blocking connect within `timeoutMs`; 0 or -1 with errno set
+        int finishConnect(int fd, int rc, int timeoutMs)
+        {
+            if(rc == 0 || errno != EINPROGRESS)
+                return rc;
+            pollfd pfd{fd, POLLOUT, 0};
+            if(::poll(&pfd, 1, timeoutMs) <= 0)
+            {
+                errno = ETIMEDOUT;
+                return -1;
+            }
+            int error = 0;
+            socklen_t length = sizeof(error);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            errno = error;
+            return error == 0 ? 0 : -1;
+        }
+    } // namespace
+
+    StreamClient::StreamClient()
+    {
+        int fds[2];
+        if(pipe(fds) == 0)
+        {
+            m_wakeRead = fds[0];
+            m_wakeWrite = fds[1];
+            setNonBlocking(m_wakeRead);
+            setNonBlocking(m_wakeWrite);
+        }
+    }
+
+    StreamClient::~StreamClient()
+    {
+        close();
+        if(m_wakeRead >= 0)
+            ::close(m_wakeRead);
+        if(m_wakeWrite >= 0)
+            ::close(m_wakeWrite);
+    }
+
+    bool StreamClient::connect(const StreamEndpoint& endpoint, int timeoutMs)
+    {
+        close();
+        m_error.clear();
+
+        if(endpoint.local)
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if(endpoint.path.size() >= sizeof(address.sun_path))
+                return fail("socket path too long: " + endpoint.path);
+            std::memcpy(address.sun_path, endpoint.path.c_str(), endpoint.path.size() + 1);
+
+            const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if(fd < 0)
+                return fail(std::string("cannot create socket: ") + std::strerror(errno));
+            setNonBlocking(fd);
+            const int rc =
+                ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+            if(finishConnect(fd, rc, timeoutMs) != 0)
+            {
+                const std::string reason = std::strerror(errno);
+                ::close(fd);
+                return fail("cannot connect to " + endpoint.path + ": " + reason);
+            }
+            m_fd = fd;
+            return true;
+        }
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        const std::string port = std::to_string(endpoint.port);
+        if(const int rc = getaddrinfo(endpoint.host.c_str(), port.c_str(), &hints, &addresses))
+            return fail("cannot resolve " + endpoint.host + ": " + gai_strerror(rc));
+
+        std::string lastError = "no addresses";
+        for(addrinfo* a = addresses; a && m_fd < 0; a = a->ai_next)
+        {
+            const int fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if(fd < 0)
+                continue;
+            setNonBlocking(fd);
+            const int one = 1;
+            setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            if(finishConnect(fd, ::connect(fd, a->ai_addr, a->ai_addrlen), timeoutMs) != 0)
+            {
+                lastError = std::strerror(errno);
+                ::close(fd);
+                continue;
+            }
+            m_fd = fd;
+        }
+        freeaddrinfo(addresses);
+        if(m_fd < 0)
+            return fail("cannot connect to " + endpoint.host + ":" + port + ": " + lastError);
+        return true;
+    }
+
+    long StreamClient::read(uint8_t* buffer, std::size_t capacity, int timeoutMs)
+    {
+        if(m_fd < 0)
+            return -1;
+
+        // Try first: under load data is usually already waiting and poll() can be skipped
+        for(bool polled = false;; polled = true)
+        {
+            const ssize_t n = ::recv(m_fd, buffer, capacity, 0);
+            if(n > 0)
+                return static_cast<long>(n);
+            if(n == 0)
+            {
+                fail("connection closed by the peer");
+                close();
+                return -1;
+            }
+            if(errno == EINTR)
+                continue;
+            if(errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                fail(std::string("read failed: ") + std::strerror(errno));
+                close();
+                return -1;
+            }
+            if(polled)
+                return 0;
+
+            pollfd fds[2] = {{m_fd, POLLIN, 0}, {m_wakeRead, POLLIN, 0}};
+            if(::poll(fds, 2, timeoutMs) <= 0)
+                return 0;
+            if(fds[1].revents & POLLIN)
+            {
+                drainWake();
+                return 0;
+            }
+        }
+    }
+
+    void StreamClient::close()
+    {
+        if(m_fd >= 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    void StreamClient::wake()
+    {
+        const uint8_t one = 1;
+        [[maybe_unused]] ssize_t written = ::write(m_wakeWrite, &one, sizeof(one));
+    }
+
+    bool StreamClient::sleep(int ms)
+    {
+        pollfd fd{m_wakeRead, POLLIN, 0};
+        if(::poll(&fd, 1, ms) > 0 && (fd.revents & POLLIN))
+        {
+            drainWake();
+            return true;
+        }
+        return false;
+    }
+
+    bool StreamClient::fail(const std::string& reason)
+    {
+        m_error = reason;
+        return false;
+    }
+
+    void StreamClient::drainWake()
+    {
+        uint8_t drained[64];
+        while(::read(m_wakeRead, drained, sizeof(drained)) > 0)
+        {
+        }
+    }
+#endif
+} // namespace tfv
@@ -0,0 +1,396 @@
+#include "network/WebSocket.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <random>
+
+namespace tfv
+{
+    namespace websocket
+    {
+        namespace
+        {
+            constexpr std::string_view kGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+            uint32_t rotl(uint32_t x, int n)
+            {
+                return (x << n) | (x >> (32 - n));
+            }
+
+            // SHA-1, needed only for the handshake's accept key
+            std::array<uint8_t, 20> sha1(std::string_view input)
+            {
+                uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+                std::string message(input);
+                const uint64_t bits = static_cast<uint64_t>(input.size()) * 8;
+                message.push_back(static_cast<char>(0x80));
+                while(message.size() % 64 != 56)
+                    message.push_back('\0');
+                for(int i = 7; i >= 0; --i)
+                    message.push_back(static_cast<char>(bits >> (8 * i)));
+
+                for(std::size_t chunk = 0; chunk < message.size(); chunk += 64)
+                {
+                    uint32_t w[80];
+                    for(int i = 0; i < 16; ++i)
+                    {
+                        const auto* p =
+                            reinterpret_cast<const uint8_t*>(message.data() + chunk + 4 * i);
+                        w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+                               (uint32_t(p[2]) << 8) | p[3];
+                    }
+                    for(int i = 16; i < 80; ++i)
+                        w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+                    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+                    for(int i = 0; i < 80; ++i)
+                    {
+                        uint32_t f, k;
+                        if(i < 20)
+                            f = (b & c) | (~b & d), k = 0x5A827999;
+                        else if(i < 40)
+                            f = b ^ c ^ d, k = 0x6ED9EBA1;
+                        else if(i < 60)
+                            f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+                        else
+                            f = b ^ c ^ d, k = 0xCA62C1D6;
+                        const uint32_t t = rotl(a, 5) + f + e + k + w[i];
+                        e = d;
+                        d = c;
+                        c = rotl(b, 30);
+                        b = a;
+                        a = t;
+                    }
+                    h[0] += a;
+                    h[1] += b;
+                    h[2] += c;
+                    h[3] += d;
+                    h[4] += e;
+                }
+
+                std::array<uint8_t, 20> digest;
+                for(int i = 0; i < 20; ++i)
+                    digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+                return digest;
+            }
+
+            std::string base64(const uint8_t* data, std::size_t size)
+            {
+                static constexpr char kAlphabet[] =
+                    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+                std::string out;
+                out.reserve((size + 2) / 3 * 4);
+                for(std::size_t i = 0; i < size; i += 3)
+                {
+                    const uint32_t n = (uint32_t(data[i]) << 16) |
+                                       (i + 1 < size ? uint32_t(data[i + 1]) << 8 : 0) |
+                                       (i + 2 < size ? uint32_t(data[i + 2]) : 0);
+                    out.push_back(kAlphabet[(n >> 18) & 63]);
+                    out.push_back(kAlphabet[(n >> 12) & 63]);
+                    out.push_back(i + 1 < size ? kAlphabet[(n >> 6) & 63] : '=');
+                    out.push_back(i + 2 < size ? kAlphabet[n & 63] : '=');
+                }
+                return out;
+            }
+
+            bool equalsIgnoreCase(std::string_view a, std::string_view b)
+            {
+                return a.size() == b.size() &&
+                       std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+                                  { return std::tolower(static_cast<unsigned char>(x)) ==
+                                           std::tolower(static_cast<unsigned char>(y)); });
+            }
+
+            bool containsToken(std::string_view list, std::string_view token)
+            {
+                // Comma-separated header value, e.g. "keep-alive, Upgrade"
+                while(!list.empty())
+                {
+                    const std::size_t comma = std::min(list.find(','), list.size());
+                    std::string_view item = list.substr(0, comma);
+                    while(!item.empty() && item.front() == ' ')
+                        item.remove_prefix(1);
+                    while(!item.empty() && item.back() == ' ')
+                        item.remove_suffix(1);
+                    if(equalsIgnoreCase(item, token))
+                        return true;
+                    list.remove_prefix(std::min(comma + 1, list.size()));
+                }
+                return false;
+            }
+        } // namespace
+
+        bool parseUrl(std::string_view url, Url& out)
+        {
+            constexpr std::string_view kScheme = "ws://";
+            if(url.size() < kScheme.size() || !equalsIgnoreCase(url.substr(0, 5), kScheme))
+                return false;
+            url.remove_prefix(kScheme.size());
+
+            const std::size_t slash = std::min(url.find('/'), url.size());
+            std::string_view authority = url.substr(0, slash);
+            Url result;
+            result.path = slash < url.size() ? std::string(url.substr(slash)) : "/";
+
+            // Bracketed IPv6 literal, or host[:port]
+            std::string_view host = authority;
+            std::string_view port;
+            if(!authority.empty() && authority.front() == '[')
+            {
+                const std::size_t close = authority.find(']');
+                if(close == std::string_view::npos)
+                    return false;
+                host = authority.substr(1, close - 1);
+                if(close + 1 < authority.size())
+                {
+                    if(authority[close + 1] != ':')
+                        return false;
+                    port = authority.substr(close + 2);
+                }
+            }
+            else if(const std::size_t colon = authority.rfind(':');
+                    colon != std::string_view::npos)
+            {
+                host = authority.substr(0, colon);
+                port = authority.substr(colon + 1);
+            }
+            if(host.empty())
+                return false;
+            result.host = std::string(host);
+
+            if(!port.empty())
+            {
+                unsigned value = 0;
+                auto [end, ec] = std::from_chars(port.data(), port.data() + port.size(), value);
+                if(ec != std::errc() || end != port.data() + port.size() || value == 0 ||
+                   value > 65535)
+                    return false;
+                result.port = static_cast<uint16_t>(value);
+            }
+
+            out = std::move(result);
+            return true;
+        }
+
+        std::string makeKey()
+        {
+            thread_local std::mt19937 rng{std::random_device{}()};
+            uint8_t nonce[16];
+            for(uint8_t& byte : nonce)
+                byte = static_cast<uint8_t>(rng());
+            return base64(nonce, sizeof(nonce));
+        }
+
+        std::string acceptFor(std::string_view key)
+        {
+            std::string input(key);
+            input.append(kGuid);
+            const auto digest = sha1(input);
+            return base64(digest.data(), digest.size());
+        }
+
+        std::string handshakeRequest(const Url& url, std::string_view key)
+        {
+            const bool ipv6 = url.host.find(':') != std::string::npos;
+            std::string host = ipv6 ? "[" + url.host + "]" : url.host;
+            if(url.port != 80)
+                host += ":" + std::to_string(url.port);
+
+            std::string request = "GET " + url.path + " HTTP/1.1\r\n";
+            request += "Host: " + host + "\r\n";
+            request += "Upgrade: websocket\r\n";
+            request += "Connection: Upgrade\r\n";
+            request += "Sec-WebSocket-Key: ";
+            request += key;
+            request += "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+            return request;
+        }
+
+        bool checkHandshakeResponse(std::string_view response, std::string_view key,
+                                    std::string& error)
+        {
+            const std::size_t lineEnd = response.find("\r\n");
+            const std::string_view status = response.substr(0, lineEnd);
+            if(status.substr(0, 9) != "HTTP/1.1 " || status.substr(9, 3) != "101")
+            {
+                error = "server refused the upgrade: " + std::string(status);
+                return false;
+            }
+
+            bool upgrade = false, connection = false, accepted = false;
+            const std::string expected = acceptFor(key);
+            std::size_t pos = lineEnd + 2;
+            while(pos < response.size())
+            {
+                const std::size_t end = std::min(response.find("\r\n", pos), response.size());
+                const std::string_view line = response.substr(pos, end - pos);
+                pos = end + 2;
+
+                const std::size_t colon = line.find(':');
+                if(colon == std::string_view::npos)
+                    continue;
+                const std::string_view name = line.substr(0, colon);
+                std::string_view value = line.substr(colon + 1);
+                while(!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+                    value.remove_prefix(1);
+                while(!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+                    value.remove_suffix(1);
+
+                if(equalsIgnoreCase(name, "Upgrade"))
+                    upgrade = equalsIgnoreCase(value, "websocket");
+                else if(equalsIgnoreCase(name, "Connection"))
+                    connection = containsToken(value, "Upgrade");
+                else if(equalsIgnoreCase(name, "Sec-WebSocket-Accept"))
+                    accepted = value == expected;
+                else if(equalsIgnoreCase(name, "Sec-WebSocket-Extensions") && !value.empty())
+                {
+                    error = "server negotiated an extension that was not offered";
+                    return false;
+                }
+            }
+
+            if(!upgrade || !connection)
+                error = "response is missing the Upgrade/Connection headers";
+            else if(!accepted)
+                error = "Sec-WebSocket-Accept does not match the key";
+            return upgrade && connection && accepted;
+        }
+
+        void applyMask(uint8_t* data, std::size_t size, uint32_t maskKey, std::size_t offset)
+        {
+            // Rotate the key so byte 0 of `data` lines up with its byte (offset % 4)
+            uint8_t key[4];
+            for(int i = 0; i < 4; ++i)
+                key[i] = static_cast<uint8_t>(maskKey >> (8 * (3 - (offset + i) % 4)));
+
+            // Eight bytes at a time; the compiler widens this further where it can
+            uint64_t wide;
+            uint8_t pattern[8];
+            for(int i = 0; i < 8; ++i)
+                pattern[i] = key[i % 4];
+            std::memcpy(&wide, pattern, sizeof(wide));
+
+            std::size_t i = 0;
+            for(; i + 8 <= size; i += 8)
+            {
+                uint64_t chunk;
+                std::memcpy(&chunk, data + i, sizeof(chunk));
+                chunk ^= wide;
+                std::memcpy(data + i, &chunk, sizeof(chunk));
+            }
+            for(; i < size; ++i)
+                data[i] ^= key[i % 4];
+        }
+
+        void encodeFrame(Opcode opcode, const uint8_t* payload, std::size_t size, bool masked,
+                         uint32_t maskKey, std::vector<uint8_t>& out, bool fin)
+        {
+            out.push_back(static_cast<uint8_t>((fin ? 0x80 : 0x00) | static_cast<uint8_t>(opcode)));
+            const uint8_t maskBit = masked ? 0x80 : 0x00;
+            if(size < 126)
+            {
+                out.push_back(static_cast<uint8_t>(maskBit | size));
+            }
+            else if(size <= 0xFFFF)
+            {
+                out.push_back(maskBit | 126);
+                out.push_back(static_cast<uint8_t>(size >> 8));
+                out.push_back(static_cast<uint8_t>(size));
+            }
+            else
+            {
+                out.push_back(maskBit | 127);
+                for(int i = 7; i >= 0; --i)
+                    out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(size) >> (8 * i)));
+            }
+            if(masked)
+            {
+                for(int i = 3; i >= 0; --i)
+                    out.push_back(static_cast<uint8_t>(maskKey >> (8 * i)));
+            }
+
+            const std::size_t start = out.size();
+            out.insert(out.end(), payload, payload + size);
+            if(masked)
+                applyMask(out.data() + start, size, maskKey);
+        }
+
+        bool FrameParser::readHeader(const uint8_t* data, std::size_t size, Header& header)
+        {
+            if(size < 2)
+                return false;
+
+            header.fin = (data[0] & 0x80) != 0;
+            header.opcode = static_cast<Opcode>(data[0] & 0x0F);
+            if(data[0] & 0x70)
+                return fail(kCloseProtocolError, "reserved bits set without an extension");
+            if(data[1] & 0x80)
+                return fail(kCloseProtocolError, "masked frame from the server");
+
+            switch(header.opcode)
+            {
+            case Opcode::CONTINUATION:
+            case Opcode::TEXT:
+            case Opcode::BINARY:
+                break;
+            case Opcode::CLOSE:
+            case Opcode::PING:
+            case Opcode::PONG:
+                if(!header.fin || (data[1] & 0x7F) > 125)
+                    return fail(kCloseProtocolError, "fragmented or oversized control frame");
+                break;
+            default:
+                return fail(kCloseProtocolError, "unknown opcode");
+            }
+
+            const uint8_t length = data[1] & 0x7F;
+            std::size_t pos = 2;
+            if(length == 126)
+            {
+                if(size < 4)
+                    return false;
+                header.payloadSize = (uint64_t(data[2]) << 8) | data[3];
+                pos = 4;
+            }
+            else if(length == 127)
+            {
+                if(size < 10)
+                    return false;
+                header.payloadSize = 0;
+                for(int i = 0; i < 8; ++i)
+                    header.payloadSize = (header.payloadSize << 8) | data[2 + i];
+                pos = 10;
+            }
+            else
+            {
+                header.payloadSize = length;
+            }
+
+            if(header.payloadSize > m_maxMessageSize)
+                return fail(kCloseTooBig, "frame too large");
+
+            header.headerSize = pos;
+            return true;
+        }
+
+        bool FrameParser::fail(uint16_t code, const char* reason)
+        {
+            m_closeCode = code;
+            m_error = reason;
+            return false;
+        }
+
+        void FrameParser::reset()
+        {
+            m_fragments.clear();
+            m_fragmentOpcode = Opcode::CONTINUATION;
+            m_closeCode = 0;
+            m_error.clear();
+        }
+    } // namespace websocket
+
+} // namespace tfv
@@ -0,0 +1,498 @@
+#include "network/WebSocketClient.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <thread>
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace tfv
+{
+    namespace
+    {
+        constexpr std::size_t kReadChunk = 256 * 1024; // Free space kept for each recv()
+        constexpr std::size_t kMaxHandshakeSize = 16 * 1024;
+        constexpr int kMaxReadsPerPoll = 64; // Let writes and wake-ups through under load
+
+        int remaining(std::chrono::steady_clock::time_point deadline)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            return static_cast<int>(std::max<int64_t>(left.count(), 0));
+        }
+    } // namespace
+
+#ifdef _WIN32
+    // Windows has no epoll/poll-based implementation yet; connecting always fails
+    WebSocketClient::WebSocketClient() = default;
+    WebSocketClient::~WebSocketClient() = default;
+
+    bool WebSocketClient::connect(const websocket::Url&, int)
+    {
+        return fail("WebSocket feeds are not supported on this platform");
+    }
+    bool WebSocketClient::poll(int, const MessageHandler&) { return false; }
+    void WebSocketClient::sendPing() {}
+    void WebSocketClient::close(uint16_t) {}
+    void WebSocketClient::wake() {}
+    bool WebSocketClient::sleep(int ms)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return false;
+    }
+    bool WebSocketClient::fail(const std::string& reason)
+    {
+        m_error = reason;
+        return false;
+    }
+#else
+    WebSocketClient::WebSocketClient()
+    {
+#ifdef __linux__
+        m_wakeRead = m_wakeWrite = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        m_poller = epoll_create1(EPOLL_CLOEXEC);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = m_wakeRead;
+        epoll_ctl(m_poller, EPOLL_CTL_ADD, m_wakeRead, &event);
+#else
+        int fds[2];
+        if(pipe(fds) == 0)
+        {
+            m_wakeRead = fds[0];
+            m_wakeWrite = fds[1];
+            for(int fd : fds)
+            {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+        }
+#endif
+    }
+
+    WebSocketClient::~WebSocketClient()
+    {
+        closeSocket();
+        if(m_poller >= 0)
+            ::close(m_poller);
+        if(m_wakeWrite >= 0 && m_wakeWrite != m_wakeRead)
+            ::close(m_wakeWrite);
+        if(m_wakeRead >= 0)
+            ::close(m_wakeRead);
+    }
+
+    void WebSocketClient::wake()
+    {
+        const uint64_t one = 1; // An eventfd takes 8 bytes; a pipe just needs any
+        [[maybe_unused]] ssize_t written = ::write(m_wakeWrite, &one, sizeof(one));
+    }
+
+    int WebSocketClient::wait(bool wantWrite, int timeoutMs)
+    {
+        int events = 0;
+#ifdef __linux__
+        if(m_fd >= 0 && wantWrite != m_pollingWrite)
+        {
+            uint32_t mask = EPOLLIN | EPOLLRDHUP;
+            if(wantWrite)
+                mask |= EPOLLOUT;
+            epoll_event event{};
+            event.events = mask;
+            event.data.fd = m_fd;
+            epoll_ctl(m_poller, EPOLL_CTL_MOD, m_fd, &event);
+            m_pollingWrite = wantWrite;
+        }
+        epoll_event ready[2];
+        const int count = epoll_wait(m_poller, ready, 2, timeoutMs);
+        for(int i = 0; i < count; ++i)
+        {
+            if(ready[i].data.fd == m_wakeRead)
+            {
+                events |= WOKEN;
+                continue;
+            }
+            if(ready[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))
+                events |= READABLE;
+            if(ready[i].events & EPOLLOUT)
+                events |= WRITABLE;
+            if(ready[i].events & EPOLLERR)
+                events |= FAILED;
+        }
+#else
+        pollfd fds[2] = {{m_wakeRead, POLLIN, 0}, {m_fd, POLLIN, 0}};
+        if(wantWrite)
+            fds[1].events |= POLLOUT;
+        const nfds_t count = m_fd >= 0 ? 2 : 1;
+        if(::poll(fds, count, timeoutMs) > 0)
+        {
+            if(fds[0].revents & POLLIN)
+                events |= WOKEN;
+            if(fds[1].revents & (POLLIN | POLLHUP))
+                events |= READABLE;
+            if(fds[1].revents & POLLOUT)
+                events |= WRITABLE;
+            if(fds[1].revents & POLLERR)
+                events |= FAILED;
+        }
+#endif
+        if(events & WOKEN)
+        {
+            uint64_t drained;
+            while(::read(m_wakeRead, &drained, sizeof(drained)) > 0)
+            {
+            }
+        }
+        return events;
+    }
+
+    bool WebSocketClient::sleep(int ms)
+    {
+        // Only the wake-up descriptor is watched, whatever the connection is doing
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        pollfd fd{m_wakeRead, POLLIN, 0};
+        while(::poll(&fd, 1, remaining(deadline)) != 0)
+        {
+            if(fd.revents & POLLIN)
+            {
+                uint64_t drained;
+                while(::read(m_wakeRead, &drained, sizeof(drained)) > 0)
+                {
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool WebSocketClient::fail(const std::string& reason)
+    {
+        m_error = reason;
+        closeSocket();
+        return false;
+    }
+
+    void WebSocketClient::closeSocket()
+    {
+        if(m_fd < 0)
+            return;
+#ifdef __linux__
+        epoll_ctl(m_poller, EPOLL_CTL_DEL, m_fd, nullptr);
+#endif
+        ::close(m_fd);
+        m_fd = -1;
+        m_pollingWrite = false;
+        m_begin = m_end = 0;
+        m_out.clear();
+        m_outPos = 0;
+    }
+
+    bool WebSocketClient::connect(const websocket::Url& url, int timeoutMs)
+    {
+        closeSocket();
+        m_error.clear();
+        m_parser.reset();
+        m_closeSent = m_closeReceived = false;
+
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        if(!connectSocket(url, deadline) || !handshake(url, deadline))
+            return false;
+        m_lastReceive = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool WebSocketClient::connectSocket(const websocket::Url& url,
+                                        std::chrono::steady_clock::time_point deadline)
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        const std::string port = std::to_string(url.port);
+        if(const int rc = getaddrinfo(url.host.c_str(), port.c_str(), &hints, &addresses))
+            return fail("cannot resolve " + url.host + ": " + gai_strerror(rc));
+
+        std::string lastError = "no addresses";
+        for(addrinfo* a = addresses; a && m_fd < 0; a = a->ai_next)
+        {
+            const int fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if(fd < 0)
+                continue;
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            const int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+            int rc = ::connect(fd, a->ai_addr, a->ai_addrlen);
+            if(rc != 0 && errno == EINPROGRESS)
+            {
+                pollfd pfd{fd, POLLOUT, 0};
+                rc = -1;
+                if(::poll(&pfd, 1, remaining(deadline)) > 0)
+                {
+                    int error = 0;
+                    socklen_t length = sizeof(error);
+                    getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                    errno = error;
+                    rc = error == 0 ? 0 : -1;
+                }
+                else
+                {
+                    errno = ETIMEDOUT;
+                }
+            }
+            if(rc != 0)
+            {
+                lastError = std::strerror(errno);
+                ::close(fd);
+                continue;
+            }
+            m_fd = fd;
+        }
+        freeaddrinfo(addresses);
+        if(m_fd < 0)
+            return fail("cannot connect to " + url.host + ":" + port + ": " + lastError);
+
+#ifdef __linux__
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = m_fd;
+        epoll_ctl(m_poller, EPOLL_CTL_ADD, m_fd, &event);
+#endif
+        if(m_in.size() < kReadChunk)
+            m_in.resize(kReadChunk);
+        return true;
+    }
+
+    bool WebSocketClient::handshake(const websocket::Url& url,
+                                    std::chrono::steady_clock::time_point deadline)
+    {
+        const std::string key = websocket::makeKey();
+        const std::string request = websocket::handshakeRequest(url, key);
+        m_out.assign(request.begin(), request.end());
+        m_outPos = 0;
+
+        // Send the request and read up to the blank line ending the response headers
+        std::size_t headerEnd = std::string_view::npos;
+        while(headerEnd == std::string_view::npos)
+        {
+            const int timeout = remaining(deadline);
+            if(timeout == 0)
+                return fail("handshake timed out");
+            const int events = wait(!m_out.empty(), timeout);
+            if(events & FAILED)
+                return fail("connection failed during the handshake");
+            if((events & WRITABLE) && !flush())
+                return false;
+            if(events & READABLE)
+            {
+                if(readInput() < 0)
+                    return false;
+                const std::string_view received(reinterpret_cast<const char*>(m_in.data()),
+                                                m_end);
+                headerEnd = received.find("\r\n\r\n");
+                if(headerEnd == std::string_view::npos && m_end > kMaxHandshakeSize)
+                    return fail("handshake response too large");
+            }
+        }
+
+        const std::string_view response(reinterpret_cast<const char*>(m_in.data()),
+                                        headerEnd + 4);
+        std::string error;
+        if(!websocket::checkHandshakeResponse(response, key, error))
+            return fail(error);
+
+        // Frames sent right behind the response stay buffered for the first poll()
+        m_begin = headerEnd + 4;
+        if(m_begin == m_end)
+            m_begin = m_end = 0;
+        return true;
+    }
+
+    int WebSocketClient::readInput()
+    {
+        // Keep a full chunk free behind the data: slide a partial frame to the front, and
+        // grow only when a single frame is larger than the buffer
+        if(m_in.size() - m_end < kReadChunk)
+        {
+            if(m_begin > 0)
+            {
+                std::memmove(m_in.data(), m_in.data() + m_begin, m_end - m_begin);
+                m_end -= m_begin;
+                m_begin = 0;
+            }
+            if(m_in.size() - m_end < kReadChunk)
+                m_in.resize(m_end + kReadChunk);
+        }
+
+        while(true)
+        {
+            const ssize_t n = ::recv(m_fd, m_in.data() + m_end, m_in.size() - m_end, 0);
+            if(n > 0)
+            {
+                m_end += static_cast<std::size_t>(n);
+                m_lastReceive = std::chrono::steady_clock::now();
+                return static_cast<int>(n);
+            }
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return 0;
+            if(n < 0 && errno == EINTR)
+                continue;
+            fail(n == 0 ? std::string("connection closed by the server")
+                        : std::string("receive failed: ") + std::strerror(errno));
+            return -1;
+        }
+    }
+
+    bool WebSocketClient::poll(int timeoutMs, const MessageHandler& onMessage)
+    {
+        if(m_fd < 0)
+            return false;
+
+        // Frames that arrived with the handshake response
+        if(m_end > m_begin && !processInput(&onMessage))
+            return false;
+
+        const int events = wait(!m_out.empty(), timeoutMs);
+        if(events & FAILED)
+            return fail("socket error");
+        if((events & WRITABLE) && !flush())
+            return false;
+        if(events & READABLE)
+        {
+            // Parse after every read so the buffer only ever holds about one chunk; a full
+            // chunk means more is probably waiting
+            for(int reads = 0; reads < kMaxReadsPerPoll; ++reads)
+            {
+                const int n = readInput();
+                if(n < 0 || (n > 0 && !processInput(&onMessage)))
+                    return false;
+                if(static_cast<std::size_t>(n) < kReadChunk)
+                    break;
+            }
+        }
+        return m_fd >= 0;
+    }
+
+    bool WebSocketClient::processInput(const MessageHandler* onMessage)
+    {
+        const std::size_t consumed = m_parser.parse(
+            m_in.data() + m_begin, m_end - m_begin,
+            [&](const Message& message)
+            {
+                if(m_closeReceived)
+                    return; // Nothing after a close frame counts
+                switch(message.opcode)
+                {
+                case websocket::Opcode::PING:
+                    queueFrame(websocket::Opcode::PONG, message.data, message.size);
+                    break;
+                case websocket::Opcode::PONG:
+                    break;
+                case websocket::Opcode::CLOSE:
+                    m_closeReceived = true;
+                    if(!m_closeSent) // Echo the status code back
+                        queueFrame(websocket::Opcode::CLOSE, message.data,
+                                   std::min<std::size_t>(message.size, 2));
+                    break;
+                default:
+                    if(onMessage && *onMessage)
+                        (*onMessage)(message);
+                    break;
+                }
+            });
+        m_begin += consumed;
+        if(m_begin == m_end)
+            m_begin = m_end = 0;
+
+        if(m_parser.failed())
+        {
+            const std::string reason = "protocol error: " + m_parser.error();
+            close(m_parser.closeCode());
+            m_error = reason;
+            return false;
+        }
+        if(m_closeReceived)
+        {
+            flush();
+            return fail("closed by the server");
+        }
+        return m_out.empty() || flush();
+    }
+
+    void WebSocketClient::queueFrame(websocket::Opcode opcode, const uint8_t* payload,
+                                     std::size_t size)
+    {
+        if(m_closeSent)
+            return;
+        if(opcode == websocket::Opcode::CLOSE)
+            m_closeSent = true;
+        websocket::encodeFrame(opcode, payload, size, true, m_maskRng(), m_out);
+    }
+
+    bool WebSocketClient::flush()
+    {
+#ifdef MSG_NOSIGNAL
+        constexpr int kFlags = MSG_NOSIGNAL;
+#else
+        constexpr int kFlags = 0; // SO_NOSIGPIPE is set on the socket instead
+#endif
+        while(m_outPos < m_out.size())
+        {
+            const ssize_t n =
+                ::send(m_fd, m_out.data() + m_outPos, m_out.size() - m_outPos, kFlags);
+            if(n > 0)
+            {
+                m_outPos += static_cast<std::size_t>(n);
+                continue;
+            }
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return true; // Rest goes out when the socket is writable
+            if(n < 0 && errno == EINTR)
+                continue;
+            return fail(std::string("send failed: ") + std::strerror(errno));
+        }
+        m_out.clear();
+        m_outPos = 0;
+        return true;
+    }
+
+    void WebSocketClient::sendPing()
+    {
+        if(m_fd < 0)
+            return;
+        queueFrame(websocket::Opcode::PING, nullptr, 0);
+        flush();
+    }
+
+    void WebSocketClient::close(uint16_t code)
+    {
+        if(m_fd < 0)
+            return;
+        const uint8_t payload[2] = {static_cast<uint8_t>(code >> 8), static_cast<uint8_t>(code)};
+        queueFrame(websocket::Opcode::CLOSE, payload, sizeof(payload));
+        flush();
+        shutdown(m_fd, SHUT_RDWR);
+        closeSocket();
+    }
+#endif
+
+} // namespace tfv
@@ -244,6 +244,47 @@ namespace tfv
         }
     }
 
+    TextureHandle MetalRenderer::createTexture(int width, int height)
+    {
+        // Would allocate an MTLTexture with MTLStorageModeShared for CPU uploads
+        return 0;
+    }
+
+    void MetalRenderer::updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch)
+    {
+        // Would call replaceRegion on the MTLTexture
+    }
+
+    void MetalRenderer::drawTexture(TextureHandle texture, int x, int y, int w, int h)
+    {
+        // Would draw a textured quad in drawInMTKView
+    }
+
+    void MetalRenderer::destroyTexture(TextureHandle texture) {}
+
+    void MetalRenderer::drawTextureQuads(TextureHandle texture,
+                                         std::span<const TexturedQuad> quads)
+    {
+        // Would append the quads to one vertex buffer and issue a single draw call
+    }
+
+    bool MetalRenderer::readPixels(uint32_t* pixels, int pitch)
+    {
+        // Would blit the drawable into a shared buffer and copy it out
+        return false;
+    }
+
+    void MetalRenderer::setVSync(bool enable)
+    {
+        if(m_metalView)
+        {
+#ifdef __OBJC__
+            MTKView* view = static_cast<MTKView*>(m_metalView);
+            static_cast<CAMetalLayer*>(view.layer).displaySyncEnabled = enable;
+#endif
+        }
+    }
+
     void MetalRenderer::setAntiAliasing(bool enable)
     {
         m_antiAliasingEnabled = enable;
@@ -283,6 +324,19 @@ namespace tfv
     void MetalRenderer::drawRect(int, int, int, int) {}
     void MetalRenderer::fillRect(int, int, int, int) {}
     void MetalRenderer::drawText(const std::string&, int, int) {}
+    TextureHandle MetalRenderer::createTexture(int, int)
+    {
+        return 0;
+    }
+    void MetalRenderer::updateTexture(TextureHandle, const uint32_t*, int) {}
+    void MetalRenderer::drawTexture(TextureHandle, int, int, int, int) {}
+    void MetalRenderer::destroyTexture(TextureHandle) {}
+    void MetalRenderer::drawTextureQuads(TextureHandle, std::span<const TexturedQuad>) {}
+    bool MetalRenderer::readPixels(uint32_t*, int)
+    {
+        return false;
+    }
+    void MetalRenderer::setVSync(bool) {}
     void MetalRenderer::setAntiAliasing(bool enable)
     {
         m_antiAliasingEnabled = enable;
@@ -1,6 +1,7 @@
 #include "rendering/platforms/SDL.hpp"
 #include "utils/LoggingManager.hpp"
 
+#include <cmath>
 #include <iostream>
 namespace tfv
 {
@@ -15,15 +16,13 @@ namespace tfv
     {
 
         // Initialize SDL_ttf
-        if(TTF_Init() == -1)
-        {
-            LOG_ERROR("SDL_ttf could not initialize! {error}", PARAM(error, TTF_GetError()));
+        m_ttf = std::make_unique<TtfLibrary>();
+        if(!m_ttf->ready())
             return false;
-        }
 
-        // Create renderer with accelerated and vsync flags for better quality
-        m_renderer =
-            SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        // Create accelerated renderer, vsync unless the frame scheduler asked otherwise
+        Uint32 flags = SDL_RENDERER_ACCELERATED | (m_vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
+        m_renderer = SDL_CreateRenderer(m_window, -1, flags);
         if(!m_renderer)
         {
             LOG_ERROR("Renderer creation failed: {error}", PARAM(error, SDL_GetError()));
@@ -36,11 +35,25 @@ namespace tfv
         // Set render quality hints
         SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
 
+        // Glyph cache for drawText(); opened once instead of per call
+        m_glyphs = std::make_unique<GlyphAtlas>(this, 512);
+        m_text = std::make_unique<TextBatch>(*m_glyphs);
+        m_font = m_glyphs->loadDefaultFont(16);
+
         return true;
     }
 
     void SDLRenderer::shutdown()
     {
+        // The atlas releases its texture through us, so it goes first
+        m_text.reset();
+        m_glyphs.reset();
+        m_font = GlyphAtlas::kInvalidFont;
+
+        for(auto& [handle, texture] : m_textures)
+            SDL_DestroyTexture(texture);
+        m_textures.clear();
+
         if(m_renderer)
         {
             SDL_DestroyRenderer(static_cast<SDL_Renderer*>(m_renderer));
@@ -50,7 +63,7 @@ namespace tfv
         // Note: We don't own the window, just the renderer
         m_window = nullptr;
 
-        TTF_Quit();
+        m_ttf.reset();
     }
 
     SDLRenderer::~SDLRenderer()
@@ -80,6 +93,8 @@ namespace tfv
     {
         SDL_SetRenderDrawColor(m_renderer, r, g, b, a);
         SDL_RenderClear(m_renderer);
+        if(m_glyphs)
+            m_glyphs->beginFrame(); // A frame starts with clear()
     }
 
     void SDLRenderer::present()
@@ -168,6 +183,19 @@ namespace tfv
         SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
     }
 
+    void SDLRenderer::setVSync(bool enable)
+    {
+        m_vsync = enable;
+        if(!m_renderer)
+            return; // Applied when the renderer is created
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if(SDL_RenderSetVSync(m_renderer, enable ? 1 : 0) != 0)
+            LOG_ERROR("Failed to change vsync: {error}", PARAM(error, SDL_GetError()));
+#else
+        LOG_ERROR("Changing vsync at runtime needs SDL 2.0.18");
+#endif
+    }
+
     void SDLRenderer::drawPoint(int x, int y)
     {
         SDL_RenderDrawPoint(m_renderer, x, y);
@@ -187,59 +215,119 @@ namespace tfv
 
     void SDLRenderer::drawText(const std::string& text, int x, int y)
     {
-        SDL_Texture* texture = createTextTexture(text);
+        if(m_font == GlyphAtlas::kInvalidFont || text.empty())
+            return;
+
+        Uint8 r, g, b, a;
+        SDL_GetRenderDrawColor(m_renderer, &r, &g, &b, &a);
+        const uint32_t color = (uint32_t(a) << 24) | (uint32_t(r) << 16) | (uint32_t(g) << 8) | b;
+
+        m_text->clear();
+        m_text->add(m_font, text, x, y, color);
+        m_text->draw(*this);
+    }
+
+    TextureHandle SDLRenderer::createTexture(int width, int height)
+    {
+        SDL_Texture* texture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888,
+                                                 SDL_TEXTUREACCESS_STREAMING, width, height);
         if(!texture)
         {
-            return;
+            LOG_ERROR("Texture creation failed: {error}", PARAM(error, SDL_GetError()));
+            return 0;
         }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
 
-        // Get texture dimensions
-        int width, height;
-        SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+        TextureHandle handle = m_nextTexture++;
+        m_textures[handle] = texture;
+        return handle;
+    }
 
-        // Render the text
-        SDL_Rect dest = {x, y, width, height};
-        SDL_RenderCopy(m_renderer, texture, nullptr, &dest);
+    void SDLRenderer::updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch)
+    {
+        auto it = m_textures.find(texture);
+        if(it != m_textures.end())
+            SDL_UpdateTexture(it->second, nullptr, pixels, pitch);
+    }
 
-        // Clean up
-        SDL_DestroyTexture(texture);
+    void SDLRenderer::drawTexture(TextureHandle texture, int x, int y, int w, int h)
+    {
+        auto it = m_textures.find(texture);
+        if(it == m_textures.end())
+            return;
+        SDL_Rect dest = {x, y, w, h};
+        SDL_RenderCopy(m_renderer, it->second, nullptr, &dest);
     }
 
-    SDL_Texture* SDLRenderer::createTextTexture(const std::string& text)
+    void SDLRenderer::drawTextureQuads(TextureHandle texture, std::span<const TexturedQuad> quads)
     {
-        // Load a font (in a real implementation, we'd cache this)
-        TTF_Font* font = TTF_OpenFont("/System/Library/Fonts/Supplemental/Arial.ttf", 16);
-        if(!font)
+        auto it = m_textures.find(texture);
+        if(it == m_textures.end() || quads.empty())
+            return;
+        SDL_Texture* tex = it->second;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        // All quads in one geometry submission
+        int texW, texH;
+        SDL_QueryTexture(tex, nullptr, nullptr, &texW, &texH);
+        const float su = 1.f / texW, sv = 1.f / texH;
+
+        m_quadVertices.clear();
+        m_quadIndices.clear();
+        m_quadVertices.reserve(quads.size() * 4);
+        m_quadIndices.reserve(quads.size() * 6);
+        for(const TexturedQuad& q : quads)
         {
-            LOG_ERROR("Failed to load font: {error}", PARAM(error, TTF_GetError()));
-            // Try fallback font
-            font = TTF_OpenFont("/System/Library/Fonts/Supplemental/Courier New.ttf", 16);
-            if(!font)
-            {
-                return nullptr;
-            }
+            const SDL_Color c{static_cast<Uint8>(q.color >> 16), static_cast<Uint8>(q.color >> 8),
+                              static_cast<Uint8>(q.color), static_cast<Uint8>(q.color >> 24)};
+            const float x0 = static_cast<float>(q.x), y0 = static_cast<float>(q.y);
+            const float x1 = x0 + q.w, y1 = y0 + q.h;
+            const float u0 = q.srcX * su, v0 = q.srcY * sv;
+            const float u1 = (q.srcX + q.srcW) * su, v1 = (q.srcY + q.srcH) * sv;
+
+            const int base = static_cast<int>(m_quadVertices.size());
+            m_quadVertices.push_back({{x0, y0}, c, {u0, v0}});
+            m_quadVertices.push_back({{x1, y0}, c, {u1, v0}});
+            m_quadVertices.push_back({{x1, y1}, c, {u1, v1}});
+            m_quadVertices.push_back({{x0, y1}, c, {u0, v1}});
+            m_quadIndices.insert(m_quadIndices.end(),
+                                 {base, base + 1, base + 2, base, base + 2, base + 3});
         }
-
-        // Get current draw color
-        Uint8 r, g, b, a;
-        SDL_GetRenderDrawColor(m_renderer, &r, &g, &b, &a);
-        SDL_Color color = {r, g, b, a};
-
-        // Render text to surface
-        SDL_Surface* surface = TTF_RenderText_Blended(font, text.c_str(), color);
-        if(!surface)
+        SDL_RenderGeometry(m_renderer, tex, m_quadVertices.data(),
+                           static_cast<int>(m_quadVertices.size()), m_quadIndices.data(),
+                           static_cast<int>(m_quadIndices.size()));
+#else
+        // Without SDL_RenderGeometry: one copy per quad with colour modulation
+        for(const TexturedQuad& q : quads)
         {
-            TTF_CloseFont(font);
-            return nullptr;
+            SDL_SetTextureColorMod(tex, static_cast<Uint8>(q.color >> 16),
+                                   static_cast<Uint8>(q.color >> 8), static_cast<Uint8>(q.color));
+            SDL_SetTextureAlphaMod(tex, static_cast<Uint8>(q.color >> 24));
+            SDL_Rect src = {q.srcX, q.srcY, q.srcW, q.srcH};
+            SDL_Rect dest = {q.x, q.y, q.w, q.h};
+            SDL_RenderCopy(m_renderer, tex, &src, &dest);
         }
+        SDL_SetTextureColorMod(tex, 255, 255, 255);
+        SDL_SetTextureAlphaMod(tex, 255);
+#endif
+    }
 
-        // Convert surface to texture
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(m_renderer, surface);
-
-        // Clean up
-        SDL_FreeSurface(surface);
-        TTF_CloseFont(font);
+    void SDLRenderer::destroyTexture(TextureHandle texture)
+    {
+        auto it = m_textures.find(texture);
+        if(it == m_textures.end())
+            return;
+        SDL_DestroyTexture(it->second);
+        m_textures.erase(it);
+    }
 
-        return texture;
+    bool SDLRenderer::readPixels(uint32_t* pixels, int pitch)
+    {
+        if(SDL_RenderReadPixels(m_renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, pixels, pitch) != 0)
+        {
+            LOG_ERROR("Failed to read pixels from renderer: {error}", PARAM(error, SDL_GetError()));
+            return false;
+        }
+        return true;
     }
 } // namespace tfv
@@ -0,0 +1,526 @@
+#include "rendering/platforms/Software.hpp"
+#include "utils/LoggingManager.hpp"
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace tfv
+{
+    namespace
+    {
+        inline uint32_t packColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+        {
+            return (uint32_t(a) << 24) | (uint32_t(r) << 16) | (uint32_t(g) << 8) | b;
+        }
+
+        // Source-over blend of packed ARGB; coverage is 0-256
+        inline uint32_t blend(uint32_t dst, uint32_t src, uint32_t coverage)
+        {
+            uint32_t a = ((src >> 24) * coverage) >> 8;
+            if(a == 0)
+                return dst;
+            if(a == 255)
+                return src | 0xFF000000u;
+            uint32_t inv = 255 - a;
+
+            // Red and blue share one multiply, green another; divide by 255 with rounding
+            uint32_t rb = (src & 0x00FF00FFu) * a + (dst & 0x00FF00FFu) * inv + 0x00800080u;
+            rb = ((rb + ((rb >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+            uint32_t g = ((src >> 8) & 0xFFu) * a + ((dst >> 8) & 0xFFu) * inv + 0x80u;
+            g = ((g + (g >> 8)) >> 8) & 0xFFu;
+            uint32_t da = dst >> 24;
+            uint32_t outA = a + (da * inv + 127) / 255;
+            return (outA << 24) | rb | (g << 8);
+        }
+
+        // Multiply each channel by the tint (glyph coverage times text colour)
+        inline uint32_t modulate(uint32_t texel, uint32_t tint)
+        {
+            auto channel = [&](int shift)
+            {
+                uint32_t c = ((texel >> shift) & 0xFFu) * ((tint >> shift) & 0xFFu);
+                return ((c + 127) / 255) << shift;
+            };
+            return channel(24) | channel(16) | channel(8) | channel(0);
+        }
+    } // namespace
+
+    SoftwareRenderer::SoftwareRenderer(int width, int height, unsigned threads)
+        : m_width(std::max(1, width)), m_height(std::max(1, height)),
+          m_threadCount(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+    {
+    }
+
+    SoftwareRenderer::~SoftwareRenderer()
+    {
+        shutdown();
+    }
+
+    bool SoftwareRenderer::initialize()
+    {
+        // Already running: calling again must not start a second worker pool
+        if(m_glyphs)
+            return true;
+
+        m_framebuffer.assign(static_cast<std::size_t>(m_width) * m_height, 0xFF000000u);
+        m_tilesX = (m_width + kTileSize - 1) / kTileSize;
+        m_tilesY = (m_height + kTileSize - 1) / kTileSize;
+        m_tileBins.assign(static_cast<std::size_t>(m_tilesX) * m_tilesY, {});
+
+        // Text is optional: without SDL_ttf or a font, drawText() is a no-op
+        m_glyphs = std::make_unique<GlyphAtlas>(this, 512);
+        m_text = std::make_unique<TextBatch>(*m_glyphs);
+        m_font = m_glyphs->loadDefaultFont(16);
+
+        // The calling thread rasterises too, so start one worker fewer
+        m_stopping = false;
+        for(unsigned i = 1; i < m_threadCount; ++i)
+            m_workers.emplace_back(&SoftwareRenderer::workerLoop, this);
+
+        LOG_INFO("Software renderer {width}x{height} on {threads} threads",
+                 PARAM(width, m_width), PARAM(height, m_height), PARAM(threads, m_threadCount));
+        return true;
+    }
+
+    void SoftwareRenderer::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_poolMutex);
+            m_stopping = true;
+        }
+        m_poolCv.notify_all();
+        for(auto& worker : m_workers)
+            worker.join();
+        m_workers.clear();
+
+        // The atlas releases its texture through us, so it goes first
+        m_text.reset();
+        m_glyphs.reset();
+        m_font = GlyphAtlas::kInvalidFont;
+
+        m_prims.clear();
+        m_textures.clear();
+    }
+
+    void* SoftwareRenderer::getNativeRenderer() const
+    {
+        return const_cast<uint32_t*>(m_framebuffer.data());
+    }
+
+    void SoftwareRenderer::getWindowSize(int& width, int& height) const
+    {
+        width = m_width;
+        height = m_height;
+    }
+
+    void SoftwareRenderer::clear(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        // Anything recorded so far would be painted over anyway
+        m_prims.clear();
+        for(auto& bin : m_tileBins)
+            bin.clear();
+        m_clearPending = true;
+        m_clearColor = packColor(r, g, b, a);
+        // A frame starts with clear(); text recorded later this frame shares the atlas layout
+        if(m_glyphs)
+            m_glyphs->beginFrame();
+    }
+
+    void SoftwareRenderer::present()
+    {
+        flush();
+    }
+
+    void SoftwareRenderer::setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        m_color = packColor(r, g, b, a);
+    }
+
+    void SoftwareRenderer::setAntiAliasing(bool enable)
+    {
+        m_antiAliasingEnabled = enable;
+    }
+
+    void SoftwareRenderer::setVSync(bool)
+    {
+        // No display to sync to
+    }
+
+    void SoftwareRenderer::drawLine(int x1, int y1, int x2, int y2)
+    {
+        drawLine(x1, y1, x2, y2, 1);
+    }
+
+    void SoftwareRenderer::drawLine(int x1, int y1, int x2, int y2, int width)
+    {
+        Primitive p{};
+        p.type = PrimType::LINE;
+        p.color = m_color;
+        // End points at pixel centres, like SDL
+        p.x1 = x1 + 0.5f;
+        p.y1 = y1 + 0.5f;
+        p.x2 = x2 + 0.5f;
+        p.y2 = y2 + 0.5f;
+        p.halfWidth = std::max(1, width) * 0.5f;
+
+        float reach = p.halfWidth + 1.f;
+        p.minX = static_cast<int>(std::floor(std::min(p.x1, p.x2) - reach));
+        p.minY = static_cast<int>(std::floor(std::min(p.y1, p.y2) - reach));
+        p.maxX = static_cast<int>(std::ceil(std::max(p.x1, p.x2) + reach));
+        p.maxY = static_cast<int>(std::ceil(std::max(p.y1, p.y2) + reach));
+        record(p);
+    }
+
+    void SoftwareRenderer::drawPoint(int x, int y)
+    {
+        fillRect(x, y, 1, 1);
+    }
+
+    void SoftwareRenderer::drawRect(int x, int y, int w, int h)
+    {
+        if(w <= 0 || h <= 0)
+            return;
+        fillRect(x, y, w, 1);
+        fillRect(x, y + h - 1, w, 1);
+        fillRect(x, y + 1, 1, h - 2);
+        fillRect(x + w - 1, y + 1, 1, h - 2);
+    }
+
+    void SoftwareRenderer::fillRect(int x, int y, int w, int h)
+    {
+        if(w <= 0 || h <= 0)
+            return;
+        Primitive p{};
+        p.type = PrimType::RECT;
+        p.color = m_color;
+        p.minX = x;
+        p.minY = y;
+        p.maxX = x + w - 1;
+        p.maxY = y + h - 1;
+        record(p);
+    }
+
+    void SoftwareRenderer::drawText(const std::string& text, int x, int y)
+    {
+        if(m_font == GlyphAtlas::kInvalidFont || text.empty())
+            return;
+
+        m_text->clear();
+        m_text->add(m_font, text, x, y, m_color);
+        m_text->draw(*this);
+    }
+
+    TextureHandle SoftwareRenderer::createTexture(int width, int height)
+    {
+        if(width <= 0 || height <= 0)
+            return 0;
+        TextureHandle handle = m_nextTexture++;
+        Image& image = m_textures[handle];
+        image.width = width;
+        image.height = height;
+        image.pixels.assign(static_cast<std::size_t>(width) * height, 0);
+        return handle;
+    }
+
+    void SoftwareRenderer::updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch)
+    {
+        auto it = m_textures.find(texture);
+        if(it == m_textures.end())
+            return;
+
+        // Draws recorded earlier this frame must see the old contents
+        flush();
+
+        Image& image = it->second;
+        for(int row = 0; row < image.height; ++row)
+        {
+            std::memcpy(image.pixels.data() + static_cast<std::size_t>(row) * image.width,
+                        reinterpret_cast<const uint8_t*>(pixels) + row * pitch,
+                        image.width * sizeof(uint32_t));
+        }
+    }
+
+    void SoftwareRenderer::drawTexture(TextureHandle texture, int x, int y, int w, int h)
+    {
+        auto it = m_textures.find(texture);
+        if(it == m_textures.end())
+            return;
+        const Image& image = it->second;
+        recordImage(image, x, y, w, h, 0, 0, image.width, image.height, 0xFFFFFFFFu);
+    }
+
+    void SoftwareRenderer::drawTextureQuads(TextureHandle texture,
+                                            std::span<const TexturedQuad> quads)
+    {
+        auto it = m_textures.find(texture);
+        if(it == m_textures.end())
+            return;
+        for(const TexturedQuad& q : quads)
+            recordImage(it->second, q.x, q.y, q.w, q.h, q.srcX, q.srcY, q.srcW, q.srcH, q.color);
+    }
+
+    void SoftwareRenderer::recordImage(const Image& image, int x, int y, int w, int h, int srcX,
+                                       int srcY, int srcW, int srcH, uint32_t tint)
+    {
+        // Clamp the source rect to the image so sampling never leaves it
+        srcX = std::clamp(srcX, 0, image.width);
+        srcY = std::clamp(srcY, 0, image.height);
+        srcW = std::min(srcW, image.width - srcX);
+        srcH = std::min(srcH, image.height - srcY);
+        if(w <= 0 || h <= 0 || srcW <= 0 || srcH <= 0 || (tint >> 24) == 0)
+            return;
+
+        Primitive p{};
+        p.type = PrimType::IMAGE;
+        p.color = tint;
+        p.image = &image;
+        p.srcX = srcX;
+        p.srcY = srcY;
+        p.srcW = srcW;
+        p.srcH = srcH;
+        p.x1 = static_cast<float>(x);
+        p.y1 = static_cast<float>(y);
+        p.x2 = static_cast<float>(x + w);
+        p.y2 = static_cast<float>(y + h);
+        p.minX = x;
+        p.minY = y;
+        p.maxX = x + w - 1;
+        p.maxY = y + h - 1;
+        record(p);
+    }
+
+    void SoftwareRenderer::destroyTexture(TextureHandle texture)
+    {
+        if(m_textures.find(texture) == m_textures.end())
+            return;
+        flush();
+        m_textures.erase(texture);
+    }
+
+    bool SoftwareRenderer::readPixels(uint32_t* pixels, int pitch)
+    {
+        if(m_framebuffer.empty())
+            return false;
+        flush();
+        for(int row = 0; row < m_height; ++row)
+        {
+            std::memcpy(reinterpret_cast<uint8_t*>(pixels) + row * pitch,
+                        m_framebuffer.data() + static_cast<std::size_t>(row) * m_width,
+                        m_width * sizeof(uint32_t));
+        }
+        return true;
+    }
+
+    void SoftwareRenderer::record(const Primitive& prim)
+    {
+        if(m_tileBins.empty())
+            return;
+
+        Primitive p = prim;
+        p.minX = std::max(p.minX, 0);
+        p.minY = std::max(p.minY, 0);
+        p.maxX = std::min(p.maxX, m_width - 1);
+        p.maxY = std::min(p.maxY, m_height - 1);
+        if(p.minX > p.maxX || p.minY > p.maxY || ((p.color >> 24) == 0 && !p.image))
+            return;
+
+        // Bin by bounding box; tiles replay their bins in submission order
+        const auto index = static_cast<uint32_t>(m_prims.size());
+        m_prims.push_back(p);
+        for(int ty = p.minY / kTileSize; ty <= p.maxY / kTileSize; ++ty)
+            for(int tx = p.minX / kTileSize; tx <= p.maxX / kTileSize; ++tx)
+                m_tileBins[static_cast<std::size_t>(ty) * m_tilesX + tx].push_back(index);
+    }
+
+    void SoftwareRenderer::flush()
+    {
+        if(!m_clearPending && m_prims.empty())
+            return;
+
+        const int tileCount = m_tilesX * m_tilesY;
+        {
+            std::lock_guard<std::mutex> lock(m_poolMutex);
+            m_nextTile.store(0, std::memory_order_relaxed);
+            m_busyWorkers = static_cast<int>(m_workers.size());
+            ++m_job;
+        }
+        m_poolCv.notify_all();
+
+        // Help out, then wait for the workers to drain the remaining tiles
+        for(int tile; (tile = m_nextTile.fetch_add(1)) < tileCount;)
+            rasterTile(tile);
+        {
+            std::unique_lock<std::mutex> lock(m_poolMutex);
+            m_doneCv.wait(lock, [this] { return m_busyWorkers == 0; });
+        }
+
+        m_prims.clear();
+        for(auto& bin : m_tileBins)
+            bin.clear();
+        m_clearPending = false;
+    }
+
+    void SoftwareRenderer::workerLoop()
+    {
+        uint64_t seen = 0;
+        const int tileCount = m_tilesX * m_tilesY;
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_poolMutex);
+                m_poolCv.wait(lock, [&] { return m_stopping || m_job != seen; });
+                if(m_stopping)
+                    return;
+                seen = m_job;
+            }
+
+            for(int tile; (tile = m_nextTile.fetch_add(1)) < tileCount;)
+                rasterTile(tile);
+
+            {
+                std::lock_guard<std::mutex> lock(m_poolMutex);
+                if(--m_busyWorkers == 0)
+                    m_doneCv.notify_one();
+            }
+        }
+    }
+
+    void SoftwareRenderer::rasterTile(int tile)
+    {
+        const int tx = tile % m_tilesX, ty = tile / m_tilesX;
+        const int x0 = tx * kTileSize, y0 = ty * kTileSize;
+        const int x1 = std::min(x0 + kTileSize, m_width) - 1;
+        const int y1 = std::min(y0 + kTileSize, m_height) - 1;
+
+        if(m_clearPending)
+        {
+            for(int y = y0; y <= y1; ++y)
+            {
+                uint32_t* row = m_framebuffer.data() + static_cast<std::size_t>(y) * m_width;
+                std::fill(row + x0, row + x1 + 1, m_clearColor);
+            }
+        }
+
+        for(uint32_t index : m_tileBins[tile])
+        {
+            const Primitive& p = m_prims[index];
+            int cx0 = std::max(x0, p.minX), cy0 = std::max(y0, p.minY);
+            int cx1 = std::min(x1, p.maxX), cy1 = std::min(y1, p.maxY);
+            switch(p.type)
+            {
+            case PrimType::LINE:
+                rasterLine(p, cx0, cy0, cx1, cy1);
+                break;
+            case PrimType::RECT:
+                rasterRect(p, cx0, cy0, cx1, cy1);
+                break;
+            case PrimType::IMAGE:
+                rasterImage(p, cx0, cy0, cx1, cy1);
+                break;
+            }
+        }
+    }
+
+    void SoftwareRenderer::rasterLine(const Primitive& p, int x0, int y0, int x1, int y1)
+    {
+        // Lines are capsules: distance from each pixel centre to the segment
+        float dx = p.x2 - p.x1, dy = p.y2 - p.y1;
+        float len = std::sqrt(dx * dx + dy * dy);
+        float ux = 1.f, uy = 0.f;
+        if(len > 1e-4f)
+        {
+            ux = dx / len;
+            uy = dy / len;
+        }
+        const float r = p.halfWidth;
+        const float reach = r + 1.f;
+
+        // Oriented box around the capsule, used to find each row's span
+        const float ex = ux * reach, ey = uy * reach; // Along the line
+        const float nx = -uy * reach, ny = ux * reach; // Across it
+        const float cornersX[4] = {p.x1 - ex + nx, p.x2 + ex + nx, p.x2 + ex - nx, p.x1 - ex - nx};
+        const float cornersY[4] = {p.y1 - ey + ny, p.y2 + ey + ny, p.y2 + ey - ny, p.y1 - ey - ny};
+
+        for(int y = y0; y <= y1; ++y)
+        {
+            const float cy = y + 0.5f;
+            float spanMin = 1e30f, spanMax = -1e30f;
+            for(int e = 0; e < 4; ++e)
+            {
+                float ax = cornersX[e], ay = cornersY[e];
+                float bx = cornersX[(e + 1) & 3], by = cornersY[(e + 1) & 3];
+                if((ay - cy) * (by - cy) > 0.f)
+                    continue;
+                float x = ay == by ? ax : ax + (cy - ay) * (bx - ax) / (by - ay);
+                spanMin = std::min({spanMin, x, ay == by ? bx : x});
+                spanMax = std::max({spanMax, x, ay == by ? bx : x});
+            }
+            if(spanMin > spanMax)
+                continue;
+
+            int sx0 = std::max(x0, static_cast<int>(std::floor(spanMin)));
+            int sx1 = std::min(x1, static_cast<int>(std::ceil(spanMax)));
+            uint32_t* row = m_framebuffer.data() + static_cast<std::size_t>(y) * m_width;
+            for(int x = sx0; x <= sx1; ++x)
+            {
+                float px = x + 0.5f - p.x1, py = cy - p.y1;
+                float t = std::clamp(px * ux + py * uy, 0.f, len);
+                float ox = px - ux * t, oy = py - uy * t;
+                float dist = std::sqrt(ox * ox + oy * oy);
+
+                uint32_t coverage;
+                if(m_antiAliasingEnabled)
+                {
+                    float c = std::clamp(r + 0.5f - dist, 0.f, 1.f);
+                    coverage = static_cast<uint32_t>(c * 256.f);
+                }
+                else
+                {
+                    coverage = dist <= r ? 256 : 0;
+                }
+                if(coverage)
+                    row[x] = blend(row[x], p.color, coverage);
+            }
+        }
+    }
+
+    void SoftwareRenderer::rasterRect(const Primitive& p, int x0, int y0, int x1, int y1)
+    {
+        const bool opaque = (p.color >> 24) == 0xFF;
+        for(int y = y0; y <= y1; ++y)
+        {
+            uint32_t* row = m_framebuffer.data() + static_cast<std::size_t>(y) * m_width;
+            if(opaque)
+            {
+                std::fill(row + x0, row + x1 + 1, p.color);
+                continue;
+            }
+            for(int x = x0; x <= x1; ++x)
+                row[x] = blend(row[x], p.color, 256);
+        }
+    }
+
+    void SoftwareRenderer::rasterImage(const Primitive& p, int x0, int y0, int x1, int y1)
+    {
+        // Nearest-neighbour scale from the destination rect back into the source rect
+        const Image& image = *p.image;
+        const bool tinted = p.color != 0xFFFFFFFFu;
+        const float scaleX = p.srcW / (p.x2 - p.x1);
+        const float scaleY = p.srcH / (p.y2 - p.y1);
+        for(int y = y0; y <= y1; ++y)
+        {
+            int sy = p.srcY + std::min(p.srcH - 1, static_cast<int>((y + 0.5f - p.y1) * scaleY));
+            const uint32_t* src = image.pixels.data() + static_cast<std::size_t>(sy) * image.width;
+            uint32_t* row = m_framebuffer.data() + static_cast<std::size_t>(y) * m_width;
+            for(int x = x0; x <= x1; ++x)
+            {
+                int sx =
+                    p.srcX + std::min(p.srcW - 1, static_cast<int>((x + 0.5f - p.x1) * scaleX));
+                uint32_t texel = tinted ? modulate(src[sx], p.color) : src[sx];
+                row[x] = blend(row[x], texel, 256);
+            }
+        }
+    }
+} // namespace tfv
@@ -0,0 +1,60 @@
+#include "recording/EncoderPool.hpp"
+
+#include <algorithm>
+
+namespace tfv
+{
+    EncoderPool::EncoderPool(FramePool& frames, unsigned threads, EncodeFn encode, WriteFn write)
+        : m_frames(frames), m_encode(std::move(encode)), m_write(std::move(write))
+    {
+        if(threads == 0)
+            threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        m_threads.reserve(threads);
+        for(unsigned i = 0; i < threads; ++i)
+            m_threads.emplace_back(&EncoderPool::run, this);
+    }
+
+    EncoderPool::~EncoderPool()
+    {
+        join();
+    }
+
+    void EncoderPool::join()
+    {
+        for(auto& thread : m_threads)
+        {
+            if(thread.joinable())
+                thread.join();
+        }
+    }
+
+    void EncoderPool::run()
+    {
+        // Per-worker output buffer; keeps its capacity from frame to frame
+        std::vector<uint8_t> encoded;
+
+        while(Frame* frame = m_frames.pop())
+        {
+            const uint64_t index = frame->index;
+            const bool ok = m_encode(*frame, encoded);
+            m_frames.release(frame);
+
+            // Pops hand out indices in order, so every earlier frame is already owned by a
+            // worker and the turn always comes round
+            {
+                std::unique_lock lock(m_turnMutex);
+                m_turnCv.wait(lock, [&] { return m_nextWrite == index; });
+            }
+            if(ok && m_write(index, encoded))
+                ++m_written;
+            else
+                ++m_failed;
+            {
+                std::scoped_lock lock(m_turnMutex);
+                ++m_nextWrite;
+            }
+            m_turnCv.notify_all();
+        }
+    }
+
+} // namespace tfv
@@ -0,0 +1,352 @@
+#include "recording/FrameEncoder.hpp"
+#include "utils/LoggingManager.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+
+#ifdef TFV_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace tfv
+{
+    namespace
+    {
+        // Pixels are ARGB8888 in native order: 0xAARRGGBB
+        inline uint8_t red(uint32_t p) { return static_cast<uint8_t>(p >> 16); }
+        inline uint8_t green(uint32_t p) { return static_cast<uint8_t>(p >> 8); }
+        inline uint8_t blue(uint32_t p) { return static_cast<uint8_t>(p); }
+
+        void putLE16(std::vector<uint8_t>& out, uint32_t v)
+        {
+            out.push_back(static_cast<uint8_t>(v));
+            out.push_back(static_cast<uint8_t>(v >> 8));
+        }
+
+        void putLE32(std::vector<uint8_t>& out, uint32_t v)
+        {
+            putLE16(out, v);
+            putLE16(out, v >> 16);
+        }
+
+        void putBE32(uint8_t* dst, uint32_t v)
+        {
+            dst[0] = static_cast<uint8_t>(v >> 24);
+            dst[1] = static_cast<uint8_t>(v >> 16);
+            dst[2] = static_cast<uint8_t>(v >> 8);
+            dst[3] = static_cast<uint8_t>(v);
+        }
+
+        bool encodeBMP(const Frame& frame, std::vector<uint8_t>& out)
+        {
+            // 32 bpp BI_RGB stores B, G, R, X per pixel: the in-memory layout of ARGB8888 on
+            // little-endian hosts, so the pixel data is a single copy. A negative height
+            // marks the rows as top-down.
+            const uint32_t imageSize = static_cast<uint32_t>(frame.pixels.size() * 4);
+            out.reserve(54 + imageSize);
+            out.push_back('B');
+            out.push_back('M');
+            putLE32(out, 54 + imageSize); // File size
+            putLE32(out, 0);              // Reserved
+            putLE32(out, 54);             // Pixel data offset
+            putLE32(out, 40);             // BITMAPINFOHEADER
+            putLE32(out, static_cast<uint32_t>(frame.width));
+            putLE32(out, static_cast<uint32_t>(-frame.height));
+            putLE16(out, 1);  // Planes
+            putLE16(out, 32); // Bits per pixel
+            putLE32(out, 0);  // BI_RGB
+            putLE32(out, imageSize);
+            putLE32(out, 2835); // 72 dpi
+            putLE32(out, 2835);
+            putLE32(out, 0);
+            putLE32(out, 0);
+
+            const std::size_t header = out.size();
+            out.resize(header + imageSize);
+            if constexpr(std::endian::native == std::endian::little)
+            {
+                std::memcpy(out.data() + header, frame.pixels.data(), imageSize);
+            }
+            else
+            {
+                uint8_t* dst = out.data() + header;
+                for(uint32_t p : frame.pixels)
+                {
+                    *dst++ = blue(p);
+                    *dst++ = green(p);
+                    *dst++ = red(p);
+                    *dst++ = 0;
+                }
+            }
+            return true;
+        }
+
+        bool encodePPM(const Frame& frame, std::vector<uint8_t>& out)
+        {
+            char header[32];
+            const int len = std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", frame.width,
+                                          frame.height);
+            out.resize(len + frame.pixels.size() * 3);
+            std::memcpy(out.data(), header, len);
+
+            uint8_t* dst = out.data() + len;
+            for(uint32_t p : frame.pixels)
+            {
+                *dst++ = red(p);
+                *dst++ = green(p);
+                *dst++ = blue(p);
+            }
+            return true;
+        }
+
+        bool encodeQOI(const Frame& frame, std::vector<uint8_t>& out)
+        {
+            // https://qoiformat.org/qoi-specification.pdf; frames are opaque, so 3 channels
+            // and alpha is pinned to 255
+            constexpr uint8_t kIndex = 0x00, kDiff = 0x40, kLuma = 0x80, kRun = 0xC0;
+            constexpr uint8_t kRGB = 0xFE;
+
+            // Worst case is 4 bytes per pixel plus header and end marker
+            out.resize(14 + frame.pixels.size() * 4 + 8);
+            uint8_t* dst = out.data();
+            std::memcpy(dst, "qoif", 4);
+            putBE32(dst + 4, static_cast<uint32_t>(frame.width));
+            putBE32(dst + 8, static_cast<uint32_t>(frame.height));
+            dst[12] = 3; // RGB
+            dst[13] = 0; // sRGB with linear alpha
+            dst += 14;
+
+            uint32_t seen[64] = {};
+            uint32_t prev = 0xFF000000u;
+            int run = 0;
+            for(uint32_t p : frame.pixels)
+            {
+                p |= 0xFF000000u;
+                if(p == prev)
+                {
+                    if(++run == 62)
+                    {
+                        *dst++ = kRun | (run - 1);
+                        run = 0;
+                    }
+                    continue;
+                }
+                if(run > 0)
+                {
+                    *dst++ = kRun | (run - 1);
+                    run = 0;
+                }
+
+                const uint8_t r = red(p), g = green(p), b = blue(p);
+                const int hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+                if(seen[hash] == p)
+                {
+                    *dst++ = kIndex | hash;
+                }
+                else
+                {
+                    seen[hash] = p;
+                    const int8_t dr = static_cast<int8_t>(r - red(prev));
+                    const int8_t dg = static_cast<int8_t>(g - green(prev));
+                    const int8_t db = static_cast<int8_t>(b - blue(prev));
+                    const int8_t drg = static_cast<int8_t>(dr - dg);
+                    const int8_t dbg = static_cast<int8_t>(db - dg);
+                    if(dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                    {
+                        *dst++ = kDiff | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2);
+                    }
+                    else if(dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 &&
+                            dbg <= 7)
+                    {
+                        *dst++ = kLuma | (dg + 32);
+                        *dst++ = static_cast<uint8_t>(((drg + 8) << 4) | (dbg + 8));
+                    }
+                    else
+                    {
+                        *dst++ = kRGB;
+                        *dst++ = r;
+                        *dst++ = g;
+                        *dst++ = b;
+                    }
+                }
+                prev = p;
+            }
+            if(run > 0)
+                *dst++ = kRun | (run - 1);
+
+            static constexpr uint8_t kEnd[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+            std::memcpy(dst, kEnd, sizeof(kEnd));
+            dst += sizeof(kEnd);
+            out.resize(dst - out.data());
+            return true;
+        }
+
+#ifdef TFV_HAS_ZLIB
+        void putChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data,
+                      std::size_t size)
+        {
+            const std::size_t at = out.size();
+            out.resize(at + 12 + size);
+            uint8_t* dst = out.data() + at;
+            putBE32(dst, static_cast<uint32_t>(size));
+            std::memcpy(dst + 4, type, 4);
+            if(size)
+                std::memcpy(dst + 8, data, size);
+            const uLong crc = crc32(crc32(0L, Z_NULL, 0), dst + 4, static_cast<uInt>(size + 4));
+            putBE32(dst + 8 + size, static_cast<uint32_t>(crc));
+        }
+
+        bool encodePNG(const Frame& frame, int level, std::vector<uint8_t>& out)
+        {
+            // Filtered scanlines: one filter byte per row, then RGB. "Sub" (left neighbour)
+            // is cheap and suits flat UI content; level 0 skips filtering altogether.
+            const std::size_t stride = static_cast<std::size_t>(frame.width) * 3 + 1;
+            thread_local std::vector<uint8_t> raw;
+            thread_local std::vector<uint8_t> packed;
+            raw.resize(stride * frame.height);
+            const uint8_t filter = level > 0 ? 1 : 0;
+            for(int y = 0; y < frame.height; ++y)
+            {
+                const uint32_t* src =
+                    frame.pixels.data() + static_cast<std::size_t>(y) * frame.width;
+                uint8_t* dst = raw.data() + y * stride;
+                *dst++ = filter;
+                uint8_t pr = 0, pg = 0, pb = 0;
+                for(int x = 0; x < frame.width; ++x)
+                {
+                    const uint8_t r = red(src[x]), g = green(src[x]), b = blue(src[x]);
+                    *dst++ = filter ? static_cast<uint8_t>(r - pr) : r;
+                    *dst++ = filter ? static_cast<uint8_t>(g - pg) : g;
+                    *dst++ = filter ? static_cast<uint8_t>(b - pb) : b;
+                    pr = r;
+                    pg = g;
+                    pb = b;
+                }
+            }
+
+            uLongf packedSize = compressBound(static_cast<uLong>(raw.size()));
+            packed.resize(packedSize);
+            if(compress2(packed.data(), &packedSize, raw.data(), static_cast<uLong>(raw.size()),
+                         std::clamp(level, 0, 9)) != Z_OK)
+                return false;
+
+            static constexpr uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+            uint8_t ihdr[13];
+            putBE32(ihdr, static_cast<uint32_t>(frame.width));
+            putBE32(ihdr + 4, static_cast<uint32_t>(frame.height));
+            ihdr[8] = 8;  // Bit depth
+            ihdr[9] = 2;  // Truecolour
+            ihdr[10] = 0; // Deflate
+            ihdr[11] = 0; // Adaptive filtering
+            ihdr[12] = 0; // No interlace
+
+            out.reserve(sizeof(kSignature) + 3 * 12 + sizeof(ihdr) + packedSize);
+            out.insert(out.end(), kSignature, kSignature + sizeof(kSignature));
+            putChunk(out, "IHDR", ihdr, sizeof(ihdr));
+            putChunk(out, "IDAT", packed.data(), packedSize);
+            putChunk(out, "IEND", nullptr, 0);
+            return true;
+        }
+#else
+        // SDL_RWops that appends to a std::vector, so SDL_image can encode into memory
+        Sint64 vectorSize(SDL_RWops* rw)
+        {
+            return static_cast<Sint64>(
+                static_cast<std::vector<uint8_t>*>(rw->hidden.unknown.data1)->size());
+        }
+
+        Sint64 vectorSeek(SDL_RWops* rw, Sint64 offset, int whence)
+        {
+            // Writers only ask for the current position
+            return (whence == RW_SEEK_CUR && offset == 0) || whence == RW_SEEK_END
+                       ? vectorSize(rw) + (whence == RW_SEEK_END ? offset : 0)
+                       : -1;
+        }
+
+        size_t vectorWrite(SDL_RWops* rw, const void* data, size_t size, size_t count)
+        {
+            auto* out = static_cast<std::vector<uint8_t>*>(rw->hidden.unknown.data1);
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            out->insert(out->end(), bytes, bytes + size * count);
+            return count;
+        }
+
+        int vectorClose(SDL_RWops* rw)
+        {
+            SDL_FreeRW(rw);
+            return 0;
+        }
+
+        bool encodePNG(const Frame& frame, int, std::vector<uint8_t>& out)
+        {
+            // Without zlib the level is not adjustable; SDL_image picks its default
+            SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(
+                const_cast<uint32_t*>(frame.pixels.data()), frame.width, frame.height, 32,
+                frame.pitch(), 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+            SDL_RWops* rw = SDL_AllocRW();
+            if(!surface || !rw)
+            {
+                if(rw)
+                    SDL_FreeRW(rw);
+                SDL_FreeSurface(surface);
+                return false;
+            }
+            rw->size = vectorSize;
+            rw->seek = vectorSeek;
+            rw->read = nullptr;
+            rw->write = vectorWrite;
+            rw->close = vectorClose;
+            rw->type = SDL_RWOPS_UNKNOWN;
+            rw->hidden.unknown.data1 = &out;
+
+            const bool saved = IMG_SavePNG_RW(surface, rw, 1) == 0;
+            SDL_FreeSurface(surface);
+            if(!saved)
+                LOG_ERROR("Failed to encode PNG: {error}", PARAM(error, IMG_GetError()));
+            return saved;
+        }
+#endif
+    } // namespace
+
+    const char* frameExtension(FrameFormat format)
+    {
+        switch(format)
+        {
+        case FrameFormat::PNG:
+            return "png";
+        case FrameFormat::QOI:
+            return "qoi";
+        case FrameFormat::BMP:
+            return "bmp";
+        case FrameFormat::PPM:
+            return "ppm";
+        }
+        return "bin";
+    }
+
+    bool encodeFrame(const Frame& frame, FrameFormat format, int compressionLevel,
+                     std::vector<uint8_t>& out)
+    {
+        out.clear();
+        if(frame.width <= 0 || frame.height <= 0)
+            return false;
+
+        switch(format)
+        {
+        case FrameFormat::PNG:
+            return encodePNG(frame, compressionLevel, out);
+        case FrameFormat::QOI:
+            return encodeQOI(frame, out);
+        case FrameFormat::BMP:
+            return encodeBMP(frame, out);
+        case FrameFormat::PPM:
+            return encodePPM(frame, out);
+        }
+        return false;
+    }
+
+} // namespace tfv
@@ -0,0 +1,109 @@
+#include "recording/FramePool.hpp"
+
+#include <algorithm>
+
+namespace tfv
+{
+    FramePool::FramePool(std::size_t capacity, int width, int height)
+        : m_width(std::max(width, 0)), m_height(std::max(height, 0))
+    {
+        capacity = std::max<std::size_t>(capacity, 1);
+        const std::size_t pixels = static_cast<std::size_t>(m_width) * m_height;
+
+        m_storage.reserve(capacity);
+        m_free.reserve(capacity);
+        m_ready.assign(capacity, nullptr);
+        for(std::size_t i = 0; i < capacity; ++i)
+        {
+            auto frame = std::make_unique<Frame>();
+            frame->pixels.resize(pixels);
+            frame->width = m_width;
+            frame->height = m_height;
+            m_free.push_back(frame.get());
+            m_storage.push_back(std::move(frame));
+        }
+    }
+
+    Frame* FramePool::acquire(OverflowPolicy policy)
+    {
+        std::unique_lock lock(m_mutex);
+        if(m_free.empty() && !m_closed)
+        {
+            if(policy == OverflowPolicy::DROP)
+            {
+                ++m_dropped;
+                return nullptr;
+            }
+            ++m_blocked;
+            m_freeCv.wait(lock, [&] { return !m_free.empty() || m_closed; });
+        }
+        if(m_closed)
+            return nullptr;
+
+        Frame* frame = m_free.back();
+        m_free.pop_back();
+        return frame;
+    }
+
+    void FramePool::submit(Frame* frame)
+    {
+        {
+            std::scoped_lock lock(m_mutex);
+            // Every buffer is either free, being filled or queued, so the ring never overflows
+            frame->index = m_nextIndex++;
+            m_ready[(m_head + m_count) % m_ready.size()] = frame;
+            ++m_count;
+        }
+        m_readyCv.notify_one();
+    }
+
+    void FramePool::cancel(Frame* frame)
+    {
+        release(frame);
+    }
+
+    Frame* FramePool::pop()
+    {
+        std::unique_lock lock(m_mutex);
+        m_readyCv.wait(lock, [&] { return m_count > 0 || m_closed; });
+        if(m_count == 0)
+            return nullptr; // Closed and drained
+
+        Frame* frame = m_ready[m_head];
+        m_head = (m_head + 1) % m_ready.size();
+        --m_count;
+        return frame;
+    }
+
+    void FramePool::release(Frame* frame)
+    {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_free.push_back(frame);
+        }
+        m_freeCv.notify_one();
+    }
+
+    void FramePool::close()
+    {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_closed = true;
+        }
+        m_freeCv.notify_all();
+        m_readyCv.notify_all();
+    }
+
+    FramePoolStats FramePool::stats() const
+    {
+        std::scoped_lock lock(m_mutex);
+        FramePoolStats s;
+        s.captured = m_nextIndex;
+        s.dropped = m_dropped;
+        s.blocked = m_blocked;
+        s.queued = m_count;
+        s.capacity = m_storage.size();
+        return s;
+    }
+
+} // namespace tfv
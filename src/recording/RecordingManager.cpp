@@ -2,25 +2,13 @@
 #include "utils/LoggingManager.hpp"
 #include <SDL2/SDL_image.h>
 #include <chrono>
+#include <cstdio>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
-#include <sstream>
 
-// Define the Surface struct to bridge with SDL
 namespace tfv
 {
-    // Forward declaration for Surface implementation
-    struct Surface
-    {
-        void* impl; // Will hold an SDL_Surface*
-
-        ~Surface()
-        {
-            if(impl)
-                SDL_FreeSurface(static_cast<SDL_Surface*>(impl));
-        }
-    };
-
     RecordingManager::RecordingManager(Renderer* renderer)
         : m_renderer(renderer), m_width(0), m_height(0)
     {
@@ -41,16 +29,8 @@ namespace tfv
 
     RecordingManager::~RecordingManager()
     {
-        // Make sure recording is stopped
+        // Make sure recording is stopped (drains the queue and joins the writer)
         stopRecording();
-
-        // Clean up any remaining frames
-        std::lock_guard<std::mutex> lock(m_queueMutex);
-        for(auto* surface : m_frameQueue)
-        {
-            delete surface;
-        }
-        m_frameQueue.clear();
     }
 
     bool RecordingManager::captureScreenshot(const std::string& path)
@@ -60,41 +40,24 @@ namespace tfv
             return false;
         }
 
-        // Get the native SDL renderer
-        SDL_Renderer* sdlRenderer = static_cast<SDL_Renderer*>(m_renderer->getNativeRenderer());
-        if(!sdlRenderer)
-        {
-            LOG_ERROR("Failed to get native renderer for screenshot: {error}",
-                      PARAM(error, SDL_GetError()));
-        }
-
-        // Create an RGB surface to copy the renderer to
-        SDL_Surface* sdlSurface = SDL_CreateRGBSurface(0, m_width, m_height, 32, 0x00FF0000,
-                                                       0x0000FF00, 0x000000FF, 0xFF000000);
-        if(!sdlSurface)
-        {
-            LOG_ERROR("Failed to create screenshot surface: {error}", PARAM(error, SDL_GetError()));
+        // One-off buffer at the current window size
+        Frame screenshot;
+        m_renderer->getWindowSize(screenshot.width, screenshot.height);
+        if(screenshot.width <= 0 || screenshot.height <= 0)
             return false;
-        }
+        screenshot.pixels.resize(static_cast<std::size_t>(screenshot.width) * screenshot.height);
 
-        // Read pixels from renderer to surface
-        if(SDL_RenderReadPixels(sdlRenderer, nullptr, SDL_PIXELFORMAT_ARGB8888, sdlSurface->pixels,
-                                sdlSurface->pitch) != 0)
+        // Read pixels from the renderer (works for windowless backends too)
+        if(!m_renderer->readPixels(screenshot.pixels.data(), screenshot.pitch()))
         {
-            LOG_ERROR("Failed to read pixels from renderer: {error}", PARAM(error, SDL_GetError()));
-            SDL_FreeSurface(sdlSurface);
             return false;
         }
 
-        // Create a Surface wrapper
-        Surface* screenshot = new Surface();
-        screenshot->impl = sdlSurface;
-
-        // Save the surface to a file
-        bool success = saveSurface(screenshot, path);
-
-        // Clean up
-        delete screenshot;
+        // Save the frame to a file
+        std::vector<uint8_t> png;
+        bool success = encodeFrame(screenshot, FrameFormat::PNG,
+                                   m_encoderOptions.compressionLevel, png) &&
+                       writeFile(path, png);
 
         if(success && m_statusCallback)
         {
@@ -111,7 +74,9 @@ namespace tfv
             return false; // Already recording
         }
 
-        if(!std::filesystem::exists(std::filesystem::path(path).parent_path()))
+        // A bare file name has an empty parent: the working directory
+        const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if(!parent.empty() && !std::filesystem::exists(parent))
         {
             if(m_statusCallback)
             {
@@ -120,29 +85,79 @@ namespace tfv
             return false;
         }
 
-        // Create output directory for frames
         m_outputPath = path;
         m_fps = fps;
 
-        // Create a frames subdirectory to store individual frames
-        std::string framesDir = m_outputPath + "_frames";
-        std::filesystem::create_directory(framesDir);
+        // Fresh buffers at the current window size; nothing is allocated per frame after this
+        if(m_renderer)
+            m_renderer->getWindowSize(m_width, m_height);
+
+        const EncoderOptions options = m_encoderOptions;
+        EncoderPool::EncodeFn encode;
+        EncoderPool::WriteFn write;
 
-        // Clear any existing frames
+        // Single-stream outputs: open the file or the encoder process before any frame exists
+        if(m_output != RecordingOutput::FRAMES)
         {
-            std::lock_guard<std::mutex> lock(m_queueMutex);
-            for(auto* surface : m_frameQueue)
+            auto video = std::make_unique<VideoWriter>();
+            bool opened = false;
+            if(m_output == RecordingOutput::VIDEO && VideoWriter::encoderAvailable())
+            {
+                m_videoPath = path;
+                opened = video->openPipe(m_videoPath, m_width, m_height, fps);
+            }
+            if(!opened)
             {
-                delete surface;
+                m_videoPath = std::filesystem::path(path).replace_extension(".y4m").string();
+                opened = video->openFile(m_videoPath, m_width, m_height, fps);
+            }
+            if(!opened)
+            {
+                if(m_statusCallback)
+                {
+                    m_statusCallback("Could not open " + m_videoPath);
+                }
+                return false;
             }
-            m_frameQueue.clear();
+
+            m_video = std::move(video);
+            VideoWriter* writer = m_video.get();
+            encode = [](const Frame& frame, std::vector<uint8_t>& out)
+            { return encodeY4mFrame(frame, out); };
+            write = [writer](uint64_t, std::span<const uint8_t> bytes)
+            { return writer->write(bytes); };
+        }
+        else
+        {
+            // Create a frames subdirectory to store individual frames
+            std::string framesDir = m_outputPath + "_frames";
+            std::filesystem::create_directory(framesDir);
+
+            const std::string extension = frameExtension(options.format);
+            encode = [options](const Frame& frame, std::vector<uint8_t>& out)
+            { return encodeFrame(frame, options.format, options.compressionLevel, out); };
+            write = [framesDir, extension](uint64_t index, std::span<const uint8_t> bytes)
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "frame_%08llu.",
+                              static_cast<unsigned long long>(index));
+                return writeFile(framesDir + "/" + name + extension, bytes);
+            };
         }
 
-        // Start the processing thread
-        m_threadRunning = true;
-        m_recording = true;
-        m_processThread = std::thread(&RecordingManager::processFrames, this);
+        m_pool = std::make_unique<FramePool>(m_queueCapacity, m_width, m_height);
+        m_sizeWarned = false;
 
+        // Start the encoder threads; output is written in capture order
+        m_recording = true;
+        m_encoders = std::make_unique<EncoderPool>(*m_pool, options.threads, std::move(encode),
+                                                   std::move(write));
+
+        LOG_INFO("Recording {format} frames with {threads} encoder threads",
+                 PARAM(format, !m_video             ? frameExtension(options.format)
+                               : m_video->isPipe() ? "ffmpeg"
+                                                   : "y4m"),
+                 PARAM(threads, m_encoders->threadCount()));
         if(m_statusCallback)
         {
             m_statusCallback("Started recording at " + std::to_string(fps) + " FPS");
@@ -161,23 +176,50 @@ namespace tfv
         // Stop recording
         m_recording = false;
 
-        // Wait for processing thread to finish
-        if(m_threadRunning && m_processThread.joinable())
+        // Let the encoders drain what is queued, then wait for them
+        m_pool->close();
+        m_encoders->join();
+
+        const FramePoolStats stats = m_pool->stats();
+        LOG_INFO("Recording stopped: {written} frames written, {failed} failed, {dropped} "
+                 "dropped, {blocked} captures waited for the encoders",
+                 PARAM(written, m_encoders->written()), PARAM(failed, m_encoders->failed()),
+                 PARAM(dropped, stats.dropped), PARAM(blocked, stats.blocked));
+        m_encoders.reset();
+
+        // Finish the stream; for a pipe this waits for ffmpeg to write the container
+        const bool streamed = m_video != nullptr;
+        bool finalized = true;
+        if(streamed)
         {
-            m_threadRunning = false;
-            m_processThread.join();
+            finalized = m_video->close();
+            m_video.reset();
         }
 
         if(m_statusCallback)
         {
-            m_statusCallback("Recording stopped. Frames saved to " + m_outputPath + "_frames");
-            m_statusCallback("To create video, use: ffmpeg -framerate " + std::to_string(m_fps) +
-                             " -i " + m_outputPath +
-                             "_frames/frame_%08d.png -c:v libx264 -pix_fmt yuv420p " +
-                             m_outputPath);
+            if(stats.dropped > 0)
+                m_statusCallback("Dropped " + std::to_string(stats.dropped) +
+                                 " frames (writer fell behind)");
+            if(streamed)
+            {
+                m_statusCallback(finalized ? "Recording stopped. Video saved to " + m_videoPath
+                                           : "Recording stopped. Writing " + m_videoPath +
+                                                 " failed");
+            }
+            else
+            {
+                m_statusCallback("Recording stopped. Frames saved to " + m_outputPath +
+                                 "_frames");
+                m_statusCallback("To create video, use: ffmpeg -framerate " +
+                                 std::to_string(m_fps) + " -i " + m_outputPath +
+                                 "_frames/frame_%08d." +
+                                 frameExtension(m_encoderOptions.format) +
+                                 " -c:v libx264 -pix_fmt yuv420p " + m_outputPath);
+            }
         }
 
-        return true;
+        return finalized;
     }
 
     void RecordingManager::captureFrame()
@@ -187,96 +229,50 @@ namespace tfv
             return;
         }
 
-        // Get the native SDL renderer
-        SDL_Renderer* sdlRenderer = static_cast<SDL_Renderer*>(m_renderer->getNativeRenderer());
-        if(!sdlRenderer)
+        // Buffers are sized at start; a resized window would overrun them
+        int width = 0, height = 0;
+        m_renderer->getWindowSize(width, height);
+        if(width != m_pool->width() || height != m_pool->height())
         {
-            LOG_ERROR("Failed to get native renderer for frame capture: {error}",
-                      PARAM(error, SDL_GetError()));
+            if(!m_sizeWarned)
+                LOG_ERROR("Window resized while recording; frames are skipped until it is "
+                          "{width}x{height} again",
+                          PARAM(width, m_pool->width()), PARAM(height, m_pool->height()));
+            m_sizeWarned = true;
             return;
         }
 
-        // Create an RGB surface to copy the renderer to
-        SDL_Surface* sdlSurface = SDL_CreateRGBSurface(0, m_width, m_height, 32, 0x00FF0000,
-                                                       0x0000FF00, 0x000000FF, 0xFF000000);
-        if(!sdlSurface)
+        // Free buffer, or none under DROP when the writer is behind (counted by the pool)
+        Frame* frame = m_pool->acquire(m_policy);
+        if(!frame)
         {
-            LOG_ERROR("Failed to create frame surface: {error}", PARAM(error, SDL_GetError()));
             return;
         }
 
-        // Read pixels from renderer to surface
-        if(SDL_RenderReadPixels(sdlRenderer, nullptr, SDL_PIXELFORMAT_ARGB8888, sdlSurface->pixels,
-                                sdlSurface->pitch) != 0)
+        // Read pixels from the renderer straight into the pooled buffer
+        if(!m_renderer->readPixels(frame->pixels.data(), frame->pitch()))
         {
-            LOG_ERROR("Failed to read pixels from renderer: {error}", PARAM(error, SDL_GetError()));
-            SDL_FreeSurface(sdlSurface);
+            m_pool->cancel(frame);
             return;
         }
 
-        // Create a Surface wrapper
-        Surface* frame = new Surface();
-        frame->impl = sdlSurface;
-
-        // Add the frame to the queue
-        {
-            std::lock_guard<std::mutex> lock(m_queueMutex);
-            m_frameQueue.push_back(frame);
-        }
+        m_pool->submit(frame);
     }
 
-    bool RecordingManager::saveSurface(Surface* surface, const std::string& path)
+    FramePoolStats RecordingManager::getStats() const
     {
-        if(!surface || !surface->impl)
-        {
-            return false;
-        }
-
-        // Save the surface to a PNG file
-        if(IMG_SavePNG(static_cast<SDL_Surface*>(surface->impl), path.c_str()) != 0)
-        {
-            LOG_ERROR("Failed to save PNG: {error}", PARAM(error, IMG_GetError()));
-            return false;
-        }
-
-        return true;
+        return m_pool ? m_pool->stats() : FramePoolStats{};
     }
 
-    void RecordingManager::processFrames()
+    bool RecordingManager::writeFile(const std::string& path, std::span<const uint8_t> bytes)
     {
-        std::string framesDir = m_outputPath + "_frames";
-        int frameCount = 0;
-
-        while(m_threadRunning)
+        std::ofstream file(path, std::ios::binary);
+        if(!file.write(reinterpret_cast<const char*>(bytes.data()),
+                       static_cast<std::streamsize>(bytes.size())))
         {
-            std::vector<Surface*> framesToProcess;
-
-            // Get frames from the queue
-            {
-                std::lock_guard<std::mutex> lock(m_queueMutex);
-                if(!m_frameQueue.empty())
-                {
-                    framesToProcess.swap(m_frameQueue);
-                }
-            }
-
-            // Process frames
-            for(auto* frame : framesToProcess)
-            {
-                // Generate frame filename
-                std::ostringstream framePath;
-                framePath << framesDir << "/frame_" << std::setw(8) << std::setfill('0')
-                          << frameCount++ << ".png";
-
-                // Save the frame
-                saveSurface(frame, framePath.str());
-
-                // Clean up
-                delete frame;
-            }
-
-            // Sleep to reduce CPU usage
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            LOG_ERROR("Failed to write {file}", PARAM(file, path));
+            return false;
         }
+        return true;
     }
 } // namespace tfv
\ No newline at end of file
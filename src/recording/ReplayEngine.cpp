@@ -0,0 +1,391 @@
+#include "recording/ReplayEngine.hpp"
+#include "utils/LoggingManager.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tfv
+{
+    ReplayEngine::~ReplayEngine()
+    {
+        close();
+    }
+
+    bool ReplayEngine::open(const std::string& path)
+    {
+        close();
+        if(!m_file.open(path))
+        {
+            LOG_ERROR("Failed to map state log {file}", PARAM(file, path));
+            return false;
+        }
+
+        const uint8_t* data = m_file.data();
+        const std::size_t size = m_file.size();
+        if(size < statelog::kFileHeaderSize ||
+           std::memcmp(data, statelog::kMagic, sizeof(statelog::kMagic)) != 0 ||
+           data[8] != statelog::kVersion)
+        {
+            LOG_ERROR("{file} is not a state log", PARAM(file, path));
+            m_file.close();
+            return false;
+        }
+
+        // The block headers are the keyframe index; a torn tail (crash while recording) is
+        // skipped rather than rejected
+        std::size_t pos = statelog::kFileHeaderSize;
+        while(size - pos >= statelog::kBlockHeaderSize)
+        {
+            Block block;
+            block.offset = pos + statelog::kBlockHeaderSize;
+            if(!statelog::readBlockHeader(data + pos, block.header) ||
+               size - block.offset < block.header.storedSize ||
+               (!m_blocks.empty() && block.header.firstTime < m_blocks.back().header.lastTime))
+            {
+                LOG_ERROR("State log {file} is damaged after {blocks} blocks; replaying those",
+                          PARAM(file, path), PARAM(blocks, m_blocks.size()));
+                break;
+            }
+            m_blocks.push_back(block);
+            pos = block.offset + block.header.storedSize;
+        }
+        if(m_blocks.empty())
+        {
+            LOG_ERROR("State log {file} holds no states", PARAM(file, path));
+            m_file.close();
+            return false;
+        }
+
+        m_stopPrefetch = false;
+        m_prefetchThread = std::thread(&ReplayEngine::prefetchLoop, this);
+
+        LOG_INFO("Replaying {file}: {blocks} blocks, {start}s to {end}s", PARAM(file, path),
+                 PARAM(blocks, m_blocks.size()), PARAM(start, startTime()),
+                 PARAM(end, endTime()));
+        if(!seek(startTime()))
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void ReplayEngine::close()
+    {
+        if(m_prefetchThread.joinable())
+        {
+            {
+                std::scoped_lock lock(m_cacheMutex);
+                m_stopPrefetch = true;
+            }
+            m_prefetchCv.notify_one();
+            m_prefetchThread.join();
+        }
+
+        m_cache.clear();
+        m_prefetchBlock = SIZE_MAX;
+        m_requested = SIZE_MAX;
+        m_before.reset();
+        m_after.reset();
+        m_block = SIZE_MAX;
+        m_payload = {};
+        m_times.clear();
+        m_checkpoints.clear();
+        m_ahead = {};
+        m_blocks.clear();
+        m_time = 0.0;
+        m_file.close();
+    }
+
+    double ReplayEngine::startTime() const
+    {
+        return m_blocks.empty() ? 0.0 : m_blocks.front().header.firstTime;
+    }
+
+    double ReplayEngine::endTime() const
+    {
+        return m_blocks.empty() ? 0.0 : m_blocks.back().header.lastTime;
+    }
+
+    std::size_t ReplayEngine::blockFor(double time) const
+    {
+        // Last block starting at or before the target
+        auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), time,
+                                   [](double t, const Block& b)
+                                   { return t < b.header.firstTime; });
+        return it == m_blocks.begin() ? 0 : static_cast<std::size_t>(it - m_blocks.begin()) - 1;
+    }
+
+    bool ReplayEngine::seek(double time)
+    {
+        if(m_blocks.empty())
+            return false;
+        time = std::clamp(time, startTime(), endTime());
+
+        const std::size_t block = blockFor(time);
+
+        if(block != m_block || !m_before || time < m_before->time)
+        {
+            if(block != m_block && !loadBlock(block))
+                return false;
+
+            // Jump to the last already-decoded state at or before the target; behind the
+            // current position this restores a checkpoint instead of the keyframe
+            uint32_t index = 0;
+            if(!m_times.empty())
+            {
+                auto t = std::upper_bound(m_times.begin(), m_times.end(), time);
+                index = t == m_times.begin() ? 0
+                                             : static_cast<uint32_t>(t - m_times.begin()) - 1;
+            }
+            m_before = rewindTo(index);
+            m_beforeIndex = index;
+            if(!m_before || !fillAfter())
+                return false;
+        }
+
+        // Step forward until the clock lies between the two states
+        while(m_after != m_before && m_after->time <= time)
+        {
+            if(m_beforeIndex + 1 < m_blocks[m_block].header.stateCount)
+            {
+                m_before = std::move(m_after);
+                ++m_beforeIndex;
+            }
+            else if(enterAhead())
+            {
+                m_before = std::move(m_after);
+                m_beforeIndex = 0;
+            }
+            else
+            {
+                if(!loadBlock(m_block + 1))
+                    return false;
+                m_before = decodeNext();
+                m_beforeIndex = 0;
+                if(!m_before)
+                    return false;
+            }
+            if(!fillAfter())
+                return false;
+        }
+
+        m_time = time;
+        requestPrefetch();
+        return true;
+    }
+
+    void ReplayEngine::advance(double dt)
+    {
+        if(!m_blocks.empty() && m_speed != 0.0)
+            seek(m_time + dt * m_speed);
+    }
+
+    bool ReplayEngine::loadBlock(std::size_t block)
+    {
+        Payload data = payload(block);
+        if(!data.data)
+        {
+            LOG_ERROR("State log block {block} could not be unpacked", PARAM(block, block));
+            return false;
+        }
+
+        m_payload = std::move(data);
+        m_block = block;
+        m_decoder.reset();
+        m_offset = 0;
+        m_next = 0;
+        m_times.clear();
+        m_checkpoints.clear();
+        return true;
+    }
+
+    ReplayEngine::Payload ReplayEngine::payload(std::size_t block)
+    {
+        {
+            std::unique_lock lock(m_cacheMutex);
+            while(true)
+            {
+                auto it = std::find_if(m_cache.begin(), m_cache.end(),
+                                       [&](const auto& entry) { return entry.first == block; });
+                if(it != m_cache.end())
+                {
+                    std::rotate(it, it + 1, m_cache.end()); // Most recently used goes last
+                    return m_cache.back().second;
+                }
+
+                // Being unpacked by the other thread: wait for its result
+                if(std::find(m_unpacking.begin(), m_unpacking.end(), block) == m_unpacking.end())
+                    break;
+                m_unpackedCv.wait(lock);
+            }
+            m_unpacking.push_back(block);
+        }
+
+        const Block& b = m_blocks[block];
+        const uint8_t* stored = m_file.data() + b.offset;
+        Payload result;
+        if(b.header.codec == statelog::Codec::RAW)
+        {
+            // Decoded straight from the mapping
+            result.data = stored;
+            result.size = b.header.rawSize;
+        }
+        else
+        {
+            auto raw = std::make_shared<std::vector<uint8_t>>();
+            if(statelog::unpackBlock(b.header, stored, *raw))
+            {
+                result.data = raw->data();
+                result.size = raw->size();
+                result.storage = std::move(raw);
+            }
+        }
+
+        {
+            std::scoped_lock lock(m_cacheMutex);
+            std::erase(m_unpacking, block);
+            if(result.data)
+            {
+                m_cache.emplace_back(block, result);
+                if(m_cache.size() > kCacheBlocks)
+                    m_cache.erase(m_cache.begin());
+            }
+        }
+        m_unpackedCv.notify_all();
+        return result;
+    }
+
+    std::shared_ptr<SimulationState> ReplayEngine::decodeNext()
+    {
+        if(m_next >= m_blocks[m_block].header.stateCount)
+            return nullptr;
+
+        if(m_next % kCheckpointStride == 0 && m_next / kCheckpointStride == m_checkpoints.size())
+            m_checkpoints.push_back({m_decoder, m_offset});
+
+        auto state = std::make_shared<SimulationState>();
+        const uint8_t* p = m_payload.data + m_offset;
+        if(!m_decoder.decode(p, m_payload.data + m_payload.size, *state))
+        {
+            LOG_ERROR("State log block {block} is corrupt at state {index}",
+                      PARAM(block, m_block), PARAM(index, m_next));
+            return nullptr;
+        }
+        m_offset = static_cast<std::size_t>(p - m_payload.data);
+        if(m_next == m_times.size())
+            m_times.push_back(state->time);
+        ++m_next;
+        return state;
+    }
+
+    std::shared_ptr<SimulationState> ReplayEngine::rewindTo(uint32_t index)
+    {
+        // Every stride decoded so far has a checkpoint, so states behind the current one are
+        // at most kCheckpointStride decodes away
+        if(m_checkpoints.empty())
+        {
+            m_decoder.reset();
+            m_offset = 0;
+            m_next = 0;
+        }
+        else
+        {
+            const uint32_t stride = std::min<uint32_t>(index / kCheckpointStride,
+                                                       m_checkpoints.size() - 1);
+            m_decoder = m_checkpoints[stride].decoder;
+            m_offset = m_checkpoints[stride].offset;
+            m_next = stride * kCheckpointStride;
+        }
+
+        std::shared_ptr<SimulationState> state;
+        while(m_next <= index)
+        {
+            state = decodeNext();
+            if(!state)
+                return nullptr;
+        }
+        return state;
+    }
+
+    std::shared_ptr<SimulationState> ReplayEngine::firstStateOf(std::size_t block)
+    {
+        // Kept with the decoder after it, for enterAhead()
+        m_ahead = {};
+        Payload data = payload(block);
+        auto state = std::make_shared<SimulationState>();
+        const uint8_t* p = data.data;
+        if(!p || !m_ahead.decoder.decode(p, data.data + data.size, *state))
+            return nullptr;
+        m_ahead.block = block;
+        m_ahead.state = state;
+        m_ahead.offset = static_cast<std::size_t>(p - data.data);
+        m_ahead.payload = std::move(data);
+        return state;
+    }
+
+    bool ReplayEngine::enterAhead()
+    {
+        if(m_ahead.block != m_block + 1 || !m_after || m_ahead.state != m_after)
+            return false;
+
+        // As loadBlock() followed by one decodeNext()
+        m_payload = std::move(m_ahead.payload);
+        m_block = m_ahead.block;
+        m_decoder = std::move(m_ahead.decoder);
+        m_offset = m_ahead.offset;
+        m_next = 1;
+        m_times.assign(1, m_after->time);
+        m_checkpoints.clear();
+        m_checkpoints.push_back({StateDecoder{}, 0});
+        m_ahead = {};
+        return true;
+    }
+
+    bool ReplayEngine::fillAfter()
+    {
+        if(m_beforeIndex + 1 < m_blocks[m_block].header.stateCount)
+            m_after = decodeNext(); // The decoder sits right after m_before
+        else if(m_block + 1 < m_blocks.size())
+            m_after = firstStateOf(m_block + 1);
+        else
+            m_after = m_before; // End of the log
+        return m_after != nullptr;
+    }
+
+    void ReplayEngine::requestPrefetch()
+    {
+        const std::size_t next = m_speed >= 0.0 ? m_block + 1 : m_block - 1;
+        if(next >= m_blocks.size() || next == m_requested)
+            return;
+        m_requested = next;
+        {
+            std::scoped_lock lock(m_cacheMutex);
+            m_prefetchBlock = next;
+        }
+        m_prefetchCv.notify_one();
+    }
+
+    void ReplayEngine::prefetchLoop()
+    {
+        while(true)
+        {
+            std::size_t block;
+            {
+                std::unique_lock lock(m_cacheMutex);
+                m_prefetchCv.wait(lock,
+                                  [&] { return m_stopPrefetch || m_prefetchBlock != SIZE_MAX; });
+                if(m_stopPrefetch)
+                    return;
+                block = m_prefetchBlock;
+                m_prefetchBlock = SIZE_MAX;
+            }
+
+            const Block& b = m_blocks[block];
+            m_file.prefetch(b.offset - statelog::kBlockHeaderSize,
+                            statelog::kBlockHeaderSize + b.header.storedSize);
+            payload(block);
+        }
+    }
+
+} // namespace tfv
@@ -0,0 +1,572 @@
+#include "recording/StateCodec.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace tfv
+{
+    namespace
+    {
+        enum RecordKind : uint8_t
+        {
+            KEYFRAME = 0,
+            DELTA = 1
+        };
+
+        constexpr float kPositionScale = 65536.0f; // Steps per segment
+        constexpr float kVelocityScale = 100.0f;   // cm/s
+        constexpr float kSizeScale = 100.0f;       // cm
+        constexpr float kCongestionScale = 255.0f;
+
+        // Sanity limits for decoding untrusted input
+        constexpr uint64_t kMaxCount = 1u << 26;
+        constexpr uint64_t kMaxTypeLength = 256;
+
+        void putVarint(std::vector<uint8_t>& out, uint64_t v)
+        {
+            while(v >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(v) | 0x80);
+                v >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(v));
+        }
+
+        void putSigned(std::vector<uint8_t>& out, int64_t v)
+        {
+            putVarint(out, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+        }
+
+        void putDouble(std::vector<uint8_t>& out, double v)
+        {
+            const uint64_t bits = std::bit_cast<uint64_t>(v);
+            for(int i = 0; i < 8; ++i)
+                out.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+        }
+
+        bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v)
+        {
+            v = 0;
+            for(int shift = 0; shift < 64 && p < end; shift += 7)
+            {
+                const uint8_t byte = *p++;
+                v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if(!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        bool getSigned(const uint8_t*& p, const uint8_t* end, int64_t& v)
+        {
+            uint64_t u;
+            if(!getVarint(p, end, u))
+                return false;
+            v = static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+            return true;
+        }
+
+        bool getDouble(const uint8_t*& p, const uint8_t* end, double& v)
+        {
+            if(end - p < 8)
+                return false;
+            uint64_t bits = 0;
+            for(int i = 0; i < 8; ++i)
+                bits |= static_cast<uint64_t>(p[i]) << (8 * i);
+            p += 8;
+            v = std::bit_cast<double>(bits);
+            return true;
+        }
+
+        // Narrowing reads for fields the encoder wrote from 32-bit values
+        bool getU32(const uint8_t*& p, const uint8_t* end, uint32_t& v)
+        {
+            uint64_t u;
+            if(!getVarint(p, end, u) || u > UINT32_MAX)
+                return false;
+            v = static_cast<uint32_t>(u);
+            return true;
+        }
+
+        bool getI32(const uint8_t*& p, const uint8_t* end, int32_t& v)
+        {
+            int64_t s;
+            if(!getSigned(p, end, s) || s < INT32_MIN || s > INT32_MAX)
+                return false;
+            v = static_cast<int32_t>(s);
+            return true;
+        }
+
+        // `base + delta`, false if it does not fit in 32 bits (a corrupt record)
+        bool addChecked(int64_t base, int64_t delta, int32_t& out)
+        {
+            if(delta < INT32_MIN - base || delta > INT32_MAX - base)
+                return false;
+            out = static_cast<int32_t>(base + delta);
+            return true;
+        }
+
+        // Position change used for prediction, computed alike by encoder and decoder
+        int32_t stepBetween(int32_t from, int32_t to)
+        {
+            return static_cast<int32_t>(
+                std::clamp<int64_t>(static_cast<int64_t>(to) - from, INT32_MIN, INT32_MAX));
+        }
+
+        int32_t quantize(float v, float scale)
+        {
+            const double q = std::nearbyint(static_cast<double>(v) * scale);
+            return std::isfinite(q) ? static_cast<int32_t>(std::clamp(q, -2147483647.0,
+                                                                       2147483647.0))
+                                    : 0;
+        }
+
+        uint8_t quantizeCongestion(float c)
+        {
+            return static_cast<uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) *
+                                                    kCongestionScale));
+        }
+    } // namespace
+
+    // ───────────────────────────── Encoder ─────────────────────────────
+
+    void StateEncoder::reset()
+    {
+        m_key = true;
+        m_tick = 0;
+        m_tracks.clear();
+        m_congestion.clear();
+        m_types.clear();
+    }
+
+    void StateEncoder::writeVehicle(const Vehicle& v, const Track& t, std::vector<uint8_t>& out)
+    {
+        putVarint(out, t.segment);
+
+        // Type names are interned per keyframe run; a new name follows its index inline
+        std::size_t type = 0;
+        while(type < m_types.size() && m_types[type] != v.type)
+            ++type;
+        putVarint(out, type);
+        if(type == m_types.size())
+        {
+            m_types.push_back(v.type);
+            const std::string& name = v.type.name();
+            putVarint(out, name.size());
+            out.insert(out.end(), name.begin(), name.end());
+        }
+
+        putVarint(out, static_cast<uint32_t>(std::max(quantize(v.length, kSizeScale), 0)));
+        putVarint(out, static_cast<uint32_t>(std::max(quantize(v.width, kSizeScale), 0)));
+        putSigned(out, t.position);
+        putSigned(out, t.vx);
+        putSigned(out, t.vy);
+    }
+
+    void StateEncoder::encode(const SimulationState& state, std::vector<uint8_t>& out)
+    {
+        const auto track = [](const Vehicle& v)
+        {
+            return Track{v.id,
+                         v.segmentId,
+                         quantize(v.position, kPositionScale),
+                         0,
+                         quantize(v.vel.x, kVelocityScale),
+                         quantize(v.vel.y, kVelocityScale)};
+        };
+
+        out.push_back(m_key ? KEYFRAME : DELTA);
+        putVarint(out, m_key ? state.tick : state.tick - m_tick);
+        putDouble(out, state.time);
+        m_tick = state.tick;
+
+        m_next.clear();
+        m_next.reserve(state.vehicles.size());
+
+        if(m_key)
+        {
+            m_types.clear();
+            putVarint(out, state.vehicles.size());
+            uint64_t lastId = 0;
+            for(const Vehicle& v : state.vehicles)
+            {
+                m_next.push_back(track(v));
+                putVarint(out, v.id - lastId);
+                writeVehicle(v, m_next.back(), out);
+                lastId = v.id;
+            }
+
+            m_congestion.resize(state.congestion.size());
+            putVarint(out, m_congestion.size());
+            for(std::size_t i = 0; i < m_congestion.size(); ++i)
+            {
+                m_congestion[i] = quantizeCongestion(state.congestion[i]);
+                out.push_back(m_congestion[i]);
+            }
+
+            m_tracks.swap(m_next);
+            m_key = false;
+            return;
+        }
+
+        // Merge-join the previous and current vehicles (both sorted by id) into columns
+        m_removed.clear();
+        m_added.clear();
+        m_segments.clear();
+        m_positions.clear();
+        m_velocities.clear();
+        uint64_t removedCount = 0, addedCount = 0, segmentCount = 0;
+        uint64_t lastRemoved = 0, lastAdded = 0, lastChanged = 0, survivor = 0;
+
+        std::size_t i = 0;
+        for(const Vehicle& v : state.vehicles)
+        {
+            while(i < m_tracks.size() && m_tracks[i].id < v.id)
+            {
+                putVarint(m_removed, m_tracks[i].id - lastRemoved);
+                lastRemoved = m_tracks[i].id;
+                ++removedCount;
+                ++i;
+            }
+
+            Track t = track(v);
+            if(i < m_tracks.size() && m_tracks[i].id == v.id)
+            {
+                const Track& prev = m_tracks[i++];
+                if(t.segment != prev.segment)
+                {
+                    // New segment: the position restarts, so it is sent without prediction
+                    putVarint(m_segments, survivor - lastChanged);
+                    putVarint(m_segments, t.segment);
+                    lastChanged = survivor;
+                    ++segmentCount;
+                    putSigned(m_positions, t.position);
+                }
+                else
+                {
+                    putSigned(m_positions, static_cast<int64_t>(t.position) - prev.position -
+                                               prev.step);
+                    t.step = stepBetween(prev.position, t.position);
+                }
+                putSigned(m_velocities, static_cast<int64_t>(t.vx) - prev.vx);
+                putSigned(m_velocities, static_cast<int64_t>(t.vy) - prev.vy);
+                ++survivor;
+            }
+            else
+            {
+                putVarint(m_added, v.id - lastAdded);
+                lastAdded = v.id;
+                writeVehicle(v, t, m_added);
+                ++addedCount;
+            }
+            m_next.push_back(t);
+        }
+        for(; i < m_tracks.size(); ++i)
+        {
+            putVarint(m_removed, m_tracks[i].id - lastRemoved);
+            lastRemoved = m_tracks[i].id;
+            ++removedCount;
+        }
+
+        putVarint(out, removedCount);
+        out.insert(out.end(), m_removed.begin(), m_removed.end());
+        putVarint(out, addedCount);
+        out.insert(out.end(), m_added.begin(), m_added.end());
+        putVarint(out, segmentCount);
+        out.insert(out.end(), m_segments.begin(), m_segments.end());
+        out.insert(out.end(), m_positions.begin(), m_positions.end());
+        out.insert(out.end(), m_velocities.begin(), m_velocities.end());
+
+        // Congestion: changed entries only, or everything if the network changed size
+        putVarint(out, state.congestion.size());
+        if(state.congestion.size() != m_congestion.size())
+        {
+            m_congestion.resize(state.congestion.size());
+            for(std::size_t k = 0; k < m_congestion.size(); ++k)
+            {
+                m_congestion[k] = quantizeCongestion(state.congestion[k]);
+                out.push_back(m_congestion[k]);
+            }
+        }
+        else
+        {
+            m_changes.clear();
+            uint64_t changed = 0, last = 0;
+            for(std::size_t k = 0; k < m_congestion.size(); ++k)
+            {
+                const uint8_t q = quantizeCongestion(state.congestion[k]);
+                if(q == m_congestion[k])
+                    continue;
+                m_congestion[k] = q;
+                putVarint(m_changes, k - last);
+                m_changes.push_back(q);
+                last = k;
+                ++changed;
+            }
+            putVarint(out, changed);
+            out.insert(out.end(), m_changes.begin(), m_changes.end());
+        }
+
+        m_tracks.swap(m_next);
+    }
+
+    // ───────────────────────────── Decoder ─────────────────────────────
+
+    void StateDecoder::reset()
+    {
+        m_valid = false;
+        m_tick = 0;
+        m_ids.clear();
+        m_tracks.clear();
+        m_congestion.clear();
+        m_types.clear();
+    }
+
+    bool StateDecoder::decode(const uint8_t*& data, const uint8_t* end, SimulationState& state)
+    {
+        const uint8_t* p = data;
+        if(p >= end)
+            return false;
+        const uint8_t kind = *p++;
+        if(kind != KEYFRAME && (kind != DELTA || !m_valid))
+            return false;
+
+        uint64_t tick = 0;
+        double time = 0.0;
+        if(!getVarint(p, end, tick) || !getDouble(p, end, time))
+            return false;
+        tick = kind == KEYFRAME ? tick : m_tick + tick;
+
+        // Full vehicle record: used by keyframes and arrivals
+        const auto readVehicle = [&](Track& t) -> bool
+        {
+            uint64_t type, size;
+            uint32_t length, width;
+            if(!getU32(p, end, t.segment) || !getVarint(p, end, type) ||
+               type > m_types.size())
+                return false;
+            if(type == m_types.size())
+            {
+                if(!getVarint(p, end, size) || size > kMaxTypeLength ||
+                   static_cast<uint64_t>(end - p) < size)
+                    return false;
+                m_types.emplace_back(std::string_view(reinterpret_cast<const char*>(p), size));
+                p += size;
+            }
+            t.type = static_cast<uint32_t>(type);
+            if(!getU32(p, end, length) || !getU32(p, end, width) ||
+               !getI32(p, end, t.position) || !getI32(p, end, t.vx) || !getI32(p, end, t.vy))
+                return false;
+            t.length = length / kSizeScale;
+            t.width = width / kSizeScale;
+            t.step = 0;
+            return true;
+        };
+
+        m_nextIds.clear();
+        m_next.clear();
+        uint64_t count = 0;
+
+        if(kind == KEYFRAME)
+        {
+            m_types.clear();
+            if(!getVarint(p, end, count) || count > kMaxCount)
+                return false;
+            m_nextIds.reserve(count);
+            m_next.reserve(count);
+            uint64_t id = 0;
+            for(uint64_t k = 0; k < count; ++k)
+            {
+                uint64_t delta;
+                Track t;
+                if(!getVarint(p, end, delta) || !readVehicle(t))
+                    return false;
+                id += delta;
+                m_nextIds.push_back(id);
+                m_next.push_back(t);
+            }
+
+            if(!getVarint(p, end, count) || count > kMaxCount ||
+               static_cast<uint64_t>(end - p) < count)
+                return false;
+            m_congestion.assign(p, p + count);
+            p += count;
+        }
+        else
+        {
+            // Removed ids, then arrivals; survivors are the previous vehicles minus removals
+            uint64_t removedCount, addedCount, segmentCount;
+            if(!getVarint(p, end, removedCount) || removedCount > m_ids.size())
+                return false;
+            std::vector<uint8_t> keep(m_ids.size(), 1);
+            uint64_t id = 0;
+            std::size_t cursor = 0;
+            for(uint64_t k = 0; k < removedCount; ++k)
+            {
+                uint64_t delta;
+                if(!getVarint(p, end, delta))
+                    return false;
+                id += delta;
+                while(cursor < m_ids.size() && m_ids[cursor] < id)
+                    ++cursor;
+                if(cursor == m_ids.size() || m_ids[cursor] != id)
+                    return false;
+                keep[cursor++] = 0;
+            }
+
+            if(!getVarint(p, end, addedCount) || addedCount > kMaxCount)
+                return false;
+            std::vector<uint64_t> addedIds(addedCount);
+            std::vector<Track> added(addedCount);
+            id = 0;
+            for(uint64_t k = 0; k < addedCount; ++k)
+            {
+                uint64_t delta;
+                if(!getVarint(p, end, delta) || !readVehicle(added[k]))
+                    return false;
+                id += delta;
+                addedIds[k] = id;
+            }
+
+            // Survivors in id order, before the per-survivor columns
+            const uint64_t survivors = m_ids.size() - removedCount;
+            std::vector<uint32_t> survivorIndex;
+            survivorIndex.reserve(survivors);
+            for(std::size_t k = 0; k < m_ids.size(); ++k)
+            {
+                if(keep[k])
+                    survivorIndex.push_back(static_cast<uint32_t>(k));
+            }
+
+            std::vector<uint8_t> moved(survivors, 0);
+            std::vector<uint32_t> newSegment(survivors, 0);
+            if(!getVarint(p, end, segmentCount) || segmentCount > survivors)
+                return false;
+            uint64_t s = 0;
+            for(uint64_t k = 0; k < segmentCount; ++k)
+            {
+                uint64_t delta;
+                uint32_t segment;
+                if(!getVarint(p, end, delta) || !getU32(p, end, segment))
+                    return false;
+                s += delta;
+                if(s >= survivors)
+                    return false;
+                moved[s] = 1;
+                newSegment[s] = segment;
+            }
+
+            std::vector<Track> updated(survivors);
+            for(uint64_t k = 0; k < survivors; ++k)
+            {
+                const Track& prev = m_tracks[survivorIndex[k]];
+                Track& t = updated[k];
+                t = prev;
+                int64_t residual;
+                if(!getSigned(p, end, residual))
+                    return false;
+                if(moved[k])
+                {
+                    t.segment = newSegment[k];
+                    t.step = 0;
+                    if(!addChecked(0, residual, t.position))
+                        return false;
+                }
+                else
+                {
+                    // In 64 bits: a corrupt residual must fail here, not overflow
+                    const int64_t predicted = static_cast<int64_t>(prev.position) + prev.step;
+                    if(!addChecked(predicted, residual, t.position))
+                        return false;
+                    t.step = stepBetween(prev.position, t.position);
+                }
+            }
+            for(uint64_t k = 0; k < survivors; ++k)
+            {
+                int64_t dvx, dvy;
+                if(!getSigned(p, end, dvx) || !getSigned(p, end, dvy) ||
+                   !addChecked(updated[k].vx, dvx, updated[k].vx) ||
+                   !addChecked(updated[k].vy, dvy, updated[k].vy))
+                    return false;
+            }
+
+            // Merge survivors and arrivals back into id order
+            m_nextIds.reserve(survivors + addedCount);
+            m_next.reserve(survivors + addedCount);
+            std::size_t a = 0;
+            for(uint64_t k = 0; k <= survivors; ++k)
+            {
+                const uint64_t sid = k < survivors ? m_ids[survivorIndex[k]] : UINT64_MAX;
+                while(a < addedCount && addedIds[a] < sid)
+                {
+                    m_nextIds.push_back(addedIds[a]);
+                    m_next.push_back(added[a++]);
+                }
+                if(k < survivors)
+                {
+                    m_nextIds.push_back(sid);
+                    m_next.push_back(updated[k]);
+                }
+            }
+
+            uint64_t size, changed;
+            if(!getVarint(p, end, size) || size > kMaxCount)
+                return false;
+            if(size != m_congestion.size())
+            {
+                if(static_cast<uint64_t>(end - p) < size)
+                    return false;
+                m_congestion.assign(p, p + size);
+                p += size;
+            }
+            else
+            {
+                if(!getVarint(p, end, changed) || changed > size)
+                    return false;
+                uint64_t index = 0;
+                for(uint64_t k = 0; k < changed; ++k)
+                {
+                    uint64_t delta;
+                    if(!getVarint(p, end, delta) || p >= end)
+                        return false;
+                    index += delta;
+                    if(index >= size)
+                        return false;
+                    m_congestion[index] = *p++;
+                }
+            }
+        }
+
+        // Materialise the state
+        state.tick = tick;
+        state.time = time;
+        state.vehicles.resize(m_next.size());
+        for(std::size_t k = 0; k < m_next.size(); ++k)
+        {
+            const Track& t = m_next[k];
+            Vehicle& v = state.vehicles[k];
+            v.id = m_nextIds[k];
+            v.segmentId = t.segment;
+            v.position = t.position / kPositionScale;
+            v.vel = glm::vec2(t.vx / kVelocityScale, t.vy / kVelocityScale);
+            v.acc = glm::vec2(0.0f, 0.0f);
+            v.length = t.length;
+            v.width = t.width;
+            v.type = m_types[t.type];
+        }
+        state.congestion.resize(m_congestion.size());
+        for(std::size_t k = 0; k < m_congestion.size(); ++k)
+            state.congestion[k] = m_congestion[k] / kCongestionScale;
+        state.x.clear();
+        state.y.clear();
+
+        m_ids.swap(m_nextIds);
+        m_tracks.swap(m_next);
+        m_tick = tick;
+        m_valid = true;
+        data = p;
+        return true;
+    }
+
+} // namespace tfv
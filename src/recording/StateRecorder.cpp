@@ -0,0 +1,286 @@
+#include "recording/StateRecorder.hpp"
+#include "utils/LoggingManager.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#ifdef TFV_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace tfv
+{
+    namespace statelog
+    {
+        namespace
+        {
+            void putLE(uint8_t* out, uint64_t v, int bytes)
+            {
+                for(int i = 0; i < bytes; ++i)
+                    out[i] = static_cast<uint8_t>(v >> (8 * i));
+            }
+
+            uint64_t getLE(const uint8_t* in, int bytes)
+            {
+                uint64_t v = 0;
+                for(int i = 0; i < bytes; ++i)
+                    v |= static_cast<uint64_t>(in[i]) << (8 * i);
+                return v;
+            }
+        } // namespace
+
+        void writeBlockHeader(const BlockHeader& header, uint8_t* out)
+        {
+            putLE(out, header.firstTick, 8);
+            putLE(out + 8, header.lastTick, 8);
+            putLE(out + 16, std::bit_cast<uint64_t>(header.firstTime), 8);
+            putLE(out + 24, std::bit_cast<uint64_t>(header.lastTime), 8);
+            putLE(out + 32, header.stateCount, 4);
+            putLE(out + 36, header.rawSize, 4);
+            putLE(out + 40, header.storedSize, 4);
+            putLE(out + 44, static_cast<uint8_t>(header.codec), 4); // Codec plus 3 reserved
+        }
+
+        bool readBlockHeader(const uint8_t* in, BlockHeader& header)
+        {
+            header.firstTick = getLE(in, 8);
+            header.lastTick = getLE(in + 8, 8);
+            header.firstTime = std::bit_cast<double>(getLE(in + 16, 8));
+            header.lastTime = std::bit_cast<double>(getLE(in + 24, 8));
+            header.stateCount = static_cast<uint32_t>(getLE(in + 32, 4));
+            header.rawSize = static_cast<uint32_t>(getLE(in + 36, 4));
+            header.storedSize = static_cast<uint32_t>(getLE(in + 40, 4));
+            const uint8_t codec = in[44];
+            header.codec = static_cast<Codec>(codec);
+
+            return codec <= static_cast<uint8_t>(Codec::ZSTD) && header.stateCount > 0 &&
+                   header.firstTick <= header.lastTick &&
+                   (header.codec != Codec::RAW || header.storedSize == header.rawSize);
+        }
+
+        bool zstdAvailable()
+        {
+#ifdef TFV_HAS_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        bool unpackBlock(const BlockHeader& header, const uint8_t* payload,
+                         std::vector<uint8_t>& raw)
+        {
+            raw.resize(header.rawSize);
+            if(header.codec == Codec::RAW)
+            {
+                std::memcpy(raw.data(), payload, header.rawSize);
+                return true;
+            }
+#ifdef TFV_HAS_ZSTD
+            const std::size_t size =
+                ZSTD_decompress(raw.data(), raw.size(), payload, header.storedSize);
+            return !ZSTD_isError(size) && size == header.rawSize;
+#else
+            LOG_ERROR("State log block is zstd-compressed but zstd support is not built in");
+            return false;
+#endif
+        }
+    } // namespace statelog
+
+    StateRecorder::~StateRecorder()
+    {
+        stop();
+    }
+
+    bool StateRecorder::start(const std::string& path, const StateRecorderOptions& options)
+    {
+        if(m_recording)
+            return false;
+
+        m_file = std::fopen(path.c_str(), "wb");
+        if(!m_file)
+        {
+            LOG_ERROR("Failed to create state log {file}", PARAM(file, path));
+            return false;
+        }
+
+        uint8_t header[statelog::kFileHeaderSize] = {};
+        std::memcpy(header, statelog::kMagic, sizeof(statelog::kMagic));
+        header[8] = static_cast<uint8_t>(statelog::kVersion);
+        if(std::fwrite(header, 1, sizeof(header), m_file) != sizeof(header))
+        {
+            LOG_ERROR("Failed to write state log {file}", PARAM(file, path));
+            std::fclose(m_file);
+            m_file = nullptr;
+            return false;
+        }
+
+        m_options = options;
+        m_options.keyframeInterval = std::max<uint32_t>(m_options.keyframeInterval, 1);
+        m_options.queueCapacity = std::max<std::size_t>(m_options.queueCapacity, 1);
+        if(m_options.compressionLevel > 0 && !statelog::zstdAvailable())
+        {
+            LOG_INFO("State log blocks are stored uncompressed (built without zstd)");
+            m_options.compressionLevel = 0;
+        }
+
+        m_encoder.reset();
+        m_block.clear();
+        m_header = {};
+        m_failed = false;
+        {
+            std::scoped_lock lock(m_mutex);
+            m_queue.clear();
+            m_closing = false;
+            m_stats = {};
+            m_stats.storedBytes = statelog::kFileHeaderSize;
+        }
+
+        m_recording = true;
+        m_thread = std::thread(&StateRecorder::run, this);
+        LOG_INFO("Recording simulation states to {file}", PARAM(file, path));
+        return true;
+    }
+
+    void StateRecorder::record(SimulationStatePtr state)
+    {
+        if(!m_recording || !state)
+            return;
+
+        {
+            std::scoped_lock lock(m_mutex);
+            if(m_closing)
+                return;
+            // Deltas are taken against the last state written, so a drop only costs that tick
+            if(m_queue.size() >= m_options.queueCapacity)
+            {
+                ++m_stats.dropped;
+                return;
+            }
+            m_queue.push_back(std::move(state));
+        }
+        m_cv.notify_one();
+    }
+
+    bool StateRecorder::stop()
+    {
+        if(!m_recording)
+            return false;
+
+        {
+            std::scoped_lock lock(m_mutex);
+            m_closing = true;
+        }
+        m_cv.notify_one();
+        if(m_thread.joinable())
+            m_thread.join();
+
+        const bool ok = std::fclose(m_file) == 0 && !m_failed;
+        m_file = nullptr;
+        m_recording = false;
+
+        const StateRecorderStats s = stats();
+        LOG_INFO("State log closed: {states} states in {blocks} blocks, {raw} bytes encoded, "
+                 "{stored} bytes written, {dropped} dropped",
+                 PARAM(states, s.recorded), PARAM(blocks, s.blocks), PARAM(raw, s.rawBytes),
+                 PARAM(stored, s.storedBytes), PARAM(dropped, s.dropped));
+        return ok;
+    }
+
+    StateRecorderStats StateRecorder::stats() const
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_stats;
+    }
+
+    void StateRecorder::run()
+    {
+        while(true)
+        {
+            SimulationStatePtr state;
+            {
+                std::unique_lock lock(m_mutex);
+                m_cv.wait(lock, [&] { return !m_queue.empty() || m_closing; });
+                if(m_queue.empty())
+                    break; // Closing and drained
+                state = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            // Each block opens with a keyframe so it can be decoded on its own
+            if(m_header.stateCount == 0)
+            {
+                m_encoder.reset();
+                m_header.firstTick = state->tick;
+                m_header.firstTime = state->time;
+            }
+            m_encoder.encode(*state, m_block);
+            m_header.lastTick = state->tick;
+            m_header.lastTime = state->time;
+            ++m_header.stateCount;
+            state.reset();
+
+            {
+                std::scoped_lock lock(m_mutex);
+                ++m_stats.recorded;
+            }
+
+            if(m_header.stateCount >= m_options.keyframeInterval ||
+               m_block.size() >= m_options.blockBytes)
+                flushBlock();
+        }
+        flushBlock();
+    }
+
+    bool StateRecorder::flushBlock()
+    {
+        if(m_header.stateCount == 0)
+            return true;
+
+        m_header.rawSize = static_cast<uint32_t>(m_block.size());
+        m_header.codec = statelog::Codec::RAW;
+        const uint8_t* payload = m_block.data();
+        std::size_t payloadSize = m_block.size();
+
+#ifdef TFV_HAS_ZSTD
+        if(m_options.compressionLevel > 0)
+        {
+            m_packed.resize(ZSTD_compressBound(m_block.size()));
+            const std::size_t packed = ZSTD_compress(m_packed.data(), m_packed.size(),
+                                                     m_block.data(), m_block.size(),
+                                                     m_options.compressionLevel);
+            // Keep the raw payload if compression failed or did not help
+            if(!ZSTD_isError(packed) && packed < m_block.size())
+            {
+                m_header.codec = statelog::Codec::ZSTD;
+                payload = m_packed.data();
+                payloadSize = packed;
+            }
+        }
+#endif
+        m_header.storedSize = static_cast<uint32_t>(payloadSize);
+
+        uint8_t header[statelog::kBlockHeaderSize];
+        statelog::writeBlockHeader(m_header, header);
+        if(!m_failed && (std::fwrite(header, 1, sizeof(header), m_file) != sizeof(header) ||
+                         std::fwrite(payload, 1, payloadSize, m_file) != payloadSize))
+        {
+            LOG_ERROR("State log write failed; the rest of the recording is discarded");
+            m_failed = true;
+        }
+
+        if(!m_failed)
+        {
+            std::scoped_lock lock(m_mutex);
+            ++m_stats.blocks;
+            m_stats.rawBytes += m_block.size();
+            m_stats.storedBytes += sizeof(header) + payloadSize;
+        }
+
+        m_block.clear();
+        m_header = {};
+        return !m_failed;
+    }
+
+} // namespace tfv
@@ -0,0 +1,409 @@
+#include "recording/VideoWriter.hpp"
+#include "utils/LoggingManager.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TFV_YUV_SSE2 1
+#endif
+
+#ifndef _WIN32
+#include <csignal>
+#include <ctime>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace tfv
+{
+    namespace
+    {
+        // BT.601 limited range in 8.8 fixed point; the SSE2 path uses the same integers
+        inline uint8_t luma(int r, int g, int b)
+        {
+            return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+        inline uint8_t chromaU(int r, int g, int b)
+        {
+            return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        }
+        inline uint8_t chromaV(int r, int g, int b)
+        {
+            return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+
+        inline int red(uint32_t p) { return (p >> 16) & 0xFF; }
+        inline int green(uint32_t p) { return (p >> 8) & 0xFF; }
+        inline int blue(uint32_t p) { return p & 0xFF; }
+
+        // Scalar conversion of columns [x, width) for one pair of rows (row1 may equal row0)
+        void convertTail(const uint32_t* row0, const uint32_t* row1, int x, int width,
+                         bool lumaRow1, uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v)
+        {
+            for(int i = x; i < width; ++i)
+            {
+                y0[i] = luma(red(row0[i]), green(row0[i]), blue(row0[i]));
+                if(lumaRow1)
+                    y1[i] = luma(red(row1[i]), green(row1[i]), blue(row1[i]));
+            }
+            for(int i = x; i < width; i += 2)
+            {
+                const int j = std::min(i + 1, width - 1);
+                const uint32_t p[4] = {row0[i], row0[j], row1[i], row1[j]};
+                int r = 2, g = 2, b = 2; // Rounds the average
+                for(uint32_t px : p)
+                {
+                    r += red(px);
+                    g += green(px);
+                    b += blue(px);
+                }
+                u[i / 2] = chromaU(r >> 2, g >> 2, b >> 2);
+                v[i / 2] = chromaV(r >> 2, g >> 2, b >> 2);
+            }
+        }
+
+#ifdef TFV_YUV_SSE2
+        // Sum adjacent 32-bit pairs of two madd results: four outputs for four pixels/blocks
+        inline __m128i pairSums(__m128i lo, __m128i hi)
+        {
+            const __m128 a = _mm_castsi128_ps(lo);
+            const __m128 b = _mm_castsi128_ps(hi);
+            const __m128i even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            return _mm_add_epi32(even, odd);
+        }
+
+        // Weighted B, G, R sum (+128) >> 8 + bias for four pixels or blocks in 16-bit BGRA
+        inline __m128i weigh(__m128i lo, __m128i hi, __m128i coef, __m128i bias)
+        {
+            const __m128i sum =
+                pairSums(_mm_madd_epi16(lo, coef), _mm_madd_epi16(hi, coef));
+            return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(128)), 8),
+                                 bias);
+        }
+
+        // Y for four ARGB8888 pixels, as 32-bit lanes
+        inline __m128i lumaX4(__m128i px)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i coef = _mm_setr_epi16(25, 129, 66, 0, 25, 129, 66, 0);
+            return weigh(_mm_unpacklo_epi8(px, zero), _mm_unpackhi_epi8(px, zero), coef,
+                         _mm_set1_epi32(16));
+        }
+
+        // Rounded 2x2 averages for four columns of two rows: two blocks of 16-bit BGRA
+        inline __m128i blockAverages(__m128i top, __m128i bottom)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero),
+                                       _mm_unpacklo_epi8(bottom, zero));
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero),
+                                       _mm_unpackhi_epi8(bottom, zero));
+            lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+            const __m128i sums = _mm_unpacklo_epi64(lo, hi);
+            return _mm_srli_epi16(_mm_add_epi16(sums, _mm_set1_epi16(2)), 2);
+        }
+
+        inline void store8(uint8_t* dst, __m128i a, __m128i b)
+        {
+            const __m128i words = _mm_packs_epi32(a, b);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(words, words));
+        }
+
+        inline void store4(uint8_t* dst, __m128i a)
+        {
+            const __m128i words = _mm_packs_epi32(a, a);
+            const int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+            std::memcpy(dst, &bytes, 4);
+        }
+
+        // 8 columns of a row pair: 8 Y per row, 4 U and 4 V; returns the columns converted
+        int convertSSE2(const uint32_t* row0, const uint32_t* row1, int width, bool lumaRow1,
+                        uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v)
+        {
+            const __m128i coefU = _mm_setr_epi16(112, -74, -38, 0, 112, -74, -38, 0);
+            const __m128i coefV = _mm_setr_epi16(-18, -94, 112, 0, -18, -94, 112, 0);
+            const __m128i bias = _mm_set1_epi32(128);
+
+            int x = 0;
+            for(; x + 8 <= width; x += 8)
+            {
+                const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x));
+                const __m128i b0 =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x + 4));
+                const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x));
+                const __m128i b1 =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x + 4));
+
+                store8(y0 + x, lumaX4(a0), lumaX4(b0));
+                if(lumaRow1)
+                    store8(y1 + x, lumaX4(a1), lumaX4(b1));
+
+                const __m128i avgA = blockAverages(a0, a1);
+                const __m128i avgB = blockAverages(b0, b1);
+                store4(u + x / 2, weigh(avgA, avgB, coefU, bias));
+                store4(v + x / 2, weigh(avgA, avgB, coefV, bias));
+            }
+            return x;
+        }
+#endif
+
+        // Quote a path for the shell that popen() runs
+        std::string shellQuote(const std::string& s)
+        {
+#ifdef _WIN32
+            return "\"" + s + "\"";
+#else
+            std::string quoted = "'";
+            for(char c : s)
+            {
+                if(c == '\'')
+                    quoted += "'\\''";
+                else
+                    quoted += c;
+            }
+            return quoted + "'";
+#endif
+        }
+#ifndef _WIN32
+        /**
+         * Blocks SIGPIPE on the calling thread while it writes to the encoder pipe, so a dying
+         * encoder fails the write with EPIPE instead of killing the app. A SIGPIPE raised in
+         * the meantime is consumed before the mask is restored; other threads and the
+         * process-wide disposition are left alone.
+         */
+        class PipeSignalGuard
+        {
+          public:
+            explicit PipeSignalGuard(bool active)
+            {
+                if(!active)
+                    return;
+                sigemptyset(&m_pipe);
+                sigaddset(&m_pipe, SIGPIPE);
+                sigset_t pending;
+                sigpending(&pending);
+                m_wasPending = sigismember(&pending, SIGPIPE) == 1;
+                m_active = pthread_sigmask(SIG_BLOCK, &m_pipe, &m_previous) == 0;
+            }
+
+            ~PipeSignalGuard()
+            {
+                if(!m_active)
+                    return;
+                if(!m_wasPending)
+                {
+                    sigset_t pending;
+                    sigpending(&pending);
+                    if(sigismember(&pending, SIGPIPE) == 1)
+                    {
+                        const timespec now{0, 0};
+                        sigtimedwait(&m_pipe, nullptr, &now);
+                    }
+                }
+                pthread_sigmask(SIG_SETMASK, &m_previous, nullptr);
+            }
+
+            PipeSignalGuard(const PipeSignalGuard&) = delete;
+            PipeSignalGuard& operator=(const PipeSignalGuard&) = delete;
+
+          private:
+            sigset_t m_pipe{};
+            sigset_t m_previous{};
+            bool m_wasPending{false};
+            bool m_active{false};
+        };
+#endif
+
+    } // namespace
+
+    void rgbToYuv420(const Frame& frame, uint8_t* y, uint8_t* u, uint8_t* v)
+    {
+        const int width = frame.width;
+        const int height = frame.height;
+        const int chromaWidth = (width + 1) / 2;
+
+        for(int row = 0; row < height; row += 2)
+        {
+            // Odd height: the last row pairs with itself for chroma and has no second luma row
+            const bool lumaRow1 = row + 1 < height;
+            const uint32_t* row0 = frame.pixels.data() + static_cast<std::size_t>(row) * width;
+            const uint32_t* row1 = lumaRow1 ? row0 + width : row0;
+            uint8_t* y0 = y + static_cast<std::size_t>(row) * width;
+            uint8_t* y1 = lumaRow1 ? y0 + width : y0;
+            uint8_t* uRow = u + static_cast<std::size_t>(row / 2) * chromaWidth;
+            uint8_t* vRow = v + static_cast<std::size_t>(row / 2) * chromaWidth;
+
+            int x = 0;
+#ifdef TFV_YUV_SSE2
+            x = convertSSE2(row0, row1, width, lumaRow1, y0, y1, uRow, vRow);
+#endif
+            convertTail(row0, row1, x, width, lumaRow1, y0, y1, uRow, vRow);
+        }
+    }
+
+    bool encodeY4mFrame(const Frame& frame, std::vector<uint8_t>& out)
+    {
+        static constexpr char kFrameTag[] = "FRAME\n";
+        constexpr std::size_t tagSize = sizeof(kFrameTag) - 1;
+
+        const std::size_t lumaSize = static_cast<std::size_t>(frame.width) * frame.height;
+        const std::size_t chromaSize =
+            static_cast<std::size_t>((frame.width + 1) / 2) * ((frame.height + 1) / 2);
+        if(lumaSize == 0 || frame.pixels.size() < lumaSize)
+            return false;
+
+        out.resize(tagSize + lumaSize + 2 * chromaSize);
+        std::memcpy(out.data(), kFrameTag, tagSize);
+        uint8_t* y = out.data() + tagSize;
+        rgbToYuv420(frame, y, y + lumaSize, y + lumaSize + chromaSize);
+        return true;
+    }
+
+    VideoWriter::~VideoWriter()
+    {
+        close();
+    }
+
+    bool VideoWriter::encoderAvailable()
+    {
+        const char* path = std::getenv("PATH");
+        if(!path)
+            return false;
+
+#ifdef _WIN32
+        const char separator = ';';
+        const char* name = "ffmpeg.exe";
+#else
+        const char separator = ':';
+        const char* name = "ffmpeg";
+#endif
+        std::string dirs = path;
+        std::size_t start = 0;
+        while(start <= dirs.size())
+        {
+            std::size_t end = dirs.find(separator, start);
+            if(end == std::string::npos)
+                end = dirs.size();
+            if(end > start)
+            {
+                std::error_code ec;
+                const auto candidate =
+                    std::filesystem::path(dirs.substr(start, end - start)) / name;
+#ifdef _WIN32
+                if(std::filesystem::is_regular_file(candidate, ec))
+                    return true;
+#else
+                // popen() runs it through the shell, which needs the execute bit
+                if(std::filesystem::is_regular_file(candidate, ec) &&
+                   access(candidate.c_str(), X_OK) == 0)
+                    return true;
+#endif
+            }
+            start = end + 1;
+        }
+        return false;
+    }
+
+    bool VideoWriter::openFile(const std::string& path, int width, int height, int fps)
+    {
+        close();
+        m_file = std::fopen(path.c_str(), "wb");
+        if(!m_file)
+        {
+            LOG_ERROR("Failed to create {file}", PARAM(file, path));
+            return false;
+        }
+        m_pipe = false;
+        return writeHeader(width, height, fps);
+    }
+
+    bool VideoWriter::openPipe(const std::string& path, int width, int height, int fps)
+    {
+        close();
+#ifdef _WIN32
+        const std::string ffmpeg = "ffmpeg";
+#else
+        // exec replaces the shell so pclose() reports ffmpeg's own exit status; SIGPIPE from
+        // a dying encoder is blocked around each write instead (see PipeSignalGuard)
+        const std::string ffmpeg = "exec ffmpeg";
+#endif
+        // libx264 needs even dimensions: pad odd window sizes by one pixel
+        const std::string command = ffmpeg +
+                                    " -hide_banner -loglevel error -y -f yuv4mpegpipe -i -"
+                                    " -vf " + shellQuote("pad=ceil(iw/2)*2:ceil(ih/2)*2") +
+                                    " -c:v libx264 -preset veryfast -pix_fmt yuv420p " +
+                                    shellQuote(path);
+#ifdef _WIN32
+        m_file = _popen(command.c_str(), "wb");
+#else
+        m_file = popen(command.c_str(), "w");
+#endif
+        if(!m_file)
+        {
+            LOG_ERROR("Failed to start the video encoder for {file}", PARAM(file, path));
+            return false;
+        }
+        m_pipe = true;
+        return writeHeader(width, height, fps);
+    }
+
+    bool VideoWriter::writeHeader(int width, int height, int fps)
+    {
+        // C420jpeg: 4:2:0 with centre-sited chroma, which is what the 2x2 average produces
+        char header[128];
+        const int size = std::snprintf(header, sizeof(header),
+                                       "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg "
+                                       "XCOLORRANGE=LIMITED\n",
+                                       width, height, std::max(fps, 1));
+        return write({reinterpret_cast<const uint8_t*>(header), static_cast<std::size_t>(size)});
+    }
+
+    bool VideoWriter::write(std::span<const uint8_t> bytes)
+    {
+        if(!m_file || m_failed)
+            return false;
+#ifndef _WIN32
+        PipeSignalGuard guard(m_pipe);
+#endif
+        if(std::fwrite(bytes.data(), 1, bytes.size(), m_file) != bytes.size())
+        {
+            LOG_ERROR("Video stream write failed; the rest of the recording is discarded");
+            m_failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool VideoWriter::close()
+    {
+        if(!m_file)
+            return false;
+
+        bool ok = !m_failed;
+        if(m_pipe)
+        {
+#ifdef _WIN32
+            ok = _pclose(m_file) == 0 && ok;
+#else
+            PipeSignalGuard guard(true); // pclose() flushes what is still buffered
+            ok = pclose(m_file) == 0 && ok;
+#endif
+        }
+        else
+        {
+            ok = std::fclose(m_file) == 0 && ok;
+        }
+
+        m_file = nullptr;
+        m_pipe = false;
+        m_failed = false;
+        return ok;
+    }
+
+} // namespace tfv
@@ -0,0 +1,129 @@
+#include "rendering/Camera.hpp"
+
+#include <algorithm>
+
+namespace tfv
+{
+    void ViewTransform::apply(const float* __restrict x, const float* __restrict y,
+                              std::size_t count, float* __restrict outX,
+                              float* __restrict outY) const
+    {
+        const float px = pivotX, py = pivotY;
+        const float m00 = a, m01 = b, m10 = c, m11 = d, ox = tx, oy = ty;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const float dx = x[i] - px, dy = y[i] - py;
+            outX[i] = m00 * dx + m01 * dy + ox;
+            outY[i] = m10 * dx + m11 * dy + oy;
+        }
+    }
+
+    bool clipToViewport(float& x1, float& y1, float& x2, float& y2, int width, int height,
+                        float margin)
+    {
+        // Double internally: end points can be ~1e9 pixels out at deep zoom
+        const double minX = -margin, minY = -margin;
+        const double maxX = width + margin, maxY = height + margin;
+        const double ox = x1, oy = y1;
+        const double dx = x2 - ox, dy = y2 - oy;
+
+        // Parametric clip: t0/t1 bound the visible part of (x1, y1) + t * (dx, dy)
+        double t0 = 0.0, t1 = 1.0;
+        auto edge = [&](double p, double q)
+        {
+            if(p == 0.0)
+                return q >= 0.0; // Parallel: inside or out entirely
+            const double r = q / p;
+            if(p < 0.0)
+                t0 = std::max(t0, r);
+            else
+                t1 = std::min(t1, r);
+            return t0 <= t1;
+        };
+        if(!edge(-dx, ox - minX) || !edge(dx, maxX - ox) || !edge(-dy, oy - minY) ||
+           !edge(dy, maxY - oy))
+            return false;
+
+        if(t1 < 1.0)
+        {
+            x2 = static_cast<float>(ox + t1 * dx);
+            y2 = static_cast<float>(oy + t1 * dy);
+        }
+        if(t0 > 0.0)
+        {
+            x1 = static_cast<float>(ox + t0 * dx);
+            y1 = static_cast<float>(oy + t0 * dy);
+        }
+        return true;
+    }
+
+    void Camera::setViewport(int width, int height)
+    {
+        m_width = std::max(width, 0);
+        m_height = std::max(height, 0);
+    }
+
+    void Camera::setZoom(double zoom)
+    {
+        m_zoom = std::clamp(zoom, kMinZoom, kMaxZoom);
+    }
+
+    void Camera::pan(double dx, double dy)
+    {
+        m_center.x -= dx / m_zoom;
+        m_center.y -= dy / m_zoom;
+    }
+
+    void Camera::zoomAt(double factor, double screenX, double screenY)
+    {
+        const glm::dvec2 anchor = screenToWorld({screenX, screenY});
+        setZoom(m_zoom * factor);
+
+        // Shift so the anchor maps back to the same pixel
+        const glm::dvec2 moved = worldToScreen(anchor);
+        pan(screenX - moved.x, screenY - moved.y);
+    }
+
+    void Camera::fit(double minX, double minY, double maxX, double maxY, double margin)
+    {
+        m_center = {(minX + maxX) * 0.5, (minY + maxY) * 0.5};
+        const double w = std::max(m_width - 2.0 * margin, 1.0);
+        const double h = std::max(m_height - 2.0 * margin, 1.0);
+        const double extentX = std::max(maxX - minX, 1e-9);
+        const double extentY = std::max(maxY - minY, 1e-9);
+        setZoom(std::min(w / extentX, h / extentY));
+    }
+
+    glm::dvec2 Camera::worldToScreen(glm::dvec2 world) const
+    {
+        return (world - m_center) * m_zoom + glm::dvec2(m_width, m_height) * 0.5;
+    }
+
+    glm::dvec2 Camera::screenToWorld(glm::dvec2 screen) const
+    {
+        return (screen - glm::dvec2(m_width, m_height) * 0.5) / m_zoom + m_center;
+    }
+
+    void Camera::visibleBounds(double& minX, double& minY, double& maxX, double& maxY) const
+    {
+        const glm::dvec2 lo = screenToWorld({0.0, 0.0});
+        const glm::dvec2 hi = screenToWorld({static_cast<double>(m_width), m_height});
+        minX = lo.x;
+        minY = lo.y;
+        maxX = hi.x;
+        maxY = hi.y;
+    }
+
+    ViewTransform Camera::transform(double originX, double originY) const
+    {
+        // Only the camera-to-origin offset is rounded to float, once per frame
+        ViewTransform t;
+        t.pivotX = static_cast<float>(m_center.x - originX);
+        t.pivotY = static_cast<float>(m_center.y - originY);
+        t.a = t.d = static_cast<float>(m_zoom);
+        t.tx = static_cast<float>(m_width * 0.5);
+        t.ty = static_cast<float>(m_height * 0.5);
+        return t;
+    }
+
+} // namespace tfv
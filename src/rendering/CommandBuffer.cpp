@@ -0,0 +1,241 @@
+#include "rendering/CommandBuffer.hpp"
+
+#include <cstring>
+
+namespace tfv
+{
+    void CommandBuffer::clear()
+    {
+        m_commands.clear();
+        m_coords.clear();
+        m_text.clear();
+        m_pixels.clear();
+        m_quads.clear();
+        m_callbacks.clear();
+    }
+
+    Command& CommandBuffer::push(CommandType type)
+    {
+        Command& cmd = m_commands.emplace_back();
+        cmd = Command{};
+        cmd.type = type;
+        cmd.r = m_r;
+        cmd.g = m_g;
+        cmd.b = m_b;
+        cmd.a = m_a;
+        return cmd;
+    }
+
+    Command& CommandBuffer::batch(CommandType type, int width)
+    {
+        if(!m_commands.empty())
+        {
+            Command& last = m_commands.back();
+            if(last.type == type && last.w == width && last.r == m_r && last.g == m_g &&
+               last.b == m_b && last.a == m_a)
+            {
+                ++last.count;
+                return last;
+            }
+        }
+
+        Command& cmd = push(type);
+        cmd.w = width;
+        cmd.offset = static_cast<uint32_t>(m_coords.size());
+        cmd.count = 1;
+        return cmd;
+    }
+
+    void CommandBuffer::setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        m_r = r;
+        m_g = g;
+        m_b = b;
+        m_a = a;
+    }
+
+    void CommandBuffer::clearTarget(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        Command& cmd = push(CommandType::CLEAR);
+        cmd.r = r;
+        cmd.g = g;
+        cmd.b = b;
+        cmd.a = a;
+    }
+
+    void CommandBuffer::line(int x1, int y1, int x2, int y2, int width)
+    {
+        batch(CommandType::LINES, width);
+        m_coords.insert(m_coords.end(), {x1, y1, x2, y2});
+    }
+
+    void CommandBuffer::point(int x, int y)
+    {
+        batch(CommandType::POINTS, 0);
+        m_coords.insert(m_coords.end(), {x, y});
+    }
+
+    void CommandBuffer::rect(int x, int y, int w, int h, bool filled)
+    {
+        batch(filled ? CommandType::FILL_RECTS : CommandType::DRAW_RECTS, 0);
+        m_coords.insert(m_coords.end(), {x, y, w, h});
+    }
+
+    void CommandBuffer::text(std::string_view text, int x, int y)
+    {
+        Command& cmd = push(CommandType::TEXT);
+        cmd.x = x;
+        cmd.y = y;
+        cmd.offset = static_cast<uint32_t>(m_text.size());
+        cmd.count = static_cast<uint32_t>(text.size());
+        m_text.insert(m_text.end(), text.begin(), text.end());
+    }
+
+    void CommandBuffer::createTexture(TextureHandle texture, int width, int height)
+    {
+        Command& cmd = push(CommandType::CREATE_TEXTURE);
+        cmd.texture = texture;
+        cmd.w = width;
+        cmd.h = height;
+    }
+
+    void CommandBuffer::updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch,
+                                      int width, int height)
+    {
+        Command& cmd = push(CommandType::UPDATE_TEXTURE);
+        cmd.texture = texture;
+        cmd.w = width;
+        cmd.h = height;
+        cmd.offset = static_cast<uint32_t>(m_pixels.size());
+        cmd.count = static_cast<uint32_t>(width * height);
+
+        // Copy now: the caller may overwrite its buffer before the frame is replayed
+        m_pixels.resize(m_pixels.size() + cmd.count);
+        uint32_t* dst = m_pixels.data() + cmd.offset;
+        for(int row = 0; row < height; ++row)
+        {
+            std::memcpy(dst + static_cast<std::size_t>(row) * width,
+                        reinterpret_cast<const uint8_t*>(pixels) + row * pitch,
+                        width * sizeof(uint32_t));
+        }
+    }
+
+    void CommandBuffer::drawTexture(TextureHandle texture, int x, int y, int w, int h)
+    {
+        Command& cmd = push(CommandType::DRAW_TEXTURE);
+        cmd.texture = texture;
+        cmd.x = x;
+        cmd.y = y;
+        cmd.w = w;
+        cmd.h = h;
+    }
+
+    void CommandBuffer::textureQuads(TextureHandle texture, std::span<const TexturedQuad> quads)
+    {
+        if(quads.empty())
+            return;
+
+        // Runs from the same texture back to back (e.g. one label after another) become one draw
+        if(m_commands.empty() || m_commands.back().type != CommandType::TEXTURE_QUADS ||
+           m_commands.back().texture != texture)
+        {
+            Command& cmd = push(CommandType::TEXTURE_QUADS);
+            cmd.texture = texture;
+            cmd.offset = static_cast<uint32_t>(m_quads.size());
+        }
+        m_commands.back().count += static_cast<uint32_t>(quads.size());
+        m_quads.insert(m_quads.end(), quads.begin(), quads.end());
+    }
+
+    void CommandBuffer::destroyTexture(TextureHandle texture)
+    {
+        Command& cmd = push(CommandType::DESTROY_TEXTURE);
+        cmd.texture = texture;
+    }
+
+    void CommandBuffer::setAntiAliasing(bool enable)
+    {
+        Command& cmd = push(CommandType::SET_ANTI_ALIASING);
+        cmd.x = enable ? 1 : 0;
+    }
+
+    void CommandBuffer::callback(RenderCallback fn, void* user)
+    {
+        Command& cmd = push(CommandType::CALLBACK);
+        cmd.offset = static_cast<uint32_t>(m_callbacks.size());
+        m_callbacks.push_back({fn, user});
+    }
+
+    void CommandBuffer::replay(Renderer& target, TextureMap& textures) const
+    {
+        auto backendTexture = [&](TextureHandle handle)
+        {
+            auto it = textures.find(handle);
+            return it != textures.end() ? it->second : TextureHandle{0};
+        };
+
+        for(const Command& cmd : m_commands)
+        {
+            // Batch payload (LINES..DRAW_RECTS)
+            const int32_t* c =
+                cmd.type <= CommandType::DRAW_RECTS ? m_coords.data() + cmd.offset : nullptr;
+            if(cmd.type != CommandType::CLEAR)
+                target.setColor(cmd.r, cmd.g, cmd.b, cmd.a);
+
+            switch(cmd.type)
+            {
+            case CommandType::CLEAR:
+                target.clear(cmd.r, cmd.g, cmd.b, cmd.a);
+                break;
+            case CommandType::LINES:
+                for(uint32_t i = 0; i < cmd.count; ++i, c += 4)
+                    target.drawLine(c[0], c[1], c[2], c[3], cmd.w);
+                break;
+            case CommandType::POINTS:
+                for(uint32_t i = 0; i < cmd.count; ++i, c += 2)
+                    target.drawPoint(c[0], c[1]);
+                break;
+            case CommandType::FILL_RECTS:
+                for(uint32_t i = 0; i < cmd.count; ++i, c += 4)
+                    target.fillRect(c[0], c[1], c[2], c[3]);
+                break;
+            case CommandType::DRAW_RECTS:
+                for(uint32_t i = 0; i < cmd.count; ++i, c += 4)
+                    target.drawRect(c[0], c[1], c[2], c[3]);
+                break;
+            case CommandType::TEXT:
+                target.drawText(std::string(m_text.data() + cmd.offset, cmd.count), cmd.x,
+                                cmd.y);
+                break;
+            case CommandType::CREATE_TEXTURE:
+                textures[cmd.texture] = target.createTexture(cmd.w, cmd.h);
+                break;
+            case CommandType::UPDATE_TEXTURE:
+                target.updateTexture(backendTexture(cmd.texture), m_pixels.data() + cmd.offset,
+                                     cmd.w * static_cast<int>(sizeof(uint32_t)));
+                break;
+            case CommandType::DRAW_TEXTURE:
+                target.drawTexture(backendTexture(cmd.texture), cmd.x, cmd.y, cmd.w, cmd.h);
+                break;
+            case CommandType::TEXTURE_QUADS:
+                target.drawTextureQuads(backendTexture(cmd.texture),
+                                        {m_quads.data() + cmd.offset, cmd.count});
+                break;
+            case CommandType::DESTROY_TEXTURE:
+                target.destroyTexture(backendTexture(cmd.texture));
+                textures.erase(cmd.texture);
+                break;
+            case CommandType::SET_ANTI_ALIASING:
+                target.setAntiAliasing(cmd.x != 0);
+                break;
+            case CommandType::CALLBACK:
+            {
+                const Callback& cb = m_callbacks[cmd.offset];
+                cb.fn(cb.user, &target);
+                break;
+            }
+            }
+        }
+    }
+
+} // namespace tfv
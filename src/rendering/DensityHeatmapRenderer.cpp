@@ -0,0 +1,275 @@
+#include "rendering/DensityHeatmapRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tfv
+{
+    namespace
+    {
+        // Densities below peak / kAlphaRamp fade towards transparent
+        constexpr float kAlphaRamp = 4.0f;
+    } // namespace
+
+    DensityHeatmapRenderer::DensityHeatmapRenderer(Renderer* renderer) : m_renderer(renderer)
+    {
+        rebuildKernel();
+    }
+
+    DensityHeatmapRenderer::~DensityHeatmapRenderer()
+    {
+        if(m_renderer && m_texture)
+            m_renderer->destroyTexture(m_texture);
+    }
+
+    void DensityHeatmapRenderer::setLut(const std::vector<uint32_t>& lut)
+    {
+        m_lut = lut;
+        m_dirty = true;
+    }
+
+    void DensityHeatmapRenderer::setOpacity(float opacity)
+    {
+        m_opacity = std::max(0.0f, std::min(1.0f, opacity));
+        m_dirty = true;
+    }
+
+    void DensityHeatmapRenderer::setKernelSigma(float cells)
+    {
+        m_sigma = std::max(0.5f, cells);
+        rebuildKernel();
+        m_cellSize = 0.f; // padding depends on the kernel: rebuild the grid
+    }
+
+    void DensityHeatmapRenderer::setCellSize(float pixels)
+    {
+        m_cellPixels = std::max(1.0f, pixels);
+    }
+
+    void DensityHeatmapRenderer::rebuildKernel()
+    {
+        const int radius = std::max(1, static_cast<int>(std::ceil(3.0f * m_sigma)));
+        m_kernel.resize(2 * radius + 1);
+        float sum = 0.f;
+        for(int i = -radius; i <= radius; ++i)
+        {
+            float x = static_cast<float>(i) / m_sigma;
+            m_kernel[i + radius] = std::exp(-0.5f * x * x);
+            sum += m_kernel[i + radius];
+        }
+        for(float& w : m_kernel)
+            w /= sum;
+    }
+
+    bool DensityHeatmapRenderer::configureGrid(const RoadNetwork* roadNetwork, float scale)
+    {
+        const SegmentGeometry& g = roadNetwork->geometry();
+
+        // Network bounds only change with the network
+        if(roadNetwork != m_network || g.size() != m_networkSegments)
+        {
+            m_network = roadNetwork;
+            m_networkSegments = g.size();
+            auto [minX1, maxX1] = std::minmax_element(g.x1.begin(), g.x1.end());
+            auto [minX2, maxX2] = std::minmax_element(g.x2.begin(), g.x2.end());
+            auto [minY1, maxY1] = std::minmax_element(g.y1.begin(), g.y1.end());
+            auto [minY2, maxY2] = std::minmax_element(g.y2.begin(), g.y2.end());
+            m_minX = std::min(*minX1, *minX2);
+            m_maxX = std::max(*maxX1, *maxX2);
+            m_minY = std::min(*minY1, *minY2);
+            m_maxY = std::max(*maxY1, *maxY2);
+            m_cellSize = 0.f;
+        }
+
+        // Cell size tracks the zoom in power-of-two steps, capped by the grid size
+        const float extentX = std::max(m_maxX - m_minX, 1.0f);
+        const float extentY = std::max(m_maxY - m_minY, 1.0f);
+        float cell = std::exp2(std::ceil(std::log2(m_cellPixels / std::max(scale, 1e-6f))));
+        while(extentX / cell > kMaxGridDim || extentY / cell > kMaxGridDim)
+            cell *= 2.0f;
+
+        if(cell == m_cellSize)
+            return false;
+
+        // Pad by the kernel radius so the blur does not clip at the network edge
+        const int pad = static_cast<int>(m_kernel.size() / 2) + 1;
+        m_cellSize = cell;
+        m_originX = m_minX - pad * cell;
+        m_originY = m_minY - pad * cell;
+        m_gridW = static_cast<int>(std::ceil(extentX / cell)) + 2 * pad;
+        m_gridH = static_cast<int>(std::ceil(extentY / cell)) + 2 * pad;
+
+        // Start over: every vehicle is re-binned on the next update
+        m_counts.assign(static_cast<std::size_t>(m_gridW) * m_gridH, 0.f);
+        m_ids.clear();
+        m_cells.clear();
+        m_lastTick = ~0ull;
+        return true;
+    }
+
+    void DensityHeatmapRenderer::update(const RoadNetwork* roadNetwork,
+                                        const SimulationState& state, float scale)
+    {
+        if(!roadNetwork || roadNetwork->geometry().size() == 0 || !m_renderer)
+            return;
+
+        configureGrid(roadNetwork, scale);
+        if(state.tick != m_lastTick)
+        {
+            m_lastTick = state.tick;
+            const SegmentGeometry& g = roadNetwork->geometry();
+            const std::size_t n = state.vehicles.size();
+
+            // World position of every vehicle in one batched pass; unknown segments get t < 0
+            m_segIdx.resize(n);
+            m_t.resize(n);
+            m_x.resize(n);
+            m_y.resize(n);
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                const Vehicle& v = state.vehicles[i];
+                uint32_t idx = g.indexOf(v.segmentId);
+                bool valid = idx != SegmentGeometry::kInvalidIndex;
+                m_segIdx[i] = valid ? idx : 0;
+                m_t[i] = valid ? v.position : -1.f;
+            }
+            g.positions(m_segIdx.data(), m_t.data(), n, m_x.data(), m_y.data());
+
+            // Cell per vehicle (-1 if off-grid)
+            const float inv = 1.0f / m_cellSize;
+            m_newIds.resize(n);
+            m_newCells.resize(n);
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                m_newIds[i] = state.vehicles[i].id;
+                int cx = static_cast<int>((m_x[i] - m_originX) * inv);
+                int cy = static_cast<int>((m_y[i] - m_originY) * inv);
+                bool inside = m_t[i] >= 0.f && cx >= 0 && cy >= 0 && cx < m_gridW && cy < m_gridH;
+                m_newCells[i] = inside ? cy * m_gridW + cx : -1;
+            }
+
+            // Both id lists are sorted: only vehicles that appeared, vanished or changed
+            // cell touch the grid
+            auto move = [&](int32_t from, int32_t to)
+            {
+                if(from == to)
+                    return;
+                if(from >= 0)
+                    m_counts[from] -= 1.f;
+                if(to >= 0)
+                    m_counts[to] += 1.f;
+                m_dirty = true;
+            };
+            std::size_t i = 0, j = 0;
+            while(i < m_ids.size() || j < n)
+            {
+                if(j == n || (i < m_ids.size() && m_ids[i] < m_newIds[j]))
+                    move(m_cells[i++], -1);
+                else if(i == m_ids.size() || m_newIds[j] < m_ids[i])
+                    move(-1, m_newCells[j++]);
+                else
+                    move(m_cells[i++], m_newCells[j++]);
+            }
+            m_ids.swap(m_newIds);
+            m_cells.swap(m_newCells);
+        }
+
+        if(m_dirty)
+        {
+            blur();
+            colorize();
+            m_dirty = false;
+        }
+    }
+
+    void DensityHeatmapRenderer::blur()
+    {
+        const int w = m_gridW, h = m_gridH;
+        const int radius = static_cast<int>(m_kernel.size() / 2);
+        const std::size_t cells = static_cast<std::size_t>(w) * h;
+        m_tmp.assign(cells, 0.f);
+        m_density.assign(cells, 0.f);
+
+        // Horizontal pass: kernel tap outermost so the inner loop is a contiguous
+        // multiply-add over the row (vectorises)
+        for(int y = 0; y < h; ++y)
+        {
+            const float* __restrict src = &m_counts[static_cast<std::size_t>(y) * w];
+            float* __restrict dst = &m_tmp[static_cast<std::size_t>(y) * w];
+            for(int k = 0; k < static_cast<int>(m_kernel.size()); ++k)
+            {
+                const float wk = m_kernel[k];
+                const int off = k - radius;
+                const int x0 = std::max(0, -off), x1 = std::min(w, w - off);
+                for(int x = x0; x < x1; ++x)
+                    dst[x] += wk * src[x + off];
+            }
+        }
+
+        // Vertical pass: accumulate whole source rows into each output row
+        for(int y = 0; y < h; ++y)
+        {
+            float* __restrict dst = &m_density[static_cast<std::size_t>(y) * w];
+            for(int k = 0; k < static_cast<int>(m_kernel.size()); ++k)
+            {
+                const int sy = y + k - radius;
+                if(sy < 0 || sy >= h)
+                    continue;
+                const float wk = m_kernel[k];
+                const float* __restrict src = &m_tmp[static_cast<std::size_t>(sy) * w];
+                for(int x = 0; x < w; ++x)
+                    dst[x] += wk * src[x];
+            }
+        }
+    }
+
+    void DensityHeatmapRenderer::colorize()
+    {
+        if(m_lut.empty() || m_density.empty())
+            return;
+
+        // Normalise against the current peak so the ramp always spans the data
+        const float peak = *std::max_element(m_density.begin(), m_density.end());
+        const float inv = peak > 0.f ? 1.0f / peak : 0.f;
+        const float top = static_cast<float>(m_lut.size() - 1);
+        const float alphaScale = m_opacity * 255.0f;
+        const uint32_t* lut = m_lut.data();
+
+        m_pixels.resize(m_density.size());
+        for(std::size_t i = 0; i < m_density.size(); ++i)
+        {
+            const float level = std::min(m_density[i] * inv, 1.0f);
+            const uint32_t rgb = lut[static_cast<uint32_t>(level * top + 0.5f)] & 0x00FFFFFFu;
+            const float a = std::min(level * kAlphaRamp, 1.0f) * alphaScale;
+            m_pixels[i] = (static_cast<uint32_t>(a) << 24) | rgb;
+        }
+
+        // (Re)create the streaming texture when the grid size changes
+        if(!m_texture || m_textureW != m_gridW || m_textureH != m_gridH)
+        {
+            if(m_texture)
+                m_renderer->destroyTexture(m_texture);
+            m_texture = m_renderer->createTexture(m_gridW, m_gridH);
+            m_textureW = m_gridW;
+            m_textureH = m_gridH;
+        }
+        if(m_texture)
+            m_renderer->updateTexture(m_texture, m_pixels.data(),
+                                      m_gridW * static_cast<int>(sizeof(uint32_t)));
+    }
+
+    void DensityHeatmapRenderer::draw(const ViewTransform& view)
+    {
+        if(!m_renderer || !m_texture)
+            return;
+
+        // Opposite corners, so the size rounds consistently with neighbouring geometry
+        float x0, y0, x1, y1;
+        view.apply(m_originX, m_originY, x0, y0);
+        view.apply(m_originX + m_textureW * m_cellSize, m_originY + m_textureH * m_cellSize, x1,
+                   y1);
+        const int x = toPixel(x0), y = toPixel(y0);
+        m_renderer->drawTexture(m_texture, x, y, toPixel(x1) - x, toPixel(y1) - y);
+    }
+
+} // namespace tfv
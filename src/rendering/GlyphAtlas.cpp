@@ -0,0 +1,294 @@
+#include "rendering/GlyphAtlas.hpp"
+#include "utils/LoggingManager.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace tfv
+{
+    namespace
+    {
+        // Transparent gap around every glyph so filtering never samples a neighbour
+        constexpr int kPadding = 1;
+
+        // Decode the UTF-8 sequence at text[i] and advance i; malformed input yields U+FFFD
+        char32_t nextCodepoint(std::string_view text, std::size_t& i)
+        {
+            const auto lead = static_cast<uint8_t>(text[i++]);
+            if(lead < 0x80)
+                return lead;
+
+            int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : -1;
+            if(extra < 0 || i + extra > text.size())
+                return U'\uFFFD';
+
+            char32_t cp = lead & (0x3F >> extra);
+            for(int k = 0; k < extra; ++k)
+            {
+                const auto cont = static_cast<uint8_t>(text[i]);
+                if((cont & 0xC0) != 0x80)
+                    return U'\uFFFD';
+                cp = (cp << 6) | (cont & 0x3F);
+                ++i;
+            }
+            return cp;
+        }
+
+        std::mutex ttfMutex;
+        int ttfUsers = 0;
+    } // namespace
+
+    TtfLibrary::TtfLibrary()
+    {
+        std::scoped_lock lock(ttfMutex);
+        if(ttfUsers == 0 && TTF_Init() == -1)
+        {
+            LOG_ERROR("SDL_ttf could not initialize! {error}", PARAM(error, TTF_GetError()));
+            return;
+        }
+        ++ttfUsers;
+        m_ready = true;
+    }
+
+    TtfLibrary::~TtfLibrary()
+    {
+        if(!m_ready)
+            return;
+        std::scoped_lock lock(ttfMutex);
+        if(--ttfUsers == 0)
+            TTF_Quit();
+    }
+
+    GlyphAtlas::GlyphAtlas(Renderer* renderer, int size)
+        : m_renderer(renderer), m_size(std::clamp(size, 64, 4096))
+    {
+        m_pixels.assign(static_cast<std::size_t>(m_size) * m_size, 0);
+    }
+
+    GlyphAtlas::~GlyphAtlas()
+    {
+        if(m_texture && m_renderer)
+            m_renderer->destroyTexture(m_texture);
+        for(Font& font : m_fonts)
+            TTF_CloseFont(font.handle);
+    }
+
+    int GlyphAtlas::loadFont(const std::string& path, int pointSize)
+    {
+        for(std::size_t i = 0; i < m_fonts.size(); ++i)
+        {
+            if(m_fonts[i].path == path && m_fonts[i].pointSize == pointSize)
+                return static_cast<int>(i);
+        }
+        if(!m_ttf.ready())
+            return kInvalidFont;
+
+        TTF_Font* handle = TTF_OpenFont(path.c_str(), pointSize);
+        if(!handle)
+            return kInvalidFont;
+        m_fonts.push_back({path, pointSize, handle});
+        return static_cast<int>(m_fonts.size() - 1);
+    }
+
+    int GlyphAtlas::loadDefaultFont(int pointSize)
+    {
+        for(const char* path : {"/System/Library/Fonts/Supplemental/Arial.ttf",
+                                "/System/Library/Fonts/Supplemental/Courier New.ttf",
+                                "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+                                "/usr/share/fonts/TTF/DejaVuSans.ttf"})
+        {
+            int font = loadFont(path, pointSize);
+            if(font != kInvalidFont)
+                return font;
+        }
+        LOG_ERROR("Failed to load font: {error}", PARAM(error, TTF_GetError()));
+        return kInvalidFont;
+    }
+
+    int GlyphAtlas::lineHeight(int font) const
+    {
+        if(font < 0 || font >= static_cast<int>(m_fonts.size()))
+            return 0;
+        return TTF_FontLineSkip(m_fonts[font].handle);
+    }
+
+    const Glyph* GlyphAtlas::glyph(int font, char32_t codepoint)
+    {
+        if(font < 0 || font >= static_cast<int>(m_fonts.size()))
+            return nullptr;
+
+        const uint64_t key = (static_cast<uint64_t>(font) << 32) | codepoint;
+        auto it = m_glyphs.find(key);
+        if(it != m_glyphs.end())
+            return &it->second;
+
+        Glyph g{};
+        if(!rasterize(m_fonts[font], codepoint, g))
+            return nullptr; // Atlas full: not cached, retried after the next reset
+        return &m_glyphs.emplace(key, g).first->second;
+    }
+
+    bool GlyphAtlas::rasterize(const Font& font, char32_t codepoint, Glyph& out)
+    {
+        out = Glyph{};
+        if(m_overflow)
+            return false;
+
+        // Glyphs the font does not have are cached as blanks so they are not retried
+        const SDL_Color white{255, 255, 255, 255};
+        int minX, maxX, minY, maxY, advance;
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+        if(!TTF_GlyphIsProvided32(font.handle, codepoint) ||
+           TTF_GlyphMetrics32(font.handle, codepoint, &minX, &maxX, &minY, &maxY, &advance) != 0)
+            return true;
+        SDL_Surface* rendered = TTF_RenderGlyph32_Blended(font.handle, codepoint, white);
+#else
+        if(codepoint > 0xFFFF)
+            return true;
+        const auto ch = static_cast<Uint16>(codepoint);
+        if(!TTF_GlyphIsProvided(font.handle, ch) ||
+           TTF_GlyphMetrics(font.handle, ch, &minX, &maxX, &minY, &maxY, &advance) != 0)
+            return true;
+        SDL_Surface* rendered = TTF_RenderGlyph_Blended(font.handle, ch, white);
+#endif
+        out.advance = static_cast<int16_t>(advance);
+        if(!rendered)
+            return true;
+        SDL_Surface* surface = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(rendered);
+        if(!surface)
+            return true;
+
+        // Trim to the covered pixels; the surface spans the whole line height
+        const auto* src = static_cast<const uint8_t*>(surface->pixels);
+        auto pixel = [&](int x, int y)
+        { return reinterpret_cast<const uint32_t*>(src + y * surface->pitch)[x]; };
+        int x0 = surface->w, y0 = surface->h, x1 = -1, y1 = -1;
+        for(int y = 0; y < surface->h; ++y)
+        {
+            for(int x = 0; x < surface->w; ++x)
+            {
+                if(pixel(x, y) >> 24)
+                {
+                    x0 = std::min(x0, x);
+                    x1 = std::max(x1, x);
+                    y0 = std::min(y0, y);
+                    y1 = std::max(y1, y);
+                }
+            }
+        }
+        if(x1 < 0)
+        {
+            SDL_FreeSurface(surface);
+            return true; // Whitespace
+        }
+
+        const int w = x1 - x0 + 1;
+        const int h = y1 - y0 + 1;
+        if(m_shelfX + w + kPadding > m_size)
+        {
+            m_shelfY += m_shelfHeight + kPadding;
+            m_shelfX = 0;
+            m_shelfHeight = 0;
+        }
+        if(w + kPadding > m_size || m_shelfY + h + kPadding > m_size)
+        {
+            SDL_FreeSurface(surface);
+            if(!m_overflow)
+                LOG_INFO("Glyph atlas full ({count} glyphs); rebuilding next frame",
+                         PARAM(count, m_glyphs.size()));
+            m_overflow = true;
+            return false;
+        }
+
+        const int ax = m_shelfX + kPadding;
+        const int ay = m_shelfY + kPadding;
+        for(int row = 0; row < h; ++row)
+        {
+            std::memcpy(m_pixels.data() + static_cast<std::size_t>(ay + row) * m_size + ax,
+                        src + (y0 + row) * surface->pitch + x0 * sizeof(uint32_t),
+                        w * sizeof(uint32_t));
+        }
+        SDL_FreeSurface(surface);
+
+        m_shelfX += w + kPadding;
+        m_shelfHeight = std::max(m_shelfHeight, h);
+        m_dirty = true;
+
+        out.x = static_cast<int16_t>(ax);
+        out.y = static_cast<int16_t>(ay);
+        out.w = static_cast<int16_t>(w);
+        out.h = static_cast<int16_t>(h);
+        out.offsetX = static_cast<int16_t>(x0);
+        out.offsetY = static_cast<int16_t>(y0);
+        return true;
+    }
+
+    void GlyphAtlas::reset()
+    {
+        m_glyphs.clear();
+        std::fill(m_pixels.begin(), m_pixels.end(), 0u);
+        m_shelfX = m_shelfY = m_shelfHeight = 0;
+        m_overflow = false;
+        m_dirty = true;
+    }
+
+    void GlyphAtlas::beginFrame()
+    {
+        // Only between frames: quads already queued this frame point into the old layout
+        if(m_overflow)
+            reset();
+    }
+
+    void GlyphAtlas::upload()
+    {
+        if(!m_dirty || !m_renderer)
+            return;
+        if(!m_texture)
+            m_texture = m_renderer->createTexture(m_size, m_size);
+        if(!m_texture)
+            return;
+
+        // New glyphs are rare once the working set is cached, so whole-texture updates are fine
+        m_renderer->updateTexture(m_texture, m_pixels.data(), m_size * sizeof(uint32_t));
+        m_dirty = false;
+    }
+
+    int TextBatch::measure(int font, std::string_view text)
+    {
+        int width = 0;
+        for(std::size_t i = 0; i < text.size();)
+        {
+            if(const Glyph* g = m_atlas.glyph(font, nextCodepoint(text, i)))
+                width += g->advance;
+        }
+        return width;
+    }
+
+    int TextBatch::add(int font, std::string_view text, int x, int y, uint32_t color)
+    {
+        int pen = x;
+        for(std::size_t i = 0; i < text.size();)
+        {
+            const Glyph* g = m_atlas.glyph(font, nextCodepoint(text, i));
+            if(!g)
+                continue;
+            if(g->w > 0)
+            {
+                m_quads.push_back({pen + g->offsetX, y + g->offsetY, g->w, g->h, g->x, g->y, g->w,
+                                   g->h, color});
+            }
+            pen += g->advance;
+        }
+        return pen - x;
+    }
+
+    void TextBatch::draw(Renderer& renderer)
+    {
+        m_atlas.upload();
+        if(!m_quads.empty() && m_atlas.texture())
+            renderer.drawTextureQuads(m_atlas.texture(), m_quads);
+    }
+
+} // namespace tfv
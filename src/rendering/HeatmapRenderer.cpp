@@ -4,44 +4,64 @@
 
 namespace tfv
 {
-    HeatmapRenderer::HeatmapRenderer(Renderer* renderer) : m_renderer(renderer) {}
+    HeatmapRenderer::HeatmapRenderer(Renderer* renderer) : m_renderer(renderer)
+    {
+        rebuildLut();
+    }
 
-    void HeatmapRenderer::draw(const RoadNetwork* roadNetwork,
-                               const std::unordered_map<uint32_t, float>& congestionLevels,
-                               int panX, int panY, float scale)
+    void HeatmapRenderer::draw(const RoadNetwork* roadNetwork, std::span<const float> congestion,
+                               const ViewTransform& view)
     {
         if(!roadNetwork || !m_renderer)
             return;
 
+        // Colours for every segment in one pass over contiguous data
+        const SegmentGeometry& g = roadNetwork->geometry();
+        const std::size_t count = std::min(g.size(), congestion.size());
+        m_colors.resize(count);
+        mapColors(congestion.first(count), m_colors.data());
+
+        // Screen end points for every segment, batched like the colours
+        for(auto* v : {&m_x1, &m_y1, &m_x2, &m_y2})
+            v->resize(count);
+        view.apply(g.x1.data(), g.y1.data(), count, m_x1.data(), m_y1.data());
+        view.apply(g.x2.data(), g.y2.data(), count, m_x2.data(), m_y2.data());
+
+        // Use same width as road but scaled
+        const float width = 10.0f * view.scale() * m_lineWidthFactor;
+        const int roadWidth = static_cast<int>(std::min(width, 4096.f));
+        const uint8_t alpha = static_cast<uint8_t>(m_opacity * 255);
+        int viewW = 0, viewH = 0;
+        m_renderer->getWindowSize(viewW, viewH);
+
         // Draw each road segment with color based on congestion
-        for(const auto& visual : roadNetwork->segments())
+        for(std::size_t i = 0; i < count; ++i)
         {
-            // Get congestion level for this segment
-            auto it = congestionLevels.find(visual.id);
-            if(it == congestionLevels.end())
+            float x1 = m_x1[i], y1 = m_y1[i], x2 = m_x2[i], y2 = m_y2[i];
+            if(!clipToViewport(x1, y1, x2, y2, viewW, viewH, roadWidth * 0.5f + 1.f))
                 continue;
 
-            float congestionLevel = it->second;
-
-            // Calculate road coordinates with pan and zoom
-            int x1 = static_cast<int>(visual.x1 * scale) + panX;
-            int y1 = static_cast<int>(visual.y1 * scale) + panY;
-            int x2 = static_cast<int>(visual.x2 * scale) + panX;
-            int y2 = static_cast<int>(visual.y2 * scale) + panY;
+            const uint32_t c = m_colors[i];
+            m_renderer->setColor(static_cast<uint8_t>(c >> 16), static_cast<uint8_t>(c >> 8),
+                                 static_cast<uint8_t>(c), alpha);
 
-            // Get color based on congestion level
-            Color color = getColorForCongestion(congestionLevel);
-
-            // Apply opacity
-            color.a = static_cast<uint8_t>(m_opacity * 255);
+            // Use anti-aliased lines for better quality (drawLine now handles anti-aliasing)
+            m_renderer->drawLine(toPixel(x1), toPixel(y1), toPixel(x2), toPixel(y2), roadWidth);
+        }
+    }
 
-            // Draw the heatmap line
-            float roadWidth =
-                10.0f * scale * m_lineWidthFactor; // Use same width as road but scaled
-            m_renderer->setColor(color.r, color.g, color.b, color.a);
+    void HeatmapRenderer::mapColors(std::span<const float> levels, uint32_t* out) const
+    {
+        const uint32_t* lut = m_lut.data();
+        const float top = static_cast<float>(m_lut.size() - 1);
+        const std::size_t n = levels.size();
+        const float* in = levels.data();
 
-            // Use anti-aliased lines for better quality (drawLine now handles anti-aliasing)
-            m_renderer->drawLine(x1, y1, x2, y2, static_cast<int>(roadWidth));
+        // Branch-free quantise + table lookup; vectorises to a gather
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            float level = std::min(std::max(in[i], 0.0f), 1.0f);
+            out[i] = lut[static_cast<uint32_t>(level * top + 0.5f)];
         }
     }
 
@@ -51,6 +71,24 @@ namespace tfv
         m_lowColor = lowColor;
         m_mediumColor = mediumColor;
         m_highColor = highColor;
+        rebuildLut();
+    }
+
+    void HeatmapRenderer::setLutSize(std::size_t entries)
+    {
+        m_lutSize = std::max<std::size_t>(2, entries);
+        rebuildLut();
+    }
+
+    void HeatmapRenderer::rebuildLut()
+    {
+        m_lut.resize(m_lutSize);
+        const float top = static_cast<float>(m_lutSize - 1);
+        for(std::size_t i = 0; i < m_lutSize; ++i)
+        {
+            Color c = getColorForCongestion(static_cast<float>(i) / top);
+            m_lut[i] = (uint32_t{c.a} << 24) | (uint32_t{c.r} << 16) | (uint32_t{c.g} << 8) | c.b;
+        }
     }
 
     Color HeatmapRenderer::getColorForCongestion(float level) const
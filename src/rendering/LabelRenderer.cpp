@@ -0,0 +1,151 @@
+#include "rendering/LabelRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <glm/glm.hpp>
+
+namespace tfv
+{
+    namespace
+    {
+        constexpr uint32_t kSegmentColor = 0xFFDCDCDCu; // Light grey, like the road edges
+        constexpr uint32_t kVehicleColor = 0xFF78E678u; // Lighter than the vehicle arrows
+    } // namespace
+
+    LabelRenderer::LabelRenderer(Renderer* renderer)
+        : m_r(renderer), m_atlas(renderer, 512), m_text(m_atlas)
+    {
+        m_font = m_atlas.loadDefaultFont(12);
+    }
+
+    bool LabelRenderer::reserve(int x, int y, int w, int h)
+    {
+        if(x < 0 || y < 0 || x + w > m_viewW || y + h > m_viewH)
+            return false;
+
+        const int cx0 = x / kCellSize, cx1 = (x + w - 1) / kCellSize;
+        const int cy0 = y / kCellSize, cy1 = (y + h - 1) / kCellSize;
+        for(int cy = cy0; cy <= cy1; ++cy)
+            for(int cx = cx0; cx <= cx1; ++cx)
+                if(m_occupied[static_cast<std::size_t>(cy) * m_cols + cx])
+                    return false;
+        for(int cy = cy0; cy <= cy1; ++cy)
+            std::fill_n(m_occupied.begin() + static_cast<std::size_t>(cy) * m_cols + cx0,
+                        cx1 - cx0 + 1, uint8_t{1});
+        return true;
+    }
+
+    void LabelRenderer::draw(const RoadNetwork* net, const SimulationState* state,
+                             const VehicleBatch& vehicles, const Camera& camera)
+    {
+        if(!net || !m_r || m_font == GlyphAtlas::kInvalidFont)
+            return;
+
+        m_viewW = camera.viewportWidth();
+        m_viewH = camera.viewportHeight();
+        if(m_viewW <= 0 || m_viewH <= 0)
+            return;
+        const SegmentGeometry& g = net->geometry();
+        m_view = camera.transform(g.originX, g.originY);
+        m_cols = (m_viewW + kCellSize - 1) / kCellSize;
+        m_rows = (m_viewH + kCellSize - 1) / kCellSize;
+        m_occupied.assign(static_cast<std::size_t>(m_cols) * m_rows, 0);
+        m_labelCount = 0;
+
+        m_atlas.beginFrame();
+        m_text.clear();
+
+        // Segments first: they are fewer and anchor the view
+        if(m_segmentLabels)
+            drawSegmentLabels(*net, state, camera);
+        if(m_vehicleLabels && state && m_view.scale() >= kMinVehicleScale)
+            drawVehicleLabels(*state, vehicles);
+
+        m_text.draw(*m_r);
+    }
+
+    void LabelRenderer::drawSegmentLabels(const RoadNetwork& net, const SimulationState* state,
+                                          const Camera& camera)
+    {
+        // Viewport in the geometry's local frame
+        const SegmentGeometry& g = net.geometry();
+        double wx0, wy0, wx1, wy1;
+        camera.visibleBounds(wx0, wy0, wx1, wy1);
+        const float scale = m_view.scale();
+
+        m_visible.clear();
+        net.segmentIndex().query(static_cast<float>(wx0 - g.originX),
+                                 static_cast<float>(wy0 - g.originY),
+                                 static_cast<float>(wx1 - g.originX),
+                                 static_cast<float>(wy1 - g.originY), m_visible);
+        std::sort(m_visible.begin(), m_visible.end()); // Stable priority between frames
+
+        const int lineHeight = m_atlas.lineHeight(m_font);
+        char text[32];
+        for(uint32_t i : m_visible)
+        {
+            if(m_labelCount >= kMaxLabels)
+                break;
+            if(i >= g.size() || g.length[i] == 0)
+                continue;
+
+            const bool congestion = state && i < state->congestion.size();
+            if(congestion)
+                std::snprintf(text, sizeof(text), "%u %d%%", g.ids[i],
+                              static_cast<int>(std::lround(state->congestion[i] * 100.f)));
+            else
+                std::snprintf(text, sizeof(text), "%u", g.ids[i]);
+
+            // Skip segments too short on screen to carry their own label
+            const int width = m_text.measure(m_font, text);
+            if(g.length[i] * scale < width)
+                continue;
+
+            float mx, my, sx, sy;
+            g.pointAt(i, 0.5f, mx, my);
+            m_view.apply(mx, my, sx, sy);
+            if(sx < 0.f || sy < 0.f || sx >= m_viewW || sy >= m_viewH)
+                continue;
+            const int x = toPixel(sx) - width / 2;
+            const int y = toPixel(sy) - lineHeight / 2;
+            if(!reserve(x, y, width, lineHeight))
+                continue;
+            m_text.add(m_font, text, x, y, kSegmentColor);
+            ++m_labelCount;
+        }
+    }
+
+    void LabelRenderer::drawVehicleLabels(const SimulationState& state,
+                                          const VehicleBatch& vehicles)
+    {
+        const int lineHeight = m_atlas.lineHeight(m_font);
+        const std::size_t count = std::min(vehicles.vehicle.size(), vehicles.sx.size());
+        char text[48];
+        for(std::size_t k = 0; k < count && m_labelCount < kMaxLabels; ++k)
+        {
+            // Cheap viewport test before any text work
+            const float fx = vehicles.sx[k], fy = vehicles.sy[k];
+            if(fx < 0.f || fy < 0.f || fx >= m_viewW || fy >= m_viewH)
+                continue;
+            const int sx = toPixel(fx), sy = toPixel(fy);
+
+            const uint32_t index = vehicles.vehicle[k];
+            if(index >= state.vehicles.size())
+                continue;
+            const Vehicle& v = state.vehicles[index];
+            std::snprintf(text, sizeof(text), "%llu %d km/h", static_cast<unsigned long long>(v.id),
+                          static_cast<int>(std::lround(glm::length(v.vel) * 3.6f)));
+
+            // Up and to the right of the vehicle, clear of its arrow
+            const int width = m_text.measure(m_font, text);
+            const int x = sx + 4;
+            const int y = sy - lineHeight - 2;
+            if(!reserve(x, y, width, lineHeight))
+                continue;
+            m_text.add(m_font, text, x, y, kVehicleColor);
+            ++m_labelCount;
+        }
+    }
+
+} // namespace tfv
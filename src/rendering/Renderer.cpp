@@ -1,6 +1,7 @@
 #include "rendering/Renderer.hpp"
 #include "rendering/platforms/Metal.hpp"
 #include "rendering/platforms/SDL.hpp"
+#include "rendering/platforms/Software.hpp"
 
 #include <cmath>
 #include <iostream>
@@ -17,12 +18,18 @@
 namespace tfv
 {
     // Factory method implementation
-    std::unique_ptr<Renderer> Renderer::create(const std::string& type, void* window)
+    std::unique_ptr<Renderer> Renderer::create(const std::string& type, void* window, int width,
+                                               int height)
     {
         if(type == "SDL")
         {
             return std::make_unique<SDLRenderer>(static_cast<SDL_Window*>(window));
         }
+        else if(type == "Software")
+        {
+            // No window: rasterises into its own framebuffer
+            return std::make_unique<SoftwareRenderer>(width, height);
+        }
         else if(type == "Metal")
         {
 #if defined(__APPLE__)
@@ -1,19 +1,127 @@
 #include "rendering/SceneRenderer.hpp"
+#include "rendering/LabelRenderer.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <glm/glm.hpp>
 
 namespace tfv
 {
-    void SceneRenderer::draw(const VehicleMap& vehicles)
+    SceneRenderer::SceneRenderer(Renderer* r) : m_r(r) {}
+
+    SceneRenderer::~SceneRenderer() = default;
+
+    void SceneRenderer::updateCamera()
+    {
+        int width = 0, height = 0;
+        m_r->getWindowSize(width, height);
+        m_camera.setViewport(width, height);
+
+        const SegmentGeometry* geom = m_net ? &m_net->geometry() : nullptr;
+        if(!m_cameraFitted && geom && geom->size() > 0 && width > 0 && height > 0)
+        {
+            m_camera.fit(geom->minX, geom->minY, geom->maxX, geom->maxY);
+            m_cameraFitted = true;
+        }
+        m_view = m_camera.transform(geom ? geom->originX : 0.0, geom ? geom->originY : 0.0);
+    }
+
+    void SceneRenderer::draw(const SimulationStatePtr& previous, const SimulationStatePtr& current,
+                             double renderTime)
+    {
+        updateCamera();
+        RoadRenderer roadR(m_r, m_view, m_antiAliasing);
+        roadR.draw(m_net, m_roadBatch);
+        if(current)
+        {
+            VehicleRenderer vehR(m_r, m_view, m_antiAliasing);
+            vehR.draw(previous ? *previous : *current, *current, renderTime, m_net, m_vehicleBatch);
+        }
+        drawHighlight(m_hover, current.get(), 255, 255, 255, 140);
+        drawHighlight(m_selection, current.get(), 255, 210, 0, 255);
+        if(m_labelsEnabled)
+        {
+            if(!m_labels)
+                m_labels = std::make_unique<LabelRenderer>(m_r);
+            m_labels->draw(m_net, current.get(), m_vehicleBatch, m_camera);
+        }
+
+        // Keep the states for later renders (shared, no copy)
+        m_previous = previous;
+        m_current = current;
+        m_renderTime = renderTime;
+    }
+
+    PickResult SceneRenderer::pickVehicle(float x, float y, float maxDistance) const
+    {
+        PickResult result;
+        if(!m_current)
+            return result;
+
+        // A drawn vehicle is at most maxStep from its tick position: widen the grid search by
+        // that much, then measure each candidate where it was drawn
+        const SimulationState& state = *m_current;
+        const VehicleBatch& drawn = m_vehicleBatch;
+        const float reach = maxDistance + state.maxStep;
+        float bestDistance = maxDistance;
+        state.vehicleIndex.visit(
+            x - reach, y - reach, x + reach, y + reach,
+            [&](uint32_t i)
+            {
+                auto it = std::lower_bound(drawn.vehicle.begin(), drawn.vehicle.end(), i);
+                if(it == drawn.vehicle.end() || *it != i)
+                    return;
+                const std::size_t k = it - drawn.vehicle.begin();
+                const float d = std::hypot(drawn.x[k] - x, drawn.y[k] - y);
+                if(d < bestDistance || (d == bestDistance && !result.hasVehicle))
+                {
+                    bestDistance = d;
+                    result.hasVehicle = true;
+                    result.vehicleId = state.vehicles[i].id;
+                    result.segment = drawn.segment[k];
+                }
+            });
+        return result;
+    }
+
+    void SceneRenderer::drawHighlight(const PickResult& pick, const SimulationState* current,
+                                      uint8_t r, uint8_t g, uint8_t b, uint8_t a)
     {
-        RoadRenderer roadR(m_r, m_panX, m_panY, m_scale, m_antiAliasing);
-        roadR.draw(m_net);
-        VehicleRenderer vehR(m_r, m_panX, m_panY, m_scale, m_antiAliasing);
-        vehR.draw(vehicles, m_net);
+        if(pick.empty() || !m_net)
+            return;
+        m_r->setColor(r, g, b, a);
+
+        const SegmentGeometry& geom = m_net->geometry();
+        if(pick.hasSegment() && pick.segment < geom.size())
+        {
+            const uint32_t i = pick.segment;
+            float x1, y1, x2, y2;
+            m_view.apply(geom.x1[i], geom.y1[i], x1, y1);
+            m_view.apply(geom.x2[i], geom.y2[i], x2, y2);
+            if(clipToViewport(x1, y1, x2, y2, m_camera.viewportWidth(),
+                              m_camera.viewportHeight(), 4.f))
+                m_r->drawLine(toPixel(x1), toPixel(y1), toPixel(x2), toPixel(y2), 4);
+        }
 
-        // Store the snapshot for later renders
-        m_lastSnapshot = vehicles;
+        // Vehicles are outlined where they were drawn this frame (interpolated position)
+        const Vehicle* v = pick.hasVehicle && current ? current->findVehicle(pick.vehicleId)
+                                                       : nullptr;
+        if(!v)
+            return;
+        const auto index = static_cast<uint32_t>(v - current->vehicles.data());
+        const auto& drawn = m_vehicleBatch.vehicle;
+        auto it = std::lower_bound(drawn.begin(), drawn.end(), index);
+        if(it == drawn.end() || *it != index)
+            return;
+        const std::size_t k = it - drawn.begin();
+        const float fx = m_vehicleBatch.sx[k], fy = m_vehicleBatch.sy[k];
+        if(fx < 0.f || fy < 0.f || fx >= m_camera.viewportWidth() ||
+           fy >= m_camera.viewportHeight())
+            return;
+        const int sx = toPixel(fx), sy = toPixel(fy);
+        const int half = std::clamp(static_cast<int>(4 * m_view.scale()), 6, 64);
+        m_r->drawRect(sx - half, sy - half, 2 * half, 2 * half);
+        m_r->drawRect(sx - half - 1, sy - half - 1, 2 * half + 2, 2 * half + 2);
     }
 
     void SceneRenderer::update(double dt)
@@ -23,60 +131,67 @@ namespace tfv
 
     void SceneRenderer::render()
     {
-        // m_lastSnapshot might be empty if no vehicles have been stored yet
-        // This is just a placeholder implementation - ideally we would get new vehicle data each
-        // frame
-        if(m_lastSnapshot.empty())
+        // No state stored yet: draw empty roads
+        if(!m_current)
         {
-            // Draw empty roads if no vehicle data
-            RoadRenderer roadR(m_r, m_panX, m_panY, m_scale, m_antiAliasing);
-            roadR.draw(m_net);
+            updateCamera();
+            RoadRenderer roadR(m_r, m_view, m_antiAliasing);
+            roadR.draw(m_net, m_roadBatch);
         }
         else
         {
-            // Use the latest snapshot
-            draw(m_lastSnapshot);
+            // Re-use the latest states
+            draw(m_previous, m_current, m_renderTime);
         }
     }
 
-    void RoadRenderer::draw(const RoadNetwork* net)
+    void RoadRenderer::draw(const RoadNetwork* net, RoadBatch& batch)
     {
-        if(!net)
+        if(!net || !m_r)
             return;
-        const auto& segs = net->segments();
-        for(const auto& s : segs)
+        const SegmentGeometry& g = net->geometry();
+        const std::size_t count = g.size();
+        int viewW = 0, viewH = 0;
+        m_r->getWindowSize(viewW, viewH);
+
+        // End points to screen space for the whole network in two vectorised passes
+        for(auto* v : {&batch.x1, &batch.y1, &batch.x2, &batch.y2})
+            v->resize(count);
+        m_view.apply(g.x1.data(), g.y1.data(), count, batch.x1.data(), batch.y1.data());
+        m_view.apply(g.x2.data(), g.y2.data(), count, batch.x2.data(), batch.y2.data());
+
+        // Edge offset is a world-space width, so it goes through the linear part only
+        const float half = roadWidth * 0.5f;
+        const float margin = half * m_scale + 2.f;
+        for(std::size_t i = 0; i < count; ++i)
         {
-            float x1 = static_cast<float>(s.x1), y1 = static_cast<float>(s.y1);
-            float x2 = static_cast<float>(s.x2), y2 = static_cast<float>(s.y2);
-            float dx = x2 - x1, dy = y2 - y1;
-            float len = std::sqrt(dx * dx + dy * dy);
-            if(len == 0)
+            if(g.length[i] == 0)
                 continue;
-            float nx = -dy / len, ny = dx / len;
-            float half = roadWidth * 0.5f;
-            auto toScreen = [&](float wx, float wy)
-            {
-                return std::pair<int, int>{static_cast<int>(wx * m_scale) + m_panX,
-                                           static_cast<int>(wy * m_scale) + m_panY};
-            };
-            auto a1 = toScreen(x1 + nx * half, y1 + ny * half);
-            auto a2 = toScreen(x2 + nx * half, y2 + ny * half);
-            auto b1 = toScreen(x1 - nx * half, y1 - ny * half);
-            auto b2 = toScreen(x2 - nx * half, y2 - ny * half);
-
-            // Calculate the road width in pixels
-            float roadWidthPx = roadWidth * m_scale;
+            float ox, oy;
+            m_view.applyVector(g.normX[i] * half, g.normY[i] * half, ox, oy);
+            float ax1 = batch.x1[i] + ox, ay1 = batch.y1[i] + oy;
+            float ax2 = batch.x2[i] + ox, ay2 = batch.y2[i] + oy;
+            float bx1 = batch.x1[i] - ox, by1 = batch.y1[i] - oy;
+            float bx2 = batch.x2[i] - ox, by2 = batch.y2[i] - oy;
 
             // Set color for roads
             m_r->setColor(200, 200, 200, 255);
 
-            // Draw the road edges
-            m_r->drawLine(a1.first, a1.second, a2.first, a2.second, 2);
-            m_r->drawLine(b1.first, b1.second, b2.first, b2.second, 2);
+            // Draw the road edges, clipped so far-off end points stay in pixel range
+            const bool aVisible = clipToViewport(ax1, ay1, ax2, ay2, viewW, viewH, margin);
+            const bool bVisible = clipToViewport(bx1, by1, bx2, by2, viewW, viewH, margin);
+            if(aVisible)
+                m_r->drawLine(toPixel(ax1), toPixel(ay1), toPixel(ax2), toPixel(ay2), 2);
+            if(bVisible)
+                m_r->drawLine(toPixel(bx1), toPixel(by1), toPixel(bx2), toPixel(by2), 2);
 
             // Draw center line
+            float cx1 = batch.x1[i] + ox, cy1 = batch.y1[i] + oy;
+            float cx2 = batch.x1[i] - ox, cy2 = batch.y1[i] - oy;
+            if(!clipToViewport(cx1, cy1, cx2, cy2, viewW, viewH, margin))
+                continue;
             m_r->setColor(140, 140, 140, 255);
-            drawDashedLine(a1.first, a1.second, b1.first, b1.second);
+            drawDashedLine(toPixel(cx1), toPixel(cy1), toPixel(cx2), toPixel(cy2));
         }
     }
 
@@ -109,36 +224,114 @@ namespace tfv
         }
     }
 
-    VehicleRenderer::VehicleRenderer(Renderer* renderer, int panX, int panY, float scale,
+    VehicleRenderer::VehicleRenderer(Renderer* renderer, const ViewTransform& view,
                                      bool antiAliasing)
-        : m_r(renderer), m_panX(panX), m_panY(panY), m_scale(scale), m_antiAliasing(antiAliasing)
+        : m_r(renderer), m_view(view), m_scale(view.scale()), m_antiAliasing(antiAliasing)
     {
         // Set anti-aliasing on the renderer
         m_r->setAntiAliasing(antiAliasing);
     }
 
-    void VehicleRenderer::draw(const VehicleMap& vehicles, const RoadNetwork* const net)
+    bool VehicleRenderer::interpolate(const Vehicle* prev, const Vehicle& cur, float alpha,
+                                      const SegmentGeometry& geom, uint32_t& segment, float& t)
+    {
+        const uint32_t curIdx = geom.indexOf(cur.segmentId);
+        if(curIdx == SegmentGeometry::kInvalidIndex || geom.length[curIdx] == 0)
+            return false;
+        segment = curIdx;
+        t = cur.position;
+
+        if(!prev || alpha >= 1.0f)
+            return true;
+
+        // Still on the same segment and moving forward: plain lerp
+        if(prev->segmentId == cur.segmentId && cur.position >= prev->position)
+        {
+            t = prev->position + (cur.position - prev->position) * alpha;
+            return true;
+        }
+
+        // Crossed onto another segment (or wrapped): blend by distance travelled, so the
+        // vehicle finishes the old segment before appearing on the new one
+        const uint32_t prevIdx = geom.indexOf(prev->segmentId);
+        float prevLen = prevIdx != SegmentGeometry::kInvalidIndex ? geom.length[prevIdx] : 0.f;
+        float curLen = geom.length[curIdx];
+        float remaining = (1.f - std::min(prev->position, 1.f)) * prevLen;
+        float travelled = alpha * (remaining + cur.position * curLen);
+
+        if(travelled < remaining && prevLen > 0)
+        {
+            segment = prevIdx;
+            t = prev->position + travelled / prevLen;
+        }
+        else
+        {
+            t = (travelled - remaining) / curLen;
+        }
+        return true;
+    }
+
+    void VehicleRenderer::draw(const SimulationState& previous, const SimulationState& current,
+                               double renderTime, const RoadNetwork* const net,
+                               VehicleBatch& batch)
     {
         if(!net || net->segments().empty())
             return;
-        const auto& segs = net->segments();
-        for(const auto& [id, v] : vehicles)
+        const SegmentGeometry& geom = net->geometry();
+
+        // Blend factor between the two ticks; 1 when they coincide
+        float alpha = 1.0f;
+        double span = current.time - previous.time;
+        if(span > 0.0)
+            alpha = static_cast<float>(std::clamp((renderTime - previous.time) / span, 0.0, 1.0));
+
+        // Pass 1: resolve (segment, offset) per vehicle. Both lists are sorted by id, so walk
+        // them together instead of looking each vehicle up.
+        batch.clear();
+        auto prevIt = previous.vehicles.begin();
+        const auto prevEnd = previous.vehicles.end();
+        for(const auto& v : current.vehicles)
         {
-            if(v.segmentId >= segs.size())
+            while(prevIt != prevEnd && prevIt->id < v.id)
+                ++prevIt;
+            const Vehicle* prev = (prevIt != prevEnd && prevIt->id == v.id) ? &*prevIt : nullptr;
+
+            uint32_t seg;
+            float t;
+            if(!interpolate(prev, v, alpha, geom, seg, t))
                 continue;
-            const auto& s = segs[v.segmentId];
-            float x1 = static_cast<float>(s.x1), y1 = static_cast<float>(s.y1);
-            float x2 = static_cast<float>(s.x2), y2 = static_cast<float>(s.y2);
-            float dx = x2 - x1, dy = y2 - y1;
-            float len = std::sqrt(dx * dx + dy * dy);
-            if(len == 0)
+            batch.vehicle.push_back(static_cast<uint32_t>(&v - current.vehicles.data()));
+            batch.segment.push_back(seg);
+            batch.t.push_back(t);
+        }
+
+        // Pass 2: world positions for the whole batch at once
+        const std::size_t count = batch.segment.size();
+        batch.x.resize(count);
+        batch.y.resize(count);
+        geom.positions(batch.segment.data(), batch.t.data(), count, batch.x.data(),
+                       batch.y.data());
+
+        // Pass 3: screen positions, one affine transform over the batch
+        batch.sx.resize(count);
+        batch.sy.resize(count);
+        m_view.apply(batch.x.data(), batch.y.data(), count, batch.sx.data(), batch.sy.data());
+
+        // Pass 4: draw what is on screen (arrows may poke in from just outside)
+        int viewW = 0, viewH = 0;
+        m_r->getWindowSize(viewW, viewH);
+        const float margin = std::max(8.f, 5.f * m_scale);
+        const float inv = m_scale > 0.f ? 1.f / m_scale : 0.f;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const float fx = batch.sx[i], fy = batch.sy[i];
+            if(fx < -margin || fy < -margin || fx > viewW + margin || fy > viewH + margin)
                 continue;
-            float ux = dx / len, uy = dy / len;
-            float t = v.position; // position is now 0..1
-            float wx = x1 + ux * (len * t);
-            float wy = y1 + uy * (len * t);
-            int sx = static_cast<int>(wx * m_scale) + m_panX;
-            int sy = static_cast<int>(wy * m_scale) + m_panY;
+            const uint32_t seg = batch.segment[i];
+            float ux, uy;
+            m_view.applyVector(geom.dirX[seg] * inv, geom.dirY[seg] * inv, ux, uy);
+            int sx = toPixel(fx);
+            int sy = toPixel(fy);
 
             // Vehicle color - different green shade than heatmap
             m_r->setColor(50, 200, 50, 255);
@@ -161,7 +354,8 @@ namespace tfv
                 m_r->drawLine(sx, sy, ex, ey, arrowWidth);
 
                 // Draw arrowhead
-                float nx = -uy, ny = ux; // normal vector
+                float nx, ny;
+                m_view.applyVector(geom.normX[seg] * inv, geom.normY[seg] * inv, nx, ny);
                 int ax1 = ex - static_cast<int>((ux * arrowLen * 0.5f + nx * arrowLen * 0.3f));
                 int ay1 = ey - static_cast<int>((uy * arrowLen * 0.5f + ny * arrowLen * 0.3f));
                 int ax2 = ex - static_cast<int>((ux * arrowLen * 0.5f - nx * arrowLen * 0.3f));
@@ -0,0 +1,268 @@
+#include "rendering/ThreadedRenderer.hpp"
+#include "utils/LoggingManager.hpp"
+
+#include <future>
+
+namespace tfv
+{
+    ThreadedRenderer::ThreadedRenderer(std::unique_ptr<Renderer> backend)
+        : m_backend(std::move(backend))
+    {
+    }
+
+    ThreadedRenderer::~ThreadedRenderer()
+    {
+        shutdown();
+    }
+
+    bool ThreadedRenderer::initialize()
+    {
+        if(m_started)
+            return true;
+
+        // The backend lives on the render thread from creation to shutdown
+        std::promise<bool> ready;
+        std::future<bool> result = ready.get_future();
+        m_stopping = false;
+        m_thread = std::thread(
+            [this, &ready]
+            {
+                bool ok = m_backend->initialize();
+                ready.set_value(ok);
+                if(ok)
+                    threadMain();
+            });
+
+        if(!result.get())
+        {
+            m_thread.join();
+            LOG_ERROR("Render thread failed to initialize its backend");
+            return false;
+        }
+        m_started = true;
+        return true;
+    }
+
+    void ThreadedRenderer::shutdown()
+    {
+        if(!m_started)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+        m_started = false;
+    }
+
+    void ThreadedRenderer::threadMain()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(true)
+        {
+            m_wake.wait(lock, [this] { return m_frameQueued || m_task || m_stopping; });
+
+            if(m_frameQueued)
+            {
+                // The main thread does not touch m_submitted while the frame is queued
+                lock.unlock();
+                m_submitted->replay(*m_backend, m_backendTextures);
+                m_backend->present();
+                lock.lock();
+                m_frameQueued = false;
+                m_done.notify_all();
+            }
+
+            if(m_task)
+            {
+                lock.unlock();
+                m_task(m_taskUser, m_backend.get());
+                lock.lock();
+                m_task = nullptr;
+                m_done.notify_all();
+            }
+
+            if(m_stopping && !m_frameQueued)
+                break;
+        }
+        lock.unlock();
+
+        m_backendTextures.clear();
+        m_backend->shutdown();
+    }
+
+    void ThreadedRenderer::present()
+    {
+        if(!m_started)
+        {
+            m_recording->clear();
+            return;
+        }
+
+        // Hand the frame over once the previous one is done with the other buffer
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [this] { return !m_frameQueued; });
+            std::swap(m_recording, m_submitted);
+            m_frameQueued = true;
+        }
+        m_wake.notify_one();
+
+        m_recording->clear();
+        m_recording->setColor(m_r, m_g, m_b, m_a);
+    }
+
+    void ThreadedRenderer::waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return !m_frameQueued; });
+    }
+
+    void ThreadedRenderer::invoke(RenderCallback fn, void* user)
+    {
+        if(!m_started || !fn)
+            return;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_task = fn;
+        m_taskUser = user;
+        m_wake.notify_one();
+        m_done.wait(lock, [this] { return m_task == nullptr; });
+    }
+
+    bool ThreadedRenderer::readPixels(uint32_t* pixels, int pitch)
+    {
+        struct Readback
+        {
+            uint32_t* pixels;
+            int pitch;
+            bool ok;
+        } readback{pixels, pitch, false};
+
+        // Runs after any queued frame, so this reads the frame last passed to present()
+        invoke(
+            [](void* user, Renderer* backend)
+            {
+                auto* r = static_cast<Readback*>(user);
+                r->ok = backend->readPixels(r->pixels, r->pitch);
+            },
+            &readback);
+        return readback.ok;
+    }
+
+    void ThreadedRenderer::clear(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        m_recording->clearTarget(r, g, b, a);
+    }
+
+    void ThreadedRenderer::setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        m_r = r;
+        m_g = g;
+        m_b = b;
+        m_a = a;
+        m_recording->setColor(r, g, b, a);
+    }
+
+    void ThreadedRenderer::drawLine(int x1, int y1, int x2, int y2)
+    {
+        m_recording->line(x1, y1, x2, y2, 1);
+    }
+
+    void ThreadedRenderer::drawLine(int x1, int y1, int x2, int y2, int width)
+    {
+        m_recording->line(x1, y1, x2, y2, width);
+    }
+
+    void ThreadedRenderer::drawPoint(int x, int y)
+    {
+        m_recording->point(x, y);
+    }
+
+    void ThreadedRenderer::drawRect(int x, int y, int w, int h)
+    {
+        m_recording->rect(x, y, w, h, false);
+    }
+
+    void ThreadedRenderer::fillRect(int x, int y, int w, int h)
+    {
+        m_recording->rect(x, y, w, h, true);
+    }
+
+    void ThreadedRenderer::drawText(const std::string& text, int x, int y)
+    {
+        m_recording->text(text, x, y);
+    }
+
+    TextureHandle ThreadedRenderer::createTexture(int width, int height)
+    {
+        if(width <= 0 || height <= 0)
+            return 0;
+        TextureHandle handle = m_nextTexture++;
+        m_textureSizes[handle] = {width, height};
+        m_recording->createTexture(handle, width, height);
+        return handle;
+    }
+
+    void ThreadedRenderer::updateTexture(TextureHandle texture, const uint32_t* pixels, int pitch)
+    {
+        auto it = m_textureSizes.find(texture);
+        if(it == m_textureSizes.end())
+            return;
+        m_recording->updateTexture(texture, pixels, pitch, it->second.width, it->second.height);
+    }
+
+    void ThreadedRenderer::drawTexture(TextureHandle texture, int x, int y, int w, int h)
+    {
+        m_recording->drawTexture(texture, x, y, w, h);
+    }
+
+    void ThreadedRenderer::drawTextureQuads(TextureHandle texture,
+                                            std::span<const TexturedQuad> quads)
+    {
+        m_recording->textureQuads(texture, quads);
+    }
+
+    void ThreadedRenderer::destroyTexture(TextureHandle texture)
+    {
+        if(m_textureSizes.erase(texture))
+            m_recording->destroyTexture(texture);
+    }
+
+    void ThreadedRenderer::setAntiAliasing(bool enable)
+    {
+        m_recording->setAntiAliasing(enable);
+    }
+
+    void ThreadedRenderer::setVSync(bool enable)
+    {
+        // Not running yet: the backend just remembers it for initialize()
+        if(!m_started)
+        {
+            m_backend->setVSync(enable);
+            return;
+        }
+
+        // Rare, and must reach the backend before the next present: apply synchronously
+        bool value = enable;
+        invoke([](void* user, Renderer* backend) { backend->setVSync(*static_cast<bool*>(user)); },
+               &value);
+    }
+
+    void ThreadedRenderer::recordCallback(RenderCallback fn, void* user)
+    {
+        m_recording->callback(fn, user);
+    }
+
+    void* ThreadedRenderer::getNativeRenderer() const
+    {
+        return m_backend->getNativeRenderer();
+    }
+
+    void ThreadedRenderer::getWindowSize(int& width, int& height) const
+    {
+        m_backend->getWindowSize(width, height);
+    }
+
+} // namespace tfv
@@ -20,11 +20,14 @@ namespace tfv
     void HeatmapLayer::onAttach()
     {
         m_heatmapRenderer = std::make_unique<HeatmapRenderer>(m_renderer);
+        m_densityRenderer = std::make_unique<DensityHeatmapRenderer>(m_renderer);
+        m_densityRenderer->setLut(m_heatmapRenderer->lut());
     }
 
     void HeatmapLayer::onDetach()
     {
         m_heatmapRenderer.reset();
+        m_densityRenderer.reset();
     }
 
     bool HeatmapLayer::onEvent(void* event)
@@ -48,10 +51,21 @@ namespace tfv
         if(!network)
             return;
 
-        // Draw the heatmap based on congestion levels
-        m_heatmapRenderer->draw(network, m_simulation->getCongestionLevels(),
-                                m_simulationLayer->getPanX(), m_simulationLayer->getPanY(),
-                                m_simulationLayer->getZoom());
+        SimulationStatePtr state = m_simulation->currentState();
+        const SegmentGeometry& geom = network->geometry();
+        const ViewTransform view =
+            m_simulationLayer->getCamera().transform(geom.originX, geom.originY);
+
+        if(m_mode == HeatmapMode::DENSITY)
+        {
+            // Re-bins only vehicles that changed cell since the last tick
+            m_densityRenderer->update(network, *state, view.scale());
+            m_densityRenderer->draw(view);
+            return;
+        }
+
+        // Draw the heatmap from the published congestion array (no per-frame map copy)
+        m_heatmapRenderer->draw(network, state->congestion, view);
     }
 
     void HeatmapLayer::onImGuiRender()
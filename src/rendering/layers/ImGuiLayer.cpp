@@ -2,6 +2,9 @@
 #include <imgui.h>
 #include <imgui_impl_sdl2.h>
 #include <imgui_impl_sdlrenderer2.h>
+
+#include <cfloat>
+#include <glm/glm.hpp>
 #include <iostream>
 
 namespace tfv
@@ -33,7 +36,10 @@ namespace tfv
 
         // Setup Platform/Renderer backends
         ImGui_ImplSDL2_InitForSDLRenderer(m_window, m_renderer);
-        ImGui_ImplSDLRenderer2_Init(m_renderer);
+        if(m_threadedRenderer)
+            m_threadedRenderer->invoke(&ImGuiLayer::backendInit, this);
+        else
+            ImGui_ImplSDLRenderer2_Init(m_renderer);
 
         m_initialized = true;
         m_showKeybindings = true; // Show keybindings by default
@@ -43,7 +49,11 @@ namespace tfv
     {
         if(m_initialized)
         {
-            ImGui_ImplSDLRenderer2_Shutdown();
+            // The SDL renderer backend belongs to the render thread when rendering is threaded
+            if(m_threadedRenderer)
+                m_threadedRenderer->invoke(&ImGuiLayer::backendShutdown, this);
+            else
+                ImGui_ImplSDLRenderer2_Shutdown();
             ImGui_ImplSDL2_Shutdown();
             ImGui::DestroyContext();
             m_initialized = false;
@@ -75,8 +85,12 @@ namespace tfv
         if(!m_initialized)
             return;
 
-        // Start the Dear ImGui frame
-        ImGui_ImplSDLRenderer2_NewFrame();
+        // Start the Dear ImGui frame. With threaded rendering this also waits until the render
+        // thread has finished with the previous frame's draw data.
+        if(m_threadedRenderer)
+            m_threadedRenderer->invoke(&ImGuiLayer::backendNewFrame, this);
+        else
+            ImGui_ImplSDLRenderer2_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
     }
@@ -98,12 +112,40 @@ namespace tfv
             renderKeybindingsWindow();
         }
 
+        // Inspector for the clicked vehicle/segment
+        renderInspectorWindow();
+
         // Render status bar at the bottom
         renderStatusBar();
 
         // Render ImGui
         ImGui::Render();
-        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), m_renderer);
+        if(m_threadedRenderer)
+            m_threadedRenderer->recordCallback(&ImGuiLayer::submitDrawData, this);
+        else
+            ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), m_renderer);
+    }
+
+    void ImGuiLayer::backendInit(void* user, Renderer*)
+    {
+        ImGui_ImplSDLRenderer2_Init(static_cast<ImGuiLayer*>(user)->m_renderer);
+    }
+
+    void ImGuiLayer::backendNewFrame(void*, Renderer*)
+    {
+        ImGui_ImplSDLRenderer2_NewFrame();
+    }
+
+    void ImGuiLayer::submitDrawData(void* user, Renderer*)
+    {
+        // Draw data stays valid until the next ImGui::NewFrame(), which waits for this frame
+        auto* layer = static_cast<ImGuiLayer*>(user);
+        ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData(), layer->m_renderer);
+    }
+
+    void ImGuiLayer::backendShutdown(void*, Renderer*)
+    {
+        ImGui_ImplSDLRenderer2_Shutdown();
     }
 
     void ImGuiLayer::renderDockspace()
@@ -260,24 +302,113 @@ namespace tfv
             ImGui::Text("FPS: %d", m_fps);
 
             ImGui::SameLine(100);
-            int vehicleCount = m_simulation ? m_simulation->snapshot().size() : 0;
+            int vehicleCount =
+                m_simulation ? static_cast<int>(m_simulation->currentState()->vehicles.size()) : 0;
             ImGui::Text("Vehicles: %d", vehicleCount);
 
             if(m_simulationLayer)
             {
                 ImGui::SameLine(200);
-                ImGui::Text("Zoom: %.1fx", m_simulationLayer->getZoom());
+                ImGui::Text("Zoom: %.3gx", m_simulationLayer->getZoom());
             }
 
+            ImGui::SameLine(300);
+            ImGui::Text("Frame p50/p95/p99: %.1f/%.1f/%.1f ms", m_frameStats.p50,
+                        m_frameStats.p95, m_frameStats.p99);
+
             if(m_recordingManager && m_recordingManager->isRecording())
             {
-                ImGui::SameLine(300);
+                ImGui::SameLine(560);
                 ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 0, 0, 255));
                 ImGui::Text("● RECORDING");
                 ImGui::PopStyleColor();
+
+                // Frames the writer could not keep up with (DROP policy)
+                const FramePoolStats rec = m_recordingManager->getStats();
+                if(rec.dropped > 0)
+                {
+                    ImGui::SameLine();
+                    ImGui::Text("%llu dropped", static_cast<unsigned long long>(rec.dropped));
+                }
+            }
+        }
+        ImGui::End();
+    }
+
+    void ImGuiLayer::renderInspectorWindow()
+    {
+        if(!m_simulationLayer || !m_simulation)
+            return;
+        const PickResult& selection = m_simulationLayer->getSelection();
+        if(selection.empty())
+            return;
+
+        bool open = true;
+        ImGui::SetNextWindowSize(ImVec2(320, 420), ImGuiCond_FirstUseEver);
+        if(ImGui::Begin("Inspector", &open))
+        {
+            ImGui::TextDisabled("Pick: %.3f ms", m_simulationLayer->getLastPickMs());
+
+            // Live values: looked up in the latest state every frame
+            if(selection.hasVehicle)
+            {
+                ImGui::SeparatorText("Vehicle");
+                SimulationStatePtr state = m_simulation->currentState();
+                if(const Vehicle* v = state->findVehicle(selection.vehicleId))
+                {
+                    ImGui::Text("Id: %llu", static_cast<unsigned long long>(v->id));
+                    ImGui::Text("Type: %s", v->type.c_str());
+                    ImGui::Text("Segment: %u  (%.0f%% along)", v->segmentId, v->position * 100.f);
+                    ImGui::Text("Speed: %.1f km/h", glm::length(v->vel) * 3.6f);
+                    ImGui::Text("Velocity: (%.2f, %.2f)", v->vel.x, v->vel.y);
+                    ImGui::Text("Acceleration: (%.2f, %.2f)", v->acc.x, v->acc.y);
+                    ImGui::Text("Size: %.1f x %.1f m", v->length, v->width);
+                }
+                else
+                {
+                    ImGui::TextDisabled("Vehicle %llu has left the simulation",
+                                        static_cast<unsigned long long>(selection.vehicleId));
+                }
+            }
+
+            const RoadNetwork* net = m_simulation->getRoadNetwork();
+            RoadSegment segment{};
+            SegmentStatistics stats;
+            if(selection.hasSegment() && net && selection.segment < net->geometry().size() &&
+               m_simulation->inspectSegment(net->geometry().ids[selection.segment], segment,
+                                            stats))
+            {
+                ImGui::SeparatorText("Segment");
+                ImGui::Text("Id: %u  (node %u -> %u)", segment.id, segment.fromNode,
+                            segment.toNode);
+                ImGui::Text("Length: %.1f m, %d lane(s)", segment.length, segment.lanes);
+                ImGui::Text("Speed limit: %.1f km/h", segment.speedLimit * 3.6f);
+                ImGui::Text("Current speed: %.1f km/h", segment.currentSpeed * 3.6f);
+                ImGui::Text("Vehicles: %d", segment.vehicleCount);
+                ImGui::Text("Congestion: %.0f%%", segment.congestionLevel * 100.f);
+
+                ImGui::SeparatorText("Statistics");
+                ImGui::Text("Average speed: %.1f km/h", stats.avgSpeed * 3.6f);
+                ImGui::Text("Average density: %.1f", stats.avgDensity);
+                if(!stats.speedHistory.empty())
+                {
+                    ImGui::PlotLines("Speed", stats.speedHistory.data(),
+                                     static_cast<int>(stats.speedHistory.size()), 0, nullptr,
+                                     0.f, FLT_MAX, ImVec2(0, 40));
+                }
+                if(!stats.densityHistory.empty())
+                {
+                    std::vector<float> density(stats.densityHistory.begin(),
+                                               stats.densityHistory.end());
+                    ImGui::PlotLines("Density", density.data(), static_cast<int>(density.size()),
+                                     0, nullptr, 0.f, FLT_MAX, ImVec2(0, 40));
+                }
             }
         }
         ImGui::End();
+
+        if(!open)
+            m_simulationLayer->clearSelection();
     }
 
     void ImGuiLayer::renderKeybindingsWindow()
@@ -288,18 +419,22 @@ namespace tfv
             ImGui::Text("Navigation Controls:");
             ImGui::BulletText("Arrow Keys - Pan the view");
             ImGui::BulletText("Mouse Wheel - Zoom in/out");
+            ImGui::BulletText("Left Click - Inspect vehicle/segment");
             ImGui::BulletText("+/- Keys - Zoom in/out");
 
             ImGui::Separator();
 
             ImGui::Text("Feature Toggles:");
             ImGui::BulletText("H - Toggle heatmap");
+            ImGui::BulletText("D - Switch heatmap mode (segments/density)");
+            ImGui::BulletText("T - Toggle segment/vehicle labels");
             ImGui::BulletText("L - Toggle live feed");
             ImGui::BulletText("A - Toggle alerts");
             ImGui::BulletText("R - Toggle recording");
             ImGui::BulletText("I - Toggle ImGui interface");
             ImGui::BulletText("G - Toggle anti-aliasing");
             ImGui::BulletText("K - Toggle this window");
+            ImGui::BulletText("P - Pause/resume simulation");
 
             ImGui::Separator();
 
@@ -1,5 +1,6 @@
 #include "rendering/layers/SimulationLayer.hpp"
 #include <SDL2/SDL.h>
+#include <chrono>
 
 namespace tfv
 {
@@ -41,37 +42,53 @@ namespace tfv
             {
             // Pan with arrow keys
             case SDLK_LEFT:
-                setPan(getPanX() + 20, getPanY());
+                getCamera().pan(kPanStep, 0.0);
                 return true;
             case SDLK_RIGHT:
-                setPan(getPanX() - 20, getPanY());
+                getCamera().pan(-kPanStep, 0.0);
                 return true;
             case SDLK_UP:
-                setPan(getPanX(), getPanY() + 20);
+                getCamera().pan(0.0, kPanStep);
                 return true;
             case SDLK_DOWN:
-                setPan(getPanX(), getPanY() - 20);
+                getCamera().pan(0.0, -kPanStep);
                 return true;
 
-            // Zoom controls
+            // Zoom controls, about the view centre
             case SDLK_EQUALS: // '+' key (zoom in)
             case SDLK_KP_PLUS:
-                setZoom(getZoom() * 1.1f);
+                getCamera().setZoom(getZoom() * kZoomStep);
                 return true;
             case SDLK_MINUS: // '-' key (zoom out)
             case SDLK_KP_MINUS:
-                setZoom(getZoom() / 1.1f);
+                getCamera().setZoom(getZoom() / kZoomStep);
                 return true;
             }
         }
 
-        // Zoom with mouse wheel
+        // Hover highlights whatever is under the cursor; a left click selects it
+        if(sdlEvent->type == SDL_MOUSEMOTION)
+        {
+            m_hover = pick(sdlEvent->motion.x, sdlEvent->motion.y);
+            m_sceneRenderer->setHover(m_hover);
+            return false;
+        }
+        if(sdlEvent->type == SDL_MOUSEBUTTONDOWN && sdlEvent->button.button == SDL_BUTTON_LEFT)
+        {
+            m_selection = pick(sdlEvent->button.x, sdlEvent->button.y);
+            m_sceneRenderer->setSelection(m_selection);
+            return !m_selection.empty();
+        }
+
+        // Zoom with mouse wheel, keeping the point under the cursor in place
         if(sdlEvent->type == SDL_MOUSEWHEEL)
         {
+            int mouseX = 0, mouseY = 0;
+            SDL_GetMouseState(&mouseX, &mouseY);
             if(sdlEvent->wheel.y > 0)
-                setZoom(getZoom() * 1.1f);
+                getCamera().zoomAt(kZoomStep, mouseX, mouseY);
             else if(sdlEvent->wheel.y < 0)
-                setZoom(getZoom() / 1.1f);
+                getCamera().zoomAt(1.0 / kZoomStep, mouseX, mouseY);
             return true;
         }
 
@@ -87,11 +104,11 @@ namespace tfv
 
     void SimulationLayer::onRender()
     {
-        // Get current vehicle snapshot from simulation
-        VehicleMap vehicles = m_simulation->snapshot();
+        // Latest two published states (shared, no copy)
+        PublishedStates states = m_simulation->publishedStates();
 
-        // Draw scene contents with the latest vehicle data
-        m_sceneRenderer->draw(vehicles);
+        // Draw scene contents interpolated at the render timestamp
+        m_sceneRenderer->draw(states.previous, states.current, m_renderTime);
     }
 
     void SimulationLayer::onImGuiRender()
@@ -99,30 +116,61 @@ namespace tfv
         // No ImGui rendering needed for this layer
     }
 
-    // Scene control methods
-    void SimulationLayer::setPan(float x, float y)
+    PickResult SimulationLayer::pick(int screenX, int screenY) const
     {
-        m_sceneRenderer->setPan(x, y);
+        PickResult result;
+        const RoadNetwork* net = m_simulation->getRoadNetwork();
+        if(!net)
+            return result;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        // Screen to world in double, then into the geometry's local frame
+        const Camera& camera = getCamera();
+        const glm::dvec2 world = camera.screenToWorld({screenX, screenY});
+        const SegmentGeometry& geom = net->geometry();
+        const auto wx = static_cast<float>(world.x - geom.originX);
+        const auto wy = static_cast<float>(world.y - geom.originY);
+        const auto radius = static_cast<float>(kPickRadius / camera.zoom());
+
+        // Vehicles win over the road they are on; a picked vehicle also selects its segment.
+        // Both are tested where they were last drawn, not at the latest tick.
+        result = m_sceneRenderer->pickVehicle(wx, wy, radius);
+        if(!result.hasVehicle)
+            result.segment = net->nearestSegment(wx, wy, radius);
+
+        m_lastPickMs = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+        return result;
     }
 
-    void SimulationLayer::setZoom(float zoom)
+    void SimulationLayer::clearSelection()
+    {
+        m_selection = PickResult{};
+        if(m_sceneRenderer)
+            m_sceneRenderer->setSelection(m_selection);
+    }
+
+    // Scene control methods
+    Camera& SimulationLayer::getCamera()
     {
-        m_sceneRenderer->setZoom(zoom);
+        return m_sceneRenderer->camera();
     }
 
-    float SimulationLayer::getPanX() const
+    const Camera& SimulationLayer::getCamera() const
     {
-        return m_sceneRenderer->getPanX();
+        return m_sceneRenderer->camera();
     }
 
-    float SimulationLayer::getPanY() const
+    void SimulationLayer::setLabelsEnabled(bool enable)
     {
-        return m_sceneRenderer->getPanY();
+        m_sceneRenderer->setLabelsEnabled(enable);
     }
 
-    float SimulationLayer::getZoom() const
+    bool SimulationLayer::getLabelsEnabled() const
     {
-        return m_sceneRenderer->getZoom();
+        return m_sceneRenderer->getLabelsEnabled();
     }
 
 } // namespace tfv
\ No newline at end of file
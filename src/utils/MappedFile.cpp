@@ -0,0 +1,124 @@
+#include "utils/MappedFile.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tfv
+{
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if(this != &other)
+        {
+            close();
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+#ifdef _WIN32
+            std::swap(m_file, other.m_file);
+            std::swap(m_mapping, other.m_mapping);
+#endif
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if(file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if(!data)
+        {
+            if(mapping)
+                CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+        m_file = file;
+        m_mapping = mapping;
+        m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            return false;
+        struct stat info;
+        if(fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ,
+                          MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping keeps the file alive
+        if(data == MAP_FAILED)
+            return false;
+        m_size = static_cast<std::size_t>(info.st_size);
+#endif
+        m_data = static_cast<const uint8_t*>(data);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if(!m_data)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+        CloseHandle(static_cast<HANDLE>(m_file));
+        m_file = m_mapping = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    void MappedFile::prefetch(std::size_t offset, std::size_t length) const
+    {
+        if(!m_data || offset >= m_size)
+            return;
+        length = std::min(length, m_size - offset);
+#ifdef _WIN32
+        WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t*>(m_data) + offset, length};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+        // madvise wants a page-aligned start
+        const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        const std::size_t start = offset / page * page;
+        madvise(const_cast<uint8_t*>(m_data) + start, length + (offset - start), MADV_WILLNEED);
+#endif
+    }
+
+} // namespace tfv
@@ -0,0 +1,83 @@
+#include "utils/TaskPool.hpp"
+
+#include <algorithm>
+
+namespace tfv
+{
+    TaskPool::TaskPool(std::size_t threads)
+    {
+        if(threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        m_threads.reserve(threads);
+        for(std::size_t i = 0; i < threads; ++i)
+            m_threads.emplace_back(&TaskPool::workerLoop, this);
+    }
+
+    TaskPool::~TaskPool()
+    {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_stop = true;
+        }
+        m_wakeCv.notify_all();
+        for(auto& thread : m_threads)
+            thread.join();
+    }
+
+    void TaskPool::run(std::size_t count, const std::function<void(std::size_t)>& task)
+    {
+        if(count == 0)
+            return;
+        if(m_threads.empty() || count == 1)
+        {
+            for(std::size_t i = 0; i < count; ++i)
+                task(i);
+            return;
+        }
+
+        {
+            std::scoped_lock lock(m_mutex);
+            m_task = &task;
+            m_count = count;
+            m_next = 0;
+            ++m_generation;
+        }
+        m_wakeCv.notify_all();
+
+        drain();
+
+        // Every index is claimed; wait for the workers still finishing theirs
+        std::unique_lock lock(m_mutex);
+        m_doneCv.wait(lock, [&] { return m_active == 0; });
+        m_task = nullptr;
+    }
+
+    void TaskPool::drain()
+    {
+        for(std::size_t i = m_next++; i < m_count; i = m_next++)
+            (*m_task)(i);
+    }
+
+    void TaskPool::workerLoop()
+    {
+        uint64_t seen = 0;
+        std::unique_lock lock(m_mutex);
+        while(true)
+        {
+            m_wakeCv.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if(m_stop)
+                return;
+            seen = m_generation;
+            if(!m_task)
+                continue; // Woke after that run had already finished
+
+            ++m_active;
+            lock.unlock();
+            drain();
+            lock.lock();
+            if(--m_active == 0)
+                m_doneCv.notify_one();
+        }
+    }
+
+} // namespace tfv